@@ -0,0 +1,485 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+// Support for textures in ZIP archives (and PK3 files, which are just renamed
+// ZIPs), with paths like "/path/to/game.pk3/textures/wall.dds".
+// The platform specific file functions (sys_*.cpp) call the functions in here
+// for such paths, so loading, the browser and --validate just work with them.
+// The central directory of an archive is only parsed once into a hash table,
+// the archive itself stays memory-mapped while it's used, so files that are
+// stored uncompressed (like usually DDS files in PK3s) are used directly from
+// that mapping without any copying. Deflated files are decompressed into a
+// buffer instead, which happens in the thread that's loading the texture
+// (usually a worker thread).
+
+#include "texview.h"
+
+#include "libs/stb_image.h" // stbi_zlib_decode_noheader_buffer()
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _WIN32
+	#define strcasecmp _stricmp
+#endif
+
+namespace texview {
+
+enum {
+	ZIP_EOCD_SIZE = 22,
+	ZIP_EOCD_MAX_COMMENT_LEN = 0xFFFF,
+	ZIP64_EOCD_LOCATOR_SIZE = 20,
+	ZIP64_EOCD_SIZE = 56,
+	ZIP_CENTRAL_HEADER_SIZE = 46,
+	ZIP_LOCAL_HEADER_SIZE = 30,
+
+	ZIP_METHOD_STORED = 0,
+	ZIP_METHOD_DEFLATED = 8,
+
+	ZIP_FLAG_ENCRYPTED = 1,
+
+	// archives opened recently are kept (memory-mapped and indexed) even if no
+	// file in them is currently used, so switching between textures is fast
+	NUM_RECENT_ARCHIVES = 8
+};
+
+static const uint32_t ZIP_EOCD_SIG = 0x06054b50;
+static const uint32_t ZIP64_EOCD_LOCATOR_SIG = 0x07064b50;
+static const uint32_t ZIP64_EOCD_SIG = 0x06064b50;
+static const uint32_t ZIP_CENTRAL_HEADER_SIG = 0x02014b50;
+static const uint32_t ZIP_LOCAL_HEADER_SIG = 0x04034b50;
+
+// ZIPs are little endian, and the headers aren't necessarily aligned
+static uint16_t ReadU16(const uint8_t* p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t ReadU32(const uint8_t* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t ReadU64(const uint8_t* p)
+{
+	return ReadU32(p) | ((uint64_t)ReadU32(p + 4) << 32);
+}
+
+struct ArchiveEntry {
+	uint64_t localHeaderOffset = 0;
+	uint64_t compressedSize = 0;
+	uint64_t uncompressedSize = 0;
+	uint16_t method = 0;
+	uint16_t flags = 0;
+};
+
+struct Archive {
+	std::string path;
+	MemMappedFile* mmf = nullptr;
+	uint64_t fileSize = 0;
+	int64_t modTime = 0;
+	// key is the full name in the archive, like "textures/wall.dds"
+	std::unordered_map<std::string, ArchiveEntry> entries;
+	// all directories (also implicit ones), without trailing '/'
+	std::unordered_set<std::string> dirs;
+
+	~Archive()
+	{
+		if(mmf != nullptr) {
+			UnloadMemMappedFile(mmf);
+		}
+	}
+
+	bool ParseCentralDirectory();
+	const uint8_t* GetEntryData(const ArchiveEntry& e) const;
+};
+
+bool Archive::ParseCentralDirectory()
+{
+	const uint8_t* data = (const uint8_t*)mmf->data;
+	const uint64_t len = mmf->length;
+	const char* fn = path.c_str();
+	if(len < ZIP_EOCD_SIZE) {
+		errprintf("'%s' is too small to be a ZIP archive!\n", fn);
+		return false;
+	}
+	// the end of central directory record is at the end of the file,
+	// followed only by the (optional) comment
+	const uint8_t* eocd = nullptr;
+	uint64_t minPos = (len > ZIP_EOCD_SIZE + ZIP_EOCD_MAX_COMMENT_LEN) ? len - ZIP_EOCD_SIZE - ZIP_EOCD_MAX_COMMENT_LEN : 0;
+	for(uint64_t pos = len - ZIP_EOCD_SIZE + 1; pos-- > minPos; ) {
+		if(ReadU32(data + pos) == ZIP_EOCD_SIG && pos + ZIP_EOCD_SIZE + ReadU16(data + pos + 20) <= len) {
+			eocd = data + pos;
+			break;
+		}
+	}
+	if(eocd == nullptr) {
+		errprintf("Couldn't find the end of central directory in '%s', is it really a ZIP archive?\n", fn);
+		return false;
+	}
+	uint64_t numEntries = ReadU16(eocd + 10);
+	uint64_t cdSize = ReadU32(eocd + 12);
+	uint64_t cdOffset = ReadU32(eocd + 16);
+	if(numEntries == 0xFFFF || cdSize == 0xFFFFFFFF || cdOffset == 0xFFFFFFFF) {
+		// ZIP64 archive (>= 4GB or >= 64k files), the real values are in the ZIP64 EOCD record
+		uint64_t eocdPos = eocd - data;
+		const uint8_t* loc = (eocdPos >= ZIP64_EOCD_LOCATOR_SIZE) ? eocd - ZIP64_EOCD_LOCATOR_SIZE : nullptr;
+		if(loc == nullptr || ReadU32(loc) != ZIP64_EOCD_LOCATOR_SIG) {
+			errprintf("'%s' looks like a ZIP64 archive, but has no ZIP64 end of central directory locator!\n", fn);
+			return false;
+		}
+		uint64_t eocd64Pos = ReadU64(loc + 8);
+		if(len < ZIP64_EOCD_SIZE || eocd64Pos > len - ZIP64_EOCD_SIZE || ReadU32(data + eocd64Pos) != ZIP64_EOCD_SIG) {
+			errprintf("Invalid ZIP64 end of central directory record in '%s'!\n", fn);
+			return false;
+		}
+		const uint8_t* eocd64 = data + eocd64Pos;
+		numEntries = ReadU64(eocd64 + 32);
+		cdSize = ReadU64(eocd64 + 40);
+		cdOffset = ReadU64(eocd64 + 48);
+	}
+	if(cdOffset > len || cdSize > len - cdOffset) {
+		errprintf("Invalid central directory offset or size in '%s'!\n", fn);
+		return false;
+	}
+
+	// each entry needs at least a central directory header, so a bogus count
+	// (esp. the 64bit one from ZIP64) can't make us allocate lots of memory
+	if(numEntries > cdSize / ZIP_CENTRAL_HEADER_SIZE) {
+		errprintf("Invalid number of entries (%llu) in central directory of '%s'!\n", (unsigned long long)numEntries, fn);
+		return false;
+	}
+	entries.reserve(numEntries);
+	const uint8_t* cd = data + cdOffset;
+	const uint8_t* cdEnd = cd + cdSize;
+	for(uint64_t i = 0; i < numEntries; ++i) {
+		if(cdEnd - cd < ZIP_CENTRAL_HEADER_SIZE || ReadU32(cd) != ZIP_CENTRAL_HEADER_SIG) {
+			errprintf("Invalid central directory header for entry %d in '%s'!\n", (int)i, fn);
+			return false;
+		}
+		uint16_t nameLen = ReadU16(cd + 28);
+		uint16_t extraLen = ReadU16(cd + 30);
+		uint16_t commentLen = ReadU16(cd + 32);
+		uint64_t headerLen = ZIP_CENTRAL_HEADER_SIZE + nameLen + extraLen + commentLen;
+		if((uint64_t)(cdEnd - cd) < headerLen) {
+			errprintf("Central directory of '%s' is truncated!\n", fn);
+			return false;
+		}
+		ArchiveEntry e;
+		e.flags = ReadU16(cd + 8);
+		e.method = ReadU16(cd + 10);
+		e.compressedSize = ReadU32(cd + 20);
+		e.uncompressedSize = ReadU32(cd + 24);
+		e.localHeaderOffset = ReadU32(cd + 42);
+
+		// if one of those is 0xFFFFFFFF, the real value is in the ZIP64 extra field,
+		// which only contains the values that didn't fit, in this order
+		if(e.uncompressedSize == 0xFFFFFFFF || e.compressedSize == 0xFFFFFFFF || e.localHeaderOffset == 0xFFFFFFFF) {
+			const uint8_t* extra = cd + ZIP_CENTRAL_HEADER_SIZE + nameLen;
+			const uint8_t* extraEnd = extra + extraLen;
+			while(extraEnd - extra >= 4) {
+				uint16_t id = ReadU16(extra);
+				uint16_t size = ReadU16(extra + 2);
+				const uint8_t* field = extra + 4;
+				const uint8_t* fieldEnd = field + size;
+				if(fieldEnd > extraEnd) {
+					break;
+				}
+				if(id == 0x0001) {
+					uint64_t* vals[3] = { &e.uncompressedSize, &e.compressedSize, &e.localHeaderOffset };
+					for(uint64_t* v : vals) {
+						if(*v == 0xFFFFFFFF && fieldEnd - field >= 8) {
+							*v = ReadU64(field);
+							field += 8;
+						}
+					}
+					break;
+				}
+				extra = fieldEnd;
+			}
+		}
+
+		std::string name((const char*)cd + ZIP_CENTRAL_HEADER_SIZE, nameLen);
+		cd += headerLen;
+
+		// some (Windows) tools write backslashes, even though the spec says they shouldn't
+		std::replace(name.begin(), name.end(), '\\', '/');
+		bool isDir = !name.empty() && name.back() == '/';
+		if(isDir) {
+			name.pop_back();
+		}
+		if(name.empty()) {
+			continue;
+		}
+		// add all parent directories, so they can be browsed even if the
+		// archive doesn't have explicit entries for them
+		for(size_t slashPos = isDir ? name.length() : name.rfind('/');
+		    slashPos != std::string::npos && slashPos > 0;
+		    slashPos = name.rfind('/', slashPos - 1)) {
+			if(!dirs.insert(name.substr(0, slashPos)).second) {
+				break; // already known => its parents are known as well
+			}
+		}
+		if(!isDir) {
+			entries[std::move(name)] = e;
+		}
+	}
+	return true;
+}
+
+// returns nullptr if the local header is broken
+const uint8_t* Archive::GetEntryData(const ArchiveEntry& e) const
+{
+	const uint8_t* data = (const uint8_t*)mmf->data;
+	const uint64_t len = mmf->length;
+	uint64_t off = e.localHeaderOffset;
+	if(off > len || len - off < ZIP_LOCAL_HEADER_SIZE || ReadU32(data + off) != ZIP_LOCAL_HEADER_SIG) {
+		return nullptr;
+	}
+	// the name and extra field lengths in the local header can be different
+	// from the ones in the central directory
+	off += ZIP_LOCAL_HEADER_SIZE + ReadU16(data + off + 26) + ReadU16(data + off + 28);
+	if(off > len || len - off < e.compressedSize) {
+		return nullptr;
+	}
+	return data + off;
+}
+
+static std::mutex archivesMutex;
+// the most recently used archive is at the front
+static std::vector<std::shared_ptr<Archive>> recentArchives;
+
+static std::shared_ptr<Archive> GetArchive(const std::string& archivePath)
+{
+	uint64_t size = 0;
+	int64_t modTime = 0;
+	if(!GetFileSizeAndModTime(archivePath.c_str(), &size, &modTime)) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(archivesMutex);
+	for(size_t i = 0; i < recentArchives.size(); ++i) {
+		std::shared_ptr<Archive> arc = recentArchives[i];
+		if(arc->path != archivePath) {
+			continue;
+		}
+		recentArchives.erase(recentArchives.begin() + i);
+		if(arc->fileSize == size && arc->modTime == modTime) {
+			recentArchives.insert(recentArchives.begin(), arc);
+			return arc;
+		}
+		// the archive has changed => open it again. Files still loaded from
+		// the old one keep the old version alive until they're unloaded
+		break;
+	}
+
+	std::shared_ptr<Archive> arc = std::make_shared<Archive>();
+	arc->path = archivePath;
+	arc->fileSize = size;
+	arc->modTime = modTime;
+	arc->mmf = LoadMemMappedFile(archivePath.c_str());
+	if(arc->mmf == nullptr) {
+		return nullptr;
+	}
+	double startTime = GetTimeSeconds();
+	if(!arc->ParseCentralDirectory()) {
+		return nullptr;
+	}
+	LogInfo("Opened archive '%s' with %d files in %.2fms\n", archivePath.c_str(),
+	        (int)arc->entries.size(), (GetTimeSeconds() - startTime) * 1000.0);
+
+	recentArchives.insert(recentArchives.begin(), arc);
+	if(recentArchives.size() > NUM_RECENT_ARCHIVES) {
+		recentArchives.pop_back();
+	}
+	return arc;
+}
+
+bool IsArchiveFileName(const char* name)
+{
+	size_t len = strlen(name);
+	if(len < 4) {
+		return false;
+	}
+	const char* ext = name + len - 4;
+	return strcasecmp(ext, ".zip") == 0 || strcasecmp(ext, ".pk3") == 0;
+}
+
+static bool IsDirSeparator(char c)
+{
+#ifdef _WIN32
+	return c == '/' || c == '\\';
+#else
+	return c == '/';
+#endif
+}
+
+bool SplitArchivePath(const char* path, std::string* archivePath, std::string* entryName)
+{
+	std::string prefix;
+	for(const char* sep = path; *sep != '\0'; ++sep) {
+		if(!IsDirSeparator(*sep) || sep[1] == '\0') {
+			continue;
+		}
+		// only check (with a syscall) if the part before this separator is
+		// an archive file if it has the right extension, that's cheap
+		prefix.assign(path, sep - path);
+		if(!IsArchiveFileName(prefix.c_str())) {
+			continue;
+		}
+		uint64_t size = 0;
+		int64_t modTime = 0;
+		// prefix is shorter than path, so this doesn't recurse endlessly
+		if(GetFileSizeAndModTime(prefix.c_str(), &size, &modTime)) {
+			*archivePath = std::move(prefix);
+			entryName->assign(sep + 1);
+			std::replace(entryName->begin(), entryName->end(), '\\', '/');
+			while(!entryName->empty() && entryName->back() == '/') {
+				entryName->pop_back();
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+MemMappedFile* LoadArchiveEntry(const std::string& archivePath, const std::string& entryName)
+{
+	std::shared_ptr<Archive> arc = GetArchive(archivePath);
+	if(arc == nullptr) {
+		return nullptr;
+	}
+	auto it = arc->entries.find(entryName);
+	if(it == arc->entries.end()) {
+		errprintf("Couldn't find '%s' in archive '%s'!\n", entryName.c_str(), archivePath.c_str());
+		return nullptr;
+	}
+	const ArchiveEntry& e = it->second;
+	const char* fn = entryName.c_str();
+	if(e.flags & ZIP_FLAG_ENCRYPTED) {
+		errprintf("Can't load '%s' from '%s', it's encrypted!\n", fn, archivePath.c_str());
+		return nullptr;
+	}
+	if(e.uncompressedSize == 0) {
+		errprintf("Can't load '%s' from '%s', it's empty!\n", fn, archivePath.c_str());
+		return nullptr;
+	}
+	const uint8_t* data = arc->GetEntryData(e);
+	if(data == nullptr) {
+		errprintf("Can't load '%s' from '%s', its local header is broken!\n", fn, archivePath.c_str());
+		return nullptr;
+	}
+
+	MemMappedFile* ret = nullptr;
+	if(e.method == ZIP_METHOD_STORED) {
+		if(e.compressedSize != e.uncompressedSize) {
+			errprintf("Can't load '%s' from '%s', invalid size!\n", fn, archivePath.c_str());
+			return nullptr;
+		}
+		// zero-copy: just point into the archive's mapping
+		ret = new MemMappedFile;
+		ret->data = data;
+	} else if(e.method == ZIP_METHOD_DEFLATED) {
+		if(e.uncompressedSize > INT_MAX || e.compressedSize > INT_MAX) {
+			errprintf("Can't load '%s' from '%s', it's too big for the deflate decoder!\n", fn, archivePath.c_str());
+			return nullptr;
+		}
+		char* buf = (char*)malloc(e.uncompressedSize);
+		if(buf == nullptr) {
+			errprintf("Couldn't allocate %zu bytes to decompress '%s' from '%s'!\n",
+			          (size_t)e.uncompressedSize, fn, archivePath.c_str());
+			return nullptr;
+		}
+		int len = stbi_zlib_decode_noheader_buffer(buf, (int)e.uncompressedSize, (const char*)data, (int)e.compressedSize);
+		if(len != (int)e.uncompressedSize) {
+			errprintf("Decompressing '%s' from '%s' failed: %s\n", fn, archivePath.c_str(),
+			          len < 0 ? stbi_failure_reason() : "unexpected size");
+			free(buf);
+			return nullptr;
+		}
+		ret = new MemMappedFile;
+		ret->data = buf;
+		ret->ownsArchiveData = true;
+	} else {
+		errprintf("Can't load '%s' from '%s', unsupported compression method %d!\n", fn, archivePath.c_str(), e.method);
+		return nullptr;
+	}
+	ret->length = e.uncompressedSize;
+	ret->archive = std::move(arc);
+	return ret;
+}
+
+void UnloadArchiveEntry(MemMappedFile* mmf)
+{
+	if(mmf->ownsArchiveData) {
+		free((void*)mmf->data);
+	}
+	// this releases the reference to the archive, which gets unmapped when
+	// it's not in recentArchives anymore and no other file from it is loaded
+	delete mmf;
+}
+
+bool GetArchiveEntryInfo(const std::string& archivePath, const std::string& entryName,
+                         bool* isDir, uint64_t* size, int64_t* modTime)
+{
+	std::shared_ptr<Archive> arc = GetArchive(archivePath);
+	if(arc == nullptr) {
+		return false;
+	}
+	if(entryName.empty() || arc->dirs.count(entryName) != 0) {
+		*isDir = true;
+		*size = 0;
+	} else {
+		auto it = arc->entries.find(entryName);
+		if(it == arc->entries.end()) {
+			return false;
+		}
+		*isDir = false;
+		*size = it->second.uncompressedSize;
+	}
+	// files in the archive can't change without the archive changing
+	*modTime = arc->modTime;
+	return true;
+}
+
+bool ListArchiveDirectory(const std::string& archivePath, const std::string& dir,
+                          std::vector<std::string>* files, std::vector<std::string>* subDirs)
+{
+	std::shared_ptr<Archive> arc = GetArchive(archivePath);
+	if(arc == nullptr) {
+		return false;
+	}
+	if(!dir.empty() && arc->dirs.count(dir) == 0) {
+		errprintf("Couldn't find directory '%s' in archive '%s'!\n", dir.c_str(), archivePath.c_str());
+		return false;
+	}
+	std::string prefix = dir;
+	if(!prefix.empty()) {
+		prefix += '/';
+	}
+	auto addChild = [&prefix](const std::string& name, std::vector<std::string>* out) {
+		if(out != nullptr && name.length() > prefix.length()
+		   && name.compare(0, prefix.length(), prefix) == 0
+		   && name.find('/', prefix.length()) == std::string::npos) {
+			out->push_back(name.substr(prefix.length()));
+		}
+	};
+	for(const auto& it : arc->entries) {
+		addChild(it.first, files);
+	}
+	for(const std::string& d : arc->dirs) {
+		addChild(d, subDirs);
+	}
+	return true;
+}
+
+} //namespace texview
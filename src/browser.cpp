@@ -0,0 +1,507 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+// a window that lists the textures in a directory, with thumbnails.
+// The thumbnails are loaded from the disk cache (thumbcache.cpp) or created
+// by worker threads (from the smallest mip level that's big enough) and kept
+// in OpenGL textures, the least recently used ones are deleted when they
+// need more than thumbnailBudgetMB.
+
+#include <glad/gl.h>
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include <imgui.h>
+
+#include "texview.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _WIN32
+	#define strcasecmp _stricmp
+#endif
+
+namespace texview {
+
+#ifdef _WIN32
+static const char dirSeparator = '\\';
+static const char* dirSeparators = "/\\";
+#else
+static const char dirSeparator = '/';
+static const char* dirSeparators = "/";
+#endif
+
+// thumbnails are created with (at most) this size, and scaled when displayed
+static const int thumbnailSize = 128;
+
+static int thumbnailBudgetMB = 32;
+static float thumbnailDisplaySize = 96.0f;
+static bool showBrowserWindow = false;
+
+struct Thumbnail {
+	GLuint glTex = 0;
+	int width = 0;
+	int height = 0;
+	bool failed = false; // couldn't be created, don't try again
+	// if !failed and glTex == 0, it's not in the disk cache and must be created by a worker
+	uint64_t lastUsedFrame = 0;
+	std::list<std::string>::iterator lruIt; // only valid if glTex != 0
+};
+
+// all thumbnails that have been created (or failed or are waiting for a worker), by path
+static std::unordered_map<std::string, Thumbnail> thumbnails;
+// paths of thumbnails that have a GL texture, most recently used first
+static std::list<std::string> thumbnailLRU;
+static size_t thumbnailBytes = 0;
+static uint64_t curFrame = 0;
+
+// the thumbnails that were visible but not available yet during the last frame,
+// the worker jobs create them in that order
+static std::vector<std::string> wantedThumbnails;
+
+// the state shared with the worker jobs, protected by thumbMutex
+struct ThumbnailResult {
+	std::string path;
+	uint64_t cacheKey = 0;
+	std::vector<uint8_t> rgba;
+	int width = 0;
+	int height = 0;
+	bool ok = false;
+};
+static std::mutex thumbMutex;
+static std::deque<std::string> thumbQueue;
+static std::unordered_set<std::string> thumbsInProgress;
+static std::vector<ThumbnailResult> thumbResults;
+static int numThumbWorkers = 0;
+
+static void ThumbnailWorker()
+{
+	// broken files in the directory shouldn't spam the log or warning overlay
+	LogSetMutedInThisThread(true);
+	std::unique_lock<std::mutex> lock(thumbMutex);
+	while(!thumbQueue.empty()) {
+		std::string path = std::move(thumbQueue.front());
+		thumbQueue.pop_front();
+		thumbsInProgress.insert(path);
+		lock.unlock();
+
+		ThumbnailResult res;
+		res.path = path;
+		// get the key before loading, in case the file is modified in between
+		res.cacheKey = ThumbCacheGetKey(path.c_str());
+		{
+			Texture tex;
+			res.ok = tex.Load(path.c_str())
+			         && tex.CreateThumbnail(thumbnailSize, res.rgba, &res.width, &res.height);
+		}
+
+		lock.lock();
+		thumbsInProgress.erase(path);
+		thumbResults.push_back(std::move(res));
+	}
+	--numThumbWorkers;
+	lock.unlock();
+	LogSetMutedInThisThread(false);
+}
+
+static void EvictThumbnails(size_t budget)
+{
+	while(thumbnailBytes > budget && !thumbnailLRU.empty()) {
+		Thumbnail& t = thumbnails[thumbnailLRU.back()];
+		if(t.lastUsedFrame == curFrame) {
+			break; // all remaining ones are visible, better exceed the budget than flicker
+		}
+		glDeleteTextures(1, &t.glTex);
+		thumbnailBytes -= size_t(t.width) * t.height * 4;
+		// removing it from the map allows creating it again when it becomes visible again
+		std::string path = std::move(thumbnailLRU.back());
+		thumbnailLRU.pop_back();
+		thumbnails.erase(path);
+	}
+}
+
+static void CreateThumbnailTexture(const std::string& path, Thumbnail& t, const uint8_t* rgba, int width, int height)
+{
+	glGenTextures(1, &t.glTex);
+	glBindTexture(GL_TEXTURE_2D, t.glTex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	t.width = width;
+	t.height = height;
+	t.lastUsedFrame = curFrame;
+	thumbnailLRU.push_front(path);
+	t.lruIt = thumbnailLRU.begin();
+	thumbnailBytes += size_t(width) * height * 4;
+}
+
+// creates GL textures for the thumbnails the workers have finished
+// and queues the wanted ones for the workers
+static void UpdateThumbnails()
+{
+	std::vector<ThumbnailResult> results;
+	{
+		std::lock_guard<std::mutex> lock(thumbMutex);
+		results.swap(thumbResults);
+
+		// the ones that aren't visible anymore (because the user scrolled on)
+		// are dropped from the queue
+		thumbQueue.clear();
+		for(std::string& path : wantedThumbnails) {
+			if(thumbsInProgress.count(path) == 0) {
+				thumbQueue.push_back(std::move(path));
+			}
+		}
+		// leave one worker thread for loading the texture that's shown
+		int maxWorkers = std::max(1, ThreadPoolGetNumThreads() - 1);
+		while(numThumbWorkers < maxWorkers && numThumbWorkers < (int)thumbQueue.size()) {
+			++numThumbWorkers;
+			ThreadPoolAddJob(ThumbnailWorker);
+		}
+	}
+	wantedThumbnails.clear();
+
+	if(results.empty()) {
+		return;
+	}
+	for(ThumbnailResult& res : results) {
+		Thumbnail& t = thumbnails[res.path];
+		if(t.glTex != 0) {
+			continue; // shouldn't happen, but whatever
+		}
+		if(!res.ok) {
+			t.failed = true;
+			continue;
+		}
+		CreateThumbnailTexture(res.path, t, res.rgba.data(), res.width, res.height);
+		ThumbCacheAdd(res.cacheKey, std::move(res.rgba), res.width, res.height);
+	}
+	EvictThumbnails(size_t(thumbnailBudgetMB) << 20);
+}
+
+// returns the thumbnail for path, if its glTex is 0 it's not available (yet)
+// and is created in the background (unless creating it failed)
+static const Thumbnail* GetThumbnail(const std::string& path)
+{
+	auto it = thumbnails.find(path);
+	if(it == thumbnails.end()) {
+		Thumbnail& t = thumbnails[path];
+		int w = 0, h = 0;
+		const uint8_t* rgba = ThumbCacheFind(ThumbCacheGetKey(path.c_str()), &w, &h);
+		if(rgba != nullptr) {
+			CreateThumbnailTexture(path, t, rgba, w, h);
+		} else {
+			wantedThumbnails.push_back(path);
+		}
+		return &t;
+	}
+	Thumbnail& t = it->second;
+	if(t.glTex != 0) {
+		t.lastUsedFrame = curFrame;
+		thumbnailLRU.splice(thumbnailLRU.begin(), thumbnailLRU, t.lruIt);
+	} else if(!t.failed) {
+		wantedThumbnails.push_back(path);
+	}
+	return &t;
+}
+
+// the directory that's currently shown and its contents
+static std::string browseDir;
+static std::vector<std::string> browseSubDirs;
+static std::vector<std::string> browseFiles;
+static std::string lastCurrentFile;
+
+static bool IsSupportedFile(const std::string& name)
+{
+	static const char* extensions[] = {
+		".dds", ".ktx", ".ktx2", // the interesting ones..
+		".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".gif", ".hdr", ".pic", ".pnm", ".ppm", ".pgm"
+	};
+	size_t dotPos = name.rfind('.');
+	if(dotPos == std::string::npos) {
+		return false;
+	}
+	const char* ext = name.c_str() + dotPos;
+	for(const char* e : extensions) {
+		if(strcasecmp(ext, e) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool CaseInsensitiveLess(const std::string& a, const std::string& b)
+{
+	return strcasecmp(a.c_str(), b.c_str()) < 0;
+}
+
+static void ListSupportedFiles(const char* dir, std::vector<std::string>& names, std::vector<std::string>* subDirs)
+{
+	std::vector<std::string> files;
+	ListDirectory(dir, &files, subDirs);
+	for(std::string& f : files) {
+		if(IsSupportedFile(f)) {
+			names.push_back(std::move(f));
+		}
+	}
+	std::sort(names.begin(), names.end(), CaseInsensitiveLess);
+}
+
+void ListTextureFiles(const char* dir, std::vector<std::string>& names)
+{
+	names.clear();
+	ListSupportedFiles(dir, names, nullptr);
+}
+
+static void ListBrowseDir()
+{
+	browseSubDirs.clear();
+	browseFiles.clear();
+	ListSupportedFiles(browseDir.c_str(), browseFiles, &browseSubDirs);
+	std::sort(browseSubDirs.begin(), browseSubDirs.end(), CaseInsensitiveLess);
+	// make sure thumbnails that failed before are tried again, maybe the file was fixed
+	for(auto it = thumbnails.begin(); it != thumbnails.end(); ) {
+		if(it->second.failed) {
+			it = thumbnails.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+static void SetBrowseDir(const std::string& dir)
+{
+	browseDir = dir;
+	// remove trailing separators (except for the root directory)
+	while(browseDir.size() > 1 && strchr(dirSeparators, browseDir.back()) != nullptr) {
+		browseDir.pop_back();
+	}
+	ListBrowseDir();
+}
+
+static std::string GetParentDir(const std::string& path)
+{
+	size_t lastSep = path.find_last_of(dirSeparators);
+	if(lastSep == std::string::npos) {
+		return std::string();
+	}
+	if(lastSep == 0) {
+		return path.substr(0, 1); // root
+	}
+	return path.substr(0, lastSep);
+}
+
+// draws one entry (file or directory) of the grid, returns true if it was clicked
+static bool DrawEntry(const std::string& name, const std::string& path, bool isDir, bool isCurrent)
+{
+	const ImGuiStyle& style = ImGui::GetStyle();
+	float lineHeight = ImGui::GetTextLineHeight();
+	ImVec2 size(thumbnailDisplaySize, thumbnailDisplaySize + style.ItemInnerSpacing.y + lineHeight);
+	ImVec2 pos = ImGui::GetCursorScreenPos();
+	bool clicked = ImGui::InvisibleButton(name.c_str(), size);
+	bool hovered = ImGui::IsItemHovered();
+
+	ImDrawList* dl = ImGui::GetWindowDrawList();
+	if(isCurrent || hovered) {
+		ImU32 col = ImGui::GetColorU32(isCurrent ? ImGuiCol_HeaderActive : ImGuiCol_HeaderHovered);
+		dl->AddRectFilled(pos - ImVec2(2, 2), pos + size + ImVec2(2, 2), col, style.FrameRounding);
+	}
+
+	ImVec2 thumbMin = pos;
+	ImVec2 thumbMax = pos + ImVec2(thumbnailDisplaySize, thumbnailDisplaySize);
+	const char* placeholder = nullptr;
+	if(isDir) {
+		placeholder = "[DIR]";
+	} else {
+		const Thumbnail* t = GetThumbnail(path);
+		if(t->glTex != 0) {
+			// keep aspect ratio, center in the square
+			float scale = thumbnailDisplaySize / std::max(t->width, t->height);
+			ImVec2 imgSize(t->width * scale, t->height * scale);
+			ImVec2 imgMin = thumbMin + (ImVec2(thumbnailDisplaySize, thumbnailDisplaySize) - imgSize) * 0.5f;
+			dl->AddImage((ImTextureID)(intptr_t)t->glTex, imgMin, imgMin + imgSize);
+		} else {
+			placeholder = t->failed ? "(no preview)" : "...";
+		}
+	}
+	if(placeholder != nullptr) {
+		dl->AddRect(thumbMin, thumbMax, ImGui::GetColorU32(ImGuiCol_Border), style.FrameRounding);
+		ImVec2 ts = ImGui::CalcTextSize(placeholder);
+		dl->AddText(thumbMin + (ImVec2(thumbnailDisplaySize, thumbnailDisplaySize) - ts) * 0.5f,
+		            ImGui::GetColorU32(ImGuiCol_TextDisabled), placeholder);
+	}
+
+	// the name below the thumbnail, cut off if it's too long
+	ImVec2 textPos(pos.x, thumbMax.y + style.ItemInnerSpacing.y);
+	ImVec4 clipRect(pos.x, textPos.y, pos.x + size.x, textPos.y + lineHeight);
+	float textW = ImGui::CalcTextSize(name.c_str()).x;
+	if(textW < size.x) {
+		textPos.x += (size.x - textW) * 0.5f;
+	}
+	dl->AddText(nullptr, 0.0f, textPos, ImGui::GetColorU32(ImGuiCol_Text), name.c_str(), nullptr, 0.0f, &clipRect);
+
+	if(hovered) {
+		ImGui::SetTooltip("%s", name.c_str());
+	}
+	return clicked;
+}
+
+void BrowserWindowShow() {
+	showBrowserWindow = true;
+}
+
+void BrowserWindowHide() {
+	showBrowserWindow = false;
+}
+
+bool BrowserWindowIsShown() {
+	return showBrowserWindow;
+}
+
+bool BrowserNeedsRedraw()
+{
+	if(!wantedThumbnails.empty()) {
+		return true; // visible, but not available yet (see GetThumbnail())
+	}
+	std::lock_guard<std::mutex> lock(thumbMutex);
+	return numThumbWorkers > 0 || !thumbResults.empty();
+}
+
+bool DrawBrowserWindow(const char* currentFile, std::string& fileToOpen)
+{
+	++curFrame;
+	// even if the window isn't shown, the results of running jobs must be handled
+	UpdateThumbnails();
+	if(!showBrowserWindow) {
+		return false;
+	}
+
+	// follow the directory of the currently shown texture
+	if(currentFile != nullptr && currentFile[0] != '\0' && lastCurrentFile != currentFile) {
+		lastCurrentFile = currentFile;
+		std::string dir = GetParentDir(lastCurrentFile);
+		if(dir != browseDir) {
+			SetBrowseDir(dir);
+		}
+	} else if(browseDir.empty()) {
+		SetBrowseDir(ToAbsolutePath("."));
+	}
+
+	bool ret = false;
+	ImVec2 displaySize = ImGui::GetIO().DisplaySize;
+	ImGui::SetNextWindowSize(ImVec2(displaySize.x * 0.5f, displaySize.y * 0.4f), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowPos(ImVec2(displaySize.x * 0.45f, displaySize.y * 0.55f), ImGuiCond_FirstUseEver);
+	if(ImGui::Begin("Browser", &showBrowserWindow)) {
+		if(ImGui::Button("Up")) {
+			std::string parent = GetParentDir(browseDir);
+			if(!parent.empty()) {
+				SetBrowseDir(parent);
+			}
+		}
+		ImGui::SameLine();
+		if(ImGui::Button("Refresh")) {
+			ListBrowseDir();
+		}
+		ImGui::SameLine();
+		ImGui::PushItemWidth(ImGui::CalcTextSize("Size 0000000").x);
+		ImGui::SliderFloat("Size", &thumbnailDisplaySize, 32.0f, 256.0f, "%.0f");
+		ImGui::PopItemWidth();
+		ImGui::SameLine();
+		ImGui::PushItemWidth(ImGui::CalcTextSize("Cache MB 0000000").x);
+		ImGui::InputInt("Cache MB", &thumbnailBudgetMB, 8, 32);
+		thumbnailBudgetMB = std::max(thumbnailBudgetMB, 1);
+		ImGui::PopItemWidth();
+		ImGui::SetItemTooltip("How much GPU memory the thumbnails may use (%.1f MB in use)",
+		                      thumbnailBytes / (1024.0 * 1024.0));
+		ImGui::BeginDisabled();
+		ImGui::TextWrapped("%s (%d files)", browseDir.c_str(), (int)browseFiles.size());
+		ImGui::EndDisabled();
+
+		if(ImGui::BeginChild("##entries")) {
+			const ImGuiStyle& style = ImGui::GetStyle();
+			float cellW = thumbnailDisplaySize + style.ItemSpacing.x + 4.0f;
+			// the height of DrawEntry()'s button + spacing
+			float cellH = thumbnailDisplaySize + style.ItemInnerSpacing.y
+			              + ImGui::GetTextLineHeight() + style.ItemSpacing.y;
+			int perRow = std::max(1, int((ImGui::GetContentRegionAvail().x + style.ItemSpacing.x) / cellW));
+			int numDirs = (int)browseSubDirs.size();
+			int numEntries = numDirs + (int)browseFiles.size();
+			int numRows = (numEntries + perRow - 1) / perRow;
+
+			// only the visible rows are drawn (and get thumbnails), so this
+			// stays fast even for directories with thousands of textures
+			ImGuiListClipper clipper;
+			clipper.Begin(numRows, cellH);
+			std::string path;
+			while(clipper.Step()) {
+				for(int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+					for(int col = 0; col < perRow; ++col) {
+						int idx = row * perRow + col;
+						if(idx >= numEntries) {
+							break;
+						}
+						if(col > 0) {
+							ImGui::SameLine(0.0f, style.ItemSpacing.x + 4.0f);
+						} else {
+							ImGui::SetCursorPosX(ImGui::GetCursorPosX() + 2.0f);
+						}
+						bool isDir = idx < numDirs;
+						const std::string& name = isDir ? browseSubDirs[idx] : browseFiles[idx - numDirs];
+						path = browseDir;
+						if(path.empty() || path.back() != dirSeparator) {
+							path += dirSeparator;
+						}
+						path += name;
+						if(DrawEntry(name, path, isDir, !isDir && path == lastCurrentFile)) {
+							if(isDir) {
+								SetBrowseDir(path);
+							} else {
+								fileToOpen = path;
+								ret = true;
+							}
+						}
+					}
+				}
+			}
+			clipper.End();
+		}
+		ImGui::EndChild();
+	}
+	ImGui::End();
+	return ret;
+}
+
+void BrowserShutdown()
+{
+	{
+		// the workers stop after the thumbnail they're currently working on,
+		// ThreadPoolShutdown() waits for them
+		std::lock_guard<std::mutex> lock(thumbMutex);
+		thumbQueue.clear();
+		thumbResults.clear();
+	}
+	for(auto& it : thumbnails) {
+		if(it.second.glTex != 0) {
+			glDeleteTextures(1, &it.second.glTex);
+		}
+	}
+	thumbnails.clear();
+	thumbnailLRU.clear();
+	thumbnailBytes = 0;
+	ThumbCacheShutdown();
+}
+
+} //namespace texview
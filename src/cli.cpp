@@ -0,0 +1,778 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+// command line modes that don't need a window or OpenGL,
+// for use in scripts and on build machines (CI) without a GPU
+
+#include "texview.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <mutex>
+
+#ifdef _WIN32
+	#define strcasecmp _stricmp
+#endif
+
+namespace texview {
+
+// calls fn(i) for all i in [0, numItems) in parallel, and prints the strings
+// returned by it in the order of i (as soon as all the ones before are done),
+// with separator between them. Empty strings are skipped.
+static void ParallelForPrintInOrder(int numItems, const char* separator,
+                                    const std::function<std::string(int)>& fn)
+{
+	std::vector<std::string> results(numItems);
+	std::vector<bool> done(numItems, false);
+	std::mutex printMutex;
+	int nextToPrint = 0;
+	bool printedAny = false;
+
+	ParallelFor(numItems, [&](int i) {
+		std::string res = fn(i);
+
+		std::lock_guard<std::mutex> lock(printMutex);
+		results[i] = std::move(res);
+		done[i] = true;
+		while(nextToPrint < numItems && done[nextToPrint]) {
+			std::string& r = results[nextToPrint];
+			if(!r.empty()) {
+				if(printedAny) {
+					fputs(separator, stdout);
+				}
+				fputs(r.c_str(), stdout);
+				printedAny = true;
+				r.clear(); // no need to keep that around
+				r.shrink_to_fit();
+			}
+			++nextToPrint;
+		}
+	});
+}
+
+static void AppendJSONString(std::string& out, const char* str)
+{
+	out += '"';
+	for(const char* c = str; *c != '\0'; ++c) {
+		switch(*c) {
+			case '"':  out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n";  break;
+			case '\r': out += "\\r";  break;
+			case '\t': out += "\\t";  break;
+			default:
+				if((unsigned char)*c < 0x20) {
+					StringAppendFormatted(out, "\\u%04x", (unsigned)*c);
+				} else {
+					out += *c; // UTF-8 can be used as it is
+				}
+		}
+	}
+	out += '"';
+}
+
+static const char* GetFileTypeName(Texture::FileType ft)
+{
+	switch(ft) {
+		case Texture::FT_DDS: return "DDS";
+		case Texture::FT_KTX: return "KTX";
+		case Texture::FT_STB: return "STB";
+		default: return "none";
+	}
+}
+
+static const struct { uint32_t flag; const char* name; } textureFlagNames[] = {
+	{ TF_SRGB,         "srgb" },
+	{ TF_TYPELESS,     "typeless" },
+	{ TF_HAS_ALPHA,    "alpha" },
+	{ TF_PREMUL_ALPHA, "premultiplied" },
+	{ TF_COMPRESSED,   "compressed" },
+	{ TF_IS_ARRAY,     "array" },
+};
+
+// formats the information about one texture (or the failure to load it)
+// as one line of text or one JSON object
+static std::string FormatTextureInfo(const char* path, const Texture* tex, double loadTimeMs, bool json)
+{
+	std::string ret;
+	float w = 0.0f, h = 0.0f;
+	if(tex != nullptr) {
+		tex->GetSize(&w, &h);
+	}
+	if(json) {
+		ret = "{ \"file\": ";
+		AppendJSONString(ret, path);
+		if(tex == nullptr) {
+			StringAppendFormatted(ret, ", \"ok\": false, \"loadTimeMs\": %.3f }", loadTimeMs);
+			return ret;
+		}
+		StringAppendFormatted(ret, ", \"ok\": true, \"type\": \"%s\", \"format\": ", GetFileTypeName(tex->fileType));
+		AppendJSONString(ret, tex->formatName.c_str());
+		StringAppendFormatted(ret, ", \"glInternalFormat\": \"0x%04X\", \"width\": %d, \"height\": %d, "
+		                      "\"mipLevels\": %d, \"layers\": %d, \"cubemapFaces\": %d, \"flags\": [",
+		                      tex->dataFormat, (int)w, (int)h, tex->GetNumMips(), tex->GetNumElements(),
+		                      tex->GetNumCubemapFaces());
+		const char* sep = "";
+		for(const auto& fn : textureFlagNames) {
+			if(tex->textureFlags & fn.flag) {
+				StringAppendFormatted(ret, "%s\"%s\"", sep, fn.name);
+				sep = ", ";
+			}
+		}
+		StringAppendFormatted(ret, "], \"loadTimeMs\": %.3f }", loadTimeMs);
+	} else {
+		ret = path;
+		if(tex == nullptr) {
+			StringAppendFormatted(ret, ": FAILED to load (%.2f ms)", loadTimeMs);
+			return ret;
+		}
+		StringAppendFormatted(ret, ": %s, %d x %d, %d mip level(s)", tex->formatName.c_str(),
+		                      (int)w, (int)h, tex->GetNumMips());
+		if(tex->IsArray()) {
+			StringAppendFormatted(ret, ", %d layers", tex->GetNumElements());
+		}
+		if(tex->IsCubemap()) {
+			StringAppendFormatted(ret, ", cubemap with %d faces", tex->GetNumCubemapFaces());
+		}
+		for(const auto& fn : textureFlagNames) {
+			if((tex->textureFlags & fn.flag) && fn.flag != TF_IS_ARRAY) {
+				ret += ", ";
+				ret += fn.name;
+			}
+		}
+		StringAppendFormatted(ret, " (loaded in %.2f ms)", loadTimeMs);
+	}
+	return ret;
+}
+
+static void PrintInfoUsage()
+{
+	fprintf(stderr, "Usage: texview --info [--json] <file> [<file> ...]\n"
+	        "  Loads the given textures (in parallel) and prints their format, size,\n"
+	        "  number of mipmap levels and array layers, flags and how long loading took.\n"
+	        "  Doesn't create a window, so it also works without a GPU.\n"
+	        "  --json  print the information as a JSON array instead of text\n"
+	        "  Exits with 1 if any texture couldn't be loaded, otherwise 0\n");
+}
+
+int RunInfoCommand(int argc, char** argv)
+{
+	bool json = false;
+	std::vector<const char*> files;
+	for(int i=0; i < argc; ++i) {
+		if(strcmp(argv[i], "--json") == 0) {
+			json = true;
+		} else if(strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+			PrintInfoUsage();
+			return 0;
+		} else {
+			files.push_back(argv[i]);
+		}
+	}
+	if(files.empty()) {
+		PrintInfoUsage();
+		return 1;
+	}
+
+	ThreadPoolInit();
+	double startTime = GetTimeSeconds();
+
+	// the files are loaded in parallel, but their results are printed in the
+	// order they were given in
+	const int numFiles = (int)files.size();
+	std::mutex failMutex;
+	int numFailed = 0;
+
+	if(json) {
+		printf("[\n");
+	}
+	ParallelForPrintInOrder(numFiles, json ? ",\n" : "", [&](int i) -> std::string {
+		double loadStart = GetTimeSeconds();
+		Texture tex;
+		bool ok = tex.Load(files[i]);
+		double ms = (GetTimeSeconds() - loadStart) * 1000.0;
+		if(!ok) {
+			std::lock_guard<std::mutex> lock(failMutex);
+			++numFailed;
+		}
+		std::string res = json ? "  " : "";
+		res += FormatTextureInfo(files[i], ok ? &tex : nullptr, ms, json);
+		if(!json) {
+			res += '\n';
+		}
+		return res;
+	});
+	if(json) {
+		printf("\n]\n");
+	}
+	fflush(stdout);
+
+	double secs = GetTimeSeconds() - startTime;
+	fprintf(stderr, "Loaded %d of %d textures in %.2f seconds (%d threads)\n",
+	        numFiles - numFailed, numFiles, secs, ThreadPoolGetNumThreads() + 1);
+
+	ThreadPoolShutdown();
+	return (numFailed > 0) ? 1 : 0;
+}
+
+// only files with these extensions are checked when scanning directories
+static bool IsValidatableFile(const std::string& name)
+{
+	static const char* extensions[] = { ".dds", ".ktx", ".ktx2" };
+	size_t dotPos = name.rfind('.');
+	if(dotPos == std::string::npos) {
+		return false;
+	}
+	const char* ext = name.c_str() + dotPos;
+	for(const char* e : extensions) {
+		if(strcasecmp(ext, e) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// adds all DDS and KTX files in dir and its subdirectories to files (sorted by name),
+// directories that couldn't be read are added to unreadableDirs
+static void CollectFilesToValidate(const std::string& dir, std::vector<std::string>& files,
+                                   std::vector<std::string>& unreadableDirs)
+{
+	std::vector<std::string> names, subDirs;
+	if(!ListDirectory(dir.c_str(), &names, &subDirs)) {
+		unreadableDirs.push_back(dir);
+		return;
+	}
+	std::sort(names.begin(), names.end());
+	std::sort(subDirs.begin(), subDirs.end());
+	std::string prefix = dir;
+	if(!prefix.empty() && prefix.back() != '/' && prefix.back() != '\\') {
+		prefix += '/';
+	}
+	for(const std::string& n : names) {
+		if(IsValidatableFile(n)) {
+			files.push_back(prefix + n);
+		}
+	}
+	for(const std::string& sd : subDirs) {
+		CollectFilesToValidate(prefix + sd, files, unreadableDirs);
+	}
+}
+
+static std::string FormatDiagnostics(const char* path, const std::vector<LoadDiagnostic>& diags, bool json)
+{
+	std::string ret;
+	if(json) {
+		ret = "    { \"file\": ";
+		AppendJSONString(ret, path);
+		ret += ", \"diagnostics\": [";
+		const char* sep = "\n";
+		for(const LoadDiagnostic& d : diags) {
+			StringAppendFormatted(ret, "%s      { \"severity\": \"%s\", \"code\": \"%s\", \"message\": ",
+			                      sep, GetDiagSeverityName(d.severity), GetDiagCodeName(d.code));
+			AppendJSONString(ret, d.message.c_str());
+			ret += " }";
+			sep = ",\n";
+		}
+		ret += "\n    ] }";
+	} else {
+		for(const LoadDiagnostic& d : diags) {
+			StringAppendFormatted(ret, "%s: %s: [%s] %s\n", path, GetDiagSeverityName(d.severity),
+			                      GetDiagCodeName(d.code), d.message.c_str());
+		}
+	}
+	return ret;
+}
+
+static void PrintValidateUsage()
+{
+	fprintf(stderr, "Usage: texview --validate [--json] [--werror] [--notes] <file or directory> ...\n"
+	        "  Checks the given files, and all DDS and KTX files in the given directories\n"
+	        "  (and their subdirectories), for problems like truncated mipmap chains or\n"
+	        "  broken headers. The files are checked in parallel.\n"
+	        "  Prints one line per problem and a summary with the number of each kind of problem.\n"
+	        "  --json    print the problems and summary as JSON instead of text\n"
+	        "  --werror  also exit with 1 if there are warnings (not just errors)\n"
+	        "  --notes   also print notes (harmless oddities, like files from known broken writers)\n"
+	        "  Exits with 1 if any file has errors, otherwise 0\n");
+}
+
+int RunValidateCommand(int argc, char** argv)
+{
+	bool json = false;
+	bool warningsAreErrors = false;
+	bool printNotes = false;
+	std::vector<std::string> files;
+	std::vector<std::string> unreadableDirs;
+	for(int i=0; i < argc; ++i) {
+		const char* arg = argv[i];
+		if(strcmp(arg, "--json") == 0) {
+			json = true;
+		} else if(strcmp(arg, "--werror") == 0) {
+			warningsAreErrors = true;
+		} else if(strcmp(arg, "--notes") == 0) {
+			printNotes = true;
+		} else if(strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+			PrintValidateUsage();
+			return 0;
+		} else if(IsDirectory(arg)) {
+			CollectFilesToValidate(arg, files, unreadableDirs);
+		} else {
+			// files given explicitly are checked no matter what their extension is
+			files.push_back(arg);
+		}
+	}
+	if(files.empty() && unreadableDirs.empty()) {
+		PrintValidateUsage();
+		return 1;
+	}
+
+	// the problems are printed in a structured way below, don't also log them
+	LogSetMuted(true);
+	ThreadPoolInit();
+	double startTime = GetTimeSeconds();
+
+	const int numFiles = (int)files.size();
+	std::mutex statsMutex;
+	int numWithErrors = 0;
+	int numWithWarnings = 0;
+	int countPerCode[_DC_COUNT][DS_ERROR+1] = {};
+
+	if(json) {
+		printf("{\n  \"files\": [\n");
+	}
+	ParallelForPrintInOrder(numFiles, json ? ",\n" : "", [&](int i) -> std::string {
+		const char* path = files[i].c_str();
+		std::vector<LoadDiagnostic> diags;
+		{
+			Texture tex;
+			tex.Load(path, &diags);
+			// tex is destroyed here already, so the file is unmapped before printing
+		}
+		bool hasError = false;
+		bool hasWarning = false;
+		{
+			std::lock_guard<std::mutex> lock(statsMutex);
+			for(const LoadDiagnostic& d : diags) {
+				++countPerCode[d.code][d.severity];
+				hasError |= d.severity == DS_ERROR;
+				hasWarning |= d.severity == DS_WARNING;
+			}
+			numWithErrors += hasError ? 1 : 0;
+			numWithWarnings += hasWarning ? 1 : 0;
+		}
+		if(!printNotes) {
+			diags.erase(std::remove_if(diags.begin(), diags.end(),
+			                           [](const LoadDiagnostic& d) { return d.severity == DS_NOTE; }),
+			            diags.end());
+		}
+		return diags.empty() ? std::string() : FormatDiagnostics(path, diags, json);
+	});
+
+	double secs = GetTimeSeconds() - startTime;
+	int numThreads = ThreadPoolGetNumThreads() + 1;
+	ThreadPoolShutdown();
+	LogSetMuted(false);
+
+	if(json) {
+		printf("\n  ],\n  \"unreadableDirectories\": [");
+		for(size_t i=0; i < unreadableDirs.size(); ++i) {
+			std::string d;
+			AppendJSONString(d, unreadableDirs[i].c_str());
+			printf("%s%s", (i > 0) ? ", " : " ", d.c_str());
+		}
+		printf(" ],\n  \"summary\": { \"filesChecked\": %d, \"filesWithErrors\": %d, "
+		       "\"filesWithWarnings\": %d, \"seconds\": %.3f, \"issues\": [",
+		       numFiles, numWithErrors, numWithWarnings, secs);
+		const char* sep = "";
+		for(int c=0; c < _DC_COUNT; ++c) {
+			for(int sev=DS_ERROR; sev >= DS_NOTE; --sev) {
+				if(countPerCode[c][sev] > 0) {
+					printf("%s\n    { \"severity\": \"%s\", \"code\": \"%s\", \"count\": %d }", sep,
+					       GetDiagSeverityName((DiagSeverity)sev), GetDiagCodeName((DiagCode)c), countPerCode[c][sev]);
+					sep = ",";
+				}
+			}
+		}
+		printf("\n  ] }\n}\n");
+	} else {
+		for(const std::string& d : unreadableDirs) {
+			printf("%s: error: couldn't read directory\n", d.c_str());
+		}
+		printf("Checked %d files in %.2f seconds (%d threads): %d with errors, %d with warnings\n",
+		       numFiles, secs, numThreads, numWithErrors, numWithWarnings);
+		for(int c=0; c < _DC_COUNT; ++c) {
+			for(int sev=DS_ERROR; sev >= DS_NOTE; --sev) {
+				if(countPerCode[c][sev] > 0) {
+					printf("  %7s %-24s %d\n", GetDiagSeverityName((DiagSeverity)sev),
+					       GetDiagCodeName((DiagCode)c), countPerCode[c][sev]);
+				}
+			}
+		}
+	}
+	fflush(stdout);
+
+	bool failed = numWithErrors > 0 || !unreadableDirs.empty() || (warningsAreErrors && numWithWarnings > 0);
+	return failed ? 1 : 0;
+}
+
+static void PrintCompareUsage()
+{
+	fprintf(stderr, "Usage: texview --compare [options] <a> <b> [<a2> <b2> ...]\n"
+	        "  Compares the textures of each pair (all mip levels both have, all array layers\n"
+	        "  and cubemap faces) on the CPU and prints the MSE, PSNR, SSIM and biggest\n"
+	        "  difference per channel. Compressed formats are decoded in software, the\n"
+	        "  default swizzle of formats like DXT5nm is applied. The pairs are compared in parallel.\n"
+	        "  Doesn't create a window, so it also works without a GPU.\n"
+	        "  --json            print the results as JSON instead of text\n"
+	        "  --list <file>     also compare the pairs in that file: one pair per line,\n"
+	        "                    the two paths separated by a tab\n"
+	        "  --min-psnr <dB>   fail if the PSNR of any channel of any image is lower\n"
+	        "  --min-ssim <val>  fail if the SSIM of any channel of any image is lower\n"
+	        "  --no-ssim         don't calculate the SSIM (it's the slowest part)\n"
+	        "  Alpha is only taken into account if at least one of the textures has alpha.\n"
+	        "  Exits with 1 if any pair is below the thresholds, 2 if any pair couldn't\n"
+	        "  be compared (file not loadable, different sizes or layer counts), otherwise 0\n");
+}
+
+// reads "a<TAB>b" lines from listFile, returns false if it can't be opened
+static bool ReadComparePairList(const char* listFile, std::vector<std::string>& files)
+{
+	FILE* f = fopen(listFile, "r");
+	if(f == nullptr) {
+		return false;
+	}
+	std::string line;
+	char buf[1024];
+	while(fgets(buf, sizeof(buf), f) != nullptr) {
+		line += buf;
+		if(line.back() != '\n' && !feof(f)) {
+			continue; // line is longer than buf
+		}
+		while(!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+			line.pop_back();
+		}
+		size_t tab = line.find('\t');
+		if(tab != std::string::npos) {
+			files.push_back(line.substr(0, tab));
+			files.push_back(line.substr(tab + 1));
+		} else if(!line.empty()) {
+			errprintf("%s: ignoring line without a tab: '%s'\n", listFile, line.c_str());
+		}
+		line.clear();
+	}
+	fclose(f);
+	return true;
+}
+
+// makes the image look like it does in the viewer: alpha is 1 if the texture
+// has none (like RGBX formats), and the texture's default swizzle is applied
+static void PrepareForComparison(const Texture& tex, std::vector<float>& img)
+{
+	const char* swizzle = tex.defaultSwizzle;
+	bool hasAlpha = (tex.textureFlags & TF_HAS_ALPHA) != 0;
+	if(swizzle == nullptr && hasAlpha) {
+		return;
+	}
+	for(size_t i=0; i < img.size(); i += 4) {
+		float* px = &img[i];
+		float src[4] = { px[0], px[1], px[2], hasAlpha ? px[3] : 1.0f };
+		for(int c=0; c < 4; ++c) {
+			if(swizzle == nullptr) {
+				px[c] = src[c];
+				continue;
+			}
+			switch(swizzle[c]) {
+				case 'r': case 'x': px[c] = src[0]; break;
+				case 'g': case 'y': px[c] = src[1]; break;
+				case 'b': case 'z': px[c] = src[2]; break;
+				case 'a': case 'w': px[c] = src[3]; break;
+				case '1': px[c] = 1.0f; break;
+				default:  px[c] = 0.0f;
+			}
+		}
+	}
+}
+
+struct CompareThresholds {
+	double minPSNR = -INFINITY;
+	double minSSIM = -INFINITY;
+	bool calcSSIM = true;
+};
+
+static void AppendJSONNumber(std::string& out, double val)
+{
+	if(isfinite(val)) {
+		StringAppendFormatted(out, "%.6g", val);
+	} else {
+		out += "null"; // JSON has no infinity (PSNR of identical images)
+	}
+}
+
+static void AppendJSONArray4(std::string& out, const double vals[4], bool toPSNR = false)
+{
+	out += '[';
+	for(int c=0; c < 4; ++c) {
+		if(c > 0) {
+			out += ", ";
+		}
+		AppendJSONNumber(out, toPSNR ? MSEToPSNR(vals[c]) : vals[c]);
+	}
+	out += ']';
+}
+
+// compares the two textures and formats the results, *failed is set to
+// 1 if they're below the thresholds and to 2 if they couldn't be compared
+static std::string ComparePair(const char* pathA, const char* pathB, const CompareThresholds& thresholds,
+                               bool json, int* failed)
+{
+	*failed = 0;
+	std::string error;
+	std::string imagesStr;
+	const char* failReason = nullptr;
+	double worstPSNR = INFINITY;
+	double worstSSIM = INFINITY;
+
+	Texture a, b;
+	if(!a.Load(pathA)) {
+		error = "couldn't load the first texture";
+	} else if(!b.Load(pathB)) {
+		error = "couldn't load the second texture";
+	} else if(a.GetNumElements() != b.GetNumElements()
+	          || a.GetNumCubemapFaces() != b.GetNumCubemapFaces()) {
+		StringAppendFormatted(error, "different number of layers or cubemap faces (%d x %d vs %d x %d)",
+		                      a.GetNumElements(), std::max(a.GetNumCubemapFaces(), 1),
+		                      b.GetNumElements(), std::max(b.GetNumCubemapFaces(), 1));
+	} else {
+		const int numMips = std::min(a.GetNumMips(), b.GetNumMips());
+		const int numFaces = std::max(a.GetNumCubemapFaces(), 1);
+		const int numElements = a.GetNumElements() * numFaces;
+		const int numChans = ((a.textureFlags | b.textureFlags) & TF_HAS_ALPHA) ? 4 : 3;
+		const bool showElement = numElements > 1;
+		std::vector<float> imgA, imgB;
+		for(int elemIdx=0; elemIdx < numElements && error.empty(); ++elemIdx) {
+			for(int mip=0; mip < numMips; ++mip) {
+				float wa, ha, wb, hb;
+				a.GetMipSize(mip, &wa, &ha);
+				b.GetMipSize(mip, &wb, &hb);
+				if(wa != wb || ha != hb) {
+					StringAppendFormatted(error, "different sizes in mip level %d (%d x %d vs %d x %d)",
+					                      mip, (int)wa, (int)ha, (int)wb, (int)hb);
+					break;
+				}
+				if(!a.GetFloatImage(mip, elemIdx, imgA) || !b.GetFloatImage(mip, elemIdx, imgB)) {
+					StringAppendFormatted(error, "can't convert mip level %d to float (unsupported format?)", mip);
+					break;
+				}
+				PrepareForComparison(a, imgA);
+				PrepareForComparison(b, imgB);
+				ImageErrors errs;
+				CompareFloatImages(imgA.data(), imgB.data(), (uint32_t)wa, (uint32_t)ha, &errs, thresholds.calcSSIM);
+
+				for(int c=0; c < numChans; ++c) {
+					double psnr = MSEToPSNR(errs.mse[c]);
+					if(psnr < worstPSNR) {
+						worstPSNR = psnr;
+					}
+					if(thresholds.calcSSIM && errs.ssim[c] < worstSSIM) {
+						worstSSIM = errs.ssim[c];
+					}
+				}
+
+				int layer = elemIdx / numFaces;
+				int face = elemIdx % numFaces;
+				if(json) {
+					if(!imagesStr.empty()) {
+						imagesStr += ",";
+					}
+					StringAppendFormatted(imagesStr, "\n        { \"layer\": %d, \"face\": %d, \"mip\": %d, "
+					                      "\"width\": %u, \"height\": %u,\n          \"mse\": ",
+					                      layer, face, mip, errs.width, errs.height);
+					AppendJSONArray4(imagesStr, errs.mse);
+					imagesStr += ", \"psnr\": ";
+					AppendJSONArray4(imagesStr, errs.mse, true);
+					imagesStr += ", \"psnrRGB\": ";
+					AppendJSONNumber(imagesStr, MSEToPSNR(errs.mseRGB));
+					imagesStr += ",\n          \"maxError\": ";
+					AppendJSONArray4(imagesStr, errs.maxError);
+					if(thresholds.calcSSIM) {
+						imagesStr += ", \"ssim\": ";
+						AppendJSONArray4(imagesStr, errs.ssim);
+					}
+					imagesStr += " }";
+				} else {
+					imagesStr += "  ";
+					if(showElement) {
+						StringAppendFormatted(imagesStr, "layer %d ", layer);
+						if(numFaces > 1) {
+							StringAppendFormatted(imagesStr, "face %d ", face);
+						}
+					}
+					StringAppendFormatted(imagesStr, "mip %d (%u x %u): PSNR", mip, errs.width, errs.height);
+					for(int c=0; c < numChans; ++c) {
+						StringAppendFormatted(imagesStr, " %c %.2f", "RGBA"[c], MSEToPSNR(errs.mse[c]));
+					}
+					StringAppendFormatted(imagesStr, " RGB %.2f dB", MSEToPSNR(errs.mseRGB));
+					if(thresholds.calcSSIM) {
+						imagesStr += " | SSIM";
+						for(int c=0; c < numChans; ++c) {
+							StringAppendFormatted(imagesStr, " %c %.4f", "RGBA"[c], errs.ssim[c]);
+						}
+					}
+					imagesStr += " | max diff";
+					for(int c=0; c < numChans; ++c) {
+						StringAppendFormatted(imagesStr, " %c %.4g", "RGBA"[c], errs.maxError[c]);
+					}
+					imagesStr += '\n';
+				}
+			}
+		}
+		if(error.empty()) {
+			if(worstPSNR < thresholds.minPSNR) {
+				failReason = "PSNR below threshold";
+			} else if(thresholds.calcSSIM && worstSSIM < thresholds.minSSIM) {
+				failReason = "SSIM below threshold";
+			}
+			if(a.GetNumMips() != b.GetNumMips() && !json) {
+				StringAppendFormatted(imagesStr, "  (only compared the first %d mip levels, %d vs %d)\n",
+				                      numMips, a.GetNumMips(), b.GetNumMips());
+			}
+		}
+	}
+
+	*failed = !error.empty() ? 2 : (failReason != nullptr) ? 1 : 0;
+	std::string ret;
+	if(json) {
+		ret = "    { \"a\": ";
+		AppendJSONString(ret, pathA);
+		ret += ", \"b\": ";
+		AppendJSONString(ret, pathB);
+		StringAppendFormatted(ret, ", \"result\": \"%s\"",
+		                      !error.empty() ? "error" : (failReason != nullptr) ? "fail" : "pass");
+		if(!error.empty()) {
+			ret += ", \"error\": ";
+			AppendJSONString(ret, error.c_str());
+		} else {
+			ret += ", \"minPSNR\": ";
+			AppendJSONNumber(ret, worstPSNR);
+			if(thresholds.calcSSIM) {
+				ret += ", \"minSSIM\": ";
+				AppendJSONNumber(ret, worstSSIM);
+			}
+			if(failReason != nullptr) {
+				ret += ", \"reason\": ";
+				AppendJSONString(ret, failReason);
+			}
+			ret += ",\n      \"images\": [";
+			ret += imagesStr;
+			ret += "\n      ]";
+		}
+		ret += " }";
+	} else {
+		StringAppendFormatted(ret, "%s <-> %s: ", pathA, pathB);
+		if(!error.empty()) {
+			StringAppendFormatted(ret, "ERROR: %s\n", error.c_str());
+		} else {
+			if(failReason != nullptr) {
+				StringAppendFormatted(ret, "FAIL (%s)", failReason);
+			} else {
+				ret += "ok";
+			}
+			StringAppendFormatted(ret, ", min PSNR %.2f dB", worstPSNR);
+			if(thresholds.calcSSIM) {
+				StringAppendFormatted(ret, ", min SSIM %.4f", worstSSIM);
+			}
+			ret += '\n';
+			ret += imagesStr;
+		}
+	}
+	return ret;
+}
+
+int RunCompareCommand(int argc, char** argv)
+{
+	bool json = false;
+	CompareThresholds thresholds;
+	std::vector<std::string> files;
+	for(int i=0; i < argc; ++i) {
+		const char* arg = argv[i];
+		bool hasNext = i + 1 < argc;
+		if(strcmp(arg, "--json") == 0) {
+			json = true;
+		} else if(strcmp(arg, "--no-ssim") == 0) {
+			thresholds.calcSSIM = false;
+		} else if(strcmp(arg, "--min-psnr") == 0 && hasNext) {
+			thresholds.minPSNR = atof(argv[++i]);
+		} else if(strcmp(arg, "--min-ssim") == 0 && hasNext) {
+			thresholds.minSSIM = atof(argv[++i]);
+		} else if(strcmp(arg, "--list") == 0 && hasNext) {
+			const char* listFile = argv[++i];
+			if(!ReadComparePairList(listFile, files)) {
+				errprintf("Couldn't open pair list '%s'\n", listFile);
+				return 2;
+			}
+		} else if(strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+			PrintCompareUsage();
+			return 0;
+		} else {
+			files.push_back(arg);
+		}
+	}
+	if(files.empty() || (files.size() % 2) != 0) {
+		PrintCompareUsage();
+		return 2;
+	}
+	if(!thresholds.calcSSIM && thresholds.minSSIM > -INFINITY) {
+		errprintf("--min-ssim can't be used together with --no-ssim\n");
+		return 2;
+	}
+
+	// load errors are reported per pair below, don't also log them
+	LogSetMuted(true);
+	ThreadPoolInit();
+	double startTime = GetTimeSeconds();
+
+	// each pair is compared by one thread, and the comparisons themselves
+	// use ParallelFor() as well, so a few big textures also use all cores
+	const int numPairs = int(files.size() / 2);
+	std::mutex statsMutex;
+	int numFailed = 0;
+	int numErrors = 0;
+
+	if(json) {
+		printf("{\n  \"pairs\": [\n");
+	}
+	ParallelForPrintInOrder(numPairs, json ? ",\n" : "", [&](int i) -> std::string {
+		int failed = 0;
+		std::string res = ComparePair(files[i*2].c_str(), files[i*2 + 1].c_str(), thresholds, json, &failed);
+		if(failed != 0) {
+			std::lock_guard<std::mutex> lock(statsMutex);
+			++((failed == 2) ? numErrors : numFailed);
+		}
+		return res;
+	});
+
+	double secs = GetTimeSeconds() - startTime;
+	int numThreads = ThreadPoolGetNumThreads() + 1;
+	ThreadPoolShutdown();
+	LogSetMuted(false);
+
+	if(json) {
+		printf("\n  ],\n  \"summary\": { \"pairs\": %d, \"failed\": %d, \"errors\": %d, \"seconds\": %.3f }\n}\n",
+		       numPairs, numFailed, numErrors, secs);
+	} else {
+		printf("Compared %d pairs in %.2f seconds (%d threads): %d passed, %d failed, %d errors\n",
+		       numPairs, secs, numThreads, numPairs - numFailed - numErrors, numFailed, numErrors);
+	}
+	fflush(stdout);
+
+	return (numErrors > 0) ? 2 : (numFailed > 0) ? 1 : 0;
+}
+
+} //namespace texview
@@ -0,0 +1,415 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+// Error metrics (MSE, PSNR, SSIM) between two images and statistics of single
+// images on the CPU, for texview --compare and for when the GPU reductions in
+// main.cpp can't be used.
+// The images are float RGBA, so one pixel fits exactly into one SSE/NEON
+// register and all four channels are handled at once. The rows are split
+// into chunks that are processed in parallel, the per-chunk sums are added
+// up in a fixed order so the results don't depend on the number of threads.
+
+#include "texview.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define TV_HAVE_SSE2 1
+		#include <emmintrin.h>
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define TV_HAVE_NEON 1
+	#include <arm_neon.h>
+#endif
+
+namespace texview {
+
+// the four channels of a float RGBA pixel, in one SSE/NEON register if possible,
+// so the metrics below only need to be written once
+struct Vec4f {
+#if defined(TV_HAVE_SSE2)
+	__m128 v;
+	Vec4f(__m128 v_) : v(v_) {}
+	explicit Vec4f(float f = 0.0f) : v(_mm_set1_ps(f)) {}
+	static Vec4f Load(const float* p) { return Vec4f(_mm_loadu_ps(p)); }
+	void Store(float* p) const { _mm_storeu_ps(p, v); }
+	Vec4f operator+(Vec4f o) const { return Vec4f(_mm_add_ps(v, o.v)); }
+	Vec4f operator-(Vec4f o) const { return Vec4f(_mm_sub_ps(v, o.v)); }
+	Vec4f operator*(Vec4f o) const { return Vec4f(_mm_mul_ps(v, o.v)); }
+	Vec4f Abs() const { return Vec4f(_mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)))); }
+	Vec4f Max(Vec4f o) const { return Vec4f(_mm_max_ps(v, o.v)); }
+	Vec4f Min(Vec4f o) const { return Vec4f(_mm_min_ps(v, o.v)); }
+#elif defined(TV_HAVE_NEON)
+	float32x4_t v;
+	Vec4f(float32x4_t v_) : v(v_) {}
+	explicit Vec4f(float f = 0.0f) : v(vdupq_n_f32(f)) {}
+	static Vec4f Load(const float* p) { return Vec4f(vld1q_f32(p)); }
+	void Store(float* p) const { vst1q_f32(p, v); }
+	Vec4f operator+(Vec4f o) const { return Vec4f(vaddq_f32(v, o.v)); }
+	Vec4f operator-(Vec4f o) const { return Vec4f(vsubq_f32(v, o.v)); }
+	Vec4f operator*(Vec4f o) const { return Vec4f(vmulq_f32(v, o.v)); }
+	Vec4f Abs() const { return Vec4f(vabsq_f32(v)); }
+	Vec4f Max(Vec4f o) const { return Vec4f(vmaxq_f32(v, o.v)); }
+	Vec4f Min(Vec4f o) const { return Vec4f(vminq_f32(v, o.v)); }
+#else
+	float v[4];
+	explicit Vec4f(float f = 0.0f) { v[0] = v[1] = v[2] = v[3] = f; }
+	static Vec4f Load(const float* p) { Vec4f r; memcpy(r.v, p, sizeof(r.v)); return r; }
+	void Store(float* p) const { memcpy(p, v, sizeof(v)); }
+	Vec4f operator+(Vec4f o) const { Vec4f r; for(int c=0; c < 4; ++c) r.v[c] = v[c] + o.v[c]; return r; }
+	Vec4f operator-(Vec4f o) const { Vec4f r; for(int c=0; c < 4; ++c) r.v[c] = v[c] - o.v[c]; return r; }
+	Vec4f operator*(Vec4f o) const { Vec4f r; for(int c=0; c < 4; ++c) r.v[c] = v[c] * o.v[c]; return r; }
+	Vec4f Abs() const { Vec4f r; for(int c=0; c < 4; ++c) r.v[c] = fabsf(v[c]); return r; }
+	Vec4f Max(Vec4f o) const { Vec4f r; for(int c=0; c < 4; ++c) r.v[c] = std::max(v[c], o.v[c]); return r; }
+	Vec4f Min(Vec4f o) const { Vec4f r; for(int c=0; c < 4; ++c) r.v[c] = std::min(v[c], o.v[c]); return r; }
+#endif
+};
+
+// squared errors are summed up in floats for this many pixels,
+// then added to the double sums (so precision doesn't suffer for huge images)
+enum { PIXELS_PER_FLOAT_SUM = 256 };
+
+struct ErrorSums {
+	double sqErr[4] = {};
+	float maxErr[4] = {};
+	double ssim[4] = {}; // sum of the SSIM of all windows
+	size_t numSSIMWindows = 0;
+};
+
+static void SumErrors(const float* a, const float* b, uint32_t numPixels, ErrorSums& sums)
+{
+	Vec4f maxErr = Vec4f::Load(sums.maxErr);
+	for(uint32_t start=0; start < numPixels; start += PIXELS_PER_FLOAT_SUM) {
+		uint32_t end = std::min(start + PIXELS_PER_FLOAT_SUM, numPixels);
+		Vec4f sq;
+		for(uint32_t i=start; i < end; ++i) {
+			Vec4f d = Vec4f::Load(a + i*4) - Vec4f::Load(b + i*4);
+			sq = sq + d * d;
+			maxErr = maxErr.Max(d.Abs());
+		}
+		float sqs[4];
+		sq.Store(sqs);
+		for(int c=0; c < 4; ++c) {
+			sums.sqErr[c] += sqs[c];
+		}
+	}
+	maxErr.Store(sums.maxErr);
+}
+
+// SSIM is calculated like in x264 and libjpeg-turbo's tjbench: the images are split
+// into 4x4 pixel blocks, and each SSIM window is 2x2 blocks (8x8 pixels), so the
+// windows overlap by half. The window statistics are made from the block sums.
+enum { SSIM_BLOCK_SIZE = 4 };
+
+struct SSIMBlockSums {
+	Vec4f a, b, aa, bb, ab;
+};
+
+// calculates the sums of the row of blocks starting at pixel row y
+static void SumSSIMBlockRow(const float* a, const float* b, uint32_t width, uint32_t y,
+                            std::vector<SSIMBlockSums>& blockSums)
+{
+	uint32_t numBlocks = width / SSIM_BLOCK_SIZE;
+	blockSums.assign(numBlocks, SSIMBlockSums());
+	for(uint32_t row=y; row < y + SSIM_BLOCK_SIZE; ++row) {
+		const float* rowA = a + size_t(row) * width * 4;
+		const float* rowB = b + size_t(row) * width * 4;
+		for(uint32_t bx=0; bx < numBlocks; ++bx) {
+			SSIMBlockSums& bs = blockSums[bx];
+			for(uint32_t x = bx * SSIM_BLOCK_SIZE; x < (bx + 1) * SSIM_BLOCK_SIZE; ++x) {
+				Vec4f pa = Vec4f::Load(rowA + x*4);
+				Vec4f pb = Vec4f::Load(rowB + x*4);
+				bs.a = bs.a + pa;
+				bs.b = bs.b + pb;
+				bs.aa = bs.aa + pa * pa;
+				bs.bb = bs.bb + pb * pb;
+				bs.ab = bs.ab + pa * pb;
+			}
+		}
+	}
+}
+
+// adds the SSIM of the windows made of blockSums[i], [i+1] of both rows to sums
+static void SumSSIMWindows(const std::vector<SSIMBlockSums>& row0, const std::vector<SSIMBlockSums>& row1,
+                           ErrorSums& sums)
+{
+	// the constants from the SSIM paper, for a dynamic range of 1
+	const float C1 = 0.01f * 0.01f;
+	const float C2 = 0.03f * 0.03f;
+	const float invN = 1.0f / (4 * SSIM_BLOCK_SIZE * SSIM_BLOCK_SIZE);
+	for(size_t i=0; i + 1 < row0.size(); ++i) {
+		float s[5][4];
+		(row0[i].a + row0[i+1].a + row1[i].a + row1[i+1].a).Store(s[0]);
+		(row0[i].b + row0[i+1].b + row1[i].b + row1[i+1].b).Store(s[1]);
+		(row0[i].aa + row0[i+1].aa + row1[i].aa + row1[i+1].aa).Store(s[2]);
+		(row0[i].bb + row0[i+1].bb + row1[i].bb + row1[i+1].bb).Store(s[3]);
+		(row0[i].ab + row0[i+1].ab + row1[i].ab + row1[i+1].ab).Store(s[4]);
+		for(int c=0; c < 4; ++c) {
+			float meanA = s[0][c] * invN;
+			float meanB = s[1][c] * invN;
+			float varA = std::max(s[2][c] * invN - meanA * meanA, 0.0f);
+			float varB = std::max(s[3][c] * invN - meanB * meanB, 0.0f);
+			float cov = s[4][c] * invN - meanA * meanB;
+			sums.ssim[c] += ((2.0f * meanA * meanB + C1) * (2.0f * cov + C2))
+			                / ((meanA * meanA + meanB * meanB + C1) * (varA + varB + C2));
+		}
+		++sums.numSSIMWindows;
+	}
+}
+
+// for images that are too small for 8x8 windows: the SSIM of the whole image
+static void CalcSSIMWholeImage(const float* a, const float* b, size_t numPixels, double ssim[4])
+{
+	const double C1 = 0.01 * 0.01;
+	const double C2 = 0.03 * 0.03;
+	for(int c=0; c < 4; ++c) {
+		double sA = 0.0, sB = 0.0, sAA = 0.0, sBB = 0.0, sAB = 0.0;
+		for(size_t i=0; i < numPixels; ++i) {
+			double va = a[i*4 + c];
+			double vb = b[i*4 + c];
+			sA += va;
+			sB += vb;
+			sAA += va * va;
+			sBB += vb * vb;
+			sAB += va * vb;
+		}
+		double meanA = sA / numPixels;
+		double meanB = sB / numPixels;
+		double varA = std::max(sAA / numPixels - meanA * meanA, 0.0);
+		double varB = std::max(sBB / numPixels - meanB * meanB, 0.0);
+		double cov = sAB / numPixels - meanA * meanB;
+		ssim[c] = ((2.0 * meanA * meanB + C1) * (2.0 * cov + C2))
+		          / ((meanA * meanA + meanB * meanB + C1) * (varA + varB + C2));
+	}
+}
+
+double MSEToPSNR(double mse, double peak)
+{
+	if(mse <= 0.0) {
+		return INFINITY; // identical
+	}
+	return 10.0 * log10(peak * peak / mse);
+}
+
+void CompareFloatImages(const float* a, const float* b, uint32_t width, uint32_t height,
+                        ImageErrors* errors, bool calcSSIM)
+{
+	*errors = ImageErrors();
+	errors->width = width;
+	errors->height = height;
+	size_t numPixels = size_t(width) * height;
+	if(numPixels == 0) {
+		return;
+	}
+	// a chunk is a number of rows of SSIM windows (and their pixels)
+	const uint32_t rowsPerChunk = std::max(1u, (256u * 1024u) / width / SSIM_BLOCK_SIZE) * SSIM_BLOCK_SIZE;
+	const int numChunks = int((height + rowsPerChunk - 1) / rowsPerChunk);
+	const uint32_t numBlockRows = height / SSIM_BLOCK_SIZE;
+	const bool useWindows = calcSSIM && width >= 2 * SSIM_BLOCK_SIZE && height >= 2 * SSIM_BLOCK_SIZE;
+	std::vector<ErrorSums> chunkSums(numChunks);
+	ParallelFor(numChunks, [&](int chunkIdx) {
+		uint32_t yStart = chunkIdx * rowsPerChunk;
+		uint32_t yEnd = std::min(yStart + rowsPerChunk, height);
+		size_t offset = size_t(yStart) * width * 4;
+		SumErrors(a + offset, b + offset, (yEnd - yStart) * width, chunkSums[chunkIdx]);
+		if(useWindows) {
+			// the windows that start in this chunk's block rows, the last one
+			// also needs the first block row of the next chunk
+			std::vector<SSIMBlockSums> rows[2];
+			uint32_t blockRow = yStart / SSIM_BLOCK_SIZE;
+			uint32_t blockRowEnd = std::min(yEnd / SSIM_BLOCK_SIZE, numBlockRows - 1);
+			if(blockRow < blockRowEnd) {
+				SumSSIMBlockRow(a, b, width, blockRow * SSIM_BLOCK_SIZE, rows[0]);
+			}
+			for( ; blockRow < blockRowEnd; ++blockRow) {
+				SumSSIMBlockRow(a, b, width, (blockRow + 1) * SSIM_BLOCK_SIZE, rows[1]);
+				SumSSIMWindows(rows[0], rows[1], chunkSums[chunkIdx]);
+				rows[0].swap(rows[1]);
+			}
+		}
+	});
+
+	double sqErr[4] = {};
+	double ssim[4] = {};
+	size_t numSSIMWindows = 0;
+	for(const ErrorSums& cs : chunkSums) {
+		for(int c=0; c < 4; ++c) {
+			sqErr[c] += cs.sqErr[c];
+			errors->maxError[c] = std::max(errors->maxError[c], (double)cs.maxErr[c]);
+			ssim[c] += cs.ssim[c];
+		}
+		numSSIMWindows += cs.numSSIMWindows;
+	}
+	for(int c=0; c < 4; ++c) {
+		errors->mse[c] = sqErr[c] / numPixels;
+	}
+	errors->mseRGB = (sqErr[0] + sqErr[1] + sqErr[2]) / (3.0 * numPixels);
+	if(useWindows) {
+		for(int c=0; c < 4; ++c) {
+			errors->ssim[c] = ssim[c] / numSSIMWindows;
+		}
+	} else if(calcSSIM) {
+		CalcSSIMWholeImage(a, b, numPixels, errors->ssim);
+	}
+}
+
+bool CompareTextureImages(Texture& a, int elemIdxA, Texture& b, int elemIdxB, int level,
+                          ImageErrors* errors, bool calcSSIM)
+{
+	float wa, ha, wb, hb;
+	a.GetMipSize(level, &wa, &ha);
+	b.GetMipSize(level, &wb, &hb);
+	if(wa != wb || ha != hb || wa == 0.0f || ha == 0.0f) {
+		return false;
+	}
+	std::vector<float> imgA, imgB;
+	if(!a.GetFloatImage(level, elemIdxA, imgA) || !b.GetFloatImage(level, elemIdxB, imgB)) {
+		return false;
+	}
+	CompareFloatImages(imgA.data(), imgB.data(), (uint32_t)wa, (uint32_t)ha, errors, calcSSIM);
+	return true;
+}
+
+// the statistics are made in two passes over the image: first min, max and the
+// sums for mean and standard deviation, then the histogram (its range depends on min and max)
+struct StatSums {
+	float min[4];
+	float max[4];
+	double sum[4] = {};
+	double sumSq[4] = {};
+};
+
+static void SumStats(const float* rgba, size_t numPixels, StatSums& sums)
+{
+	Vec4f mn = Vec4f::Load(rgba);
+	Vec4f mx = mn;
+	for(size_t start=0; start < numPixels; start += PIXELS_PER_FLOAT_SUM) {
+		size_t end = std::min(start + PIXELS_PER_FLOAT_SUM, numPixels);
+		Vec4f sum, sumSq;
+		for(size_t i=start; i < end; ++i) {
+			Vec4f p = Vec4f::Load(rgba + i*4);
+			mn = mn.Min(p);
+			mx = mx.Max(p);
+			sum = sum + p;
+			sumSq = sumSq + p * p;
+		}
+		float s[4], sq[4];
+		sum.Store(s);
+		sumSq.Store(sq);
+		for(int c=0; c < 4; ++c) {
+			sums.sum[c] += s[c];
+			sums.sumSq[c] += sq[c];
+		}
+	}
+	mn.Store(sums.min);
+	mx.Store(sums.max);
+}
+
+void SetHistogramRange(ImageStats* stats)
+{
+	float lo = 0.0f;
+	float hi = 1.0f;
+	for(int c=0; c < 4; ++c) {
+		// infinite values (possible in HDR images) just end up in the first or last bin
+		if(isfinite(stats->min[c])) {
+			lo = std::min(lo, (float)stats->min[c]);
+		}
+		if(isfinite(stats->max[c])) {
+			hi = std::max(hi, (float)stats->max[c]);
+		}
+	}
+	stats->histoMin = lo;
+	stats->histoMax = hi;
+}
+
+void CalcImageStats(const float* rgba, uint32_t width, uint32_t height, ImageStats* stats)
+{
+	*stats = ImageStats();
+	stats->width = width;
+	stats->height = height;
+	const size_t numPixels = size_t(width) * height;
+	if(numPixels == 0) {
+		return;
+	}
+	const uint32_t rowsPerChunk = std::max(1u, (256u * 1024u) / width);
+	const int numChunks = int((height + rowsPerChunk - 1) / rowsPerChunk);
+	std::vector<StatSums> chunkSums(numChunks);
+	ParallelFor(numChunks, [&](int chunkIdx) {
+		uint32_t yStart = chunkIdx * rowsPerChunk;
+		uint32_t yEnd = std::min(yStart + rowsPerChunk, height);
+		SumStats(rgba + size_t(yStart) * width * 4, size_t(yEnd - yStart) * width, chunkSums[chunkIdx]);
+	});
+
+	double sum[4] = {};
+	double sumSq[4] = {};
+	for(int c=0; c < 4; ++c) {
+		stats->min[c] = chunkSums[0].min[c];
+		stats->max[c] = chunkSums[0].max[c];
+	}
+	for(const StatSums& cs : chunkSums) {
+		for(int c=0; c < 4; ++c) {
+			stats->min[c] = std::min(stats->min[c], (double)cs.min[c]);
+			stats->max[c] = std::max(stats->max[c], (double)cs.max[c]);
+			sum[c] += cs.sum[c];
+			sumSq[c] += cs.sumSq[c];
+		}
+	}
+	for(int c=0; c < 4; ++c) {
+		stats->mean[c] = sum[c] / numPixels;
+		double variance = sumSq[c] / numPixels - stats->mean[c] * stats->mean[c];
+		stats->stddev[c] = sqrt(std::max(variance, 0.0));
+	}
+
+	SetHistogramRange(stats);
+	const float scale = IMAGE_STATS_NUM_BINS / (stats->histoMax - stats->histoMin);
+	const Vec4f histoMin(stats->histoMin);
+	const Vec4f histoScale(scale);
+	struct Histogram {
+		uint32_t bins[4][IMAGE_STATS_NUM_BINS];
+	};
+	std::vector<Histogram> chunkHistos(numChunks); // (zero-initialized)
+	ParallelFor(numChunks, [&](int chunkIdx) {
+		Histogram& histo = chunkHistos[chunkIdx];
+		uint32_t yStart = chunkIdx * rowsPerChunk;
+		uint32_t yEnd = std::min(yStart + rowsPerChunk, height);
+		const float* px = rgba + size_t(yStart) * width * 4;
+		const float* pxEnd = rgba + size_t(yEnd) * width * 4;
+		for( ; px < pxEnd; px += 4) {
+			float b[4];
+			((Vec4f::Load(px) - histoMin) * histoScale).Store(b);
+			for(int c=0; c < 4; ++c) {
+				// (written like this so NaN ends up in bin 0)
+				int bin = (b[c] >= 0.0f) ? int(std::min(b[c], float(IMAGE_STATS_NUM_BINS - 1))) : 0;
+				++histo.bins[c][bin];
+			}
+		}
+	});
+	for(const Histogram& h : chunkHistos) {
+		for(int c=0; c < 4; ++c) {
+			for(int i=0; i < IMAGE_STATS_NUM_BINS; ++i) {
+				stats->histogram[c][i] += h.bins[c][i];
+			}
+		}
+	}
+}
+
+bool CalcTextureImageStats(Texture& tex, int elemIdx, int level, ImageStats* stats)
+{
+	float w, h;
+	tex.GetMipSize(level, &w, &h);
+	std::vector<float> img;
+	if(w == 0.0f || h == 0.0f || !tex.GetFloatImage(level, elemIdx, img)) {
+		return false;
+	}
+	CalcImageStats(img.data(), (uint32_t)w, (uint32_t)h, stats);
+	return true;
+}
+
+} //namespace texview
@@ -1163,6 +1163,14 @@ ktxTexture2_SetPrimaries(ktxTexture2* This, khr_df_primaries_e primaries);
 
 KTX_API ktx_error_code_e KTX_APIENTRY
 ktxTexture2_LoadImageData(ktxTexture2* This, ktx_uint8_t* pBuffer, ktx_size_t bufSize);
+/*
+ * DG: Inflates a single level of a Zstd or ZLIB supercompressed texture whose
+ * image data hasn't been loaded, reading it from the (e.g. memory-mapped) file data.
+ */
+KTX_API ktx_error_code_e KTX_APIENTRY
+ktxTexture2_InflateLevelFromMemory(ktxTexture2* This, ktx_uint32_t level,
+                                   const ktx_uint8_t* pFileData, ktx_size_t fileSize,
+                                   ktx_uint8_t* pDest, ktx_size_t destSize);
 /*
  * For rare testing scenarios. Use ktxTexture2_LoadImageData.
  */
@@ -1690,6 +1698,20 @@ KTX_API KTX_error_code KTX_APIENTRY
 ktxTexture2_TranscodeBasis(ktxTexture2* This, ktx_transcode_fmt_e fmt,
                            ktx_transcode_flags transcodeFlags);
 
+/*
+ * DG: Used by ktxTexture2_TranscodeBasisParallel() to run jobs in parallel:
+ * must call job(jobData, i) for each i in [0, numJobs) and return when all are done.
+ */
+typedef void (*ktxParallelForFn)(void* userData, ktx_uint32_t numJobs,
+                                 void (*job)(void* jobData, ktx_uint32_t i),
+                                 void* jobData);
+
+KTX_API KTX_error_code KTX_APIENTRY
+ktxTexture2_TranscodeBasisParallel(ktxTexture2* This, ktx_transcode_fmt_e fmt,
+                                   ktx_transcode_flags transcodeFlags,
+                                   ktxParallelForFn parallelFor,
+                                   void* parallelForUserData);
+
 /*
  * Returns a string corresponding to a KTX error code.
  */
@@ -20,6 +20,9 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <atomic>
+#include <functional>
+#include <vector>
 #include <KHR/khr_df.h>
 
 #include "dfdutils/dfd.h"
@@ -50,13 +53,50 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
                            alpha_content_e alphaContent,
                            ktxTexture2* prototype,
                            ktx_transcode_fmt_e outputFormat,
-                           ktx_transcode_flags transcodeFlags);
+                           ktx_transcode_flags transcodeFlags,
+                           ktxParallelForFn parallelFor,
+                           void* parallelForUserData);
 KTX_error_code
 ktxTexture2_transcodeUastc(ktxTexture2* This,
                            alpha_content_e alphaContent,
                            ktxTexture2* prototype,
                            ktx_transcode_fmt_e outputFormat,
-                           ktx_transcode_flags transcodeFlags);
+                           ktx_transcode_flags transcodeFlags,
+                           ktxParallelForFn parallelFor,
+                           void* parallelForUserData);
+
+// DG: the images (per level, layer and face) are transcoded independently of
+//     each other (except for video), so they're collected as jobs that can be
+//     run in parallel with the parallelFor function passed to
+//     ktxTexture2_TranscodeBasisParallel(), or serially if there is none.
+struct xcodeJobList {
+    std::vector<std::function<bool()>> jobs;
+    std::atomic<bool> failed{false};
+};
+
+static void
+runXcodeJob(void* jobData, ktx_uint32_t i)
+{
+    xcodeJobList* list = (xcodeJobList*)jobData;
+    if (list->failed.load())
+        return;
+    if (!list->jobs[i]())
+        list->failed = true;
+}
+
+static bool
+runXcodeJobs(xcodeJobList& list, ktxParallelForFn parallelFor,
+             void* parallelForUserData)
+{
+    ktx_uint32_t numJobs = (ktx_uint32_t)list.jobs.size();
+    if (parallelFor != NULL && numJobs > 1) {
+        parallelFor(parallelForUserData, numJobs, runXcodeJob, &list);
+    } else {
+        for (ktx_uint32_t i = 0; i < numJobs && !list.failed.load(); i++)
+            runXcodeJob(&list, i);
+    }
+    return !list.failed.load();
+}
 
 /**
  * @memberof ktxTexture2
@@ -134,6 +174,35 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
  ktxTexture2_TranscodeBasis(ktxTexture2* This,
                             ktx_transcode_fmt_e outputFormat,
                             ktx_transcode_flags transcodeFlags)
+{
+    return ktxTexture2_TranscodeBasisParallel(This, outputFormat,
+                                              transcodeFlags, NULL, NULL);
+}
+
+/**
+ * @memberof ktxTexture2
+ * @ingroup reader
+ * @~English
+ * @brief Like ktxTexture2_TranscodeBasis(), but transcodes the images in parallel.
+ *
+ * DG: Added for texview. Each image (mip level, layer, face) is transcoded
+ * as a separate job, @p parallelFor is called with all of them and must call
+ * job(jobData, i) for each i in [0, numJobs) (on any threads it likes) and only
+ * return once all are done. The transcoded images are written to the same
+ * preallocated buffer as with ktxTexture2_TranscodeBasis(), so the result is
+ * identical. Video textures are always transcoded serially, because P-frames
+ * depend on the previous frame.
+ *
+ * @param[in]   parallelFor  the function used to run the jobs, if NULL they're
+ *                           run serially in the calling thread.
+ * @param[in]   parallelForUserData passed to @p parallelFor as is.
+ */
+ KTX_error_code
+ ktxTexture2_TranscodeBasisParallel(ktxTexture2* This,
+                                    ktx_transcode_fmt_e outputFormat,
+                                    ktx_transcode_flags transcodeFlags,
+                                    ktxParallelForFn parallelFor,
+                                    void* parallelForUserData)
 {
     uint32_t* BDB = This->pDfd + 1;
     khr_df_model_e colorModel = (khr_df_model_e)KHR_DFDVAL(BDB, MODEL);
@@ -333,20 +402,21 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
     // Transcoder global initialization. Requires ~9 milliseconds when compiled
     // and executed natively on a Core i7 2.2 GHz. If this is too slow, the
     // tables it computes can easily be moved to be compiled in.
-    static bool transcoderInitialized;
-    if (!transcoderInitialized) {
-        basisu_transcoder_init();
-        transcoderInitialized = true;
-    }
+    // DG: initialization of function-local statics is thread-safe,
+    //     this function might be called by several threads at once
+    static bool transcoderInitialized = (basisu_transcoder_init(), true);
+    (void)transcoderInitialized;
 
     if (textureFormat == basis_tex_format::cETC1S) {
         result = ktxTexture2_transcodeLzEtc1s(This, alphaContent,
                                             prototype, outputFormat,
-                                            transcodeFlags);
+                                            transcodeFlags, parallelFor,
+                                            parallelForUserData);
     } else {
         result = ktxTexture2_transcodeUastc(This, alphaContent,
                                             prototype, outputFormat,
-                                            transcodeFlags);
+                                            transcodeFlags, parallelFor,
+                                            parallelForUserData);
     }
 
     if (result == KTX_SUCCESS) {
@@ -458,7 +528,9 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
                              alpha_content_e alphaContent,
                              ktxTexture2* prototype,
                              ktx_transcode_fmt_e outputFormat,
-                             ktx_transcode_flags transcodeFlags)
+                             ktx_transcode_flags transcodeFlags,
+                             ktxParallelForFn parallelFor,
+                             void* parallelForUserData)
 {
     DECLARE_PRIVATE(priv, This);
     DECLARE_PRIVATE(protoPriv, prototype);
@@ -480,7 +552,7 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
     // level to largest or when randomly accessing them (t.b.c). The last array
     // entry contains the total number of images, for calculating the offsets
     // of the endpoints, etc.
-    uint32_t* firstImages = new uint32_t[This->numLevels+1];
+    std::vector<uint32_t> firstImages(This->numLevels+1);
 
     // Temporary invariant value
     uint32_t layersFaces = This->numLayers * This->numFaces;
@@ -491,19 +563,15 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
         firstImages[level] = firstImages[level - 1]
                            + layersFaces * MAX(This->baseDepth >> (level - 1), 1);
     }
-    uint32_t& imageCount = firstImages[This->numLevels];
+    uint32_t imageCount = firstImages[This->numLevels];
 
     if (BGD_TABLES_ADDR(0, bgdh, imageCount) + bgdh.tablesByteLength > priv._sgdByteLength) {
-        // Compiler will not allow `goto cleanup;` because "jump bypasses variable initialization."
-        // The static initializations below this and before the loop are presumably the issue
-        // as the compiler is,presumably, inserting code to destruct those at the end of the
-        // function.
-        delete[] firstImages;
         return KTX_FILE_DATA_ERROR;
     }
     // FIXME: Do more validation.
 
     // Prepare low-level transcoder for transcoding slices.
+    // DG: transcode_image() doesn't modify it, so it can be shared by all jobs
     basist::basisu_lowlevel_etc1s_transcoder bit;
 
     // basisu_transcoder_state is used to find the previous frame when
@@ -511,8 +579,10 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
     // level. For cube map array textures we need to find the previous frame
     // for each face so we a state per face. Although providing this is only
     // needed for video, it is easier to always pass our own.
+    // DG: it also holds temporary data, so when not transcoding a video
+    //     (which is done serially) each job uses its own state.
     std::vector<basisu_transcoder_state> xcoderStates;
-    xcoderStates.resize(This->isVideo ? This->numFaces : 1);
+    xcoderStates.resize(This->isVideo ? This->numFaces : 0);
 
     bit.decode_palettes(bgdh.endpointCount, BGD_ENDPOINTS_ADDR(bgd, imageCount),
                         bgdh.endpointsByteLength,
@@ -546,12 +616,14 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
     // the app can query file_info and image_info from the transcoder which
     // returns a structure with lots of info about the image.
 
+    xcodeJobList jobList;
+    jobList.jobs.reserve(imageCount);
+
     protoLevelIndex = protoPriv._levelIndex;
     levelOffsetWrite = 0;
     for (int32_t level = This->numLevels - 1; level >= 0; level--) {
         uint64_t levelOffset = ktxTexture2_levelDataOffset(This, level);
         uint64_t writeOffset = levelOffsetWrite;
-        uint64_t writeOffsetBlocks = levelOffsetWrite / outputBlockByteLength;
         uint32_t levelWidth = MAX(1, This->baseWidth >> level);
         uint32_t levelHeight = MAX(1, This->baseHeight >> level);
         // ETC1S texel block dimensions
@@ -573,13 +645,16 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
         for (; image < endImage; image++) {
             const ktxBasisLzEtc1sImageDesc& imageDesc = imageDescs[image];
 
-            basisu_transcoder_state& xcoderState = xcoderStates[stateIndex];
-            // We have face0 [face1 ...] within each layer. Use `stateIndex`
-            // rather than a double loop of layers and faceSlices as this
-            // works for 3d texture and non-array cube maps as well as
-            // cube map arrays without special casing.
-            if (++stateIndex == xcoderStates.size())
-                stateIndex = 0;
+            basisu_transcoder_state* xcoderState = NULL;
+            if (isVideo) {
+                xcoderState = &xcoderStates[stateIndex];
+                // We have face0 [face1 ...] within each layer. Use `stateIndex`
+                // rather than a double loop of layers and faceSlices as this
+                // works for 3d texture and non-array cube maps as well as
+                // cube map arrays without special casing.
+                if (++stateIndex == xcoderStates.size())
+                    stateIndex = 0;
+            }
 
             if (alphaContent != eNone)
             {
@@ -589,8 +664,10 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
                     return KTX_FILE_DATA_ERROR;
             }
 
-            bool status;
-            status = bit.transcode_image(
+            uint64_t writeOffsetBlocks = writeOffset / outputBlockByteLength;
+            jobList.jobs.push_back([=, &bit]() -> bool {
+                basisu_transcoder_state localState;
+                return bit.transcode_image(
                       (transcoder_texture_format)outputFormat,
                       pXcodedData + writeOffset,
                       (uint32_t)(xcodedDataLength - writeOffsetBlocks),
@@ -616,13 +693,10 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
                       // the I-Frame flag.
                       //imageDesc.imageFlags ^ cSliceDescFlagsFrameIsIFrame,
                       0, // output_row_pitch_in_blocks_or_pixels
-                      &xcoderState,
+                      xcoderState ? xcoderState : &localState,
                       0  // output_rows_in_pixels
                       );
-            if (!status) {
-                result = KTX_TRANSCODE_FAILED;
-                goto cleanup;
-            }
+            });
 
             writeOffset += levelImageSizeOut;
             levelSizeOut += levelImageSizeOut;
@@ -637,10 +711,9 @@ ktxTexture2_transcodeLzEtc1s(ktxTexture2* This,
                                      levelOffsetWrite);
     } // level loop
 
-    result = KTX_SUCCESS;
+    if (!runXcodeJobs(jobList, isVideo ? NULL : parallelFor, parallelForUserData))
+        result = KTX_TRANSCODE_FAILED;
 
-cleanup:
-    delete[] firstImages;
     return result;
 }
 
@@ -650,7 +723,9 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
                            alpha_content_e alphaContent,
                            ktxTexture2* prototype,
                            ktx_transcode_fmt_e outputFormat,
-                           ktx_transcode_flags transcodeFlags)
+                           ktx_transcode_flags transcodeFlags,
+                           ktxParallelForFn parallelFor,
+                           void* parallelForUserData)
 {
     assert(This->supercompressionScheme != KTX_SS_BASIS_LZ);
 
@@ -663,16 +738,18 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
     ktxLevelIndexEntry* protoLevelIndex = protoPriv._levelIndex;
     ktx_size_t levelOffsetWrite = 0;
 
+    // DG: transcode_image() doesn't modify it, so it can be shared by all jobs
     basisu_lowlevel_uastc_transcoder uit;
     // See comment on same declaration in transcodeEtc1s.
     std::vector<basisu_transcoder_state> xcoderStates;
-    xcoderStates.resize(This->isVideo ? This->numFaces : 1);
+    xcoderStates.resize(This->isVideo ? This->numFaces : 0);
+
+    xcodeJobList jobList;
 
     for (ktx_int32_t level = This->numLevels - 1; level >= 0; level--)
     {
         ktx_uint32_t depth;
         uint64_t writeOffset = levelOffsetWrite;
-        uint64_t writeOffsetBlocks = levelOffsetWrite / outputBlockByteLength;
         ktx_size_t levelImageSizeIn, levelImageOffsetIn;
         ktx_size_t levelImageSizeOut, levelSizeOut;
         ktx_uint32_t levelImageCount;
@@ -695,14 +772,19 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
 
         levelImageOffsetIn = ktxTexture2_levelDataOffset(This, level);
         levelSizeOut = 0;
-        bool status;
         for (uint32_t image = 0; image < levelImageCount; image++) {
-            basisu_transcoder_state& xcoderState = xcoderStates[stateIndex];
-            // See comment before same lines in transcodeEtc1s.
-            if (++stateIndex == xcoderStates.size())
-                stateIndex = 0;
+            basisu_transcoder_state* xcoderState = NULL;
+            if (This->isVideo) {
+                xcoderState = &xcoderStates[stateIndex];
+                // See comment before same lines in transcodeEtc1s.
+                if (++stateIndex == xcoderStates.size())
+                    stateIndex = 0;
+            }
 
-            status = uit.transcode_image(
+            uint64_t writeOffsetBlocks = writeOffset / outputBlockByteLength;
+            jobList.jobs.push_back([=, &uit]() -> bool {
+                basisu_transcoder_state localState;
+                return uit.transcode_image(
                           (transcoder_texture_format)outputFormat,
                           pXcodedData + writeOffset,
                           (uint32_t)(xcodedDataLength - writeOffsetBlocks),
@@ -720,13 +802,12 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
                           This->isVideo, // is_video
                           //imageDesc.imageFlags ^ cSliceDescFlagsFrameIsIFrame,
                           0, // output_row_pitch_in_blocks_or_pixels
-                          &xcoderState, // pState
+                          xcoderState ? xcoderState : &localState, // pState
                           0, // output_rows_in_pixels,
                           -1, // channel0
                           -1  // channel1
                           );
-            if (!status)
-                return KTX_TRANSCODE_FAILED;
+            });
             writeOffset += levelImageSizeOut;
             levelSizeOut += levelImageSizeOut;
             levelImageOffsetIn += levelImageSizeIn;
@@ -740,5 +821,9 @@ ktxTexture2_transcodeUastc(ktxTexture2* This,
     // In case of transcoding to uncompressed.
     levelOffsetWrite = _KTX_PADN(protoPriv._requiredLevelAlignment,
                                  levelOffsetWrite);
+
+    if (!runXcodeJobs(jobList, This->isVideo ? NULL : parallelFor,
+                      parallelForUserData))
+        return KTX_TRANSCODE_FAILED;
     return KTX_SUCCESS;
 }
@@ -2726,6 +2726,100 @@ ktxTexture2_LoadDeflatedImageData(ktxTexture2* This,
     return ktxTexture2_loadImageDataInt(This, pBuffer, bufSize, LOADDATA_DONT_INFLATE_ON_LOAD);
 }
 
+/**
+ * @memberof ktxTexture2
+ * @~English
+ * @brief Inflate a single level of a Zstd or ZLIB supercompressed texture.
+ *
+ * DG: Added for texview. Reads the level straight from @p pFileData, which must
+ * contain the whole KTX2 file the texture was created from (e.g. memory-mapped),
+ * so the texture must have been created without
+ * @c KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT and its image data must not have
+ * been loaded. Doesn't modify the texture, so several levels can be inflated
+ * in parallel by different threads.
+ *
+ * @param[in] This pointer to the ktxTexture2 object of interest.
+ * @param[in] level the mip level to inflate.
+ * @param[in] pFileData pointer to the data of the whole KTX2 file.
+ * @param[in] fileSize size of the data pointed at by @p pFileData.
+ * @param[in,out] pDest buffer the inflated level is written to, the images
+ *                      of the layers/faces/slices are tightly packed.
+ * @param[in] destSize size of the buffer pointed at by @p pDest, must be at
+ *                     least ktxTexture_GetLevelSize(This, level).
+ *
+ * @return      KTX_SUCCESS on success, other KTX_* enum values on error.
+ *
+ * @exception KTX_INVALID_OPERATION
+ *                      The texture isn't Zstd or ZLIB supercompressed, or its
+ *                      image data has already been loaded.
+ * @exception KTX_INVALID_VALUE @p level is out of range, @p pDest is too small
+ *                              or the level isn't inside @p pFileData.
+ * @exception KTX_DECOMPRESS_LENGTH_ERROR The inflated data has the wrong size.
+ * @exception KTX_FILE_DATA_ERROR The compressed data is broken.
+ */
+ktx_error_code_e
+ktxTexture2_InflateLevelFromMemory(ktxTexture2* This, ktx_uint32_t level,
+                                   const ktx_uint8_t* pFileData,
+                                   ktx_size_t fileSize,
+                                   ktx_uint8_t* pDest, ktx_size_t destSize)
+{
+    if (This == NULL || pFileData == NULL || pDest == NULL)
+        return KTX_INVALID_VALUE;
+    if (This->pData != NULL
+        || (This->supercompressionScheme != KTX_SS_ZSTD
+            && This->supercompressionScheme != KTX_SS_ZLIB))
+        return KTX_INVALID_OPERATION;
+    if (level >= This->numLevels)
+        return KTX_INVALID_VALUE;
+
+    ktxLevelIndexEntry* levelIndex = This->_private->_levelIndex;
+    ktx_uint64_t srcOffset = ktxTexture2_levelFileOffset(This, level);
+    ktx_uint64_t srcLength = levelIndex[level].byteLength;
+    ktx_uint64_t inflatedLength = levelIndex[level].uncompressedByteLength;
+    if (srcOffset > fileSize || srcLength > fileSize - srcOffset
+        || inflatedLength > destSize)
+        return KTX_INVALID_VALUE;
+
+    const ktx_uint8_t* pSrc = pFileData + srcOffset;
+    if (This->supercompressionScheme == KTX_SS_ZSTD) {
+        size_t levelSize = ZSTD_decompress(pDest, destSize, pSrc, srcLength);
+        if (ZSTD_isError(levelSize)) {
+            switch (ZSTD_getErrorCode(levelSize)) {
+              case ZSTD_error_dstSize_tooSmall:
+                return KTX_DECOMPRESS_LENGTH_ERROR;
+              case ZSTD_error_checksum_wrong:
+                return KTX_DECOMPRESS_CHECKSUM_ERROR;
+              case ZSTD_error_memory_allocation:
+                return KTX_OUT_OF_MEMORY;
+              default:
+                return KTX_FILE_DATA_ERROR;
+            }
+        }
+        if (levelSize != inflatedLength)
+            return KTX_DECOMPRESS_LENGTH_ERROR;
+    } else {
+        ktx_size_t levelSize = destSize;
+        KTX_error_code result = ktxUncompressZLIBInt(pDest, &levelSize,
+                                                     pSrc, srcLength);
+        if (result != KTX_SUCCESS)
+            return result;
+        if (levelSize != inflatedLength)
+            return KTX_DECOMPRESS_LENGTH_ERROR;
+    }
+
+#if IS_BIG_ENDIAN
+    switch (This->_protected->_typeSize) {
+      case 2:
+        _ktxSwapEndian16((ktx_uint16_t*)pDest, inflatedLength / 2);
+        break;
+      case 4:
+        _ktxSwapEndian32((ktx_uint32_t*)pDest, inflatedLength / 4);
+        break;
+    }
+#endif
+    return KTX_SUCCESS;
+}
+
 /**
  * @memberof ktxTexture2 @private
  * @~English
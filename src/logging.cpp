@@ -10,10 +10,13 @@
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui.h>
+#include <GLFW/glfw3.h>
 #include "texview.h"
 #include <math.h>
 #include <time.h>
 
+#include <mutex>
+
 
 namespace texview {
 
@@ -212,13 +215,38 @@ void StringAppendFormatted(std::string& str, const char* fmt, ...)
 }
 
 static TexviewAppLog log;
+// textures are loaded (and might log errors) in worker threads,
+// so everything that modifies or reads the log or warning overlay text
+// must hold this mutex
+static std::mutex logMutex;
 static bool showLogWindow = false;
+static bool logChanged = false; // messages were added since the last DrawLogWindow()
 static bool imguiInitialized = false;
+static bool logMuted = false;
+static thread_local bool logMutedInThisThread = false;
 
 void LogImGuiInit() {
 	imguiInitialized = true;
 }
 
+// if a message must be shown, wakes up the main loop in case it's waiting for events
+// (see WaitForRedraw() in main.cpp), as messages from worker threads don't cause any.
+// glfwPostEmptyEvent() is thread-safe. Must be called with logMutex locked
+static void WakeUpForLogMessage(bool isWarning) {
+	if(imguiInitialized && (showLogWindow || isWarning)) {
+		glfwPostEmptyEvent();
+	}
+}
+
+void LogSetMuted(bool muted) {
+	std::lock_guard<std::mutex> lock(logMutex);
+	logMuted = muted;
+}
+
+void LogSetMutedInThisThread(bool muted) {
+	logMutedInThisThread = muted;
+}
+
 void LogWindowShow() {
 	showLogWindow = true;
 }
@@ -233,6 +261,9 @@ bool LogWindowIsShown() {
 
 static void LogImpl(LogLevel logLevel, const char* fmt, va_list args)
 {
+	if(logMuted || logMutedInThisThread) {
+		return;
+	}
 	time_t nowT = time(nullptr);
 	struct tm now = {};
 #ifdef _WIN32
@@ -250,7 +281,9 @@ static void LogImpl(LogLevel logLevel, const char* fmt, va_list args)
 	size_t msgStartOffset = logLine.size();
 	StringAppendFormattedV(logLine, fmt, args);
 
+	std::lock_guard<std::mutex> lock(logMutex);
 	log.AddLogRaw(logLine.data(), logLine.data() + logLine.length());
+	logChanged = true;
 
 	// also log to stderr
 	fprintf(stderr, "%s", logLine.c_str());
@@ -262,15 +295,22 @@ static void LogImpl(LogLevel logLevel, const char* fmt, va_list args)
 		// don't show timestamp or [Error]
 		ShowWarningOverlay(logLine.c_str() + msgStartOffset, logLevel == LL_ERROR);
 	}
+	WakeUpForLogMessage(logLevel > LL_INFO);
 }
 
 // this one doesn't prepend timestamp and [Error] or whatever
 // (useful to log multiple lines)
 void LogPrint(const char* fmt, ...) {
+	std::lock_guard<std::mutex> lock(logMutex);
+	if(logMuted || logMutedInThisThread) {
+		return;
+	}
 	va_list args;
 	va_start(args, fmt);
 	log.AddLogV(fmt, args);
 	va_end(args);
+	logChanged = true;
+	WakeUpForLogMessage(false);
 	va_start(args, fmt);
 	fprintf(stderr, fmt, args);
 	va_end(args);
@@ -299,6 +339,8 @@ void LogInfo(const char* fmt, ...) {
 
 
 static std::string warningOverlayText;
+// if there's no user input, the overlay is closed after this many seconds
+static const double warningOverlayDuration = 10.0;
 static double warningOverlayStartTime = -100.0;
 static bool warningOverlayRequested = 0;
 static bool warningOverlayForError = false;
@@ -321,7 +363,7 @@ static void UpdateWarningOverlay()
 		bool close = ImGui::IsKeyPressed(ImGuiKey_Escape) || ImGui::IsMouseClicked(ImGuiMouseButton_Left);
 		bool openLogWindow = ImGui::IsKeyPressed(ImGuiKey_Enter);
 
-		if ( close || openLogWindow || dt > 10.0f ) {
+		if ( close || openLogWindow || dt > warningOverlayDuration ) {
 			warningOverlayStartTime = -100.0f;
 			if(openLogWindow) {
 				LogWindowShow();
@@ -393,7 +435,23 @@ void ShowWarningOverlay( const char* text, bool isError )
 	}
 }
 
+double LogGetRedrawTimeout()
+{
+	std::lock_guard<std::mutex> lock(logMutex);
+	if(warningOverlayRequested || (logChanged && showLogWindow)) {
+		return 0.0;
+	}
+	if(warningOverlayStartTime < 0.0) {
+		return -1.0;
+	}
+	// (a bit later, so ImGui::GetTime() in that frame is definitely past it)
+	double closeTime = warningOverlayStartTime + warningOverlayDuration + 0.01;
+	return std::max(closeTime - ImGui::GetTime(), 0.0);
+}
+
 void DrawLogWindow() {
+	std::lock_guard<std::mutex> lock(logMutex);
+	logChanged = false;
 	UpdateWarningOverlay();
 	if(showLogWindow) {
 		ImVec2 displaySize = ImGui::GetIO().DisplaySize;
@@ -20,8 +20,12 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
+#include <algorithm>
+#include <atomic>
 #include <initializer_list>
+#include <memory>
 
 #include "texview.h"
 #include "version.h"
@@ -30,6 +34,10 @@
 #include "data/texview_icon32.h"
 #include "data/proggyvector_font.h"
 
+#ifdef _WIN32
+	#define strcasecmp _stricmp
+#endif
+
 using namespace texview;
 
 // a wrapper around glVertexAttribPointer() to stay sane
@@ -44,13 +52,8 @@ static GLFWwindow* glfwWindow;
 
 static ImVec4 clear_color(0.45f, 0.55f, 0.60f, 1.00f);
 
-// TODO: should probably support more than one texture eventually..
-static texview::Texture curTex;
-
-static GLuint shaderProgram = 0;
 static GLuint quadsVBO = 0;
 static GLuint quadsVAO = 0;
-static GLint mvpMatrixUniform = 0;
 
 static bool showImGuiDemoWindow = false;
 static bool showAboutWindow = false;
@@ -63,43 +66,132 @@ static bool updateFont;
 static float imguiScale = 1.0f;
 static ImGuiStyle defaultStyle; // to reset style sizes before calling ScaleAllSizes()
 
-static double zoomLevel = 1.0;
-static double transX = 10;
-static double transY = 10;
 static bool dragging = false;
 static ImVec2 lastDragPos;
 
-static bool linearFilter = false;
-static int mipmapLevel = -1; // -1: auto, otherwise enforce that level
-static int overrideSRGB = -1; // -1: auto, 0: force disable, 1: force enable
-static int overrideAlpha = -1; // -1: auto, 0: force disable alpha blending, 1: force enable
-
-static int cubeCrossVariant = 0; // 0-3
-static int textureArrayIndex = 0;
-static std::string texSampleAndNormalize; // used in shader and shown in GLSL (swizzle) editor
-static std::string swizzle; // used in shader, modifiable by user
-// something like "b1ga", transformed to swizzle with SetSwizzleFromSimple()
-static char simpleSwizzle[5] = {};
-static bool useSimpleSwizzle = true;
+// if set, texview only redraws when something changed, otherwise the main loop
+// waits for events, so an idle texview doesn't keep a CPU core and the GPU busy.
+// input callbacks and everything else that changes what's shown call RequestRedraw()
+static bool redrawOnDemand = true;
+static int redrawFrames = 3; // how many frames must still be drawn
+// when something must be redrawn anyway (e.g. for COMPARE_FLICKER), in glfwGetTime() seconds
+static double redrawTime = INFINITY;
+
+// ImGui only reacts to input in the next frame and some things (like the size of
+// auto-resizing windows) take another frame to settle, so by default a few are drawn
+static void RequestRedraw(int numFrames = 3)
+{
+	redrawFrames = std::max(redrawFrames, numFrames);
+}
 
+static void RequestRedrawAt(double time)
+{
+	redrawTime = std::min(redrawTime, time);
+}
 
-static enum ViewMode {
+enum ViewMode {
 	SINGLE,
 	MIPMAPS_COMPACT,
 	MIPMAPS_ROW,
 	MIPMAPS_COLUMN,
 	TILED
-} viewMode;
-static bool viewAtSameSize = true;
-static int spacingBetweenMips = 2;
-static int numTiles[2] = {2, 2};
+};
+
+struct AsyncTextureLoad;
+
+// a texture and all the settings for showing it (including the shader program
+// that's compiled for its type and swizzle), so switching between the textures
+// in the workspace doesn't reset or recompile anything.
+// Several views can share the same Texture, e.g. to look at different channels
+struct TextureView {
+	int id = 0; // unique, for ImGui and for finding the view again
+	std::shared_ptr<texview::Texture> tex = std::make_shared<texview::Texture>();
+
+	// the most recently requested texture for this view, while it's being loaded.
+	// if another texture is requested before it's done, the older one
+	// is moved to prefetchedLoads (see LoadTexture())
+	std::shared_ptr<AsyncTextureLoad> pendingLoad;
+	// the (absolute) path last passed to LoadTexture(), for OpenNeighbourFile()
+	std::string lastRequestedPath;
+
+	GLuint shaderProgram = 0;
+	GLint mvpMatrixUniform = 0;
+	int shaderGeneration = 0; // incremented whenever shaderProgram is replaced
+
+	double zoomLevel = 1.0;
+	double transX = 10;
+	double transY = 10;
+
+	bool linearFilter = false;
+	int mipmapLevel = -1; // -1: auto, otherwise enforce that level
+	int overrideSRGB = -1; // -1: auto, 0: force disable, 1: force enable
+	int overrideAlpha = -1; // -1: auto, 0: force disable alpha blending, 1: force enable
+
+	int cubeCrossVariant = 0; // 0-3
+	int textureArrayIndex = 0;
+	int statsCubeFace = 0; // cubemaps: the face the statistics are calculated for
+	std::string samplerType; // like "sampler2D" or "usampler2DArray", used in shader
+	std::string texSampleAndNormalize; // used in shader and shown in GLSL (swizzle) editor
+	std::string swizzle; // used in shader, modifiable by user
+	// something like "b1ga", transformed to swizzle with SetSwizzleFromSimple()
+	char simpleSwizzle[5] = {};
+	bool useSimpleSwizzle = true;
+
+	ViewMode viewMode = SINGLE;
+	bool viewAtSameSize = true;
+	int spacingBetweenMips = 2;
+	int numTiles[2] = {2, 2};
+
+	TextureView() = default;
+	TextureView(const TextureView&) = delete;
+	~TextureView() {
+		if(shaderProgram != 0) {
+			glDeleteProgram(shaderProgram);
+		}
+	}
+};
+
+// the values (except for COMPARE_OFF) are also used in compareFragShaderMain
+enum CompareMode {
+	COMPARE_OFF,
+	COMPARE_SIDE_BY_SIDE,
+	COMPARE_WIPE,
+	COMPARE_FLICKER,
+	COMPARE_DIFF
+};
+
+// how the difference is shown in COMPARE_DIFF mode, also used in compareFragShaderMain
+enum DiffMode {
+	DIFF_ABS,     // absolute difference per channel
+	DIFF_HEATMAP, // biggest absolute difference of all channels, as heatmap
+	DIFF_SSIM     // 1 - SSIM (of the luma in a 3x3 window), as heatmap
+};
+
+// all the opened textures, shown as tabs in the sidebar
+static struct Workspace {
+	std::vector<std::unique_ptr<TextureView>> views; // never empty (after startup)
+	int current = 0; // index in views
+	int lastViewId = 0;
+	int selectTabId = -1; // set if the tab of a view must be selected because it was changed in code
+
+	// the current view can be compared with another one, see GetCompareView()
+	CompareMode compareMode = COMPARE_OFF;
+	int compareViewId = 0; // id of the view that's compared with the current one
+	float wipePos = 0.5f; // COMPARE_WIPE: the other texture is shown right of this (in texture coordinates)
+	float flickerInterval = 0.5f; // COMPARE_FLICKER: switch between the textures every flickerInterval seconds
+	DiffMode diffMode = DIFF_ABS; // COMPARE_DIFF: how the difference is shown
+	float diffScale = 1.0f; // COMPARE_DIFF: differences are multiplied by this, so small ones become visible
+} workspace;
+
+// the view that's currently shown, workspace.views[workspace.current]
+static TextureView* cur = nullptr;
 
 static void glfw_error_callback(int error, const char* description)
 {
 	errprintf("GLFW Error: %d - %s\n", error, description);
 }
 
-static void ZoomFitToWindow(GLFWwindow* window, float tw, float th, bool isCube)
+static void ZoomFitToWindow(TextureView& view, GLFWwindow* window, float tw, float th, bool isCube)
 {
 	if(isCube) {
 		// shown as cross lying on the side => 4 wide, 3 high
@@ -112,13 +204,13 @@ static void ZoomFitToWindow(GLFWwindow* window, float tw, float th, bool isCube)
 	double zw = winW / tw;
 	double zh = display_h / th;
 	if(zw < zh) {
-		zoomLevel = zw;
-		transX = 0;
-		transY = floor(0.5 * (display_h/zw - th));
+		view.zoomLevel = zw;
+		view.transX = 0;
+		view.transY = floor(0.5 * (display_h/zw - th));
 	} else {
-		zoomLevel = zh;
-		transX = isCube ? 0.0 : floor(0.5 * (winW/zh - tw));
-		transY = 0;
+		view.zoomLevel = zh;
+		view.transX = isCube ? 0.0 : floor(0.5 * (winW/zh - tw));
+		view.transY = 0;
 	}
 }
 
@@ -164,6 +256,358 @@ static const char* fragShaderEnd =  R"(
 }
 )";
 
+// for comparing two textures in one pass, see UpdateCompareShader().
+// position.z selects the texture in side-by-side mode: 0 for texA, 1 for texB
+static const char* compareVertexShaderSrc = R"(
+in vec4 position; // TV_ATTRIB_POSITION
+in vec4 inTexCoord; // TV_ATTRIB_TEXCOORD
+uniform mat4 mvpMatrix;
+
+out vec4 texCoord;
+out float mipLevel;
+out float whichTex;
+void main()
+{
+	gl_Position = mvpMatrix * vec4(position.xy, 0.0, 1.0);
+	texCoord = inTexCoord;
+	mipLevel = position.w;
+	whichTex = position.z;
+}
+)";
+
+// color space conversions for the compare and metrics shaders
+static const char* compareColorFuncs = R"(
+vec3 ToLinear(vec3 c)
+{
+	return mix(c / 12.92, pow((c + 0.055) / 1.055, vec3(2.4)), step(0.04045, c));
+}
+
+vec3 ToSRGB(vec3 c)
+{
+	return mix(c * 12.92, 1.055 * pow(c, vec3(1.0/2.4)) - 0.055, step(0.0031308, c));
+}
+)";
+
+// before this, UpdateCompareShader() adds the sampler uniforms texA and texB
+// and SampleA() and SampleB() functions, made from the views' texSampleAndNormalize and swizzle,
+// and compareColorFuncs
+static const char* compareFragShaderMain = R"(
+in vec4 texCoord;
+in float mipLevel;
+in float whichTex;
+out vec4 OutColor;
+
+uniform int compareMode; // 1: side by side, 2: wipe, 3: flicker, 4: difference (see enum CompareMode)
+uniform float wipePos;
+uniform bool showB; // for flicker
+uniform float mipLevelB; // used instead of mipLevel, unless that's -1 (auto)
+uniform float layerB;
+uniform int convertB; // 1: convert texB's color from sRGB to linear, 2: from linear to sRGB
+uniform int diffMode; // see enum DiffMode
+uniform float diffScale;
+uniform bool diffInSRGB; // compare the sRGB encoded colors (as they're shown)
+uniform vec2 texelSize; // of texA, for DIFF_SSIM
+
+vec4 GetB(vec2 st)
+{
+	vec4 b = SampleB(texB, vec4(st, layerB, 0.0), (mipLevel < 0.0) ? -1.0 : mipLevelB);
+	if(convertB == 1)
+		b.rgb = ToLinear(b.rgb);
+	else if(convertB == 2)
+		b.rgb = ToSRGB(b.rgb);
+	return b;
+}
+
+// colors for values from 0 (blue) to 1 (red)
+vec3 Heatmap(float v)
+{
+	v = clamp(v, 0.0, 1.0);
+	return clamp(vec3(1.5) - abs(4.0 * vec3(v) - vec3(3.0, 2.0, 1.0)), 0.0, 1.0);
+}
+
+float Luma(vec4 c)
+{
+	if(diffInSRGB)
+		c.rgb = ToSRGB(c.rgb);
+	return dot(c.rgb, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// SSIM of the luma in the 3x3 texel window around texCoord
+float LocalSSIM()
+{
+	const float C1 = 0.01 * 0.01;
+	const float C2 = 0.03 * 0.03;
+	float sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+	for(int y = -1; y <= 1; ++y) {
+		for(int x = -1; x <= 1; ++x) {
+			vec4 tc = texCoord;
+			tc.st += vec2(x, y) * texelSize;
+			float la = Luma(SampleA(texA, tc, mipLevel));
+			float lb = Luma(GetB(tc.st));
+			sumA += la;
+			sumB += lb;
+			sumAA += la * la;
+			sumBB += lb * lb;
+			sumAB += la * lb;
+		}
+	}
+	float meanA = sumA / 9.0;
+	float meanB = sumB / 9.0;
+	float varA = max(sumAA / 9.0 - meanA * meanA, 0.0);
+	float varB = max(sumBB / 9.0 - meanB * meanB, 0.0);
+	float covAB = sumAB / 9.0 - meanA * meanB;
+	return ((2.0 * meanA * meanB + C1) * (2.0 * covAB + C2))
+	       / ((meanA * meanA + meanB * meanB + C1) * (varA + varB + C2));
+}
+
+void main()
+{
+	bool useB;
+	if(compareMode == 1)
+		useB = whichTex > 0.5;
+	else if(compareMode == 2)
+		useB = texCoord.s >= wipePos;
+	else
+		useB = showB;
+
+	// always sample both, choosing the mip level needs derivatives
+	// which are undefined in non-uniform control flow
+	vec4 a = SampleA(texA, texCoord, mipLevel);
+	vec4 b = GetB(texCoord.st);
+
+	vec4 c = useB ? b : a;
+	if(compareMode == 4) {
+		if(diffInSRGB) {
+			a.rgb = ToSRGB(a.rgb);
+			b.rgb = ToSRGB(b.rgb);
+		}
+		vec4 d = abs(a - b);
+		if(diffMode == 0)
+			c = vec4(min(d.rgb * diffScale, vec3(1.0)), 1.0);
+		else if(diffMode == 1)
+			c = vec4(Heatmap(max(max(d.r, d.g), max(d.b, d.a)) * diffScale), 1.0);
+		else
+			c = vec4(Heatmap((1.0 - LocalSSIM()) * diffScale), 1.0);
+	} else if(compareMode == 2 && abs(texCoord.s - wipePos) < fwidth(texCoord.s)) {
+		c = vec4(1.0); // the line between the textures
+	}
+	OutColor = c;
+}
+)";
+
+// the error metrics of COMPARE_DIFF are calculated on the GPU (see ComputeDiffMetricsGPU()):
+// first the squared differences of blocks of METRICS_BLOCK_SIZE x METRICS_BLOCK_SIZE texels
+// are summed up into a float texture, that's then reduced further by summing up 4x4 texels
+// at a time, until only one is left
+enum { METRICS_BLOCK_SIZE = 8 };
+
+static const char* metricsVertexShaderSrc = R"(
+in vec4 position; // TV_ATTRIB_POSITION
+void main()
+{
+	gl_Position = vec4(position.xy, 0.0, 1.0);
+}
+)";
+
+// like compareFragShaderMain, this comes after the sample functions and compareColorFuncs
+static const char* metricsFragShaderMain = R"(
+out vec4 OutColor;
+
+uniform vec2 texSize; // size of the mip level in texels
+uniform float lodA;
+uniform float lodB;
+uniform float layerA;
+uniform float layerB;
+uniform int convertB;
+uniform bool inSRGB;
+
+void main()
+{
+	ivec2 base = ivec2(gl_FragCoord.xy) * METRICS_BLOCK_SIZE;
+	vec4 sum = vec4(0.0);
+	for(int y = 0; y < METRICS_BLOCK_SIZE; ++y) {
+		for(int x = 0; x < METRICS_BLOCK_SIZE; ++x) {
+			vec2 t = vec2(base + ivec2(x, y));
+			if(t.x < texSize.x && t.y < texSize.y) {
+				// sampling the texel centers at the exact mip level gives the texels' values,
+				// regardless of the filter
+				vec2 st = (t + 0.5) / texSize;
+				vec4 a = SampleA(texA, vec4(st, layerA, 0.0), lodA);
+				vec4 b = SampleB(texB, vec4(st, layerB, 0.0), lodB);
+				if(convertB == 1)
+					b.rgb = ToLinear(b.rgb);
+				else if(convertB == 2)
+					b.rgb = ToSRGB(b.rgb);
+				if(inSRGB) {
+					a.rgb = ToSRGB(a.rgb);
+					b.rgb = ToSRGB(b.rgb);
+				}
+				vec4 d = a - b;
+				sum += d * d;
+			}
+		}
+	}
+	OutColor = sum;
+}
+)";
+
+static const char* reduceFragShaderSrc = R"(
+out vec4 OutColor;
+uniform sampler2D src;
+uniform ivec2 srcSize; // only that part of src is used
+
+void main()
+{
+	ivec2 base = ivec2(gl_FragCoord.xy) * 4;
+	vec4 sum = vec4(0.0);
+	for(int y = 0; y < 4; ++y) {
+		for(int x = 0; x < 4; ++x) {
+			ivec2 p = base + ivec2(x, y);
+			if(p.x < srcSize.x && p.y < srcSize.y)
+				sum += texelFetch(src, p, 0);
+		}
+	}
+	OutColor = sum;
+}
+)";
+
+// the statistics of the current texture (see ComputeTextureStatsGPU()) are calculated
+// like the error metrics: first the min, max, sum and sum of squares of blocks of
+// STATS_BLOCK_SIZE x STATS_BLOCK_SIZE texels are written to four float textures,
+// which are then reduced 4x4 texels at a time. OpenGL 3.2 has neither compute shaders
+// nor atomic counters, so the histogram is made by drawing one point per texel and
+// channel into a IMAGE_STATS_NUM_BINS x 1 float texture, with additive blending
+enum { STATS_BLOCK_SIZE = 8 };
+
+// comes after the view's sample function SampleA() (without swizzle) and compareColorFuncs
+static const char* statsTexelFuncs = R"(
+uniform ivec2 texSize; // size of the mip level in texels
+uniform float lod;
+uniform float layer;
+uniform int cubeFace; // -1 if it's not a cubemap
+uniform bool encodeSRGB; // the statistics are for the values as stored, not sRGB decoded
+
+vec4 FetchTexel(ivec2 texel)
+{
+	vec2 st = (vec2(texel) + 0.5) / vec2(texSize);
+	vec4 texCoord = vec4(st, layer, 0.0);
+	if(cubeFace >= 0) {
+		// the direction that hits the texel's center, like in AddCubeQuad()
+		vec2 mc = st * 2.0 - 1.0;
+		vec3 dir;
+		if(cubeFace == 0)      dir = vec3( 1.0, -mc.y, -mc.x);
+		else if(cubeFace == 1) dir = vec3(-1.0, -mc.y,  mc.x);
+		else if(cubeFace == 2) dir = vec3( mc.x,  1.0,  mc.y);
+		else if(cubeFace == 3) dir = vec3( mc.x, -1.0, -mc.y);
+		else if(cubeFace == 4) dir = vec3( mc.x, -mc.y,  1.0);
+		else                   dir = vec3(-mc.x, -mc.y, -1.0);
+		texCoord = vec4(dir, layer);
+	}
+	vec4 c = SampleA(texA, texCoord, lod);
+	if(encodeSRGB) {
+		// all sRGB formats have 8 bits per channel, rounding removes
+		// the imprecision of decoding (when sampling) and encoding again
+		c.rgb = floor(ToSRGB(c.rgb) * 255.0 + 0.5) / 255.0;
+	}
+	return c;
+}
+)";
+
+static const char* statsFragShaderMain = R"(
+out vec4 OutStats[4]; // min, max, sum, sum of squares
+
+void main()
+{
+	ivec2 base = ivec2(gl_FragCoord.xy) * STATS_BLOCK_SIZE;
+	vec4 c = FetchTexel(base);
+	vec4 mn = c;
+	vec4 mx = c;
+	vec4 sum = vec4(0.0);
+	vec4 sumSq = vec4(0.0);
+	for(int y = 0; y < STATS_BLOCK_SIZE; ++y) {
+		for(int x = 0; x < STATS_BLOCK_SIZE; ++x) {
+			ivec2 t = base + ivec2(x, y);
+			if(t.x < texSize.x && t.y < texSize.y) {
+				c = FetchTexel(t);
+				mn = min(mn, c);
+				mx = max(mx, c);
+				sum += c;
+				sumSq += c * c;
+			}
+		}
+	}
+	OutStats[0] = mn;
+	OutStats[1] = mx;
+	OutStats[2] = sum;
+	OutStats[3] = sumSq;
+}
+)";
+
+static const char* statsReduceFragShaderSrc = R"(
+out vec4 OutStats[4];
+uniform sampler2D srcMin;
+uniform sampler2D srcMax;
+uniform sampler2D srcSum;
+uniform sampler2D srcSumSq;
+uniform ivec2 srcSize; // only that part of the src textures is used
+
+void main()
+{
+	ivec2 base = ivec2(gl_FragCoord.xy) * 4;
+	vec4 mn = texelFetch(srcMin, base, 0);
+	vec4 mx = texelFetch(srcMax, base, 0);
+	vec4 sum = vec4(0.0);
+	vec4 sumSq = vec4(0.0);
+	for(int y = 0; y < 4; ++y) {
+		for(int x = 0; x < 4; ++x) {
+			ivec2 p = base + ivec2(x, y);
+			if(p.x < srcSize.x && p.y < srcSize.y) {
+				mn = min(mn, texelFetch(srcMin, p, 0));
+				mx = max(mx, texelFetch(srcMax, p, 0));
+				sum += texelFetch(srcSum, p, 0);
+				sumSq += texelFetch(srcSumSq, p, 0);
+			}
+		}
+	}
+	OutStats[0] = mn;
+	OutStats[1] = mx;
+	OutStats[2] = sum;
+	OutStats[3] = sumSq;
+}
+)";
+
+// one point per texel and channel (no vertex attributes, gl_VertexID is used),
+// at the position of its histogram bin. (like texview::CalcImageStats(), NaN goes to bin 0)
+// it's drawn in batches of rows starting at firstRow, so gl_VertexID can't overflow
+static const char* histoVertexShaderMain = R"(
+uniform float histoMin;
+uniform float histoScale; // bins per unit
+uniform int firstRow;
+out vec4 binValue;
+
+void main()
+{
+	int pixel = gl_VertexID / 4;
+	int channel = gl_VertexID - pixel * 4;
+	vec4 c = FetchTexel(ivec2(pixel % texSize.x, firstRow + pixel / texSize.x));
+	float bin = (c[channel] - histoMin) * histoScale;
+	bin = (bin >= 0.0) ? min(floor(bin), NUM_BINS - 1.0) : 0.0;
+	gl_Position = vec4((bin + 0.5) * (2.0 / NUM_BINS) - 1.0, 0.0, 0.0, 1.0);
+	binValue = vec4(0.0);
+	binValue[channel] = 1.0;
+}
+)";
+
+static const char* histoFragShaderSrc = R"(
+in vec4 binValue;
+out vec4 OutColor;
+
+void main()
+{
+	OutColor = binValue;
+}
+)";
+
 static GLuint
 CompileShader(GLenum shaderType, std::initializer_list<const char*> shaderSources)
 {
@@ -275,12 +719,12 @@ CreateShaderProgram(const GLuint shaders[2])
 	return prog;
 }
 
-static void SetSwizzleFromSimple()
+static void SetSwizzleFromSimple(TextureView& view)
 {
-	swizzle.clear();
+	view.swizzle.clear();
 	const char* args[4] = { "0.0", "0.0", "0.0", "1.0" };
 	for(int i=0; i<4; ++i) {
-		char c = simpleSwizzle[i];
+		char c = view.simpleSwizzle[i];
 		if(c >= 'A' && c <= 'Z') {
 			c += 32; // to lowercase
 		}
@@ -313,13 +757,13 @@ static void SetSwizzleFromSimple()
 				i = 4;
 				break;
 			default:
-				errprintf("Invalid character '%c' in swizzle!\n", simpleSwizzle[i]);
+				errprintf("Invalid character '%c' in swizzle!\n", view.simpleSwizzle[i]);
 		}
 	}
-	StringAppendFormatted(swizzle, "c = vec4(%s, %s, %s, %s);\n", args[0], args[1], args[2], args[3]);
+	StringAppendFormatted(view.swizzle, "c = vec4(%s, %s, %s, %s);\n", args[0], args[1], args[2], args[3]);
 }
 
-static bool UpdateShaders()
+static bool UpdateShaders(TextureView& view)
 {
 	const char* glslVersion = "#version 150\n";
 
@@ -330,7 +774,7 @@ static bool UpdateShaders()
 	}
 
 	bool isUnsigned = false;
-	const char* normDiv = curTex.GetIntTexInfo(isUnsigned); // divisor to normalize integer texture
+	const char* normDiv = view.tex->GetIntTexInfo(isUnsigned); // divisor to normalize integer texture
 	bool isIntTexture = normDiv != nullptr;
 
 	std::string glslAdvVersion; // if used, glslVersion will point to it
@@ -342,10 +786,10 @@ static bool UpdateShaders()
 	if(isIntTexture) {
 		typePrefix = isUnsigned ? "u" : "i";
 	}
-	if(curTex.IsCubemap()) {
+	if(view.tex->IsCubemap()) {
 		samplerBaseType = "samplerCube";
 		numTexCoords = 3;
-		if(curTex.IsArray()) {
+		if(view.tex->IsArray()) {
 			// for cubemap arrays, this #extension thingy must be added after the #version
 			// (unless version >= 400)
 			glslAdvVersion = glslVersion;
@@ -353,18 +797,22 @@ static bool UpdateShaders()
 			glslVersion = glslAdvVersion.c_str();
 		}
 	}
-	if(curTex.IsArray()) {
+	if(view.tex->IsArray()) {
 		typePostfix = "Array";
 		numTexCoords++;
 	}
 
+	view.samplerType = typePrefix;
+	view.samplerType += samplerBaseType;
+	view.samplerType += typePostfix;
+
 	char samplerUniform[48] = {};
-	snprintf(samplerUniform, sizeof(samplerUniform), "uniform %s%s%s tex0;\n", typePrefix, samplerBaseType, typePostfix);
+	snprintf(samplerUniform, sizeof(samplerUniform), "uniform %s tex0;\n", view.samplerType.c_str());
 
-	texSampleAndNormalize.clear();
+	view.texSampleAndNormalize.clear();
 
 	if(isIntTexture) {
-		StringAppendFormatted(texSampleAndNormalize, " %svec4 v;\n", typePrefix);
+		StringAppendFormatted(view.texSampleAndNormalize, " %svec4 v;\n", typePrefix);
 		/* ivec4 v; // or uvec4
 		 * if(mipLevel < 0.0)
 		 *     v = texture( tex0, texCoord.st ); // or maybe .stp or .stpq
@@ -374,14 +822,14 @@ static bool UpdateShaders()
 		 * vec4 c = vec4(4) / 127.0; // or other divisor depending on integer type
 		 */
 
-		StringAppendFormatted(texSampleAndNormalize, " if(mipLevel < 0.0)\n"
+		StringAppendFormatted(view.texSampleAndNormalize, " if(mipLevel < 0.0)\n"
 		                "	v = texture(tex0, texCoord.%.*s);\n",
 		                numTexCoords, "stpq");
-		StringAppendFormatted(texSampleAndNormalize, " else\n"
+		StringAppendFormatted(view.texSampleAndNormalize, " else\n"
 		                "	v = textureLod(tex0, texCoord.%.*s, mipLevel);\n",
 		                numTexCoords, "stpq");
 		// integer textures (GL_RGB_INTEGER etc) need normalization to display something useful
-		StringAppendFormatted(texSampleAndNormalize, "\n vec4 c = vec4(v) / %s;\n", normDiv);
+		StringAppendFormatted(view.texSampleAndNormalize, "\n vec4 c = vec4(v) / %s;\n", normDiv);
 	} else {
 		/* vec4 c;
 		 * if(mipLevel < 0.0)
@@ -390,25 +838,25 @@ static bool UpdateShaders()
 		 *     c = textureLod( tex0, texCoord.stp, mipLevel );
 		 */
 		// normal textures don't need normalization, so assign to vec4 c directly
-		StringAppendFormatted(texSampleAndNormalize, " vec4 c;\n");
-		StringAppendFormatted(texSampleAndNormalize, " if(mipLevel < 0.0)\n"
+		StringAppendFormatted(view.texSampleAndNormalize, " vec4 c;\n");
+		StringAppendFormatted(view.texSampleAndNormalize, " if(mipLevel < 0.0)\n"
 		                "	c = texture(tex0, texCoord.%.*s);\n",
 		                numTexCoords, "stpq");
-		StringAppendFormatted(texSampleAndNormalize, " else\n"
+		StringAppendFormatted(view.texSampleAndNormalize, " else\n"
 		                "	c = textureLod(tex0, texCoord.%.*s, mipLevel);\n",
 		                numTexCoords, "stpq");
 	}
 
-	if(useSimpleSwizzle) {
-		SetSwizzleFromSimple();
+	if(view.useSimpleSwizzle) {
+		SetSwizzleFromSimple(view);
 	}
 
 	std::initializer_list<const char*> fragShaderSrc = {
 		glslVersion,
 		samplerUniform,
 		fragShaderStart,
-		texSampleAndNormalize.c_str(),
-		swizzle.c_str(),
+		view.texSampleAndNormalize.c_str(),
+		view.swizzle.c_str(),
 		fragShaderEnd
 	};
 	shaders[1] = CompileShader(GL_FRAGMENT_SHADER, fragShaderSrc );
@@ -426,14 +874,14 @@ static bool UpdateShaders()
 		return false;
 	}
 
-	if(shaderProgram != 0) { // if we already had one and want to replace it
-		glDeleteProgram(shaderProgram);
+	if(view.shaderProgram != 0) { // if we already had one and want to replace it
+		glDeleteProgram(view.shaderProgram);
 	}
 
 	glUseProgram(prog);
 
-	mvpMatrixUniform = glGetUniformLocation(prog, "mvpMatrix");
-	if(mvpMatrixUniform == -1) {
+	view.mvpMatrixUniform = glGetUniformLocation(prog, "mvpMatrix");
+	if(view.mvpMatrixUniform == -1) {
 		errprintf("Can't find mvpMatrix uniform in the shader?!\n");
 		glUseProgram(0);
 		glDeleteProgram(prog);
@@ -446,107 +894,707 @@ static bool UpdateShaders()
 		0, 0, 1, 0,
 		0, 0, 0, 1
 	};
-	glUniformMatrix4fv(mvpMatrixUniform, 1, GL_FALSE, idmat);
+	glUniformMatrix4fv(view.mvpMatrixUniform, 1, GL_FALSE, idmat);
+
+	view.shaderProgram = prog;
+	view.shaderGeneration++;
+
+	return true;
+}
+
+// shader program that shows two textures at once, for comparing them (see DrawCompare())
+static struct CompareShader {
+	GLuint program = 0;
+	// the views and their shaderGeneration it has been created for
+	int viewIds[2] = {};
+	int shaderGens[2] = {};
+
+	GLint mvpMatrixUniform = -1;
+	GLint compareModeUniform = -1;
+	GLint wipePosUniform = -1;
+	GLint showBUniform = -1;
+	GLint mipLevelBUniform = -1;
+	GLint layerBUniform = -1;
+	GLint convertBUniform = -1;
+	GLint diffModeUniform = -1;
+	GLint diffScaleUniform = -1;
+	GLint diffInSRGBUniform = -1;
+	GLint texelSizeUniform = -1;
+
+	// for the error metrics, created together with program (with the same sample functions)
+	GLuint metricsProgram = 0;
+} compareShader;
+
+// sums up 4x4 texels of a float texture, for the error metrics (see ComputeDiffMetricsGPU())
+static GLuint reduceProgram = 0;
+
+// shader programs for the statistics of the current view's texture (see ComputeTextureStatsGPU()),
+// made with the view's sample function like compareShader
+static struct StatsShader {
+	int viewId = 0;
+	int shaderGen = 0;
+	GLuint sumProgram = 0; // min, max and sums of blocks of texels
+	GLuint histoProgram = 0;
+} statsShader;
+
+// reduces the four textures written by statsShader.sumProgram
+static GLuint statsReduceProgram = 0;
+// the histogram points don't have vertex attributes, but OpenGL core needs a VAO anyway
+static GLuint statsVAO = 0;
+
+// appends a function like "vec4 SampleA(sampler2D tex0, vec4 texCoord, float mipLevel)"
+// that samples the texture and swizzles the color like view's own shader does
+static void AppendCompareSampleFunc(std::string& out, const TextureView& view, char which, bool swizzle = true)
+{
+	StringAppendFormatted(out, "uniform %s tex%c;\n", view.samplerType.c_str(), which);
+	StringAppendFormatted(out, "vec4 Sample%c(%s tex0, vec4 texCoord, float mipLevel)\n{\n",
+	                      which, view.samplerType.c_str());
+	out += view.texSampleAndNormalize;
+	if(swizzle) {
+		out += view.swizzle;
+	}
+	out += " return c;\n}\n\n";
+}
+
+// (re)creates compareShader if a or b changed since it has been created,
+// returns false if it couldn't be created
+static bool UpdateCompareShader(const TextureView& a, const TextureView& b)
+{
+	if( compareShader.viewIds[0] == a.id && compareShader.shaderGens[0] == a.shaderGeneration
+	   && compareShader.viewIds[1] == b.id && compareShader.shaderGens[1] == b.shaderGeneration ) {
+		return compareShader.program != 0;
+	}
+	// even if creating it fails, it's only tried again when one of the views' shader changes
+	compareShader.viewIds[0] = a.id;
+	compareShader.shaderGens[0] = a.shaderGeneration;
+	compareShader.viewIds[1] = b.id;
+	compareShader.shaderGens[1] = b.shaderGeneration;
+	if(compareShader.program != 0) {
+		glDeleteProgram(compareShader.program);
+		compareShader.program = 0;
+	}
+	if(compareShader.metricsProgram != 0) {
+		glDeleteProgram(compareShader.metricsProgram);
+		compareShader.metricsProgram = 0;
+	}
+
+	const char* glslVersion = "#version 150\n";
+
+	GLuint shaders[2] = {};
+	shaders[0] = CompileShader(GL_VERTEX_SHADER, { glslVersion, compareVertexShaderSrc });
+	if(shaders[0] == 0) {
+		return false;
+	}
+
+	std::string sampleFuncs;
+	AppendCompareSampleFunc(sampleFuncs, a, 'A');
+	AppendCompareSampleFunc(sampleFuncs, b, 'B');
+	shaders[1] = CompileShader(GL_FRAGMENT_SHADER, { glslVersion, sampleFuncs.c_str(), compareColorFuncs, compareFragShaderMain });
+	if(shaders[1] == 0) {
+		glDeleteShader(shaders[0]);
+		return false;
+	}
+
+	GLuint prog = CreateShaderProgram(shaders);
+	glDeleteShader(shaders[0]);
+	glDeleteShader(shaders[1]);
+	if(prog == 0) {
+		return false;
+	}
+
+	// if this fails, the metrics are calculated on the CPU instead
+	char blockSizeDefine[48];
+	snprintf(blockSizeDefine, sizeof(blockSizeDefine), "#define METRICS_BLOCK_SIZE %d\n", METRICS_BLOCK_SIZE);
+	shaders[0] = CompileShader(GL_VERTEX_SHADER, { glslVersion, metricsVertexShaderSrc });
+	shaders[1] = CompileShader(GL_FRAGMENT_SHADER, { glslVersion, blockSizeDefine, sampleFuncs.c_str(),
+	                                                 compareColorFuncs, metricsFragShaderMain });
+	if(shaders[0] != 0 && shaders[1] != 0) {
+		compareShader.metricsProgram = CreateShaderProgram(shaders);
+		if(compareShader.metricsProgram != 0) {
+			glUseProgram(compareShader.metricsProgram);
+			glUniform1i(glGetUniformLocation(compareShader.metricsProgram, "texA"), 0);
+			glUniform1i(glGetUniformLocation(compareShader.metricsProgram, "texB"), 1);
+		}
+	}
+	glDeleteShader(shaders[0]); // (deleting shader 0 is silently ignored)
+	glDeleteShader(shaders[1]);
 
-	shaderProgram = prog;
+	glUseProgram(prog);
+	glUniform1i(glGetUniformLocation(prog, "texA"), 0);
+	glUniform1i(glGetUniformLocation(prog, "texB"), 1);
+
+	compareShader.mvpMatrixUniform = glGetUniformLocation(prog, "mvpMatrix");
+	compareShader.compareModeUniform = glGetUniformLocation(prog, "compareMode");
+	compareShader.wipePosUniform = glGetUniformLocation(prog, "wipePos");
+	compareShader.showBUniform = glGetUniformLocation(prog, "showB");
+	compareShader.mipLevelBUniform = glGetUniformLocation(prog, "mipLevelB");
+	compareShader.layerBUniform = glGetUniformLocation(prog, "layerB");
+	compareShader.convertBUniform = glGetUniformLocation(prog, "convertB");
+	compareShader.diffModeUniform = glGetUniformLocation(prog, "diffMode");
+	compareShader.diffScaleUniform = glGetUniformLocation(prog, "diffScale");
+	compareShader.diffInSRGBUniform = glGetUniformLocation(prog, "diffInSRGB");
+	compareShader.texelSizeUniform = glGetUniformLocation(prog, "texelSize");
+	if(compareShader.mvpMatrixUniform == -1) {
+		errprintf("Can't find mvpMatrix uniform in the compare shader?!\n");
+		glUseProgram(0);
+		glDeleteProgram(prog);
+		return false;
+	}
 
+	compareShader.program = prog;
 	return true;
 }
 
-static void UpdateTextureFilter(bool bindTex = true)
+// (re)creates statsShader if view changed since it has been created,
+// returns false if it couldn't be created
+static bool UpdateStatsShader(const TextureView& view)
+{
+	if(statsShader.viewId == view.id && statsShader.shaderGen == view.shaderGeneration) {
+		return statsShader.sumProgram != 0 && statsShader.histoProgram != 0;
+	}
+	statsShader.viewId = view.id;
+	statsShader.shaderGen = view.shaderGeneration;
+	if(statsShader.sumProgram != 0) {
+		glDeleteProgram(statsShader.sumProgram);
+		statsShader.sumProgram = 0;
+	}
+	if(statsShader.histoProgram != 0) {
+		glDeleteProgram(statsShader.histoProgram);
+		statsShader.histoProgram = 0;
+	}
+
+	std::string glslVersion = "#version 150\n";
+	if(view.tex->IsCubemap() && view.tex->IsArray()) {
+		glslVersion += "#extension GL_ARB_texture_cube_map_array : enable\n";
+	}
+	char defines[96];
+	snprintf(defines, sizeof(defines), "#define STATS_BLOCK_SIZE %d\n#define NUM_BINS %d.0\n",
+	         STATS_BLOCK_SIZE, texview::IMAGE_STATS_NUM_BINS);
+	// the statistics are for the texture's channels, not the swizzled ones
+	std::string sampleFunc;
+	AppendCompareSampleFunc(sampleFunc, view, 'A', false);
+
+	GLuint shaders[2] = {};
+	shaders[0] = CompileShader(GL_VERTEX_SHADER, { glslVersion.c_str(), metricsVertexShaderSrc });
+	shaders[1] = CompileShader(GL_FRAGMENT_SHADER, { glslVersion.c_str(), defines, sampleFunc.c_str(),
+	                                                 compareColorFuncs, statsTexelFuncs, statsFragShaderMain });
+	if(shaders[0] != 0 && shaders[1] != 0) {
+		statsShader.sumProgram = CreateShaderProgram(shaders);
+	}
+	glDeleteShader(shaders[0]);
+	glDeleteShader(shaders[1]);
+
+	shaders[0] = CompileShader(GL_VERTEX_SHADER, { glslVersion.c_str(), defines, sampleFunc.c_str(),
+	                                               compareColorFuncs, statsTexelFuncs, histoVertexShaderMain });
+	shaders[1] = CompileShader(GL_FRAGMENT_SHADER, { glslVersion.c_str(), histoFragShaderSrc });
+	if(shaders[0] != 0 && shaders[1] != 0) {
+		statsShader.histoProgram = CreateShaderProgram(shaders);
+	}
+	glDeleteShader(shaders[0]);
+	glDeleteShader(shaders[1]);
+
+	for(GLuint prog : { statsShader.sumProgram, statsShader.histoProgram }) {
+		if(prog != 0) {
+			glUseProgram(prog);
+			glUniform1i(glGetUniformLocation(prog, "texA"), 0);
+		}
+	}
+	// OutStats[0..3] must be written to the color attachments 0..3,
+	// it's the only output so that should be the case
+	if(statsShader.sumProgram != 0 && glGetFragDataLocation(statsShader.sumProgram, "OutStats") != 0) {
+		glDeleteProgram(statsShader.sumProgram);
+		statsShader.sumProgram = 0;
+	}
+	return statsShader.sumProgram != 0 && statsShader.histoProgram != 0;
+}
+
+static void UpdateTextureFilter(TextureView& view, bool bindTex = true)
 {
-	GLuint glTex = curTex.glTextureHandle;
-	GLenum target = curTex.glTarget;
+	GLuint glTex = view.tex->glTextureHandle;
+	GLenum target = view.tex->glTarget;
 	if(glTex == 0) {
 		return;
 	}
 	if(bindTex) {
 		glBindTexture(target, glTex);
 	}
-	GLint filter = linearFilter ? GL_LINEAR : GL_NEAREST;
-	if(curTex.GetNumMips() == 1) {
+	GLint filter = view.linearFilter ? GL_LINEAR : GL_NEAREST;
+	if(view.tex->GetNumMips() == 1) {
 		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filter);
 		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filter);
 	} else {
-		GLint mipFilter = linearFilter ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+		GLint mipFilter = view.linearFilter ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
 		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, mipFilter);
 		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filter);
 	}
 }
 
-static void LoadTexture(const char* path)
+// returns pointer to the filename part of path (after the last (back)slash)
+static const char* GetFileNamePart(const char* path)
 {
-	{
-		texview::Texture newTex;
-		if(!newTex.Load(path)) {
-			errprintf("Couldn't load texture '%s'!\n", path);
-			return;
+	const char* fileName = strrchr(path, '/');
+#ifdef _WIN32
+	const char* lastBS = strrchr(path, '\\');
+	if( lastBS != nullptr && (fileName == nullptr || fileName < lastBS) )
+		fileName = lastBS;
+#endif
+	if(fileName == nullptr)
+		fileName = path;
+	else
+		++fileName; // skip (back)slash
+	return fileName;
+}
+
+// a texture that's loaded in a worker thread
+struct AsyncTextureLoad {
+	std::string path;
+	texview::Texture tex;
+	double startTime = 0.0;
+	bool success = false; // only valid once done is true
+	std::atomic<bool> done{false};
+	bool prefetchUploadStarted = false; // see UpdatePrefetch()
+};
+
+// big textures are uploaded progressively (smallest mip level first),
+// at most this many MB per frame (but at least one mip level). 0: all at once
+static int uploadBudgetMB = 64;
+
+static size_t GetUploadBudget()
+{
+	return (uploadBudgetMB > 0) ? size_t(uploadBudgetMB) << 20 : SIZE_MAX;
+}
+
+// textures of the files next to the current one in its directory, loaded
+// (and uploaded) in the background so stepping through the directory
+// with OpenNeighbourFile() is instant. The previously shown texture is
+// also kept here, as long as it's one of the neighbours.
+static std::vector<std::shared_ptr<AsyncTextureLoad>> prefetchedLoads;
+static int prefetchNumFiles = 2; // in each direction
+// how much memory the prefetched textures may use, on the GPU (and about the same in RAM)
+static int prefetchBudgetMB = 1024;
+
+// images without mipmaps (like PNGs or JPGs) get them generated on the CPU
+// when they're loaded, so the mipmap views and the mip level slider work for them
+static bool generateMipmaps = true;
+static int mipmapFilter = texview::MF_BOX;
+static bool mipmapsAssumeSRGB = true; // filter 8bit RGB(A) images in linear light
+static int maxTextureSize = 0; // GL_MAX_TEXTURE_SIZE
+
+static std::shared_ptr<AsyncTextureLoad> StartAsyncTextureLoad(const char* path)
+{
+	std::shared_ptr<AsyncTextureLoad> load = std::make_shared<AsyncTextureLoad>();
+	load->path = path;
+	load->startTime = glfwGetTime();
+	const bool genMips = generateMipmaps;
+	const texview::MipFilter mipFilter = (texview::MipFilter)mipmapFilter;
+	const bool assumeSRGB = mipmapsAssumeSRGB;
+
+	// Texture::Load() (parsing, decoding and transcoding the file) can take
+	// several seconds for big textures, so it's done in a worker thread and
+	// the UI keeps rendering the previous texture in the meantime.
+	// The OpenGL part happens in SetViewTexture() in the main thread.
+	texview::ThreadPoolAddJob([load, genMips, mipFilter, assumeSRGB]() {
+		load->success = load->tex.Load(load->path.c_str());
+		if(load->success) {
+			// if the GPU doesn't support the format, decoding it in software
+			// is better done here than in the main thread
+			load->tex.SoftwareDecodeIfUnsupported();
+			if(genMips) {
+				load->tex.GenerateMipmaps(mipFilter, assumeSRGB, maxTextureSize);
+			}
 		}
+		load->done.store(true, std::memory_order_release);
+	});
+	return load;
+}
 
-		curTex = std::move(newTex);
-	}
+static void UpdateWindowTitle()
+{
 	// set windowtitle to filename (not entire path)
-	{
-		const char* fileName = strrchr(path, '/');
-#ifdef _WIN32
-		const char* lastBS = strrchr(path, '\\');
-		if( lastBS != nullptr && (fileName == nullptr || fileName < lastBS) )
-			fileName = lastBS;
-#endif
-		if(fileName == nullptr)
-			fileName = path;
-		else
-			++fileName; // skip (back)slash
+	char winTitle[256];
+	if(cur->tex->name.empty()) {
+		snprintf(winTitle, sizeof(winTitle), "Texture Viewer");
+	} else {
+		snprintf(winTitle, sizeof(winTitle), "Texture Viewer - %s", GetFileNamePart(cur->tex->name.c_str()));
+	}
+	glfwSetWindowTitle(glfwWindow, winTitle);
+}
 
-		char winTitle[256];
-		snprintf(winTitle, sizeof(winTitle), "Texture Viewer - %s", fileName);
+// returns the texture if path is already open in any view, otherwise NULL
+static std::shared_ptr<texview::Texture> FindOpenTexture(const std::string& path)
+{
+	for(const std::unique_ptr<TextureView>& view : workspace.views) {
+		if(view->tex->name == path) {
+			return view->tex;
+		}
+	}
+	return nullptr;
+}
 
-		glfwSetWindowTitle(glfwWindow, winTitle);
+// sets view's texture to tex (that has just been loaded or is already open in another view)
+// and resets the settings that depend on the texture
+static void SetViewTexture(TextureView& view, std::shared_ptr<texview::Texture> tex)
+{
+	if(!view.tex->name.empty() && view.tex.use_count() == 1) {
+		// no other view uses the old one, keep it around in case the user goes back to it
+		std::shared_ptr<AsyncTextureLoad> old = std::make_shared<AsyncTextureLoad>();
+		old->path = view.tex->name;
+		old->tex = std::move(*view.tex);
+		old->success = true;
+		old->done.store(true, std::memory_order_relaxed);
+		old->prefetchUploadStarted = true;
+		prefetchedLoads.push_back(std::move(old));
+	}
+	view.tex = std::move(tex);
+	texview::Texture& t = *view.tex;
+	if(&view == cur) {
+		UpdateWindowTitle();
 	}
 
-	curTex.CreateOpenGLtexture();
-	int numMips = curTex.GetNumMips();
+	if(!t.HasGLTexture()) {
+		t.CreateOpenGLtexture(GetUploadBudget());
+	} else {
+		// it has been (at least partly) uploaded by UpdatePrefetch() or for another view already
+		glBindTexture(t.glTarget, t.glTextureHandle);
+	}
+	int numMips = t.GetNumMips();
 
-	UpdateTextureFilter(false);
+	UpdateTextureFilter(view, false);
 	if(numMips > 1) {
-		if(mipmapLevel != -1) {
+		if(view.mipmapLevel != -1) {
 			// if it's set to auto, keep it at auto, otherwise default to 0
-			mipmapLevel = 0;
+			view.mipmapLevel = 0;
+		}
+		// (the tiles of tiled textures have their own levels, see Texture::UploadTile())
+		if(t.glTextureHandle != 0) {
+			int maxLevel = t.GetNumMips() - 1;
+			// if not all levels have been uploaded yet, start with the finest available one
+			glTexParameteri(t.glTarget, GL_TEXTURE_BASE_LEVEL, t.GetFinestUploadedMip());
+			glTexParameteri(t.glTarget, GL_TEXTURE_MAX_LEVEL, maxLevel);
 		}
-		int maxLevel = curTex.GetNumMips() - 1;
-		glTexParameteri(curTex.glTarget, GL_TEXTURE_BASE_LEVEL, 0);
-		glTexParameteri(curTex.glTarget, GL_TEXTURE_MAX_LEVEL, maxLevel);
 	}
 
-	if(curTex.IsCubemap()) {
+	if(t.IsCubemap()) {
 		float w, h;
-		curTex.GetSize(&w, &h);
-		ZoomFitToWindow(glfwWindow, w, h, true);
-		spacingBetweenMips = 0;
+		t.GetSize(&w, &h);
+		ZoomFitToWindow(view, glfwWindow, w, h, true);
+		view.spacingBetweenMips = 0;
 	} else {
-		spacingBetweenMips = 2;
+		view.spacingBetweenMips = 2;
 	}
 
-	textureArrayIndex = 0;
+	view.textureArrayIndex = 0;
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 
-	if(curTex.defaultSwizzle != nullptr) {
-		strncpy(simpleSwizzle, curTex.defaultSwizzle, 4);
-		simpleSwizzle[4] = '\0';
+	if(t.defaultSwizzle != nullptr) {
+		strncpy(view.simpleSwizzle, t.defaultSwizzle, 4);
+		view.simpleSwizzle[4] = '\0';
 	} else {
-		if(curTex.textureFlags & texview::TF_HAS_ALPHA) {
-			strncpy(simpleSwizzle, "rgba", 5);
+		if(t.textureFlags & texview::TF_HAS_ALPHA) {
+			strncpy(view.simpleSwizzle, "rgba", 5);
 		} else {
-			strncpy(simpleSwizzle, "rgb1", 5);
+			strncpy(view.simpleSwizzle, "rgb1", 5);
 		}
 	}
-	useSimpleSwizzle = true;
-	swizzle.clear();
+	view.useSimpleSwizzle = true;
+	view.swizzle.clear();
 
-	UpdateShaders();
+	UpdateShaders(view);
+}
+
+// loads the texture at path into the current view
+static void LoadTexture(const char* path)
+{
+	// the texture's name, the prefetched loads and the directory navigation
+	// all use absolute paths, so relative ones (like from the commandline) must be
+	// converted, otherwise they wouldn't match
+	std::string absPath = texview::ToAbsolutePath(path);
+	path = absPath.c_str();
+	TextureView& view = *cur;
+	view.lastRequestedPath = absPath;
+	if(view.pendingLoad != nullptr) {
+		// when quickly stepping through files, the skipped ones might still
+		// be useful (if they're neighbours of the new one, see UpdatePrefetch())
+		prefetchedLoads.push_back(std::move(view.pendingLoad));
+	}
+	// if it's already open in another view, just use the same texture, unless
+	// the file has changed since then (opening the file that's shown in this view
+	// again reloads it though)
+	uint64_t fileSize = 0;
+	int64_t modTime = 0;
+	if(texview::GetFileSizeAndModTime(path, &fileSize, &modTime)) {
+		std::shared_ptr<texview::Texture> tex = FindOpenTexture(absPath);
+		if(tex != nullptr && tex != view.tex
+		   && tex->fileSize == fileSize && tex->fileModTime == modTime) {
+			SetViewTexture(view, std::move(tex));
+			return;
+		}
+	}
+	// if it has been prefetched, it's already loaded (or at least being loaded),
+	// CheckPendingTextureLoads() takes care of the rest once it's done
+	for(size_t i = 0; i < prefetchedLoads.size(); ++i) {
+		if(prefetchedLoads[i]->path == path) {
+			view.pendingLoad = std::move(prefetchedLoads[i]);
+			prefetchedLoads.erase(prefetchedLoads.begin() + i);
+			return;
+		}
+	}
+	view.pendingLoad = StartAsyncTextureLoad(path);
+}
+
+// called once per frame, finishes the loads of all views
+// once the textures have been loaded by the worker threads
+static void CheckPendingTextureLoads()
+{
+	for(std::unique_ptr<TextureView>& view : workspace.views) {
+		if(view->pendingLoad == nullptr || !view->pendingLoad->done.load(std::memory_order_acquire)) {
+			continue;
+		}
+		std::shared_ptr<AsyncTextureLoad> load = std::move(view->pendingLoad);
+		view->pendingLoad = nullptr;
+		if(!load->success) {
+			errprintf("Couldn't load texture '%s'!\n", load->path.c_str());
+			continue;
+		}
+		SetViewTexture(*view, std::make_shared<texview::Texture>(std::move(load->tex)));
+	}
+}
+
+static TextureView* AddView()
+{
+	std::unique_ptr<TextureView> view(new TextureView);
+	view->id = ++workspace.lastViewId;
+	workspace.views.push_back(std::move(view));
+	return workspace.views.back().get();
+}
+
+static void SelectView(int idx)
+{
+	workspace.current = idx;
+	cur = workspace.views[idx].get();
+	workspace.selectTabId = cur->id;
+	UpdateWindowTitle();
+}
+
+static void CloseView(int idx)
+{
+	TextureView* view = workspace.views[idx].get();
+	if(view->pendingLoad != nullptr) {
+		// might still be useful for the other views
+		prefetchedLoads.push_back(std::move(view->pendingLoad));
+	}
+	workspace.views.erase(workspace.views.begin() + idx);
+	if(workspace.views.empty()) {
+		AddView();
+	}
+	int current = workspace.current;
+	if(current > idx || current >= (int)workspace.views.size()) {
+		--current;
+	}
+	SelectView(std::max(current, 0));
+}
+
+static TextureView* FindView(int id)
+{
+	for(std::unique_ptr<TextureView>& view : workspace.views) {
+		if(view->id == id) {
+			return view.get();
+		}
+	}
+	return nullptr;
+}
+
+static int GetViewIndex(const TextureView* view)
+{
+	for(int i = 0; i < (int)workspace.views.size(); ++i) {
+		if(workspace.views[i].get() == view) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// returns the name shown for the view in the UI
+static const char* GetViewName(const TextureView& view)
+{
+	return view.tex->name.empty() ? "(empty)" : GetFileNamePart(view.tex->name.c_str());
+}
+
+// returns the view the current one is compared with, or NULL if not comparing
+// (or if the textures can't be compared: cubemaps aren't supported and both
+//  must have been uploaded at least partly)
+static TextureView* GetCompareView()
+{
+	if(workspace.compareMode == COMPARE_OFF) {
+		return nullptr;
+	}
+	TextureView* other = FindView(workspace.compareViewId);
+	if(other == nullptr || other == cur) {
+		return nullptr;
+	}
+	for(const texview::Texture* tex : { cur->tex.get(), other->tex.get() }) {
+		if(tex->glTextureHandle == 0 || tex->IsCubemap()) {
+			return nullptr;
+		}
+	}
+	return other;
+}
+
+// the names of the texture files in navDir, see GetNavIndex()
+static std::string navDir;
+static std::vector<std::string> navFiles;
+
+// lists the directory of path if it's not the one that has been listed before
+// (or relist is set), returns the index of path's file in navFiles (or -1)
+static int GetNavIndex(const std::string& path, bool relist = false)
+{
+	const char* fileName = GetFileNamePart(path.c_str());
+	std::string dir(path.c_str(), fileName - path.c_str()); // with trailing (back)slash
+	if(relist || dir != navDir) {
+		navDir = dir;
+		texview::ListTextureFiles(dir.empty() ? "." : dir.c_str(), navFiles);
+	}
+	// navFiles is sorted case-insensitively, so look for the first match ignoring case
+	// and then for one that's identical (there can be several on case-sensitive filesystems)
+	auto it = std::lower_bound(navFiles.begin(), navFiles.end(), fileName,
+		[](const std::string& a, const char* b) -> bool { return strcasecmp(a.c_str(), b) < 0; });
+	for( ; it != navFiles.end() && strcasecmp(it->c_str(), fileName) == 0; ++it) {
+		if(*it == fileName) {
+			return int(it - navFiles.begin());
+		}
+	}
+	return -1;
+}
+
+// opens the file offset positions after (or before, if negative) the last
+// requested one in the same directory, wrapping around at the end
+static void OpenNeighbourFile(int offset)
+{
+	if(cur->lastRequestedPath.empty()) {
+		return;
+	}
+	int idx = GetNavIndex(cur->lastRequestedPath);
+	if(idx < 0) {
+		// maybe the file is new, list the directory again
+		idx = GetNavIndex(cur->lastRequestedPath, true);
+		if(idx < 0) {
+			return;
+		}
+	}
+	int numFiles = (int)navFiles.size();
+	int newIdx = ((idx + offset) % numFiles + numFiles) % numFiles;
+	if(newIdx != idx) {
+		LoadTexture((navDir + navFiles[newIdx]).c_str());
+	}
+}
+
+// paths of neighbours that didn't fit into the prefetch budget, so they're
+// not loaded again and again (until another texture is shown)
+static std::vector<std::string> prefetchTooBig;
+static std::string prefetchCenter;
+
+// called once per frame: starts loading the neighbours of the current texture
+// (one at a time, nearest first), uploads them progressively (when the current
+// texture isn't being uploaded) and frees those that aren't needed anymore
+static void UpdatePrefetch()
+{
+	if(cur->pendingLoad != nullptr) {
+		return; // the texture that's being loaded has priority (and will be the new center)
+	}
+	if(prefetchCenter != cur->tex->name) {
+		prefetchCenter = cur->tex->name;
+		prefetchTooBig.clear();
+	}
+	std::vector<std::string> wanted; // the paths of the neighbours, most important first
+	int idx = cur->tex->name.empty() ? -1 : GetNavIndex(cur->tex->name);
+	if(idx >= 0) {
+		int numFiles = (int)navFiles.size();
+		for(int i = 1; i <= prefetchNumFiles && i < numFiles; ++i) {
+			// the next file first, that's the most likely one to be opened
+			for(int dir : {1, -1}) {
+				std::string path = navDir + navFiles[((idx + dir * i) % numFiles + numFiles) % numFiles];
+				// (no need to prefetch textures that are open in a view anyway)
+				if(FindOpenTexture(path) == nullptr && std::find(wanted.begin(), wanted.end(), path) == wanted.end()
+				   && std::find(prefetchTooBig.begin(), prefetchTooBig.end(), path) == prefetchTooBig.end()) {
+					wanted.push_back(std::move(path));
+				}
+			}
+		}
+	}
+
+	// put the prefetched textures in the order of wanted, the others are freed
+	std::vector<std::shared_ptr<AsyncTextureLoad>> loads;
+	size_t budget = size_t(prefetchBudgetMB) << 20;
+	size_t usedBytes = 0;
+	bool isLoading = false;
+	for(const std::string& path : wanted) {
+		std::shared_ptr<AsyncTextureLoad> load;
+		for(std::shared_ptr<AsyncTextureLoad>& l : prefetchedLoads) {
+			if(l != nullptr && l->path == path) {
+				load = std::move(l);
+				break;
+			}
+		}
+		if(load == nullptr) {
+			// only load one file at a time, so the others (and thumbnails) still get a thread
+			if(!isLoading && usedBytes < budget) {
+				loads.push_back(StartAsyncTextureLoad(path.c_str()));
+				isLoading = true;
+			}
+		} else if(!load->done.load(std::memory_order_acquire)) {
+			isLoading = true;
+			loads.push_back(std::move(load));
+		} else if(load->success) {
+			size_t size = load->tex.GetDataSize();
+			if(usedBytes + size > budget) {
+				prefetchTooBig.push_back(path);
+			} else {
+				usedBytes += size;
+				loads.push_back(std::move(load));
+			}
+		} else {
+			// keep it so it's not loaded again, opening it will show the error
+			loads.push_back(std::move(load));
+		}
+	}
+	prefetchedLoads.swap(loads);
+
+	// upload one texture at a time, progressively like the ones of the views
+	// (which have priority)
+	for(const std::unique_ptr<TextureView>& view : workspace.views) {
+		if(view->tex->IsUploadPending()) {
+			return;
+		}
+	}
+	for(std::shared_ptr<AsyncTextureLoad>& load : prefetchedLoads) {
+		if(!load->done.load(std::memory_order_acquire) || !load->success) {
+			continue;
+		}
+		texview::Texture& tex = load->tex;
+		if(!load->prefetchUploadStarted) {
+			// if this fails it's tried again by SetViewTexture(), when the user opens it
+			load->prefetchUploadStarted = true;
+			tex.CreateOpenGLtexture(GetUploadBudget());
+			break;
+		} else if(tex.IsUploadPending()) {
+			tex.ContinueUpload(GetUploadBudget());
+			break;
+		}
+	}
+}
+
+static size_t GetPrefetchedBytes()
+{
+	size_t ret = 0;
+	for(const std::shared_ptr<AsyncTextureLoad>& load : prefetchedLoads) {
+		if(load->done.load(std::memory_order_acquire) && load->success) {
+			ret += load->tex.GetDataSize();
+		}
+	}
+	return ret;
 }
 
 struct vec4 {
@@ -566,18 +1614,14 @@ struct VertexData {
 
 static std::vector<VertexData> drawData;
 
-// mipLevel -1 == use configured mipmapLevel
-static void AddQuad(texview::Texture& texture, int mipLevel, int arrayIndex, ImVec2 pos, ImVec2 size, ImVec2 texCoordMax = ImVec2(1, 1))
-{
-	ImVec2 texCoordMin = ImVec2(0, 0);
-
-	if(mipLevel < 0) {
-		mipLevel = mipmapLevel;
-	}
-
-	float lod = std::min(mipLevel, texture.GetNumMips() - 1);
-	float idx = arrayIndex;
+// the part of the coordinate space of the quads that's visible in the window,
+// updated by GenericFrame(), for culling the tiles of tiled textures
+static ImVec2 visibleMin;
+static ImVec2 visibleMax;
 
+static void AddQuadVertices(ImVec2 pos, ImVec2 size, ImVec2 texCoordMax, float lod, float idx,
+                            ImVec2 texCoordMin = ImVec2(0, 0))
+{
 	// vertices of the quad
 	VertexData v1 = {
 		{ pos.x, pos.y, 0.0f, lod },
@@ -606,6 +1650,139 @@ static void AddQuad(texview::Texture& texture, int mipLevel, int arrayIndex, ImV
 	drawData.push_back(v4);
 }
 
+static void DrawQuads();
+
+// for textures that are shown through a pyramid (see texview::Texture::pyramid)
+// the tiles of the level that matches the zoom are drawn, like in DrawTiledQuad()
+static void DrawPyramidQuad(texview::Texture& texture, ImVec2 pos, ImVec2 size, ImVec2 texCoordMax)
+{
+	float texW, texH;
+	texture.GetSize(&texW, &texH);
+	ImVec2 repSize(size.x / texCoordMax.x, size.y / texCoordMax.y);
+	ImVec2 quadEnd(pos.x + size.x, pos.y + size.y);
+	int numRepX = (int)ceilf(texCoordMax.x);
+	int numRepY = (int)ceilf(texCoordMax.y);
+	float texelsPerPixel = texW / (repSize.x * cur->zoomLevel);
+
+	// the tiles have their own mipmaps, the GPU chooses between the finest two
+	GLint filter = cur->linearFilter ? GL_LINEAR : GL_NEAREST;
+	GLint minFilter = cur->linearFilter ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+
+	static std::vector<texview::Texture::PyramidTile> tiles;
+	for(int ry = 0; ry < numRepY; ++ry) {
+		for(int rx = 0; rx < numRepX; ++rx) {
+			ImVec2 repPos(pos.x + rx * repSize.x, pos.y + ry * repSize.y);
+			// the part of the texture that's visible in this repetition, in texels
+			// (the last repetition might only be partly shown)
+			ImVec2 endPos(std::min(visibleMax.x, quadEnd.x), std::min(visibleMax.y, quadEnd.y));
+			float x0 = (visibleMin.x - repPos.x) / repSize.x * texW;
+			float y0 = (visibleMin.y - repPos.y) / repSize.y * texH;
+			float x1 = (endPos.x - repPos.x) / repSize.x * texW;
+			float y1 = (endPos.y - repPos.y) / repSize.y * texH;
+			float maxX = (quadEnd.x - repPos.x) / repSize.x * texW;
+			float maxY = (quadEnd.y - repPos.y) / repSize.y * texH;
+			if(!texture.GetPyramidTiles(x0, y0, x1, y1, texelsPerPixel, GetUploadBudget(), tiles)) {
+				RequestRedraw(1); // to draw the missing tiles once they're uploaded
+			}
+			for(texview::Texture::PyramidTile& tile : tiles) {
+				// cut off what's beyond the end of the quad
+				if(tile.x1 > maxX) {
+					tile.tcMaxX = tile.tcMinX + (tile.tcMaxX - tile.tcMinX) * (maxX - tile.x0) / (tile.x1 - tile.x0);
+					tile.x1 = maxX;
+				}
+				if(tile.y1 > maxY) {
+					tile.tcMaxY = tile.tcMinY + (tile.tcMaxY - tile.tcMinY) * (maxY - tile.y0) / (tile.y1 - tile.y0);
+					tile.y1 = maxY;
+				}
+				if(tile.x1 <= tile.x0 || tile.y1 <= tile.y0) {
+					continue;
+				}
+				glBindTexture(GL_TEXTURE_2D, tile.glTextureHandle);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+				ImVec2 tilePos(repPos.x + (tile.x0 / texW) * repSize.x, repPos.y + (tile.y0 / texH) * repSize.y);
+				ImVec2 tileSize(((tile.x1 - tile.x0) / texW) * repSize.x, ((tile.y1 - tile.y0) / texH) * repSize.y);
+				AddQuadVertices(tilePos, tileSize, ImVec2(tile.tcMaxX, tile.tcMaxY), -1.0f, 0.0f,
+				                ImVec2(tile.tcMinX, tile.tcMinY));
+				DrawQuads();
+			}
+		}
+	}
+}
+
+// textures that are too big for OpenGL are split into tiles that are separate
+// OpenGL textures (see texview::Texture::glTiles), so this draws the quad
+// right away, with one draw call for each tile that's visible
+static void DrawTiledQuad(texview::Texture& texture, float lod, ImVec2 pos, ImVec2 size, ImVec2 texCoordMax)
+{
+	if(texture.IsPyramid()) {
+		// the level is chosen automatically, from the zoom
+		DrawPyramidQuad(texture, pos, size, texCoordMax);
+		return;
+	}
+	float texW, texH;
+	texture.GetSize(&texW, &texH);
+	// in TILED view mode the texture is repeated texCoordMax times
+	ImVec2 repSize(size.x / texCoordMax.x, size.y / texCoordMax.y);
+	ImVec2 quadEnd(pos.x + size.x, pos.y + size.y);
+	int numRepX = (int)ceilf(texCoordMax.x);
+	int numRepY = (int)ceilf(texCoordMax.y);
+
+	// tiles can be uploaded after the filter has been set in UpdateTextureFilter(),
+	// so it's set here for each of them
+	GLint filter = cur->linearFilter ? GL_LINEAR : GL_NEAREST;
+	GLint minFilter = filter;
+	if(texture.numTileMips > 1) {
+		minFilter = cur->linearFilter ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+	}
+
+	for(int ry = 0; ry < numRepY; ++ry) {
+		for(int rx = 0; rx < numRepX; ++rx) {
+			ImVec2 repPos(pos.x + rx * repSize.x, pos.y + ry * repSize.y);
+			for(const texview::Texture::GLTile& tile : texture.glTiles) {
+				if(tile.glTextureHandle == 0) {
+					continue; // not uploaded yet
+				}
+				ImVec2 tilePos(repPos.x + (tile.x / texW) * repSize.x, repPos.y + (tile.y / texH) * repSize.y);
+				ImVec2 tileSize((tile.width / texW) * repSize.x, (tile.height / texH) * repSize.y);
+				// the last repetition might only be partly shown
+				ImVec2 shownSize(std::min(tileSize.x, quadEnd.x - tilePos.x), std::min(tileSize.y, quadEnd.y - tilePos.y));
+				if(shownSize.x <= 0.0f || shownSize.y <= 0.0f
+				   || tilePos.x + shownSize.x < visibleMin.x || tilePos.x > visibleMax.x
+				   || tilePos.y + shownSize.y < visibleMin.y || tilePos.y > visibleMax.y) {
+					continue;
+				}
+				glBindTexture(GL_TEXTURE_2D, tile.glTextureHandle);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+				ImVec2 tcMax(shownSize.x / tileSize.x, shownSize.y / tileSize.y);
+				AddQuadVertices(tilePos, shownSize, tcMax, lod, 0.0f);
+				DrawQuads();
+			}
+		}
+	}
+}
+
+// mipLevel -1 == use configured mipmapLevel
+static void AddQuad(texview::Texture& texture, int mipLevel, int arrayIndex, ImVec2 pos, ImVec2 size, ImVec2 texCoordMax = ImVec2(1, 1))
+{
+	if(mipLevel < 0) {
+		mipLevel = cur->mipmapLevel;
+	}
+
+	float lod = std::min(mipLevel, texture.GetNumMips() - 1);
+	if(lod >= 0.0f) {
+		// textureLod() is relative to GL_TEXTURE_BASE_LEVEL, which is > 0
+		// while the finer levels are still being uploaded
+		lod = std::max(lod - texture.GetFinestUploadedMip(), 0.0f);
+	}
+	if(texture.IsTiled()) {
+		DrawTiledQuad(texture, lod, pos, size, texCoordMax);
+	} else {
+		AddQuadVertices(pos, size, texCoordMax, lod, arrayIndex);
+	}
+}
+
 enum CubeFaceIndex {
 	FI_XPOS = 0,
 	FI_XNEG = 1,
@@ -662,8 +1839,8 @@ static void AddCubeQuad(texview::Texture& texture, int mipLevel, int faceIndex,
 		mc.w = arrayIndex;
 	}
 
-	if(cubeCrossVariant > 0 && (faceIndex == FI_YPOS || faceIndex == FI_YNEG)) {
-		int rotationSteps = (faceIndex == FI_YPOS) ? cubeCrossVariant : (4 - cubeCrossVariant);
+	if(cur->cubeCrossVariant > 0 && (faceIndex == FI_YPOS || faceIndex == FI_YNEG)) {
+		int rotationSteps = (faceIndex == FI_YPOS) ? cur->cubeCrossVariant : (4 - cur->cubeCrossVariant);
 		vec4 mapCoordsCopy[4];
 		for(int i=0; i<4; ++i) {
 			mapCoordsCopy[i] = mapCoords[ (i+rotationSteps) % 4 ];
@@ -672,10 +1849,15 @@ static void AddCubeQuad(texview::Texture& texture, int mipLevel, int faceIndex,
 	}
 
 	if(mipLevel < 0) {
-		mipLevel = mipmapLevel;
+		mipLevel = cur->mipmapLevel;
 	}
 
 	float lod = std::min(mipLevel, texture.GetNumMips() - 1);
+	if(lod >= 0.0f) {
+		// textureLod() is relative to GL_TEXTURE_BASE_LEVEL, which is > 0
+		// while the finer levels are still being uploaded
+		lod = std::max(lod - texture.GetFinestUploadedMip(), 0.0f);
+	}
 
 	// vertices of the quad
 	VertexData v1 = {
@@ -717,41 +1899,53 @@ static void DrawQuads()
 	drawData.clear();
 }
 
+static bool ViewUsesAlphaBlend(const TextureView& view)
+{
+	if(view.overrideAlpha != -1)
+		return view.overrideAlpha;
+	return (view.tex->textureFlags & texview::TF_HAS_ALPHA) != 0;
+}
+
+// this whole SRGB thing confuses me.. if the gl texture has an SRGB format
+// (like GL_SRGB_ALPHA), it must have GL_FRAMEBUFFER_SRGB enabled for drawing.
+// if it has a non-SRGB format (even if using the exact same pixeldata
+// e.g. from stb_image!) it must have GL_FRAMEBUFFER_SRGB disabled.
+// no idea what sense that's supposed to make (if all the information is in
+// the texture, why is there no magic to always make it look correct?),
+// but maybe it makes a difference when writing shaders?
+static bool ViewUsesSRGB(const TextureView& view)
+{
+	if(view.overrideSRGB != -1)
+		return view.overrideSRGB;
+	return (view.tex->textureFlags & texview::TF_SRGB) != 0;
+}
+
 static void DrawTexture()
 {
-	texview::Texture& tex = curTex;
+	texview::Texture& tex = *cur->tex;
 
 	GLuint gltex = tex.glTextureHandle;
-	if(!gltex) {
+	if(!tex.HasGLTexture()) {
 		return;
 	}
 
-	bool enableAlphaBlend = (tex.textureFlags & texview::TF_HAS_ALPHA) != 0;
-	if(overrideAlpha != -1)
-		enableAlphaBlend = overrideAlpha;
-	if(enableAlphaBlend)
+	if(ViewUsesAlphaBlend(*cur))
 		glEnable(GL_BLEND);
 	else
 		glDisable(GL_BLEND);
 
-	int arrayIndex = textureArrayIndex;
-
-	// this whole SRGB thing confuses me.. if the gl texture has an SRGB format
-	// (like GL_SRGB_ALPHA), it must have GL_FRAMEBUFFER_SRGB enabled for drawing.
-	// if it has a non-SRGB format (even if using the exact same pixeldata
-	// e.g. from stb_image!) it must have GL_FRAMEBUFFER_SRGB disabled.
-	// no idea what sense that's supposed to make (if all the information is in
-	// the texture, why is there no magic to always make it look correct?),
-	// but maybe it makes a difference when writing shaders?
-	bool enableSRGB = (tex.textureFlags & texview::TF_SRGB) != 0;
-	if(overrideSRGB != -1)
-		enableSRGB = overrideSRGB;
-	if(enableSRGB)
+	int arrayIndex = cur->textureArrayIndex;
+
+	if(ViewUsesSRGB(*cur))
 		glEnable( GL_FRAMEBUFFER_SRGB );
 	else
 		glDisable( GL_FRAMEBUFFER_SRGB );
 
 	glBindTexture(tex.glTarget, gltex);
+	if(cur->tex.use_count() > 1) {
+		// the filter is part of the texture object, which is shared with another view
+		UpdateTextureFilter(*cur, false);
+	}
 
 	float texW, texH;
 	tex.GetSize(&texW, &texH);
@@ -764,7 +1958,7 @@ static void DrawTexture()
 		// extra feature of this texture viewer: cycle the middle ones (e.g. Z+, X+, Z+, X-)
 		// and rotate the upper/lower ones accordingly
 
-		const float offset = texW + spacingBetweenMips; // texW = texH
+		const float offset = texW + cur->spacingBetweenMips; // texW = texH
 		float posX = offset;
 		float posY = 0.0f;
 		const ImVec2 size(texW, texH);
@@ -773,7 +1967,7 @@ static void DrawTexture()
 		posX = 0.0f;
 		posY += offset;
 		const int middleIndices[4] = { FI_XNEG, FI_ZPOS, FI_XPOS, FI_ZNEG };
-		for(int i=cubeCrossVariant, n=cubeCrossVariant+4; i < n; ++i) {
+		for(int i=cur->cubeCrossVariant, n=cur->cubeCrossVariant+4; i < n; ++i) {
 			int faceIndex = middleIndices[i % 4];
 			AddCubeQuad(tex, -1, faceIndex, arrayIndex, ImVec2(posX, posY), size);
 			posX += offset;
@@ -789,23 +1983,23 @@ static void DrawTexture()
 		return;
 	}
 
-	if(viewMode == SINGLE) {
+	if(cur->viewMode == SINGLE) {
 		AddQuad(tex, -1, arrayIndex, ImVec2(0, 0), ImVec2(texW, texH));
-	} else if(viewMode == TILED) {
-		float tilesX = numTiles[0];
-		float tilesY = numTiles[1];
+	} else if(cur->viewMode == TILED) {
+		float tilesX = cur->numTiles[0];
+		float tilesY = cur->numTiles[1];
 		ImVec2 size(texW*tilesX, texH*tilesY);
 		AddQuad(tex, -1, arrayIndex, ImVec2(0, 0), size, ImVec2(tilesX, tilesY));
-	} else if(viewAtSameSize) {
+	} else if(cur->viewAtSameSize) {
 		int numMips = tex.GetNumMips();
-		if(viewMode == MIPMAPS_COMPACT) {
+		if(cur->viewMode == MIPMAPS_COMPACT) {
 			// try to have about the same with and height
 			// (but round up because more horizontally is preferable due to displays being wide)
 			int numHor = ceil(sqrtf(numMips * texH / texW));
 			float posX = 0.0f;
 			float posY = 0.0f;
-			float hOffset = texW + spacingBetweenMips;
-			float vOffset = texH + spacingBetweenMips;
+			float hOffset = texW + cur->spacingBetweenMips;
+			float vOffset = texH + cur->spacingBetweenMips;
 			for(int i=0; i < numMips; ++i) {
 				AddQuad(tex, i, arrayIndex, ImVec2(posX, posY), ImVec2(texW, texH));
 				if(((i+1) % numHor) == 0) {
@@ -818,9 +2012,9 @@ static void DrawTexture()
 					posX += hOffset;
 				}
 			}
-		} else if(viewMode == MIPMAPS_ROW || viewMode == MIPMAPS_COLUMN) {
-			float hOffset = (viewMode == MIPMAPS_ROW) ? texW + spacingBetweenMips : 0.0f;
-			float vOffset = (viewMode == MIPMAPS_ROW) ? 0.0f : texH + spacingBetweenMips;
+		} else if(cur->viewMode == MIPMAPS_ROW || cur->viewMode == MIPMAPS_COLUMN) {
+			float hOffset = (cur->viewMode == MIPMAPS_ROW) ? texW + cur->spacingBetweenMips : 0.0f;
+			float vOffset = (cur->viewMode == MIPMAPS_ROW) ? 0.0f : texH + cur->spacingBetweenMips;
 			float posX = 0.0f;
 			float posY = 0.0f;
 			for(int i=0; i < numMips; ++i) {
@@ -828,62 +2022,648 @@ static void DrawTexture()
 				posX += hOffset;
 				posY += vOffset;
 			}
-		} else {
-			assert(0 && "unknown viewmode?!");
+		} else {
+			assert(0 && "unknown viewmode?!");
+		}
+
+	} else { // don't view at same size
+		int numMips = tex.GetNumMips();
+		if(cur->viewMode == MIPMAPS_COMPACT) {
+
+			bool toRight = (texW/texH <= 1.2f); // otherwise down
+
+			// below I adjust the spacing between mipmaps so it's not absurdly big
+			// for the smallest mips, by limiting it to half the current mipmap width or height
+			// but I also want to make sure that it's at least 2 pixels
+			// UNLESS spacingBetweenMips is smaller than that.
+			// using minSpace instead of 2 helps with that.
+			float minSpace = std::min(2, cur->spacingBetweenMips);
+
+			float posX = 0.0f;
+			float posY = 0.0f;
+			for(int i=0; i < numMips; ++i) {
+				float w, h;
+				tex.GetMipSize(i, &w, &h);
+				AddQuad(tex, i, arrayIndex, ImVec2(posX, posY), ImVec2(w, h));
+
+				if( (toRight && (i & 1) == 0)
+				   || (!toRight && (i & 1) == 1) ) {
+					float space = std::max(minSpace, std::min(float(cur->spacingBetweenMips), w * 0.5f));
+					posX += space + w;
+				} else {
+					float space = std::max(minSpace, std::min(float(cur->spacingBetweenMips), h * 0.5f));
+					posY += space + h;
+				}
+			}
+
+		} else if(cur->viewMode == MIPMAPS_ROW || cur->viewMode == MIPMAPS_COLUMN) {
+			bool inRow = (cur->viewMode == MIPMAPS_ROW);
+			float posX = 0.0f;
+			float posY = 0.0f;
+			for(int i=0; i < numMips; ++i) {
+				float w, h;
+				tex.GetMipSize(i, &w, &h);
+				AddQuad(tex, i, arrayIndex, ImVec2(posX, posY), ImVec2(w, h));
+				if(inRow) {
+					posX += cur->spacingBetweenMips + w;
+				} else {
+					posY += cur->spacingBetweenMips + h;
+				}
+			}
+		} else {
+			assert(0 && "unknown viewmode?!");
+		}
+	}
+
+	DrawQuads();
+
+	glDisable( GL_FRAMEBUFFER_SRGB ); // make sure it's disabled or ImGui will look wrong
+}
+
+// how other's colors must be converted to match the current texture's:
+// 0: not at all, 1: from sRGB to linear, 2: from linear to sRGB (convertB in the compare shaders)
+static int GetCompareColorConversion(const TextureView& other)
+{
+	bool curSRGB = ViewUsesSRGB(*cur);
+	bool otherSRGB = ViewUsesSRGB(other);
+	if(curSRGB && !otherSRGB)
+		return 1; // the framebuffer will convert to sRGB, so the color must be linear
+	else if(!curSRGB && otherSRGB)
+		return 2;
+	return 0;
+}
+
+// draws the current texture and other's in one pass with compareShader,
+// with the current view's settings (other's are only used for the swizzle and filter)
+static void DrawCompare(TextureView& other)
+{
+	texview::Texture& texA = *cur->tex;
+	texview::Texture& texB = *other.tex;
+	bool isDiff = (workspace.compareMode == COMPARE_DIFF);
+
+	if(ViewUsesAlphaBlend(*cur) && !isDiff)
+		glEnable(GL_BLEND);
+	else
+		glDisable(GL_BLEND);
+
+	// GL_FRAMEBUFFER_SRGB is set for the current texture, the other texture's
+	// colors are converted in the shader so they look like when it's shown on its own
+	bool enableSRGB = ViewUsesSRGB(*cur);
+	int convertB = GetCompareColorConversion(other);
+	// the difference is calculated from the colors as they're shown (so sRGB encoded
+	// if the current texture is shown as sRGB), the result must not be converted again
+	if(enableSRGB && !isDiff)
+		glEnable( GL_FRAMEBUFFER_SRGB );
+	else
+		glDisable( GL_FRAMEBUFFER_SRGB );
+
+	// if both views show the same texture, the current view's filter wins
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(texB.glTarget, texB.glTextureHandle);
+	if(other.tex.use_count() > 1) {
+		UpdateTextureFilter(other, false);
+	}
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(texA.glTarget, texA.glTextureHandle);
+	if(cur->tex.use_count() > 1) {
+		UpdateTextureFilter(*cur, false);
+	}
+
+	// both textures are shown with the same mip level and array layer, if possible
+	float lodB = -1.0f;
+	if(cur->mipmapLevel >= 0) {
+		// relative to GL_TEXTURE_BASE_LEVEL, like in AddQuad()
+		lodB = std::min(cur->mipmapLevel, texB.GetNumMips() - 1);
+		lodB = std::max(lodB - texB.GetFinestUploadedMip(), 0.0f);
+	}
+	int layerB = texB.IsArray() ? std::min(cur->textureArrayIndex, texB.GetNumElements() - 1) : 0;
+	double flickerInterval = std::max(workspace.flickerInterval, 0.01f);
+	bool showB = (int)(glfwGetTime() / flickerInterval) & 1;
+	if(workspace.compareMode == COMPARE_FLICKER) {
+		RequestRedrawAt((floor(glfwGetTime() / flickerInterval) + 1.0) * flickerInterval);
+	}
+
+	glUniform1i(compareShader.compareModeUniform, workspace.compareMode);
+	glUniform1f(compareShader.wipePosUniform, workspace.wipePos);
+	glUniform1i(compareShader.showBUniform, showB);
+	glUniform1f(compareShader.mipLevelBUniform, lodB);
+	glUniform1f(compareShader.layerBUniform, layerB);
+	glUniform1i(compareShader.convertBUniform, convertB);
+	glUniform1i(compareShader.diffModeUniform, workspace.diffMode);
+	glUniform1f(compareShader.diffScaleUniform, workspace.diffScale);
+	glUniform1i(compareShader.diffInSRGBUniform, enableSRGB);
+	{
+		// SSIM is calculated from the neighbouring texels of the shown mip level
+		float w, h;
+		texA.GetMipSize(std::max(cur->mipmapLevel, 0), &w, &h);
+		glUniform2f(compareShader.texelSizeUniform, 1.0f / std::max(w, 1.0f), 1.0f / std::max(h, 1.0f));
+	}
+
+	// in wipe, flicker and diff mode, the other texture is stretched to the size of the current one
+	float texW, texH;
+	texA.GetSize(&texW, &texH);
+	AddQuad(texA, -1, cur->textureArrayIndex, ImVec2(0, 0), ImVec2(texW, texH));
+	if(workspace.compareMode == COMPARE_SIDE_BY_SIDE) {
+		float w, h;
+		texB.GetSize(&w, &h);
+		AddQuad(texB, -1, layerB, ImVec2(texW + cur->spacingBetweenMips, 0), ImVec2(w, h));
+		// position.z selects texB in compareVertexShaderSrc
+		for(size_t i = drawData.size() - 6; i < drawData.size(); ++i) {
+			drawData[i].pos.z = 1.0f;
+		}
+	}
+
+	DrawQuads();
+
+	glDisable( GL_FRAMEBUFFER_SRGB ); // make sure it's disabled or ImGui will look wrong
+}
+
+// error metrics between the current texture and the one it's compared with,
+// shown in the sidebar in COMPARE_DIFF mode. Only recalculated when something
+// that affects them changed (see UpdateDiffMetrics())
+static struct DiffMetrics {
+	// what they've been calculated for
+	struct Key {
+		int viewIds[2];
+		int shaderGens[2]; // the swizzle is part of the shader
+		int level;
+		int layers[2];
+		int finestMips[2]; // while uploading, they're calculated once the level is on the GPU
+		int srgb[2];
+
+		bool operator==(const Key& o) const {
+			return memcmp(this, &o, sizeof(Key)) == 0;
+		}
+	} key = {};
+
+	bool valid = false;
+	bool onCPU = false; // calculated by CompareTextureImages() because the GPU way didn't work
+	texview::ImageErrors errors;
+	const char* problem = nullptr; // why they haven't been calculated, if !valid
+} diffMetrics;
+
+// sums up the squared differences between the given mip level (and layer) of
+// the textures of cur and other (with the sample functions of compareShader)
+// on the GPU. Returns false if that didn't work
+static bool ComputeDiffMetricsGPU(const TextureView& other, int level, int layerA, int layerB, texview::ImageErrors* errors)
+{
+	if(compareShader.metricsProgram == 0) {
+		return false;
+	}
+	if(reduceProgram == 0) {
+		const char* glslVersion = "#version 150\n";
+		GLuint shaders[2] = {};
+		shaders[0] = CompileShader(GL_VERTEX_SHADER, { glslVersion, metricsVertexShaderSrc });
+		shaders[1] = CompileShader(GL_FRAGMENT_SHADER, { glslVersion, reduceFragShaderSrc });
+		if(shaders[0] != 0 && shaders[1] != 0) {
+			reduceProgram = CreateShaderProgram(shaders);
+		}
+		glDeleteShader(shaders[0]);
+		glDeleteShader(shaders[1]);
+		if(reduceProgram == 0) {
+			return false;
+		}
+		glUseProgram(reduceProgram);
+		glUniform1i(glGetUniformLocation(reduceProgram, "src"), 0);
+	}
+
+	texview::Texture& texA = *cur->tex;
+	texview::Texture& texB = *other.tex;
+	float w, h;
+	texA.GetMipSize(level, &w, &h);
+	const int width = (int)w;
+	const int height = (int)h;
+
+	// two float textures, the reduction passes render from one to the other (ping-pong)
+	int sizes[2][2];
+	sizes[0][0] = (width + METRICS_BLOCK_SIZE - 1) / METRICS_BLOCK_SIZE;
+	sizes[0][1] = (height + METRICS_BLOCK_SIZE - 1) / METRICS_BLOCK_SIZE;
+	sizes[1][0] = (sizes[0][0] + 3) / 4;
+	sizes[1][1] = (sizes[0][1] + 3) / 4;
+	GLuint sumTextures[2] = {};
+	glGenTextures(2, sumTextures);
+	for(int i=0; i < 2; ++i) {
+		glBindTexture(GL_TEXTURE_2D, sumTextures[i]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, sizes[i][0], sizes[i][1], 0, GL_RGBA, GL_FLOAT, nullptr);
+	}
+	GLuint fbo = 0;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sumTextures[0], 0);
+
+	bool ret = false;
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+		glDisable(GL_BLEND);
+		glDisable(GL_FRAMEBUFFER_SRGB);
+
+		// a quad covering the whole viewport
+		const float quad[6][2] = { {-1, -1}, {-1, 1}, {1, 1}, {-1, -1}, {1, 1}, {1, -1} };
+		auto addViewportQuad = [&quad]() {
+			for(const float* p : quad) {
+				VertexData v = { { p[0], p[1], 0.0f, 0.0f }, { 0.0f, 0.0f } };
+				drawData.push_back(v);
+			}
+		};
+
+		GLuint prog = compareShader.metricsProgram;
+		glUseProgram(prog);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(texB.glTarget, texB.glTextureHandle);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(texA.glTarget, texA.glTextureHandle);
+		// textureLod() is relative to GL_TEXTURE_BASE_LEVEL
+		glUniform2f(glGetUniformLocation(prog, "texSize"), w, h);
+		glUniform1f(glGetUniformLocation(prog, "lodA"), level - texA.GetFinestUploadedMip());
+		glUniform1f(glGetUniformLocation(prog, "lodB"), level - texB.GetFinestUploadedMip());
+		glUniform1f(glGetUniformLocation(prog, "layerA"), layerA);
+		glUniform1f(glGetUniformLocation(prog, "layerB"), layerB);
+		glUniform1i(glGetUniformLocation(prog, "convertB"), GetCompareColorConversion(other));
+		glUniform1i(glGetUniformLocation(prog, "inSRGB"), ViewUsesSRGB(*cur));
+		glViewport(0, 0, sizes[0][0], sizes[0][1]);
+		addViewportQuad();
+		DrawQuads();
+
+		glUseProgram(reduceProgram);
+		GLint srcSizeUniform = glGetUniformLocation(reduceProgram, "srcSize");
+		int srcIdx = 0;
+		int srcW = sizes[0][0];
+		int srcH = sizes[0][1];
+		while(srcW > 1 || srcH > 1) {
+			int dstW = (srcW + 3) / 4;
+			int dstH = (srcH + 3) / 4;
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sumTextures[srcIdx ^ 1], 0);
+			glBindTexture(GL_TEXTURE_2D, sumTextures[srcIdx]);
+			glUniform2i(srcSizeUniform, srcW, srcH);
+			glViewport(0, 0, dstW, dstH);
+			addViewportQuad();
+			DrawQuads();
+			srcIdx ^= 1;
+			srcW = dstW;
+			srcH = dstH;
+		}
+		// now the (single texel) result is in the texture that's attached to the framebuffer
+		// (or, if there was only one block, sumTextures[0] is still attached)
+		float sums[4] = {};
+		glReadPixels(0, 0, 1, 1, GL_RGBA, GL_FLOAT, sums);
+
+		double numPixels = double(width) * height;
+		*errors = texview::ImageErrors();
+		errors->width = width;
+		errors->height = height;
+		for(int c=0; c < 4; ++c) {
+			errors->mse[c] = sums[c] / numPixels;
 		}
+		errors->mseRGB = (double(sums[0]) + sums[1] + sums[2]) / (3.0 * numPixels);
+		ret = true;
+	}
 
-	} else { // don't view at same size
-		int numMips = tex.GetNumMips();
-		if(viewMode == MIPMAPS_COMPACT) {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteTextures(2, sumTextures);
+	return ret;
+}
 
-			bool toRight = (texW/texH <= 1.2f); // otherwise down
+// called every frame in COMPARE_DIFF mode, recalculates diffMetrics if needed
+static void UpdateDiffMetrics(TextureView& other)
+{
+	texview::Texture& texA = *cur->tex;
+	texview::Texture& texB = *other.tex;
+	// the metrics are for the shown mip level (the first one in auto mode) and layer
+	int level = std::min(std::max(cur->mipmapLevel, 0), texA.GetNumMips() - 1);
+	int layerA = texA.IsArray() ? cur->textureArrayIndex : 0;
+	int layerB = texB.IsArray() ? std::min(cur->textureArrayIndex, texB.GetNumElements() - 1) : 0;
+
+	DiffMetrics::Key key = {};
+	key.viewIds[0] = cur->id;
+	key.viewIds[1] = other.id;
+	key.shaderGens[0] = cur->shaderGeneration;
+	key.shaderGens[1] = other.shaderGeneration;
+	key.level = level;
+	key.layers[0] = layerA;
+	key.layers[1] = layerB;
+	key.finestMips[0] = texA.GetFinestUploadedMip();
+	key.finestMips[1] = texB.GetFinestUploadedMip();
+	key.srgb[0] = ViewUsesSRGB(*cur);
+	key.srgb[1] = ViewUsesSRGB(other);
+	if(key == diffMetrics.key) {
+		return;
+	}
+	diffMetrics.key = key;
+	diffMetrics.valid = false;
+	diffMetrics.onCPU = false;
+
+	float wa, ha, wb, hb;
+	texA.GetMipSize(level, &wa, &ha);
+	texB.GetMipSize(level, &wb, &hb);
+	if(wa != wb || ha != hb) {
+		diffMetrics.problem = "The textures have different sizes (at this mip level)";
+		return;
+	}
+	if(level < key.finestMips[0] || level < key.finestMips[1]) {
+		diffMetrics.problem = "Waiting for the mip level to be uploaded";
+		return;
+	}
+	double startTime = glfwGetTime();
+	if(ComputeDiffMetricsGPU(other, level, layerA, layerB, &diffMetrics.errors)) {
+		diffMetrics.valid = true;
+		LogInfo("Calculated the error metrics of %d x %d pixels on the GPU in %.2f ms\n",
+		        (int)wa, (int)ha, (glfwGetTime() - startTime) * 1000.0);
+	} else if(!texA.IsUploadPending() && !texB.IsUploadPending()) {
+		// (GetFloatImage() must not be used while uploading)
+		diffMetrics.valid = texview::CompareTextureImages(texA, layerA, texB, layerB, level, &diffMetrics.errors);
+		diffMetrics.onCPU = true;
+		if(diffMetrics.valid) {
+			LogInfo("Calculated the error metrics of %d x %d pixels on the CPU in %.2f ms\n",
+			        (int)wa, (int)ha, (glfwGetTime() - startTime) * 1000.0);
+		}
+	}
+	if(!diffMetrics.valid) {
+		diffMetrics.problem = "Couldn't calculate the error metrics";
+	}
+}
 
-			// below I adjust the spacing between mipmaps so it's not absurdly big
-			// for the smallest mips, by limiting it to half the current mipmap width or height
-			// but I also want to make sure that it's at least 2 pixels
-			// UNLESS spacingBetweenMips is smaller than that.
-			// using minSpace instead of 2 helps with that.
-			float minSpace = std::min(2, spacingBetweenMips);
+// statistics of the current texture, shown in the sidebar when the "Statistics" section
+// is open. Only recalculated when something that affects them changed (see UpdateTextureStats())
+static struct TextureStats {
+	// what they've been calculated for
+	struct Key {
+		int viewId;
+		int shaderGen; // changes when the view's texture changes
+		int level;
+		int layer;
+		int face; // -1 if not a cubemap
+		int finestMip; // while uploading, they're calculated once the level is on the GPU
+
+		bool operator==(const Key& o) const {
+			return memcmp(this, &o, sizeof(Key)) == 0;
+		}
+	} key = {};
 
-			float posX = 0.0f;
-			float posY = 0.0f;
-			for(int i=0; i < numMips; ++i) {
-				float w, h;
-				tex.GetMipSize(i, &w, &h);
-				AddQuad(tex, i, arrayIndex, ImVec2(posX, posY), ImVec2(w, h));
+	bool valid = false;
+	bool onCPU = false; // calculated by CalcTextureImageStats() because the GPU way didn't work
+	texview::ImageStats stats;
+	const char* problem = nullptr; // why they haven't been calculated, if !valid
+} texStats;
 
-				if( (toRight && (i & 1) == 0)
-				   || (!toRight && (i & 1) == 1) ) {
-					float space = std::max(minSpace, std::min(float(spacingBetweenMips), w * 0.5f));
-					posX += space + w;
-				} else {
-					float space = std::max(minSpace, std::min(float(spacingBetweenMips), h * 0.5f));
-					posY += space + h;
-				}
+static bool showTextureStats = false; // set by DrawSidebar() while the statistics are visible
+static bool statsLogScale = false;
+
+// calculates the statistics of the given mip level, layer and cubemap face
+// (-1 if not a cubemap) of the current texture on the GPU. Returns false if that didn't work
+static bool ComputeTextureStatsGPU(int level, int layer, int face, texview::ImageStats* stats)
+{
+	if(!UpdateStatsShader(*cur)) {
+		return false;
+	}
+	if(statsReduceProgram == 0) {
+		const char* glslVersion = "#version 150\n";
+		GLuint shaders[2] = {};
+		shaders[0] = CompileShader(GL_VERTEX_SHADER, { glslVersion, metricsVertexShaderSrc });
+		shaders[1] = CompileShader(GL_FRAGMENT_SHADER, { glslVersion, statsReduceFragShaderSrc });
+		if(shaders[0] != 0 && shaders[1] != 0) {
+			statsReduceProgram = CreateShaderProgram(shaders);
+		}
+		glDeleteShader(shaders[0]);
+		glDeleteShader(shaders[1]);
+		if(statsReduceProgram == 0) {
+			return false;
+		}
+		if(glGetFragDataLocation(statsReduceProgram, "OutStats") != 0) {
+			glDeleteProgram(statsReduceProgram);
+			statsReduceProgram = 0;
+			return false;
+		}
+		glUseProgram(statsReduceProgram);
+		const char* srcNames[4] = { "srcMin", "srcMax", "srcSum", "srcSumSq" };
+		for(int i=0; i < 4; ++i) {
+			glUniform1i(glGetUniformLocation(statsReduceProgram, srcNames[i]), i);
+		}
+	}
+	if(statsVAO == 0) {
+		glGenVertexArrays(1, &statsVAO);
+	}
+
+	texview::Texture& tex = *cur->tex;
+	float w, h;
+	tex.GetMipSize(level, &w, &h);
+	const int width = (int)w;
+	const int height = (int)h;
+
+	// two sets of four float textures (min, max, sum, sum of squares),
+	// the reduction passes render from one set to the other (ping-pong)
+	int sizes[2][2];
+	sizes[0][0] = (width + STATS_BLOCK_SIZE - 1) / STATS_BLOCK_SIZE;
+	sizes[0][1] = (height + STATS_BLOCK_SIZE - 1) / STATS_BLOCK_SIZE;
+	sizes[1][0] = (sizes[0][0] + 3) / 4;
+	sizes[1][1] = (sizes[0][1] + 3) / 4;
+	GLuint statTextures[2][4] = {};
+	GLuint histoTexture = 0;
+	glGenTextures(8, statTextures[0]);
+	glGenTextures(1, &histoTexture);
+	for(int i=0; i < 9; ++i) {
+		bool isHisto = (i == 8);
+		glBindTexture(GL_TEXTURE_2D, isHisto ? histoTexture : statTextures[i / 4][i % 4]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		int tw = isHisto ? texview::IMAGE_STATS_NUM_BINS : sizes[i / 4][0];
+		int th = isHisto ? 1 : sizes[i / 4][1];
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, tw, th, 0, GL_RGBA, GL_FLOAT, nullptr);
+	}
+	const GLenum drawBuffers[4] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
+	GLuint fbo = 0;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	auto attachSet = [&](int set) {
+		for(int i=0; i < 4; ++i) {
+			glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, statTextures[set][i], 0);
+		}
+	};
+	attachSet(0);
+	glDrawBuffers(4, drawBuffers);
+
+	bool ret = false;
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+		glDisable(GL_BLEND);
+		glDisable(GL_FRAMEBUFFER_SRGB);
+
+		// a quad covering the whole viewport
+		const float quad[6][2] = { {-1, -1}, {-1, 1}, {1, 1}, {-1, -1}, {1, 1}, {1, -1} };
+		auto addViewportQuad = [&quad]() {
+			for(const float* p : quad) {
+				VertexData v = { { p[0], p[1], 0.0f, 0.0f }, { 0.0f, 0.0f } };
+				drawData.push_back(v);
 			}
+		};
+		auto setTexelUniforms = [&](GLuint prog) {
+			glUseProgram(prog);
+			glUniform2i(glGetUniformLocation(prog, "texSize"), width, height);
+			// textureLod() is relative to GL_TEXTURE_BASE_LEVEL
+			glUniform1f(glGetUniformLocation(prog, "lod"), level - tex.GetFinestUploadedMip());
+			glUniform1f(glGetUniformLocation(prog, "layer"), layer);
+			glUniform1i(glGetUniformLocation(prog, "cubeFace"), face);
+			glUniform1i(glGetUniformLocation(prog, "encodeSRGB"), (tex.textureFlags & texview::TF_SRGB) != 0);
+		};
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(tex.glTarget, tex.glTextureHandle);
+		setTexelUniforms(statsShader.sumProgram);
+		glViewport(0, 0, sizes[0][0], sizes[0][1]);
+		addViewportQuad();
+		DrawQuads();
 
-		} else if(viewMode == MIPMAPS_ROW || viewMode == MIPMAPS_COLUMN) {
-			bool inRow = (viewMode == MIPMAPS_ROW);
-			float posX = 0.0f;
-			float posY = 0.0f;
-			for(int i=0; i < numMips; ++i) {
-				float w, h;
-				tex.GetMipSize(i, &w, &h);
-				AddQuad(tex, i, arrayIndex, ImVec2(posX, posY), ImVec2(w, h));
-				if(inRow) {
-					posX += spacingBetweenMips + w;
-				} else {
-					posY += spacingBetweenMips + h;
-				}
+		glUseProgram(statsReduceProgram);
+		GLint srcSizeUniform = glGetUniformLocation(statsReduceProgram, "srcSize");
+		int srcIdx = 0;
+		int srcW = sizes[0][0];
+		int srcH = sizes[0][1];
+		while(srcW > 1 || srcH > 1) {
+			int dstW = (srcW + 3) / 4;
+			int dstH = (srcH + 3) / 4;
+			attachSet(srcIdx ^ 1);
+			for(int i=0; i < 4; ++i) {
+				glActiveTexture(GL_TEXTURE0 + i);
+				glBindTexture(GL_TEXTURE_2D, statTextures[srcIdx][i]);
+			}
+			glUniform2i(srcSizeUniform, srcW, srcH);
+			glViewport(0, 0, dstW, dstH);
+			addViewportQuad();
+			DrawQuads();
+			srcIdx ^= 1;
+			srcW = dstW;
+			srcH = dstH;
+		}
+		glActiveTexture(GL_TEXTURE0);
+		// now the (single texel) results are in the textures attached to the framebuffer
+		float results[4][4] = {};
+		for(int i=0; i < 4; ++i) {
+			glReadBuffer(drawBuffers[i]);
+			glReadPixels(0, 0, 1, 1, GL_RGBA, GL_FLOAT, results[i]);
+		}
+
+		double numPixels = double(width) * height;
+		*stats = texview::ImageStats();
+		stats->width = width;
+		stats->height = height;
+		for(int c=0; c < 4; ++c) {
+			stats->min[c] = results[0][c];
+			stats->max[c] = results[1][c];
+			stats->mean[c] = results[2][c] / numPixels;
+			double variance = results[3][c] / numPixels - stats->mean[c] * stats->mean[c];
+			stats->stddev[c] = sqrt(std::max(variance, 0.0));
+		}
+		texview::SetHistogramRange(stats);
+
+		// the histogram: the points of all texels are added up in one row of float texels.
+		// float counts are only exact up to 2^24, so it's done in batches of less than
+		// 2^24 points that are read back and added up in 64bit integers.
+		// (smaller batches also don't run into the driver's timeout with huge textures)
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, histoTexture, 0);
+		for(int i=1; i < 4; ++i) {
+			glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, 0, 0);
+		}
+		glDrawBuffers(1, drawBuffers);
+		glViewport(0, 0, texview::IMAGE_STATS_NUM_BINS, 1);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		GLuint prog = statsShader.histoProgram;
+		setTexelUniforms(prog);
+		glUniform1f(glGetUniformLocation(prog, "histoMin"), stats->histoMin);
+		glUniform1f(glGetUniformLocation(prog, "histoScale"),
+		            texview::IMAGE_STATS_NUM_BINS / (stats->histoMax - stats->histoMin));
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		glBindVertexArray(statsVAO);
+		GLint firstRowUniform = glGetUniformLocation(prog, "firstRow");
+		const int64_t pointsPerRow = int64_t(width) * 4;
+		const int rowsPerDraw = (int)std::max(int64_t(1), ((1 << 24) - 1) / pointsPerRow);
+		std::vector<float> bins(texview::IMAGE_STATS_NUM_BINS * 4);
+		std::vector<uint64_t> counts(texview::IMAGE_STATS_NUM_BINS * 4, 0);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+		for(int firstRow = 0; firstRow < height; firstRow += rowsPerDraw) {
+			int numRows = std::min(rowsPerDraw, height - firstRow);
+			glClear(GL_COLOR_BUFFER_BIT);
+			glUniform1i(firstRowUniform, firstRow);
+			glDrawArrays(GL_POINTS, 0, GLint(pointsPerRow * numRows));
+			glReadPixels(0, 0, texview::IMAGE_STATS_NUM_BINS, 1, GL_RGBA, GL_FLOAT, bins.data());
+			for(size_t i=0; i < bins.size(); ++i) {
+				counts[i] += uint64_t(bins[i] + 0.5f);
+			}
+		}
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDisable(GL_BLEND);
+
+		for(int i=0; i < texview::IMAGE_STATS_NUM_BINS; ++i) {
+			for(int c=0; c < 4; ++c) {
+				stats->histogram[c][i] = uint32_t(std::min(counts[i*4 + c], uint64_t(UINT32_MAX)));
 			}
-		} else {
-			assert(0 && "unknown viewmode?!");
 		}
+		ret = true;
 	}
 
-	DrawQuads();
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteTextures(8, statTextures[0]);
+	glDeleteTextures(1, &histoTexture);
+	return ret;
+}
 
-	glDisable( GL_FRAMEBUFFER_SRGB ); // make sure it's disabled or ImGui will look wrong
+// called every frame while the statistics are shown, recalculates texStats if needed
+static void UpdateTextureStats()
+{
+	texview::Texture& tex = *cur->tex;
+	if(tex.GetNumMips() == 0) {
+		texStats.valid = false;
+		texStats.problem = nullptr;
+		texStats.key = TextureStats::Key();
+		return;
+	}
+	int numFaces = tex.GetNumCubemapFaces();
+	TextureStats::Key key = {};
+	key.viewId = cur->id;
+	key.shaderGen = cur->shaderGeneration;
+	// the statistics are for the shown mip level (the first one in auto mode) and layer
+	key.level = std::min(std::max(cur->mipmapLevel, 0), tex.GetNumMips() - 1);
+	key.layer = tex.IsArray() ? cur->textureArrayIndex : 0;
+	key.face = tex.IsCubemap() ? std::min(cur->statsCubeFace, numFaces - 1) : -1;
+	key.finestMip = tex.GetFinestUploadedMip();
+	if(key == texStats.key) {
+		return;
+	}
+	texStats.key = key;
+	texStats.valid = false;
+	texStats.onCPU = false;
+
+	if(key.level < key.finestMip) {
+		texStats.problem = "Waiting for the mip level to be uploaded";
+		return;
+	}
+	if(tex.IsTiled()) {
+		// it's not one OpenGL texture, and decoding a whole level of such a huge
+		// texture to float RGBA for CalcTextureImageStats() needs too much memory
+		texStats.problem = "Not supported for textures that are split into tiles";
+		return;
+	}
+	float w, h;
+	tex.GetMipSize(key.level, &w, &h);
+	double startTime = glfwGetTime();
+	if(ComputeTextureStatsGPU(key.level, key.layer, key.face, &texStats.stats)) {
+		texStats.valid = true;
+		LogInfo("Calculated the statistics of %d x %d pixels on the GPU in %.2f ms\n",
+		        (int)w, (int)h, (glfwGetTime() - startTime) * 1000.0);
+	} else if(!tex.IsUploadPending()) {
+		// (GetFloatImage() must not be used while uploading)
+		int elemIdx = tex.IsCubemap() ? key.layer * numFaces + key.face : key.layer;
+		texStats.valid = texview::CalcTextureImageStats(tex, elemIdx, key.level, &texStats.stats);
+		texStats.onCPU = true;
+		if(texStats.valid) {
+			LogInfo("Calculated the statistics of %d x %d pixels on the CPU in %.2f ms\n",
+			        (int)w, (int)h, (glfwGetTime() - startTime) * 1000.0);
+		}
+	}
+	if(!texStats.valid) {
+		texStats.problem = "Couldn't calculate the statistics";
+	}
 }
 
 static void GenericFrame(GLFWwindow* window)
@@ -905,7 +2685,30 @@ static void GenericFrame(GLFWwindow* window)
 		return;
 	}
 
-	glUseProgram(shaderProgram);
+	GLuint program = cur->shaderProgram;
+	GLint mvpMatrixUniform = cur->mvpMatrixUniform;
+	TextureView* compareView = GetCompareView();
+	if(compareView != nullptr) {
+		if(UpdateCompareShader(*cur, *compareView)) {
+			program = compareShader.program;
+			mvpMatrixUniform = compareShader.mvpMatrixUniform;
+			// pan and zoom are locked together, also when switching to the other view
+			compareView->zoomLevel = cur->zoomLevel;
+			compareView->transX = cur->transX;
+			compareView->transY = cur->transY;
+			if(workspace.compareMode == COMPARE_DIFF) {
+				UpdateDiffMetrics(*compareView);
+				glViewport(0, 0, display_w, display_h);
+			}
+		} else {
+			compareView = nullptr;
+		}
+	}
+	if(showTextureStats) {
+		UpdateTextureStats();
+		glViewport(0, 0, display_w, display_h);
+	}
+	glUseProgram(program);
 
 	float mvp[4][4] = {};
 	glViewport(xOffs, 0, winW, display_h);
@@ -923,19 +2726,26 @@ static void GenericFrame(GLFWwindow* window)
 		mvp[3][2] = (near + far) / (near - far);
 	}
 	// scale with (zoomLevel, zoomLevel, 1.0)
-	mvp[0][0] *= zoomLevel;
-	mvp[1][1] *= zoomLevel;
+	mvp[0][0] *= cur->zoomLevel;
+	mvp[1][1] *= cur->zoomLevel;
 	// translate by ((transX * sx) / zoomLevel, (transY * sy) / zoomLevel, 0.0)
 	{
-		float tx = (transX * imguiCoordScale.x) / zoomLevel;
-		float ty = (transY * imguiCoordScale.y) / zoomLevel;
+		float tx = (cur->transX * imguiCoordScale.x) / cur->zoomLevel;
+		float ty = (cur->transY * imguiCoordScale.y) / cur->zoomLevel;
 		mvp[3][0] += mvp[0][0] * tx;
 		mvp[3][1] += mvp[1][1] * ty;
+
+		visibleMin = ImVec2(-tx, -ty);
+		visibleMax = ImVec2(winW / cur->zoomLevel - tx, display_h / cur->zoomLevel - ty);
 	}
 
 	glUniformMatrix4fv(mvpMatrixUniform, 1, GL_FALSE, mvp[0]);
 
-	DrawTexture();
+	if(compareView != nullptr) {
+		DrawCompare(*compareView);
+	} else {
+		DrawTexture();
+	}
 }
 
 
@@ -945,8 +2755,8 @@ static void OpenFilePicker() {
 		//args.filterList = filters;
 		//args.filterCount = 2;
 		std::string dp;
-		if(!curTex.name.empty()) {
-			dp = curTex.name;
+		if(!cur->tex->name.empty()) {
+			dp = cur->tex->name;
 			size_t lastSlash = dp.find_last_of('/');
 	#ifdef _WIN32
 			size_t lastBS = dp.find_last_of('\\');
@@ -1032,6 +2842,56 @@ static void DrawAboutWindow(GLFWwindow* window)
 	ImGui::End();
 }
 
+// shown at the bottom of the texture area while a texture is loaded in the background
+static void DrawLoadingIndicator()
+{
+	if(cur->pendingLoad == nullptr && !cur->tex->IsUploadPending()) {
+		return;
+	}
+	ImGuiIO& io = ImGui::GetIO();
+	float xOffs = imguiMenuCollapsed ? 0.0f : imguiMenuWidth;
+	ImVec2 pos( xOffs + 0.5f * (io.DisplaySize.x - xOffs), io.DisplaySize.y - ImGui::GetFontSize() );
+	ImGui::SetNextWindowPos( pos, ImGuiCond_Always, ImVec2(0.5f, 1.0f) );
+	ImGuiWindowFlags flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove
+	        | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoSavedSettings
+	        | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing
+	        | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs;
+	if(ImGui::Begin("##loadingIndicator", NULL, flags) && cur->pendingLoad == nullptr) {
+		// the texture is shown already, but its finer mip levels (or more tiles) are still being uploaded
+		const texview::Texture& tex = *cur->tex;
+		float barWidth = ImGui::CalcTextSize("0123456789abcdef0123456789").x;
+		if(tex.IsPyramidBuilding()) {
+			// (only happens once, later the pyramid is loaded from the cache)
+			ImGui::Text("Building pyramid of %s ...", GetFileNamePart(tex.name.c_str()));
+			float progress = tex.GetPyramidBuildProgress();
+			char progressStr[32];
+			snprintf(progressStr, sizeof(progressStr), "%d%%", int(progress * 100.0f));
+			ImGui::ProgressBar(progress, ImVec2(barWidth, 0.0f), progressStr);
+		} else {
+			int numTotal = tex.GetNumMips();
+			int numDone = numTotal - tex.GetFinestUploadedMip();
+			const char* what = "mips";
+			if(tex.IsTiled()) {
+				numTotal = (int)tex.glTiles.size();
+				numDone = tex.nextTileToUpload;
+				what = "tiles";
+			}
+			ImGui::Text("Uploading %s ...", GetFileNamePart(tex.name.c_str()));
+			char levelsStr[32];
+			snprintf(levelsStr, sizeof(levelsStr), "%d/%d %s", numDone, numTotal, what);
+			ImGui::ProgressBar(float(numDone) / numTotal, ImVec2(barWidth, 0.0f), levelsStr);
+		}
+	} else if(cur->pendingLoad != nullptr) {
+		ImGui::Text("Loading %s ...", GetFileNamePart(cur->pendingLoad->path.c_str()));
+		char elapsedStr[32];
+		snprintf(elapsedStr, sizeof(elapsedStr), "%.1fs", glfwGetTime() - cur->pendingLoad->startTime);
+		// a negative fraction gives an "indeterminate" animated progress bar
+		float barWidth = ImGui::CalcTextSize("0123456789abcdef0123456789").x;
+		ImGui::ProgressBar(-1.0f * (float)ImGui::GetTime(), ImVec2(barWidth, 0.0f), elapsedStr);
+	}
+	ImGui::End();
+}
+
 static void DrawGLSLeditWindow(GLFWwindow* window)
 {
 	ImGuiIO& io = ImGui::GetIO();
@@ -1043,19 +2903,21 @@ static void DrawGLSLeditWindow(GLFWwindow* window)
 
 	ImGuiWindowFlags flags = 0;
 	if(ImGui::Begin("Advanced Swizzling", &showGLSLeditWindow, flags)) {
-		ImGui::TextDisabled("%s", texSampleAndNormalize.c_str());
+		ImGui::TextDisabled("%s", cur->texSampleAndNormalize.c_str());
 
 		static char buf[4096] = {};
-		if(ImGui::IsWindowAppearing()) {
-			size_t len = std::min(swizzle.size(), sizeof(buf)-1);
-			memcpy(buf, swizzle.c_str(), len);
+		static int bufViewId = 0; // the view buf belongs to
+		if(ImGui::IsWindowAppearing() || bufViewId != cur->id) {
+			bufViewId = cur->id;
+			size_t len = std::min(cur->swizzle.size(), sizeof(buf)-1);
+			memcpy(buf, cur->swizzle.c_str(), len);
 			buf[len] = '\0';
 		}
 
 		ImGuiInputTextFlags flags = ImGuiInputTextFlags_AllowTabInput;
 		ImGui::SetNextItemWidth(-8.0f);
 		if(ImGui::InputTextMultiline("##glslcode", buf, sizeof(buf), ImVec2(0, 0), flags)) {
-			swizzle = buf;
+			cur->swizzle = buf;
 		}
 
 		ImGui::TextDisabled(" OutColor = c;");
@@ -1066,7 +2928,7 @@ static void DrawGLSLeditWindow(GLFWwindow* window)
 		float buttonWidth = ImGui::CalcTextSize("Close or what").x;
 		if( ImGui::Button("Apply", ImVec2(buttonWidth, 0.0f))
 		   || (haveFocus && ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Enter)) ) {
-			UpdateShaders();
+			UpdateShaders(*cur);
 		}
 		ImGui::SetItemTooltip("Alternatively you can press Ctrl+Enter to apply");
 
@@ -1081,6 +2943,141 @@ static void DrawGLSLeditWindow(GLFWwindow* window)
 	ImGui::End();
 }
 
+// shows diffMetrics in the sidebar's "Compare" section
+static void DrawDiffMetrics()
+{
+	ImGui::Spacing();
+	if(!diffMetrics.valid) {
+		if(diffMetrics.problem != nullptr) {
+			ImGui::TextWrapped("%s", diffMetrics.problem);
+		}
+		return;
+	}
+	const texview::ImageErrors& e = diffMetrics.errors;
+	ImGui::Text("Mip Level %d (%u x %u)", diffMetrics.key.level, e.width, e.height);
+	ImGui::SetItemTooltip("The metrics are calculated for the selected Mip Level and Layer,\n"
+	                      "with the swizzles of both views, from the colors as they're shown\n"
+	                      "(sRGB encoded if the current texture is shown as sRGB).%s",
+	                      diffMetrics.onCPU ? "\nCalculated on the CPU, without swizzle" : "");
+	ImGuiTableFlags tableFlags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg;
+	if(ImGui::BeginTable("##diffMetrics", 3, tableFlags)) {
+		ImGui::TableSetupColumn("");
+		ImGui::TableSetupColumn("MSE");
+		ImGui::TableSetupColumn("PSNR");
+		ImGui::TableHeadersRow();
+		const char* names[5] = { "R", "G", "B", "A", "RGB" };
+		for(int c=0; c < 5; ++c) {
+			double mse = (c < 4) ? e.mse[c] : e.mseRGB;
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(names[c]);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3g", mse);
+			ImGui::TableNextColumn();
+			if(mse > 0.0) {
+				ImGui::Text("%.2f dB", texview::MSEToPSNR(mse));
+			} else {
+				ImGui::TextUnformatted("identical");
+			}
+		}
+		ImGui::EndTable();
+	}
+}
+
+static void DrawTextureStats()
+{
+	texview::Texture& tex = *cur->tex;
+	if(tex.IsCubemap()) {
+		const char* faceNames[6] = { "+X", "-X", "+Y", "-Y", "+Z", "-Z" };
+		int numFaces = tex.GetNumCubemapFaces();
+		int face = std::min(cur->statsCubeFace, numFaces - 1);
+		if(ImGui::Combo("Face", &face, faceNames, numFaces)) {
+			cur->statsCubeFace = face;
+		}
+	}
+	ImGui::Spacing();
+	if(!texStats.valid) {
+		if(texStats.problem != nullptr) {
+			ImGui::TextWrapped("%s", texStats.problem);
+		}
+		return;
+	}
+	const texview::ImageStats& st = texStats.stats;
+	ImGui::Text("Mip Level %d (%u x %u)", texStats.key.level, st.width, st.height);
+	ImGui::SetItemTooltip("The statistics are calculated for the selected Mip Level and Layer,\n"
+	                      "from the values as they're stored in the texture\n"
+	                      "(without swizzle, sRGB textures aren't converted to linear).%s",
+	                      texStats.onCPU ? "\nCalculated on the CPU" : "");
+	ImGuiTableFlags tableFlags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg;
+	if(ImGui::BeginTable("##texStats", 5, tableFlags)) {
+		ImGui::TableSetupColumn("");
+		ImGui::TableSetupColumn("Min");
+		ImGui::TableSetupColumn("Max");
+		ImGui::TableSetupColumn("Mean");
+		ImGui::TableSetupColumn("Std.Dev.");
+		ImGui::TableHeadersRow();
+		for(int c=0; c < 4; ++c) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%c", "RGBA"[c]);
+			for(double v : { st.min[c], st.max[c], st.mean[c], st.stddev[c] }) {
+				ImGui::TableNextColumn();
+				ImGui::Text("%.4g", v);
+			}
+		}
+		ImGui::EndTable();
+	}
+
+	// the histograms of all channels on top of each other (alpha only if the texture has it)
+	int numChans = (tex.textureFlags & texview::TF_HAS_ALPHA) ? 4 : 3;
+	ImGui::Checkbox("Logarithmic", &statsLogScale);
+	ImGui::SetItemTooltip("Use a logarithmic scale for the histogram's counts,\n"
+	                      "so small counts next to big spikes are still visible");
+	const int numBins = texview::IMAGE_STATS_NUM_BINS;
+	uint32_t maxCount = 1;
+	for(int c=0; c < numChans; ++c) {
+		for(int i=0; i < numBins; ++i) {
+			maxCount = std::max(maxCount, st.histogram[c][i]);
+		}
+	}
+	ImVec2 size(ImGui::GetContentRegionAvail().x, ImGui::GetFontSize() * 6.0f);
+	ImVec2 p0 = ImGui::GetCursorScreenPos();
+	ImVec2 p1(p0.x + size.x, p0.y + size.y);
+	ImGui::InvisibleButton("##histogram", size);
+	ImDrawList* dl = ImGui::GetWindowDrawList();
+	dl->AddRectFilled(p0, p1, ImGui::GetColorU32(ImGuiCol_FrameBg));
+	const ImU32 colors[4] = { IM_COL32(255, 80, 80, 255), IM_COL32(80, 220, 80, 255),
+	                          IM_COL32(100, 140, 255, 255), IM_COL32(220, 220, 220, 255) };
+	float logMax = logf(1.0f + maxCount);
+	ImVec2 points[texview::IMAGE_STATS_NUM_BINS];
+	for(int c=0; c < numChans; ++c) {
+		for(int i=0; i < numBins; ++i) {
+			float count = st.histogram[c][i];
+			float f = statsLogScale ? logf(1.0f + count) / logMax : count / maxCount;
+			points[i] = ImVec2(p0.x + (i + 0.5f) * size.x / numBins, p1.y - f * (size.y - 1.0f));
+		}
+		dl->AddPolyline(points, numBins, colors[c], ImDrawFlags_None, 1.0f);
+	}
+	float binWidth = (st.histoMax - st.histoMin) / numBins;
+	if(ImGui::IsItemHovered()) {
+		int bin = (int)((ImGui::GetIO().MousePos.x - p0.x) * numBins / size.x);
+		bin = std::min(std::max(bin, 0), numBins - 1);
+		float x = p0.x + (bin + 0.5f) * size.x / numBins;
+		dl->AddLine(ImVec2(x, p0.y), ImVec2(x, p1.y), ImGui::GetColorU32(ImGuiCol_Text, 0.5f));
+		ImGui::BeginTooltip();
+		ImGui::Text("%.4g to %.4g", st.histoMin + bin * binWidth, st.histoMin + (bin + 1) * binWidth);
+		for(int c=0; c < numChans; ++c) {
+			ImGui::Text("%c: %u", "RGBA"[c], st.histogram[c][bin]);
+		}
+		ImGui::EndTooltip();
+	}
+	ImGui::Text("%.4g", st.histoMin);
+	char maxStr[32];
+	snprintf(maxStr, sizeof(maxStr), "%.4g", st.histoMax);
+	ImGui::SameLine(size.x - ImGui::CalcTextSize(maxStr).x);
+	ImGui::TextUnformatted(maxStr);
+}
+
 static void DrawSidebar(GLFWwindow* window)
 {
 	ImGuiIO& io = ImGui::GetIO();
@@ -1096,13 +3093,76 @@ static void DrawSidebar(GLFWwindow* window)
 		if(ImGui::Button("Open File")) {
 			OpenFilePicker();
 		}
+		ImGui::SameLine();
+		if(ImGui::Button("Browser")) {
+			if(texview::BrowserWindowIsShown()) {
+				texview::BrowserWindowHide();
+			} else {
+				texview::BrowserWindowShow();
+			}
+		}
+		ImGui::SetItemTooltip("Show/hide a list of the textures in the current directory");
+		ImGui::SameLine();
+		if(ImGui::ArrowButton("##prevFile", ImGuiDir_Left)) {
+			OpenNeighbourFile(-1);
+		}
+		ImGui::SetItemTooltip("Open the previous file in the directory (Left Arrow or Page Up key)");
+		ImGui::SameLine(0.0f, style.ItemInnerSpacing.x);
+		if(ImGui::ArrowButton("##nextFile", ImGuiDir_Right)) {
+			OpenNeighbourFile(1);
+		}
+		ImGui::SetItemTooltip("Open the next file in the directory (Right Arrow or Page Down key)");
+
+		// one tab per view, each view has its own texture and settings
+		ImGuiTabBarFlags tabBarFlags = ImGuiTabBarFlags_AutoSelectNewTabs | ImGuiTabBarFlags_FittingPolicyScroll;
+		if(ImGui::BeginTabBar("##views", tabBarFlags)) {
+			int closeIdx = -1;
+			bool canClose = workspace.views.size() > 1;
+			for(int i = 0; i < (int)workspace.views.size(); ++i) {
+				TextureView* view = workspace.views[i].get();
+				char label[128];
+				// the ### part is the ID, so the tab stays the same when the texture changes
+				snprintf(label, sizeof(label), "%s###view%d", GetViewName(*view), view->id);
+				ImGuiTabItemFlags tabFlags = 0;
+				if(workspace.selectTabId == view->id) {
+					tabFlags |= ImGuiTabItemFlags_SetSelected;
+				}
+				bool open = true;
+				if(ImGui::BeginTabItem(label, canClose ? &open : NULL, tabFlags)) {
+					// don't switch to the tab ImGui still considers selected
+					// while the one selected with SelectView() isn't shown yet
+					if(i != workspace.current && workspace.selectTabId < 0) {
+						SelectView(i);
+						workspace.selectTabId = -1;
+					}
+					ImGui::EndTabItem();
+				}
+				if(!view->tex->name.empty()) {
+					ImGui::SetItemTooltip("%s", view->tex->name.c_str());
+				}
+				if(!open) {
+					closeIdx = i;
+				}
+			}
+			workspace.selectTabId = -1;
+			if(ImGui::TabItemButton("+", ImGuiTabItemFlags_Trailing | ImGuiTabItemFlags_NoTooltip)) {
+				AddView();
+				SelectView((int)workspace.views.size() - 1);
+			}
+			ImGui::SetItemTooltip("Add a view for another texture");
+			ImGui::EndTabBar();
+			if(closeIdx >= 0) {
+				CloseView(closeIdx);
+			}
+		}
+
 		float fontWrapWidth = ImGui::CalcTextSize("0123456789abcdef0123456789ABCDEF").x;
 		ImGui::PushTextWrapPos(fontWrapWidth);
 		float texWidth, texHeight;
-		curTex.GetSize(&texWidth, &texHeight);
-		bool isCubemap = curTex.IsCubemap();
-		bool texHasAlpha = (curTex.textureFlags & texview::TF_HAS_ALPHA) != 0;
-		bool texIsSRGB = (curTex.textureFlags & texview::TF_SRGB) != 0;
+		cur->tex->GetSize(&texWidth, &texHeight);
+		bool isCubemap = cur->tex->IsCubemap();
+		bool texHasAlpha = (cur->tex->textureFlags & texview::TF_HAS_ALPHA) != 0;
+		bool texIsSRGB = (cur->tex->textureFlags & texview::TF_SRGB) != 0;
 
 		float unindentWidth = style.FramePadding.x;
 		// move the treenode arrow a bit to the left to waste less space
@@ -1113,24 +3173,35 @@ static void DrawSidebar(GLFWwindow* window)
 			//ImGui::TextWrapped("File: %s", curTex.name.c_str());
 			ImGui::Text("File: ");
 			ImGui::BeginDisabled(true);
-			ImGui::TextWrapped("%s", curTex.name.c_str());
+			ImGui::TextWrapped("%s", cur->tex->name.c_str());
 			ImGui::EndDisabled();
-			ImGui::Text("Format: %s", curTex.formatName.c_str());
+			ImGui::Text("Format: %s", cur->tex->formatName.c_str());
 			ImGui::Text("Texture Size: %d x %d", (int)texWidth, (int)texHeight);
-			ImGui::Text("MipMap Levels: %d", curTex.GetNumMips());
-			int numCubeFaces = curTex.GetNumCubemapFaces();
-			if(curTex.IsArray()) {
-				ImGui::Text("%sArray Layers: %d", isCubemap ? "Cubemap " : "", curTex.GetNumElements());
+			ImGui::Text("MipMap Levels: %d", cur->tex->GetNumMips());
+			if(cur->tex->IsPyramid()) {
+				ImGui::Text("Shown through a pyramid (too big for GPU)");
+				ImGui::SetItemTooltip("It's split into tiles and only the visible ones of the level that "
+				                      "matches the zoom are on the GPU. The pyramid has %d levels and is "
+				                      "cached on disk. The mip level settings don't apply to it.",
+				                      cur->tex->GetNumPyramidLevels());
+			} else if(cur->tex->IsTiled()) {
+				ImGui::Text("Split into %d tiles (too big for GPU)", (int)cur->tex->glTiles.size());
+				ImGui::SetItemTooltip("Only the first %d mip levels are shown, and with linear filtering "
+				                      "there are faint seams between the tiles", cur->tex->numTileMips);
+			}
+			int numCubeFaces = cur->tex->GetNumCubemapFaces();
+			if(cur->tex->IsArray()) {
+				ImGui::Text("%sArray Layers: %d", isCubemap ? "Cubemap " : "", cur->tex->GetNumElements());
 			} else if(isCubemap) {
 				if(numCubeFaces == 6) {
 					ImGui::Text("Cubemap Texture");
 				} else {
-					ImGui::Text("Cubemap Texture with %d faces", curTex.GetNumCubemapFaces());
+					ImGui::Text("Cubemap Texture with %d faces", cur->tex->GetNumCubemapFaces());
 				}
 			}
 			const char* alphaStr = "no";
 			if(texHasAlpha) {
-				alphaStr = (curTex.textureFlags & texview::TF_PREMUL_ALPHA) ? "Premultiplied" : "Straight";
+				alphaStr = (cur->tex->textureFlags & texview::TF_PREMUL_ALPHA) ? "Premultiplied" : "Straight";
 			}
 			ImGui::Text("Alpha: %s - sRGB: %s", alphaStr, texIsSRGB ? "yes" : "no");
 			ImGui::Indent(unindentWidth);
@@ -1138,52 +3209,129 @@ static void DrawSidebar(GLFWwindow* window)
 		} else {
 			ImGui::SetItemTooltip( "Click to show information about the Texture" );
 		}
+		if(ImGui::TreeNode("Compare")) {
+			ImGui::Unindent(unindentWidth);
+			if(workspace.views.size() < 2) {
+				ImGui::TextWrapped("Open another texture in a new tab (+) to compare it with this one.");
+			} else {
+				TextureView* other = FindView(workspace.compareViewId);
+				if(other == nullptr || other == cur) {
+					// default to the next view
+					other = workspace.views[(workspace.current + 1) % workspace.views.size()].get();
+					workspace.compareViewId = other->id;
+				}
+				int mode = workspace.compareMode;
+				if(ImGui::Combo("Mode", &mode, "Off\0Side by Side\0Wipe\0Flicker\0Difference\0")) {
+					workspace.compareMode = (CompareMode)mode;
+				}
+				char label[128];
+				snprintf(label, sizeof(label), "%s###view%d", GetViewName(*other), other->id);
+				if(ImGui::BeginCombo("With", label)) {
+					for(const std::unique_ptr<TextureView>& view : workspace.views) {
+						if(view.get() == cur) {
+							continue;
+						}
+						snprintf(label, sizeof(label), "%s###view%d", GetViewName(*view), view->id);
+						if(ImGui::Selectable(label, view.get() == other)) {
+							workspace.compareViewId = view->id;
+						}
+					}
+					ImGui::EndCombo();
+				}
+				if(mode == COMPARE_WIPE) {
+					ImGui::SliderFloat("Wipe", &workspace.wipePos, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+					ImGui::SetItemTooltip("You can also move it by holding Shift while dragging with the mouse");
+				} else if(mode == COMPARE_FLICKER) {
+					ImGui::SliderFloat("Interval", &workspace.flickerInterval, 0.05f, 2.0f, "%.2f s", ImGuiSliderFlags_Logarithmic);
+				} else if(mode == COMPARE_DIFF) {
+					int diffMode = workspace.diffMode;
+					if(ImGui::Combo("Show", &diffMode, "Abs. Difference\0Error Heatmap\0SSIM Heatmap\0")) {
+						workspace.diffMode = (DiffMode)diffMode;
+					}
+					ImGui::SetItemTooltip("Abs. Difference: per color channel\n"
+					                      "Error Heatmap: biggest difference of all channels (incl. alpha)\n"
+					                      "SSIM Heatmap: 1 - SSIM of the luma in a 3x3 texel window");
+					ImGui::SliderFloat("Scale", &workspace.diffScale, 1.0f, 256.0f, "%.1f x", ImGuiSliderFlags_Logarithmic);
+					ImGui::SetItemTooltip("Differences are multiplied with this, so small ones become visible");
+				}
+				if(ImGui::Button("Swap")) {
+					int curId = cur->id;
+					SelectView(GetViewIndex(other));
+					workspace.compareViewId = curId;
+				}
+				ImGui::SetItemTooltip("Switch to the other texture's tab and compare it with this one");
+				if(mode != COMPARE_OFF) {
+					if(GetCompareView() == nullptr) {
+						ImGui::TextDisabled("Can't compare these textures (both must be loaded, Cubemaps and textures split into tiles aren't supported yet)");
+					} else {
+						ImGui::TextDisabled("The View Mode is ignored while comparing");
+						if(mode == COMPARE_DIFF) {
+							DrawDiffMetrics();
+						}
+					}
+				}
+			}
+			ImGui::Indent(unindentWidth);
+			ImGui::TreePop();
+		} else {
+			ImGui::SetItemTooltip( "Click to compare this texture with another one" );
+		}
+		if(ImGui::TreeNode("Statistics")) {
+			ImGui::Unindent(unindentWidth);
+			showTextureStats = true;
+			DrawTextureStats();
+			ImGui::Indent(unindentWidth);
+			ImGui::TreePop();
+		} else {
+			showTextureStats = false;
+			ImGui::SetItemTooltip( "Click to show the minimum, maximum, mean and histogram of each channel" );
+		}
 		ImGui::Indent(unindentWidth);
 
 		ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing();
 		ImGui::PushItemWidth(fontWrapWidth - ImGui::CalcTextSize("View Mode  ").x);
-		float zl = zoomLevel;
+		float zl = cur->zoomLevel;
 		if(ImGui::SliderFloat("Zoom", &zl, 0.0125, 50.0f, "%.3f", ImGuiSliderFlags_Logarithmic)) {
-			zoomLevel = zl;
+			cur->zoomLevel = zl;
 		}
 		if(ImGui::Button("Fit to Window")) {
-			ZoomFitToWindow(window, texWidth, texHeight, isCubemap);
+			ZoomFitToWindow(*cur, window, texWidth, texHeight, isCubemap);
 		}
 		ImGui::SameLine();
 		if(ImGui::Button("Reset Zoom")) {
-			zoomLevel = 1.0;
+			cur->zoomLevel = 1.0;
 		}
 		if(ImGui::Button("Reset Position")) {
-			transX = transY = 10.0;
+			cur->transX = cur->transY = 10.0;
 		}
 
 		ImGui::Spacing();
 
-		int vMode = viewMode;
-		if(curTex.IsCubemap()) {
-			ImGui::SliderInt("View Mode##cube", &cubeCrossVariant, 0, 3, "%d", ImGuiSliderFlags_AlwaysClamp);
+		int vMode = cur->viewMode;
+		if(cur->tex->IsCubemap()) {
+			ImGui::SliderInt("View Mode##cube", &cur->cubeCrossVariant, 0, 3, "%d", ImGuiSliderFlags_AlwaysClamp);
 
-			ImGui::SliderInt("Spacing", &spacingBetweenMips, 0, 32, "%d pix");
+			ImGui::SliderInt("Spacing", &cur->spacingBetweenMips, 0, 32, "%d pix");
 		} else { // not cubemap
 			if(ImGui::Combo("View Mode", &vMode, "Single\0MipMaps Compact\0MipMaps in Row\0MipMaps in Column\0Tiled\0")) {
 				// zoom out when not single, so everything (or at least more) is on the screen
 				// TODO: do some calculation for good amount of zooming out here?
-				if(viewMode == SINGLE && vMode != SINGLE) {
-					zoomLevel *= 0.5;
+				if(cur->viewMode == SINGLE && vMode != SINGLE) {
+					cur->zoomLevel *= 0.5;
 				}
-				viewMode = (ViewMode)vMode;
+				cur->viewMode = (ViewMode)vMode;
 			}
 			if(vMode != SINGLE && vMode != TILED) {
-				ImGui::Checkbox("Show MipMaps at same size", &viewAtSameSize);
-				ImGui::SliderInt("Spacing", &spacingBetweenMips, 0, 32, "%d pix");
+				ImGui::Checkbox("Show MipMaps at same size", &cur->viewAtSameSize);
+				ImGui::SliderInt("Spacing", &cur->spacingBetweenMips, 0, 32, "%d pix");
 				ImGui::SetItemTooltip("Spacing between mips");
 			} else if(vMode == TILED) {
-				ImGui::InputInt2("Tiles", numTiles);
+				ImGui::InputInt2("Tiles", cur->numTiles);
 			}
 		}
 		if(isCubemap || vMode == SINGLE || vMode == TILED) {
-			int mipLevel = mipmapLevel;
-			int maxLevel = std::max(0, curTex.GetNumMips() - 1);
+			int mipLevel = cur->mipmapLevel;
+			int maxLevel = std::max(0, cur->tex->GetNumMips() - 1);
 			if(maxLevel == 0) {
 				ImGui::BeginDisabled(true);
 				ImGui::SliderInt("LOD", &mipLevel, 0, 1, "0 (No Mip Maps)");
@@ -1195,49 +3343,49 @@ static void DrawSidebar(GLFWwindow* window)
 					mipLevel = std::min(mipLevel, maxLevel);
 					miplevelString = miplevelStrBuf;
 					float w, h;
-					curTex.GetMipSize(mipLevel, &w, &h);
+					cur->tex->GetMipSize(mipLevel, &w, &h);
 					snprintf(miplevelStrBuf, sizeof(miplevelStrBuf), "%d (%dx%d)",
 					         mipLevel, (int)w, (int)h);
 				}
 				if(ImGui::SliderInt("Mip Level", &mipLevel, -1, maxLevel,
 				                    miplevelString, ImGuiSliderFlags_AlwaysClamp)) {
-					mipmapLevel = mipLevel;
+					cur->mipmapLevel = mipLevel;
 				}
 			}
 		}
-		if(curTex.IsArray()) {
-			int numElems = curTex.GetNumElements();
-			ImGui::SliderInt("Layer", &textureArrayIndex, 0, numElems-1,
+		if(cur->tex->IsArray()) {
+			int numElems = cur->tex->GetNumElements();
+			ImGui::SliderInt("Layer", &cur->textureArrayIndex, 0, numElems-1,
 			                 "%d", ImGuiSliderFlags_AlwaysClamp);
 			ImGui::SetItemTooltip("Index in Texture Array");
 		}
 
 		ImGui::Spacing();
-		int texFilter = linearFilter;
+		int texFilter = cur->linearFilter;
 		if(ImGui::Combo("Filter", &texFilter, "Nearest\0Linear\0")) {
-			if(texFilter != (int)linearFilter) {
-				linearFilter = texFilter != 0;
-				UpdateTextureFilter();
+			if(texFilter != (int)cur->linearFilter) {
+				cur->linearFilter = texFilter != 0;
+				UpdateTextureFilter(*cur);
 			}
 		}
 
-		int srgb = overrideSRGB + 1 ; // -1 => 0 etc
+		int srgb = cur->overrideSRGB + 1 ; // -1 => 0 etc
 		const char* srgbStr = texIsSRGB ? "Tex Default (sRGB)\0Force Linear\0Force sRGB\0"
 		                                : "Tex Default (Linear)\0Force Linear\0Force sRGB\0";
 		if(ImGui::Combo("sRGB", &srgb, srgbStr)) {
-			overrideSRGB = srgb - 1;
+			cur->overrideSRGB = srgb - 1;
 		}
 		ImGui::SetItemTooltip("Override if texture is assumed to have sRGB or Linear data");
 
-		int alpha = overrideAlpha + 1; // -1 => 0 etc
+		int alpha = cur->overrideAlpha + 1; // -1 => 0 etc
 		const char* alphaSelStr = texHasAlpha ? "Tex Default (on)\0Force Disable\0Force Enable\0"
 		                                      : "Tex Default (off)\0Force Disable\0Force Enable\0";
 		if(ImGui::Combo("Alpha", &alpha, alphaSelStr)) {
-			overrideAlpha = alpha - 1;
+			cur->overrideAlpha = alpha - 1;
 		}
 		ImGui::SetItemTooltip("Enable/Disable Alpha Blending");
 
-		if(useSimpleSwizzle) {
+		if(cur->useSimpleSwizzle) {
 			ImGuiInputTextFlags swizzleInputFlags = ImGuiInputTextFlags_CallbackCharFilter;
 			ImGuiInputTextCallback swizzleInputCB = [](ImGuiInputTextCallbackData* data) -> int {
 				// according to the documentation, returning 1 here skips the char
@@ -1249,8 +3397,8 @@ static void DrawSidebar(GLFWwindow* window)
 				}
 				return strchr(validChars, c) == nullptr;
 			};
-			if( ImGui::InputText("Swizzle", simpleSwizzle, sizeof(simpleSwizzle), swizzleInputFlags, swizzleInputCB) ) {
-				UpdateShaders();
+			if( ImGui::InputText("Swizzle", cur->simpleSwizzle, sizeof(cur->simpleSwizzle), swizzleInputFlags, swizzleInputCB) ) {
+				UpdateShaders(*cur);
 			}
 			ImGui::SetItemTooltip("Swizzles the color channels. Four characters,\n"
 			                      "for the Red, Green, Blue and Alpha channels.\n"
@@ -1261,20 +3409,20 @@ static void DrawSidebar(GLFWwindow* window)
 		} else {
 			ImGui::Text("Using advanced Swizzling:");
 			ImGui::BeginDisabled();
-			ImGui::Text("%.*s ...", 24, swizzle.c_str());
+			ImGui::Text("%.*s ...", 24, cur->swizzle.c_str());
 			ImGui::EndDisabled();
 			if(ImGui::Button("Edit advanced Swizzling")) {
 				showGLSLeditWindow = true;
 			}
 		}
-		bool useAdvancedSwizzle = !useSimpleSwizzle;
+		bool useAdvancedSwizzle = !cur->useSimpleSwizzle;
 		if(ImGui::Checkbox("Use advanced Swizzling", &useAdvancedSwizzle)) {
-			useSimpleSwizzle = !useAdvancedSwizzle;
-			if(useAdvancedSwizzle && simpleSwizzle[0] == '\0') {
+			cur->useSimpleSwizzle = !useAdvancedSwizzle;
+			if(useAdvancedSwizzle && cur->simpleSwizzle[0] == '\0') {
 				// in case no simple swizzle was set, set the default one now
 				// so the advanced swizzle text isn't empty
-				memcpy(simpleSwizzle, "rgba", 5);
-				SetSwizzleFromSimple();
+				memcpy(cur->simpleSwizzle, "rgba", 5);
+				SetSwizzleFromSimple(*cur);
 			}
 		}
 
@@ -1298,6 +3446,32 @@ static void DrawSidebar(GLFWwindow* window)
 			updateFont = true;
 		}
 		ImGui::SetItemTooltip("Adjust the size of the UI (like this sidebar)");
+		ImGui::Checkbox("Redraw On Demand", &redrawOnDemand);
+		ImGui::SetItemTooltip("Only redraw when something changed instead of in every frame,\n"
+		                      "so texview uses (almost) no CPU and GPU time while idle");
+		ImGui::InputInt("Upload MB/frame", &uploadBudgetMB, 16, 64);
+		uploadBudgetMB = std::max(uploadBudgetMB, 0);
+		ImGui::SetItemTooltip("Big textures are uploaded to the GPU progressively, smallest mipmap\n"
+		                      "level first, at most this many MB per frame (0: all at once)");
+		ImGui::Checkbox("Generate Mipmaps", &generateMipmaps);
+		ImGui::SetItemTooltip("Create mipmaps on the CPU for images that don't have any (PNG, JPG, HDR, ...),\n"
+		                      "in linear light for sRGB images. Applies to images loaded afterwards");
+		if(generateMipmaps) {
+			ImGui::Combo("Mip Filter", &mipmapFilter, "Box\0Kaiser\0");
+			ImGui::SetItemTooltip("Box is fast, Kaiser (windowed sinc) keeps the smaller levels sharper");
+			ImGui::Checkbox("Treat Images as sRGB", &mipmapsAssumeSRGB);
+			ImGui::SetItemTooltip("Filter 8bit RGB(A) images (like PNGs and JPGs) in linear light.\n"
+			                      "Disable for data like normalmaps. 16bit and grayscale images are never\n"
+			                      "treated as sRGB (unless the file says so)");
+		}
+		ImGui::InputInt("Prefetch Files", &prefetchNumFiles, 1, 2);
+		prefetchNumFiles = std::max(prefetchNumFiles, 0);
+		ImGui::SetItemTooltip("How many of the next and previous files in the directory are loaded\n"
+		                      "in the background, so switching to them is instant");
+		ImGui::InputInt("Prefetch MB", &prefetchBudgetMB, 64, 256);
+		prefetchBudgetMB = std::max(prefetchBudgetMB, 0);
+		ImGui::SetItemTooltip("How much GPU memory (and about as much RAM) the prefetched textures may use\n"
+		                      "(%.1f MB in use)", GetPrefetchedBytes() / (1024.0 * 1024.0));
 		if(ImGui::Button("Show Log Window")) {
 			texview::LogWindowShow();
 		}
@@ -1475,19 +3649,35 @@ static void ImGuiFrame(GLFWwindow* window)
 
 	DrawSidebar(window);
 
+	DrawLoadingIndicator();
+
 	texview::DrawLogWindow(); // whether it should be shown is handled there (logging.cpp)
 
+	std::string fileToOpen;
+	if(texview::DrawBrowserWindow(cur->tex->name.c_str(), fileToOpen)) {
+		LoadTexture(fileToOpen.c_str());
+	}
+
 	// NOTE: ImGui::GetMouseDragDelta() is not very useful here, because
 	//       I only want drags that start outside of ImGui windows
 	bool mouseDown = ImGui::IsMouseDown(ImGuiMouseButton_Left);
 	if( dragging || (mouseDown && !ImGui::GetIO().WantCaptureMouse) ) {
 		ImVec2 mousePos = ImGui::GetMousePos();
 		if(mouseDown) {
-			if(dragging) {
+			if(dragging && ImGui::GetIO().KeyShift && workspace.compareMode == COMPARE_WIPE
+			   && GetCompareView() != nullptr) {
+				// move the wipe line to the mouse position, in texture coordinates
+				float xOffs = imguiMenuCollapsed ? 0.0f : imguiMenuWidth;
+				float texW, texH;
+				cur->tex->GetSize(&texW, &texH);
+				float x = (mousePos.x - xOffs - cur->transX) * ImGui::GetIO().DisplayFramebufferScale.x / cur->zoomLevel;
+				workspace.wipePos = std::min(std::max(x / texW, 0.0f), 1.0f);
+				lastDragPos = mousePos;
+			} else if(dragging) {
 				float dx = mousePos.x - lastDragPos.x;
 				float dy = mousePos.y - lastDragPos.y;
-				transX += dx;
-				transY += dy;
+				cur->transX += dx;
+				cur->transY += dy;
 				lastDragPos = mousePos;
 			} else {
 				lastDragPos = mousePos;
@@ -1498,6 +3688,14 @@ static void ImGuiFrame(GLFWwindow* window)
 		}
 	}
 
+	// ImGui needs more frames for tooltips that appear after a delay and the
+	// blinking text cursor, and while a widget is used (e.g. repeating buttons)
+	if(ImGui::GetIO().WantTextInput || ImGui::IsAnyItemHovered()) {
+		RequestRedrawAt(glfwGetTime() + 0.1);
+	} else if(ImGui::IsAnyItemActive()) {
+		RequestRedraw(1);
+	}
+
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
@@ -1540,6 +3738,7 @@ static double CalcZoomLevel(double zl, bool increase)
 
 static void myGLFWscrollfun(GLFWwindow* window, double xoffset, double yoffset)
 {
+	RequestRedraw();
 	// ImGui_ImplSDL2_ProcessEvent() doc says:
 	//   You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
 	//   - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
@@ -1549,11 +3748,12 @@ static void myGLFWscrollfun(GLFWwindow* window, double xoffset, double yoffset)
 		return;
 	}
 
-	zoomLevel = CalcZoomLevel(zoomLevel, yoffset > 0.0);
+	cur->zoomLevel = CalcZoomLevel(cur->zoomLevel, yoffset > 0.0);
 }
 
 static void myGLFWkeyfun(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+	RequestRedraw();
 	// while io.WantCaptureKeyboard doesn't work well (it returns true if an
 	// ImGui window has focus, even if no text input is active), this seems to
 	// do exactly what I want (i.e. let me ignore keys only if one is currently
@@ -1563,15 +3763,110 @@ static void myGLFWkeyfun(GLFWwindow* window, int key, int scancode, int action,
 	}
 
 	if(key == GLFW_KEY_R) {
-		zoomLevel = 1.0;
-		transX = 10.0;
-		transY = 10.0;
+		cur->zoomLevel = 1.0;
+		cur->transX = 10.0;
+		cur->transY = 10.0;
+	}
+
+	if(action != GLFW_RELEASE) {
+		// the arrow keys are used by ImGui's keyboard navigation
+		// if the user is currently using that
+		bool arrowsFree = !ImGui::GetIO().NavVisible;
+		if(key == GLFW_KEY_PAGE_DOWN || (key == GLFW_KEY_RIGHT && arrowsFree)) {
+			OpenNeighbourFile(1);
+		} else if(key == GLFW_KEY_PAGE_UP || (key == GLFW_KEY_LEFT && arrowsFree)) {
+			OpenNeighbourFile(-1);
+		}
 	}
 }
 
 static void myGLFWwindowcontentscalefun(GLFWwindow* window, float xscale, float yscale)
 {
 	updateFont = true;
+	RequestRedraw();
+}
+
+// the following callbacks are only needed to redraw on demand
+// (ImGui's GLFW backend calls them from its own callbacks)
+
+static void myGLFWcursorposfun(GLFWwindow* window, double x, double y)
+{
+	RequestRedraw();
+}
+
+static void myGLFWmousebuttonfun(GLFWwindow* window, int button, int action, int mods)
+{
+	RequestRedraw();
+}
+
+static void myGLFWcharfun(GLFWwindow* window, unsigned int codepoint)
+{
+	RequestRedraw();
+}
+
+static void myGLFWcursorenterfun(GLFWwindow* window, int entered)
+{
+	RequestRedraw();
+}
+
+static void myGLFWwindowfocusfun(GLFWwindow* window, int focused)
+{
+	RequestRedraw();
+}
+
+static void myGLFWframebuffersizefun(GLFWwindow* window, int width, int height)
+{
+	RequestRedraw();
+}
+
+// the window contents were damaged (e.g. by another window) and must be redrawn
+static void myGLFWwindowrefreshfun(GLFWwindow* window)
+{
+	RequestRedraw(1);
+}
+
+// true while something progresses from frame to frame, like loading textures or
+// uploading them to the GPU, then every frame is drawn (like without redrawOnDemand)
+static bool IsBusy()
+{
+	if(dragging) {
+		return true;
+	}
+	for(const std::unique_ptr<TextureView>& view : workspace.views) {
+		if(view->pendingLoad != nullptr || view->tex->IsUploadPending()) {
+			return true;
+		}
+	}
+	for(const std::shared_ptr<AsyncTextureLoad>& load : prefetchedLoads) {
+		if(!load->done.load(std::memory_order_acquire)) {
+			return true;
+		}
+		if(load->success && (!load->prefetchUploadStarted || load->tex.IsUploadPending())) {
+			return true;
+		}
+	}
+	return texview::BrowserNeedsRedraw();
+}
+
+// waits until there's input or something must be redrawn
+static void WaitForRedraw()
+{
+	// (log messages from worker threads wake it up with glfwPostEmptyEvent())
+	double logTimeout = texview::LogGetRedrawTimeout();
+	if(logTimeout >= 0.0) {
+		RequestRedrawAt(glfwGetTime() + logTimeout);
+	}
+	double timeout = redrawTime - glfwGetTime();
+	if(timeout == INFINITY) {
+		glfwWaitEvents();
+	} else if(timeout > 0.0) {
+		glfwWaitEventsTimeout(timeout);
+	} else {
+		glfwPollEvents();
+	}
+	if(glfwGetTime() >= redrawTime || texview::LogGetRedrawTimeout() == 0.0) {
+		RequestRedraw(1);
+	}
 }
 
 /*
@@ -1636,6 +3931,26 @@ int my_main(int argc, char** argv) // called from WinMain() in sys_win.cpp
 int main(int argc, char** argv)
 #endif
 {
+	if(argc > 1 && strcmp(argv[1], "--bench-decoders") == 0) {
+		// doesn't need a window or OpenGL, only measures the CPU decoders
+		texview::ThreadPoolInit();
+		texview::BenchmarkSoftwareDecoders();
+		texview::ThreadPoolShutdown();
+		return 0;
+	}
+	if(argc > 1 && strcmp(argv[1], "--info") == 0) {
+		// prints information about the given textures, also without a window or GPU
+		return texview::RunInfoCommand(argc - 2, argv + 2);
+	}
+	if(argc > 1 && strcmp(argv[1], "--validate") == 0) {
+		// checks DDS and KTX files for problems, for asset pipelines
+		return texview::RunValidateCommand(argc - 2, argv + 2);
+	}
+	if(argc > 1 && strcmp(argv[1], "--compare") == 0) {
+		// compares pairs of textures without a GPU, for regression tests in CI
+		return texview::RunCompareCommand(argc - 2, argv + 2);
+	}
+
 	int ret = 0;
 	static std::string imguiIniPath;
 	imguiIniPath = texview::GetSettingsDir();
@@ -1688,7 +4003,9 @@ int main(int argc, char** argv)
 	glfwSetWindowIcon(glfwWindow, 2, icons);
 
 	glfwMakeContextCurrent(glfwWindow);
-	gladLoadGL(glfwGetProcAddress);
+	int gladGLversion = gladLoadGL(glfwGetProcAddress);
+	texview::glVersion = GLAD_VERSION_MAJOR(gladGLversion) * 10 + GLAD_VERSION_MINOR(gladGLversion);
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
 
 	if(wantDebugContext) {
 		int haveDebugContext = glfwGetWindowAttrib(glfwWindow, GLFW_CONTEXT_DEBUG);
@@ -1718,6 +4035,13 @@ int main(int argc, char** argv)
 
 	glfwSetScrollCallback(glfwWindow, myGLFWscrollfun);
 	glfwSetKeyCallback(glfwWindow, myGLFWkeyfun);
+	glfwSetCursorPosCallback(glfwWindow, myGLFWcursorposfun);
+	glfwSetMouseButtonCallback(glfwWindow, myGLFWmousebuttonfun);
+	glfwSetCharCallback(glfwWindow, myGLFWcharfun);
+	glfwSetCursorEnterCallback(glfwWindow, myGLFWcursorenterfun);
+	glfwSetWindowFocusCallback(glfwWindow, myGLFWwindowfocusfun);
+	glfwSetFramebufferSizeCallback(glfwWindow, myGLFWframebuffersizefun);
+	glfwSetWindowRefreshCallback(glfwWindow, myGLFWwindowrefreshfun);
 
 	// Setup Dear ImGui context
 	IMGUI_CHECKVERSION();
@@ -1750,18 +4074,56 @@ int main(int argc, char** argv)
 		updateFont = true; // make sure font is loaded
 	}
 
+	// worker threads, used to load textures in the background
+	texview::ThreadPoolInit();
+
+	AddView();
+	SelectView(0);
+
 	// load texture once everything is set up, so if errors happen they can be displayed
 	if(argc > 1) {
 		LoadTexture(argv[1]);
 	}
 
+	bool busy = false; // see IsBusy()
 	while (!glfwWindowShouldClose(glfwWindow)) {
 		// Poll and handle events (inputs, window resize, etc.)
 		// You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
 		// - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
 		// - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
 		// Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
-		glfwPollEvents();
+		if(!redrawOnDemand || busy || redrawFrames > 0) {
+			glfwPollEvents();
+		} else {
+			WaitForRedraw();
+		}
+
+		CheckPendingTextureLoads();
+
+		// continue uploading the textures of the views, the current one first
+		if(cur->tex->IsUploadPending()) {
+			cur->tex->ContinueUpload(GetUploadBudget());
+		} else {
+			for(std::unique_ptr<TextureView>& view : workspace.views) {
+				if(view->tex->IsUploadPending()) {
+					view->tex->ContinueUpload(GetUploadBudget());
+					break;
+				}
+			}
+		}
+		UpdatePrefetch();
+
+		// once loading or uploading is done, the result must be shown
+		bool wasBusy = busy;
+		busy = IsBusy();
+		if(wasBusy && !busy) {
+			RequestRedraw();
+		}
+		if(redrawOnDemand && !busy && redrawFrames <= 0) {
+			continue; // nothing has changed
+		}
+		redrawFrames = std::max(redrawFrames - 1, 0);
+		redrawTime = INFINITY; // requested again while drawing, if still needed
 
 		GenericFrame(glfwWindow);
 
@@ -1775,15 +4137,38 @@ int main(int argc, char** argv)
 		}
 	}
 
-	if(shaderProgram != 0) {
-		glDeleteProgram(shaderProgram);
+	if(compareShader.program != 0) {
+		glDeleteProgram(compareShader.program);
+	}
+	if(compareShader.metricsProgram != 0) {
+		glDeleteProgram(compareShader.metricsProgram);
+	}
+	if(reduceProgram != 0) {
+		glDeleteProgram(reduceProgram);
+	}
+	for(GLuint prog : { statsShader.sumProgram, statsShader.histoProgram, statsReduceProgram }) {
+		if(prog != 0) {
+			glDeleteProgram(prog);
+		}
+	}
+	if(statsVAO != 0) {
+		glDeleteVertexArrays(1, &statsVAO);
 	}
 	glDeleteBuffers(1, &quadsVBO);
 	quadsVBO = 0;
 	glDeleteVertexArrays(1, &quadsVAO);
 	quadsVAO = 0;
 
-	curTex.Clear(); // also frees opengl texture which must happen before shutdown
+	// wait for texture loads that might still be running in the background
+	prefetchedLoads.clear(); // also frees their opengl textures
+	texview::BrowserShutdown();
+	texview::ThreadPoolShutdown();
+
+	// also frees opengl textures and shaders, which must happen before shutdown
+	// (the views' pending loads have already finished because of ThreadPoolShutdown())
+	cur = nullptr;
+	workspace.views.clear();
+	texview::UploadRingShutdown();
 
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
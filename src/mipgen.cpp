@@ -0,0 +1,478 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+// Generating mipmaps on the CPU for textures that only have one level (like all
+// images loaded with stb_image), so the mipmap views and the mip level slider
+// work for them as well.
+// The levels are filtered in linear light (sRGB data is linearized first) and
+// weighted by alpha, so transparent texels don't bleed their color into the
+// visible ones. Each level is created from the previous one, which is kept as
+// floats so the rounding errors don't add up. Bands of rows are filtered in
+// parallel, the filter loops use SSE or NEON for the four channels.
+
+#include <glad/gl.h>
+
+#include "texview.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define TV_HAVE_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define TV_HAVE_NEON 1
+	#include <arm_neon.h>
+#endif
+
+namespace texview {
+
+// like in texdecode.cpp, channel 4 is luminance (stored in red, green and blue)
+static const struct MipGenLayout {
+	uint32_t glFormat;
+	int numChans;
+	int chanOrder[4];
+} mipGenLayouts[] = {
+	{ GL_RED,             1, { 0, -1, -1, -1 } },
+	{ GL_RG,              2, { 0,  1, -1, -1 } },
+	{ GL_RGB,             3, { 0,  1,  2, -1 } },
+	{ GL_BGR,             3, { 2,  1,  0, -1 } },
+	{ GL_RGBA,            4, { 0,  1,  2,  3 } },
+	{ GL_BGRA,            4, { 2,  1,  0,  3 } },
+	{ GL_ALPHA,           1, { 3, -1, -1, -1 } },
+	{ GL_LUMINANCE,       1, { 4, -1, -1, -1 } },
+	{ GL_LUMINANCE_ALPHA, 2, { 4,  3, -1, -1 } },
+};
+
+struct MipGenParams {
+	const MipGenLayout* layout;
+	uint32_t glType;
+	uint32_t bytesPerChan;
+	bool srgb;          // RGB are converted to linear before filtering
+	bool alphaWeighted; // RGB are premultiplied with alpha while filtering
+	const float* toLinearLUT; // for srgb unorm data, indexed by the stored value
+	const float* srgb8Thresholds; // for srgb 8 bit data, see LinearToSRGB8()
+};
+
+// ############ Filters ############
+
+// the taps of a separable filter that scales srcSize texels to dstSize:
+// dst[i] = sum of weights[i * maxTaps + t] * src[first[i] + t] for t < num[i]
+struct FilterTaps {
+	std::vector<uint32_t> first;
+	std::vector<uint32_t> num;
+	std::vector<float> weights;
+	uint32_t maxTaps = 0;
+};
+
+// like NVTT's default mipmap filter
+static const double KAISER_WIDTH = 3.0; // radius, in destination texels
+static const double KAISER_ALPHA = 4.0;
+static const double PI = 3.14159265358979323846;
+
+// modified Bessel function of the first kind, order 0
+static double BesselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	const double halfX = x * 0.5;
+	for(int k=1; k < 50; ++k) {
+		double f = halfX / k;
+		term *= f * f;
+		sum += term;
+		if(term < sum * 1e-12) {
+			break;
+		}
+	}
+	return sum;
+}
+
+// x is in destination texels
+static double KaiserWeight(double x)
+{
+	if(fabs(x) >= KAISER_WIDTH) {
+		return 0.0;
+	}
+	double t = x / KAISER_WIDTH;
+	double window = BesselI0(KAISER_ALPHA * sqrt(1.0 - t*t)) / BesselI0(KAISER_ALPHA);
+	double sinc = (x == 0.0) ? 1.0 : sin(PI * x) / (PI * x);
+	return sinc * window;
+}
+
+static void CalcFilterTaps(MipFilter filter, uint32_t srcSize, uint32_t dstSize, FilterTaps& taps)
+{
+	// with odd sizes a destination texel covers 2.something source texels,
+	// so the weights are calculated for each one instead of just using 0.5, 0.5
+	const double scale = double(srcSize) / dstSize;
+	const double radius = ((filter == MF_KAISER) ? KAISER_WIDTH : 0.5) * scale; // in source texels
+	taps.maxTaps = uint32_t(ceil(2.0 * radius)) + 2;
+	taps.first.resize(dstSize);
+	taps.num.resize(dstSize);
+	taps.weights.assign(size_t(dstSize) * taps.maxTaps, 0.0f);
+
+	const int maxIdx = int(srcSize) - 1;
+	for(uint32_t i=0; i < dstSize; ++i) {
+		const double center = (i + 0.5) * scale;
+		const int lo = int(floor(center - radius));
+		const int hi = int(ceil(center + radius)); // exclusive
+		// texels outside the image are clamped to the border,
+		// their weights are added to those of the border texels
+		const int first = std::min(std::max(lo, 0), maxIdx);
+		const int last = std::min(std::max(hi - 1, 0), maxIdx);
+		float* w = &taps.weights[size_t(i) * taps.maxTaps];
+		double sum = 0.0;
+		for(int s = lo; s < hi; ++s) {
+			double wt;
+			if(filter == MF_KAISER) {
+				wt = KaiserWeight((s + 0.5 - center) / scale);
+			} else {
+				wt = std::min(s + 1.0, center + radius) - std::max(double(s), center - radius);
+				if(wt <= 0.0) {
+					continue;
+				}
+			}
+			int idx = std::min(std::max(s, 0), maxIdx);
+			w[idx - first] += float(wt);
+			sum += wt;
+		}
+		const float norm = float(1.0 / sum);
+		for(int t=0; t <= last - first; ++t) {
+			w[t] *= norm;
+		}
+		taps.first[i] = first;
+		taps.num[i] = last - first + 1;
+	}
+}
+
+// filters a row of float RGBA texels horizontally
+static void FilterRowH(const float* src, const FilterTaps& taps, uint32_t dstWidth, float* dst)
+{
+	for(uint32_t x=0; x < dstWidth; ++x) {
+		const float* s = src + size_t(taps.first[x]) * 4;
+		const float* w = &taps.weights[size_t(x) * taps.maxTaps];
+		const uint32_t num = taps.num[x];
+#if defined(TV_HAVE_SSE2)
+		__m128 acc = _mm_setzero_ps();
+		for(uint32_t t=0; t < num; ++t) {
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s + t*4), _mm_set1_ps(w[t])));
+		}
+		_mm_storeu_ps(dst + x*4, acc);
+#elif defined(TV_HAVE_NEON)
+		float32x4_t acc = vdupq_n_f32(0.0f);
+		for(uint32_t t=0; t < num; ++t) {
+			acc = vmlaq_n_f32(acc, vld1q_f32(s + t*4), w[t]);
+		}
+		vst1q_f32(dst + x*4, acc);
+#else
+		float acc[4] = {};
+		for(uint32_t t=0; t < num; ++t) {
+			for(int c=0; c < 4; ++c) {
+				acc[c] += s[t*4 + c] * w[t];
+			}
+		}
+		memcpy(dst + x*4, acc, sizeof(acc));
+#endif
+	}
+}
+
+// dst[i] += src[i] * weight, for the vertical filter. numFloats is a multiple of 4
+static void MulAddRow(float* dst, const float* src, float weight, size_t numFloats)
+{
+#if defined(TV_HAVE_SSE2)
+	const __m128 w = _mm_set1_ps(weight);
+	for(size_t i=0; i < numFloats; i += 4) {
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), w)));
+	}
+#elif defined(TV_HAVE_NEON)
+	for(size_t i=0; i < numFloats; i += 4) {
+		vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), weight));
+	}
+#else
+	for(size_t i=0; i < numFloats; ++i) {
+		dst[i] += src[i] * weight;
+	}
+#endif
+}
+
+// ############ Conversions ############
+
+static float SRGBToLinear(float v)
+{
+	return (v <= 0.04045f) ? v * (1.0f / 12.92f) : powf((v + 0.055f) * (1.0f / 1.055f), 2.4f);
+}
+
+static float LinearToSRGB(float v)
+{
+	return (v <= 0.0031308f) ? v * 12.92f : 1.055f * powf(v, 1.0f / 2.4f) - 0.055f;
+}
+
+static std::vector<float> CreateToLinearLUT(uint32_t maxVal)
+{
+	std::vector<float> lut(maxVal + 1);
+	for(uint32_t i=0; i <= maxVal; ++i) {
+		lut[i] = SRGBToLinear(float(i) / maxVal);
+	}
+	return lut;
+}
+
+static const float* GetToLinearLUT(uint32_t glType)
+{
+	// (initialization of static locals is thread-safe)
+	if(glType == GL_UNSIGNED_BYTE) {
+		static const std::vector<float> lut8 = CreateToLinearLUT(255);
+		return lut8.data();
+	} else if(glType == GL_UNSIGNED_SHORT) {
+		static const std::vector<float> lut16 = CreateToLinearLUT(65535);
+		return lut16.data();
+	}
+	return nullptr;
+}
+
+// for each 8 bit sRGB value i < 255, the linear value halfway to the next one
+static const float* GetSRGB8Thresholds()
+{
+	static const std::vector<float> thresholds = []() {
+		std::vector<float> ret(255);
+		for(int i=0; i < 255; ++i) {
+			ret[i] = SRGBToLinear((i + 0.5f) / 255.0f);
+		}
+		return ret;
+	}();
+	return thresholds.data();
+}
+
+// the same as uint8_t(LinearToSRGB(v) * 255.0f + 0.5f), but without powf()
+static inline uint8_t LinearToSRGB8(float v, const float* thresholds)
+{
+	return uint8_t(std::upper_bound(thresholds, thresholds + 255, v) - thresholds);
+}
+
+const float* GetSRGB8ToLinearLUT()
+{
+	return GetToLinearLUT(GL_UNSIGNED_BYTE);
+}
+
+uint8_t LinearToSRGB8(float v)
+{
+	return LinearToSRGB8(v, GetSRGB8Thresholds());
+}
+
+// converts a row of the texture's level 0 to what's filtered: float RGBA,
+// linear and premultiplied (if srgb and alphaWeighted). (ConvertToFloatRGBA()
+// supports all formats, but is a lot slower than this)
+static void LoadTexels(const uint8_t* src, uint32_t numTexels, const MipGenParams& p, float* rgba)
+{
+	const MipGenLayout& l = *p.layout;
+	const size_t bpp = l.numChans * p.bytesPerChan;
+	const float scale = (p.glType == GL_UNSIGNED_BYTE) ? (1.0f / 255.0f) : (1.0f / 65535.0f);
+	for(uint32_t i=0; i < numTexels; ++i) {
+		const uint8_t* s = src + i * bpp;
+		float* t = rgba + size_t(i) * 4;
+		t[0] = t[1] = t[2] = 0.0f;
+		t[3] = 1.0f;
+		for(int c=0; c < l.numChans; ++c) {
+			uint32_t raw;
+			float v;
+			if(p.glType == GL_UNSIGNED_BYTE) {
+				raw = s[c];
+				v = raw * scale;
+			} else if(p.glType == GL_UNSIGNED_SHORT) {
+				uint16_t v16;
+				memcpy(&v16, s + 2*c, 2);
+				raw = v16;
+				v = raw * scale;
+			} else {
+				memcpy(&v, s + 4*c, 4);
+				raw = 0;
+			}
+			const int dst = l.chanOrder[c];
+			if(p.srgb && dst != 3) {
+				v = (p.toLinearLUT != nullptr) ? p.toLinearLUT[raw] : SRGBToLinear(v);
+			}
+			if(dst == 4) {
+				t[0] = t[1] = t[2] = v;
+			} else {
+				t[dst] = v;
+			}
+		}
+		if(p.alphaWeighted) {
+			t[0] *= t[3];
+			t[1] *= t[3];
+			t[2] *= t[3];
+		}
+	}
+}
+
+static inline float Clamp01(float v)
+{
+	return (v > 0.0f) ? std::min(v, 1.0f) : 0.0f; // (also turns NaN into 0)
+}
+
+// converts filtered texels back to the texture's format
+static void StoreTexels(const float* rgba, size_t numTexels, const MipGenParams& p, uint8_t* dst)
+{
+	const MipGenLayout& l = *p.layout;
+	const size_t bpp = l.numChans * p.bytesPerChan;
+	for(size_t i=0; i < numTexels; ++i) {
+		float vals[5];
+		memcpy(vals, rgba + i*4, 4 * sizeof(float));
+		if(p.alphaWeighted && vals[3] > 0.0f) {
+			float invA = 1.0f / vals[3];
+			vals[0] *= invA;
+			vals[1] *= invA;
+			vals[2] *= invA;
+		}
+		if(p.srgb) {
+			for(int c=0; c < 3; ++c) {
+				vals[c] = (p.srgb8Thresholds != nullptr)
+				          ? LinearToSRGB8(vals[c], p.srgb8Thresholds) * (1.0f / 255.0f)
+				          : LinearToSRGB(Clamp01(vals[c]));
+			}
+		}
+		vals[4] = vals[0]; // luminance
+		uint8_t* d = dst + i * bpp;
+		for(int c=0; c < l.numChans; ++c) {
+			float v = vals[l.chanOrder[c]];
+			if(p.glType == GL_UNSIGNED_BYTE) {
+				d[c] = uint8_t(Clamp01(v) * 255.0f + 0.5f);
+			} else if(p.glType == GL_UNSIGNED_SHORT) {
+				uint16_t v16 = uint16_t(Clamp01(v) * 65535.0f + 0.5f);
+				memcpy(d + 2*c, &v16, 2);
+			} else {
+				memcpy(d + 4*c, &v, 4);
+			}
+		}
+	}
+}
+
+// ############ Texture::GenerateMipmaps() ############
+
+bool Texture::GenerateMipmaps(MipFilter filter, bool assumeSRGB, uint32_t maxSize)
+{
+	// (ktxTexture_GLUpload() uploads from ktxTex, not from elements)
+	if(GetNumMips() != 1 || (textureFlags & TF_COMPRESSED) || ktxTex != nullptr) {
+		return false;
+	}
+	const uint32_t width = elements[0][0].width;
+	const uint32_t height = elements[0][0].height;
+	if((width <= 1 && height <= 1) || (maxSize > 0 && (width > maxSize || height > maxSize))) {
+		return false;
+	}
+	MipGenParams params = {};
+	for(const MipGenLayout& l : mipGenLayouts) {
+		if(l.glFormat == glFormat) {
+			params.layout = &l;
+			break;
+		}
+	}
+	// the common formats of stb_image, DDS and KTX (for packed, signed
+	// and half float types it's not worth the trouble)
+	switch(glType) {
+		case GL_UNSIGNED_BYTE:  params.bytesPerChan = 1; break;
+		case GL_UNSIGNED_SHORT: params.bytesPerChan = 2; break;
+		case GL_FLOAT:          params.bytesPerChan = 4; break;
+	}
+	if(params.layout == nullptr || params.bytesPerChan == 0) {
+		LogInfo("Can't generate mipmaps for '%s' (%s)\n", name.c_str(), formatName.c_str());
+		return false;
+	}
+	const MipGenLayout& layout = *params.layout;
+	params.glType = glType;
+	// stb_image doesn't tell, but 8 bit color images (PNG, JPG etc) are usually sRGB.
+	// 16 bit and grayscale ones are more likely data (heightmaps, masks), so they're
+	// only linearized when marked as sRGB (which doesn't happen with stb_image)
+	const bool hasColor = (layout.chanOrder[0] == 0 || layout.chanOrder[0] == 2 || layout.chanOrder[0] == 4);
+	params.srgb = hasColor && ((textureFlags & TF_SRGB)
+	              || (assumeSRGB && fileType == FT_STB && glType == GL_UNSIGNED_BYTE && layout.numChans >= 3));
+	params.alphaWeighted = (textureFlags & TF_HAS_ALPHA) && !(textureFlags & TF_PREMUL_ALPHA)
+	                       && layout.chanOrder[0] != 3 && layout.numChans > 1;
+	params.toLinearLUT = params.srgb ? GetToLinearLUT(glType) : nullptr;
+	params.srgb8Thresholds = (params.srgb && glType == GL_UNSIGNED_BYTE) ? GetSRGB8Thresholds() : nullptr;
+
+	const uint32_t bytesPerTexel = layout.numChans * params.bytesPerChan;
+	int numLevels = 1;
+	size_t elemSize = 0;
+	for(uint32_t w = width, h = height; w > 1 || h > 1; ++numLevels) {
+		w = std::max(w >> 1, 1u);
+		h = std::max(h >> 1, 1u);
+		elemSize += size_t(w) * h * bytesPerTexel;
+	}
+	generatedMips.resize(elemSize * elements.size());
+
+	double startTime = GetTimeSeconds();
+	size_t offset = 0;
+	std::vector<float> prevLevel; // linear (premultiplied) float RGBA
+	std::vector<float> curLevel;
+	FilterTaps hTaps, vTaps;
+	for(std::vector<MipLevel>& mips : elements) {
+		const MipLevel& ml0 = mips[0];
+		// (rows of DDS data and stb_image images aren't padded)
+		const size_t srcPitch = ml0.size / ml0.height;
+		uint32_t sw = width;
+		uint32_t sh = height;
+		for(int level=1; level < numLevels; ++level) {
+			const uint32_t dw = std::max(sw >> 1, 1u);
+			const uint32_t dh = std::max(sh >> 1, 1u);
+			CalcFilterTaps(filter, sw, dw, hTaps);
+			CalcFilterTaps(filter, sh, dh, vTaps);
+			curLevel.resize(size_t(dw) * dh * 4);
+			uint8_t* out = generatedMips.data() + offset;
+
+			const uint32_t rowsPerBand = std::max(1u, (128u * 1024u) / dw);
+			const int numBands = int((dh + rowsPerBand - 1) / rowsPerBand);
+			ParallelFor(numBands, [&](int band) {
+				const uint32_t y0 = band * rowsPerBand;
+				const uint32_t y1 = std::min(y0 + rowsPerBand, dh);
+				// the source rows that this band's taps need
+				const uint32_t srcY0 = vTaps.first[y0];
+				const uint32_t numSrcRows = vTaps.first[y1-1] + vTaps.num[y1-1] - srcY0;
+				std::vector<float> srcRows;
+				const float* src;
+				if(level == 1) {
+					srcRows.resize(size_t(numSrcRows) * sw * 4);
+					for(uint32_t r=0; r < numSrcRows; ++r) {
+						const uint8_t* srcRow = (const uint8_t*)ml0.data + (srcY0 + r) * srcPitch;
+						LoadTexels(srcRow, sw, params, srcRows.data() + size_t(r) * sw * 4);
+					}
+					src = srcRows.data();
+				} else {
+					src = prevLevel.data() + size_t(srcY0) * sw * 4;
+				}
+				std::vector<float> hRows(size_t(numSrcRows) * dw * 4);
+				for(uint32_t r=0; r < numSrcRows; ++r) {
+					FilterRowH(src + size_t(r) * sw * 4, hTaps, dw, hRows.data() + size_t(r) * dw * 4);
+				}
+				for(uint32_t y=y0; y < y1; ++y) {
+					float* dstRow = curLevel.data() + size_t(y) * dw * 4;
+					std::fill(dstRow, dstRow + size_t(dw) * 4, 0.0f);
+					const float* w = &vTaps.weights[size_t(y) * vTaps.maxTaps];
+					for(uint32_t t=0; t < vTaps.num[y]; ++t) {
+						const float* hRow = hRows.data() + size_t(vTaps.first[y] + t - srcY0) * dw * 4;
+						MulAddRow(dstRow, hRow, w[t], size_t(dw) * 4);
+					}
+					StoreTexels(dstRow, dw, params, out + size_t(y) * dw * bytesPerTexel);
+				}
+			});
+
+			uint32_t size = dw * dh * bytesPerTexel;
+			mips.push_back(MipLevel(dw, dh, out, size));
+			offset += size;
+			prevLevel.swap(curLevel);
+			sw = dw;
+			sh = dh;
+		}
+	}
+	double ms = (GetTimeSeconds() - startTime) * 1000.0;
+	LogInfo("Generated %d mipmap levels for '%s' (%s filter%s%s) in %.2f ms\n", numLevels - 1,
+	        name.c_str(), (filter == MF_KAISER) ? "Kaiser" : "box", params.srgb ? ", sRGB" : "",
+	        params.alphaWeighted ? ", alpha weighted" : "", ms);
+	formatName += " (mipmaps generated)";
+	return true;
+}
+
+} //namespace texview
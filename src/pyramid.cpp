@@ -0,0 +1,832 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+// out-of-core multiresolution pyramids for 2D textures that are too big for
+// OpenGL, like huge scans or terrain heightmaps.
+// The texture and its downscaled versions (each level is half as big as the
+// previous one, rounded up, until it fits into a single tile) are split into
+// tiles of PYRAMID_TILE_SIZE x PYRAMID_TILE_SIZE texels that are stored in a
+// cache file in GetSettingsDir()/pyramids/. That file is memory-mapped and only
+// the tiles that are visible at the current zoom are uploaded to the GPU,
+// into an LRU cache of OpenGL textures that's shared by all pyramids.
+// The file is built once per texture (until the texture's file is modified)
+// by a job in a worker thread, one row of tiles of level 0 at a time: its tiles
+// are converted (in parallel), written to the file and downscaled into the
+// row buffer of level 1, whose rows are written (and downscaled further) once
+// they're complete. So the memory needed for building only depends on the width
+// of the texture, not on its size. However the source texture itself must be
+// in memory: DDS files are memory-mapped, but images loaded with stb_image
+// (PNG, JPG, HDR, ...) are decoded into RAM as a whole by Texture::Load(),
+// so those can't be bigger than the available memory.
+// sRGB textures are downscaled in linear light, like the mipmaps in mipgen.cpp.
+// The file looks like:
+//   PyramidHeader
+//   the texels of all levels, the finest level first. Each level is stored
+//   as rows of tiles and each tile as its tightly packed rows, the tiles at the
+//   right and bottom borders are smaller, so the offset of each tile is known
+
+#include <glad/gl.h>
+
+#include "texview.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace texview {
+
+enum {
+	// small enough to only upload what's visible (and to keep the row buffers
+	// used for building small), big enough to not need too many draw calls
+	PYRAMID_TILE_SIZE = 256
+};
+
+enum PyramidTexelFormat {
+	PTF_RGBA8 = 1,
+	PTF_RGBA16,
+	PTF_RGBA32F
+};
+
+struct PyramidHeader {
+	char magic[8]; // "TVPYRAMD"
+	uint32_t version;
+	uint32_t complete; // 0 while the file is being written
+	uint64_t sourceKey; // ThumbCacheGetKey() of the texture's file
+	uint32_t width; // of level 0
+	uint32_t height;
+	uint32_t tileSize;
+	uint32_t texelFormat; // PyramidTexelFormat
+};
+
+static const char pyramidMagic[8] = { 'T', 'V', 'P', 'Y', 'R', 'A', 'M', 'D' };
+static const uint32_t pyramidVersion = 2; // 2: sRGB textures downscaled in linear light
+
+// when a new pyramid has been built, the oldest ones are deleted
+// if all of them together are bigger than this
+static const uint64_t pyramidCacheMaxBytes = 16ull << 30;
+// how much GPU memory the tiles of all pyramids may use
+static const size_t pyramidTileMaxBytes = 512 << 20;
+
+struct PyramidLevel {
+	uint32_t width;
+	uint32_t height;
+	uint32_t numTilesX;
+	uint32_t numTilesY;
+	uint64_t offset; // in the file
+};
+
+static uint32_t GetBytesPerTexel(uint32_t texelFormat)
+{
+	switch(texelFormat) {
+		case PTF_RGBA8:   return 4;
+		case PTF_RGBA16:  return 8;
+		case PTF_RGBA32F: return 16;
+	}
+	return 0;
+}
+
+// sets levels and returns the size of the whole file
+static uint64_t CalcPyramidLevels(uint32_t width, uint32_t height, uint32_t bytesPerTexel,
+                                  std::vector<PyramidLevel>& levels)
+{
+	const uint32_t ts = PYRAMID_TILE_SIZE;
+	uint64_t offset = sizeof(PyramidHeader);
+	levels.clear();
+	while(true) {
+		PyramidLevel lv = { width, height, (width + ts - 1) / ts, (height + ts - 1) / ts, offset };
+		levels.push_back(lv);
+		offset += uint64_t(width) * height * bytesPerTexel;
+		if(width <= ts && height <= ts) {
+			break;
+		}
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+	}
+	return offset;
+}
+
+// size of the tile at tx, ty (they're only smaller than PYRAMID_TILE_SIZE at the borders)
+static void GetTileSize(const PyramidLevel& lv, uint32_t tx, uint32_t ty, uint32_t* tw, uint32_t* th)
+{
+	*tw = std::min<uint32_t>(PYRAMID_TILE_SIZE, lv.width - tx * PYRAMID_TILE_SIZE);
+	*th = std::min<uint32_t>(PYRAMID_TILE_SIZE, lv.height - ty * PYRAMID_TILE_SIZE);
+}
+
+static uint64_t GetTileOffset(const PyramidLevel& lv, uint32_t tx, uint32_t ty, uint32_t bytesPerTexel)
+{
+	uint32_t tw, th;
+	GetTileSize(lv, tx, ty, &tw, &th);
+	// all rows of tiles but the last are PYRAMID_TILE_SIZE high
+	uint64_t rowOffset = uint64_t(ty) * PYRAMID_TILE_SIZE * lv.width * bytesPerTexel;
+	return lv.offset + rowOffset + uint64_t(tx) * PYRAMID_TILE_SIZE * th * bytesPerTexel;
+}
+
+static std::string GetPyramidCacheDir()
+{
+	std::string ret = GetSettingsDir();
+#ifdef _WIN32
+	ret += "\\pyramids";
+#else
+	ret += "/pyramids";
+#endif
+	return ret;
+}
+
+struct ResidentTile {
+	Texture::TilePyramid* pyramid;
+	uint64_t key; // see GetTileKey()
+	unsigned int glTextureHandle;
+	size_t bytes;
+	uint32_t lastUse; // pyramidUseCounter when it was last used
+};
+
+// the tiles of all pyramids that are on the GPU, the most recently used one first
+static std::list<ResidentTile> residentTiles;
+static size_t residentTileBytes = 0;
+// incremented for each GetPyramidTiles() call, tiles used in the
+// current call aren't evicted to make space for other tiles
+static uint32_t pyramidUseCounter = 0;
+
+static uint64_t GetTileKey(int level, uint32_t tx, uint32_t ty)
+{
+	return (uint64_t(level) << 56) | (uint64_t(ty) << 28) | tx;
+}
+
+struct Texture::TilePyramid {
+	enum State {
+		BUILDING,
+		BUILT, // but not opened yet
+		FAILED,
+		OPEN
+	};
+	// mutex protects state, jobRunning and cancelled
+	std::mutex mutex;
+	std::condition_variable condVar;
+	State state = BUILDING;
+	bool jobRunning = false;
+	bool cancelled = false;
+	std::atomic<uint32_t> rowsDone{0}; // of level 0, while building
+
+	std::string path; // of the cache file
+	std::string name; // of the texture, for log messages
+	uint64_t sourceKey = 0;
+	uint32_t texelFormat = 0;
+	uint32_t bytesPerTexel = 0;
+	uint64_t fileSize = 0;
+	std::vector<PyramidLevel> levels;
+
+	// the rest is only used in the main thread, once it's OPEN
+	MemMappedFile* mmf = nullptr;
+	GLenum glInternalFormat = 0;
+	GLenum glType = 0;
+	// the only tile of the coarsest level, it's always on the GPU
+	unsigned int topTile = 0;
+	std::unordered_map<uint64_t, std::list<ResidentTile>::iterator> tiles;
+
+	bool Open();
+	void Close();
+	unsigned int UploadTile(int level, uint32_t tx, uint32_t ty);
+	// returns the tile if it's on the GPU (and marks it as used), otherwise 0
+	unsigned int GetTile(int level, uint32_t tx, uint32_t ty);
+	// with texture coordinates for the part of the tile that's drawn
+	bool AddTile(int level, uint32_t tx, uint32_t ty, float x0, float y0, float x1, float y1,
+	             std::vector<PyramidTile>& out);
+};
+
+// what the building job needs from the Texture, which might be moved or destroyed
+// while it runs (but then DeletePyramid() waits for the job before freeing the data)
+struct PyramidSource {
+	Texture::MipLevel level0;
+	uint32_t dataFormat;
+	uint32_t glFormat;
+	uint32_t glType;
+	bool isCompressed;
+};
+
+static bool WriteAt(FILE* f, uint64_t offset, const void* data, size_t size)
+{
+	return FSeek64(f, offset) && (size == 0 || fwrite(data, size, 1, f) == 1);
+}
+
+template<typename C>
+static inline void AverageTexels(const C* a, const C* b, const C* c, const C* d, C* out)
+{
+	for(int i=0; i < 4; ++i) {
+		out[i] = C((uint32_t(a[i]) + b[i] + c[i] + d[i] + 2) / 4);
+	}
+}
+
+template<>
+inline void AverageTexels<float>(const float* a, const float* b, const float* c, const float* d, float* out)
+{
+	for(int i=0; i < 4; ++i) {
+		out[i] = 0.25f * (a[i] + b[i] + c[i] + d[i]);
+	}
+}
+
+// for GL_SRGB8_ALPHA8 tiles, RGB are averaged in linear light
+static inline void AverageTexelsSRGB8(const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* d,
+                                      uint8_t* out, const float* toLinear)
+{
+	for(int i=0; i < 3; ++i) {
+		out[i] = LinearToSRGB8(0.25f * (toLinear[a[i]] + toLinear[b[i]] + toLinear[c[i]] + toLinear[d[i]]));
+	}
+	out[3] = uint8_t((uint32_t(a[3]) + b[3] + c[3] + d[3] + 2) / 4);
+}
+
+struct PyramidBuilder {
+	Texture::TilePyramid& pyr;
+	const PyramidSource& src;
+	FILE* f = nullptr;
+	// for each level, the row of tiles that's currently being filled, in the layout of the file
+	std::vector<std::vector<uint8_t>> rowBuffers;
+	std::atomic<bool> failed{false};
+
+	PyramidBuilder(Texture::TilePyramid& pyr_, const PyramidSource& src_) : pyr(pyr_), src(src_) {}
+
+	// the texel at x (in the level) and y (relative to the first row of the row buffer)
+	uint8_t* GetTexel(int level, uint32_t rowHeight, uint32_t x, uint32_t y)
+	{
+		const PyramidLevel& lv = pyr.levels[level];
+		uint32_t tx = x / PYRAMID_TILE_SIZE;
+		uint32_t tw = std::min<uint32_t>(PYRAMID_TILE_SIZE, lv.width - tx * PYRAMID_TILE_SIZE);
+		size_t idx = size_t(tx) * PYRAMID_TILE_SIZE * rowHeight + size_t(y) * tw + (x - tx * PYRAMID_TILE_SIZE);
+		return rowBuffers[level].data() + idx * pyr.bytesPerTexel;
+	}
+
+	// converts the tiles of the given row of level 0 into its row buffer
+	void ConvertRow(uint32_t ty)
+	{
+		const PyramidLevel& lv = pyr.levels[0];
+		ParallelFor(lv.numTilesX, [&](int tx) {
+			uint32_t tw, th;
+			GetTileSize(lv, tx, ty, &tw, &th);
+			std::vector<float> rgba(size_t(tw) * th * 4);
+			if(!ConvertImageRegionToFloatRGBA(src.level0, src.dataFormat, src.glFormat, src.glType,
+			                                  src.isCompressed, tx * PYRAMID_TILE_SIZE,
+			                                  ty * PYRAMID_TILE_SIZE, tw, th, rgba.data())) {
+				failed = true;
+				return;
+			}
+			uint8_t* dst = GetTexel(0, th, tx * PYRAMID_TILE_SIZE, 0);
+			const size_t n = rgba.size();
+			if(pyr.texelFormat == PTF_RGBA8) {
+				for(size_t i=0; i < n; ++i) {
+					float v = std::min(std::max(rgba[i], 0.0f), 1.0f);
+					dst[i] = uint8_t(v * 255.0f + 0.5f);
+				}
+			} else if(pyr.texelFormat == PTF_RGBA16) {
+				uint16_t* dst16 = (uint16_t*)dst;
+				for(size_t i=0; i < n; ++i) {
+					float v = std::min(std::max(rgba[i], 0.0f), 1.0f);
+					dst16[i] = uint16_t(v * 65535.0f + 0.5f);
+				}
+			} else {
+				memcpy(dst, rgba.data(), n * sizeof(float));
+			}
+		});
+	}
+
+	// averages each 2x2 texels with avg(a, b, c, d, out), like AverageTexels<C>()
+	template<typename C, typename AvgFn>
+	void DownscaleRows(int level, uint32_t ty, uint32_t firstRow, uint32_t endRow, AvgFn avg)
+	{
+		const PyramidLevel& lv = pyr.levels[level];
+		const PyramidLevel& next = pyr.levels[level + 1];
+		const uint32_t srcRowHeight = std::min<uint32_t>(PYRAMID_TILE_SIZE, lv.height - ty * PYRAMID_TILE_SIZE);
+		const uint32_t ty1 = ty / 2;
+		const uint32_t dstRowHeight = std::min<uint32_t>(PYRAMID_TILE_SIZE, next.height - ty1 * PYRAMID_TILE_SIZE);
+		const uint32_t srcStart = ty * PYRAMID_TILE_SIZE;
+		ParallelFor(int(endRow - firstRow), [&](int i) {
+			uint32_t y = firstRow + i;
+			// both source rows are in this row of tiles, because PYRAMID_TILE_SIZE is even
+			uint32_t sy0 = 2 * y - srcStart;
+			uint32_t sy1 = std::min(2 * y + 1, lv.height - 1) - srcStart;
+			for(uint32_t x=0; x < next.width; ++x) {
+				uint32_t sx0 = 2 * x;
+				uint32_t sx1 = std::min(2 * x + 1, lv.width - 1);
+				avg((const C*)GetTexel(level, srcRowHeight, sx0, sy0),
+				    (const C*)GetTexel(level, srcRowHeight, sx1, sy0),
+				    (const C*)GetTexel(level, srcRowHeight, sx0, sy1),
+				    (const C*)GetTexel(level, srcRowHeight, sx1, sy1),
+				    (C*)GetTexel(level + 1, dstRowHeight, x, y - ty1 * PYRAMID_TILE_SIZE));
+			}
+		});
+	}
+
+	// writes the row buffer of level, that now contains row ty, to the file
+	// and downscales it into the row buffer of the next level
+	void FinishRow(int level, uint32_t ty)
+	{
+		const PyramidLevel& lv = pyr.levels[level];
+		uint32_t rowHeight = std::min<uint32_t>(PYRAMID_TILE_SIZE, lv.height - ty * PYRAMID_TILE_SIZE);
+		uint64_t offset = GetTileOffset(lv, 0, ty, pyr.bytesPerTexel);
+		if(!WriteAt(f, offset, rowBuffers[level].data(), size_t(rowHeight) * lv.width * pyr.bytesPerTexel)) {
+			failed = true;
+			return;
+		}
+		if(level + 1 == (int)pyr.levels.size()) {
+			return;
+		}
+		// the rows of the next level that this row of tiles covers
+		uint32_t firstRow = (ty * PYRAMID_TILE_SIZE) / 2;
+		uint32_t endRow = (ty * PYRAMID_TILE_SIZE + rowHeight + 1) / 2;
+		switch(pyr.texelFormat) {
+			case PTF_RGBA8:
+				if(pyr.glInternalFormat == GL_SRGB8_ALPHA8) {
+					const float* toLinear = GetSRGB8ToLinearLUT();
+					DownscaleRows<uint8_t>(level, ty, firstRow, endRow,
+						[toLinear](const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* d, uint8_t* out) {
+							AverageTexelsSRGB8(a, b, c, d, out, toLinear);
+						});
+				} else {
+					DownscaleRows<uint8_t>(level, ty, firstRow, endRow, AverageTexels<uint8_t>);
+				}
+				break;
+			case PTF_RGBA16:  DownscaleRows<uint16_t>(level, ty, firstRow, endRow, AverageTexels<uint16_t>); break;
+			case PTF_RGBA32F: DownscaleRows<float>(level, ty, firstRow, endRow, AverageTexels<float>); break;
+		}
+		// a row of tiles of the next level is made of two rows of this level
+		if((ty % 2) == 1 || ty + 1 == lv.numTilesY) {
+			FinishRow(level + 1, ty / 2);
+		}
+	}
+
+	bool Build(const char* tmpPath)
+	{
+		f = FOpenUTF8(tmpPath, "wb");
+		if(f == nullptr) {
+			LogWarn("Couldn't create pyramid cache file '%s'\n", tmpPath);
+			return false;
+		}
+		PyramidHeader header = {};
+		memcpy(header.magic, pyramidMagic, sizeof(pyramidMagic));
+		header.version = pyramidVersion;
+		header.complete = 0;
+		header.sourceKey = pyr.sourceKey;
+		header.width = pyr.levels[0].width;
+		header.height = pyr.levels[0].height;
+		header.tileSize = PYRAMID_TILE_SIZE;
+		header.texelFormat = pyr.texelFormat;
+		bool ok = WriteAt(f, 0, &header, sizeof(header));
+
+		rowBuffers.resize(pyr.levels.size());
+		for(size_t l=0; l < pyr.levels.size(); ++l) {
+			rowBuffers[l].resize(size_t(PYRAMID_TILE_SIZE) * pyr.levels[l].width * pyr.bytesPerTexel);
+		}
+		const uint32_t numRows = pyr.levels[0].numTilesY;
+		for(uint32_t ty=0; ok && ty < numRows; ++ty) {
+			{
+				std::lock_guard<std::mutex> lock(pyr.mutex);
+				if(pyr.cancelled) {
+					ok = false;
+					break;
+				}
+			}
+			ConvertRow(ty);
+			if(!failed) {
+				FinishRow(0, ty);
+			}
+			ok = !failed;
+			pyr.rowsDone = ty + 1;
+		}
+		if(ok) {
+			// only now the file is valid
+			header.complete = 1;
+			ok = WriteAt(f, 0, &header, sizeof(header));
+		}
+		ok = (fclose(f) == 0) && ok;
+		f = nullptr;
+		return ok;
+	}
+};
+
+// deletes the oldest pyramids (except for keepPath) if they're too big all together
+static void TrimPyramidCache(const std::string& keepPath)
+{
+	std::string dir = GetPyramidCacheDir();
+	std::vector<std::string> files;
+	if(!ListDirectory(dir.c_str(), &files, nullptr)) {
+		return;
+	}
+	struct CacheFile {
+		std::string path;
+		uint64_t size;
+		int64_t modTime;
+	};
+	std::vector<CacheFile> cacheFiles;
+	uint64_t totalSize = 0;
+	for(const std::string& name : files) {
+		size_t len = name.length();
+		if(len < 6 || name.compare(len - 6, 6, ".tvpyr") != 0) {
+			continue; // including .tmp files of pyramids that are currently being built
+		}
+		CacheFile cf;
+#ifdef _WIN32
+		cf.path = dir + "\\" + name;
+#else
+		cf.path = dir + "/" + name;
+#endif
+		if(GetFileSizeAndModTime(cf.path.c_str(), &cf.size, &cf.modTime)) {
+			totalSize += cf.size;
+			cacheFiles.push_back(cf);
+		}
+	}
+	std::sort(cacheFiles.begin(), cacheFiles.end(), [](const CacheFile& a, const CacheFile& b) -> bool {
+		return a.modTime < b.modTime;
+	});
+	for(const CacheFile& cf : cacheFiles) {
+		if(totalSize <= pyramidCacheMaxBytes) {
+			break;
+		}
+		if(cf.path != keepPath && RemoveFile(cf.path.c_str())) {
+			LogInfo("Deleted the old pyramid cache file '%s'\n", cf.path.c_str());
+			totalSize -= cf.size;
+		}
+	}
+}
+
+static void BuildPyramid(std::shared_ptr<Texture::TilePyramid> pyrPtr, const PyramidSource& src)
+{
+	Texture::TilePyramid& pyr = *pyrPtr;
+	{
+		std::lock_guard<std::mutex> lock(pyr.mutex);
+		if(pyr.cancelled) {
+			pyr.state = Texture::TilePyramid::FAILED;
+			return;
+		}
+		pyr.jobRunning = true;
+	}
+	double startTime = GetTimeSeconds();
+	// several textures could be built from the same file at the same time
+	static std::atomic<int> tmpCounter{0};
+	std::string tmpPath = pyr.path + ".tmp" + std::to_string(tmpCounter++);
+	PyramidBuilder builder(pyr, src);
+	bool ok = builder.Build(tmpPath.c_str());
+	builder.rowBuffers.clear();
+	if(ok) {
+		ok = RenameFile(tmpPath.c_str(), pyr.path.c_str());
+	} else {
+		RemoveFile(tmpPath.c_str());
+	}
+	if(ok) {
+		LogInfo("Built the pyramid of '%s' with %d levels (%.1f MB) in %.2f s\n", pyr.name.c_str(),
+		        (int)pyr.levels.size(), pyr.fileSize / (1024.0 * 1024.0), GetTimeSeconds() - startTime);
+		TrimPyramidCache(pyr.path);
+	}
+	{
+		std::lock_guard<std::mutex> lock(pyr.mutex);
+		if(!ok && !pyr.cancelled) {
+			LogWarn("Couldn't build the pyramid of '%s' in '%s'\n", pyr.name.c_str(), pyr.path.c_str());
+		}
+		pyr.state = ok ? Texture::TilePyramid::BUILT : Texture::TilePyramid::FAILED;
+		pyr.jobRunning = false;
+	}
+	pyr.condVar.notify_all();
+}
+
+bool Texture::TilePyramid::Open()
+{
+	uint64_t size = 0;
+	int64_t modTime = 0;
+	if(!GetFileSizeAndModTime(path.c_str(), &size, &modTime)) {
+		return false; // not built yet
+	}
+	if(size != fileSize) {
+		LogWarn("Pyramid cache file '%s' has the wrong size, building it again\n", path.c_str());
+		return false;
+	}
+	mmf = LoadMemMappedFile(path.c_str());
+	if(mmf == nullptr) {
+		return false;
+	}
+	const PyramidHeader* header = (const PyramidHeader*)mmf->data;
+	if(memcmp(header->magic, pyramidMagic, sizeof(pyramidMagic)) != 0
+	   || header->version != pyramidVersion || header->complete != 1
+	   || header->sourceKey != sourceKey || header->width != levels[0].width
+	   || header->height != levels[0].height || header->tileSize != PYRAMID_TILE_SIZE
+	   || header->texelFormat != texelFormat) {
+		// can also happen if texview crashed while writing it
+		LogWarn("Pyramid cache file '%s' is broken or outdated, building it again\n", path.c_str());
+		Close();
+		return false;
+	}
+	topTile = UploadTile((int)levels.size() - 1, 0, 0);
+	if(topTile == 0) {
+		Close();
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	state = OPEN;
+	return true;
+}
+
+void Texture::TilePyramid::Close()
+{
+	for(auto& it : tiles) {
+		ResidentTile& rt = *it.second;
+		glDeleteTextures(1, &rt.glTextureHandle);
+		residentTileBytes -= rt.bytes;
+		residentTiles.erase(it.second);
+	}
+	tiles.clear();
+	if(topTile != 0) {
+		glDeleteTextures(1, &topTile);
+		topTile = 0;
+	}
+	if(mmf != nullptr) {
+		UnloadMemMappedFile(mmf);
+		mmf = nullptr;
+	}
+}
+
+unsigned int Texture::TilePyramid::UploadTile(int level, uint32_t tx, uint32_t ty)
+{
+	const PyramidLevel& lv = levels[level];
+	uint32_t tw, th;
+	GetTileSize(lv, tx, ty, &tw, &th);
+	// the data comes straight from the mapping, so this is where it's read from disk
+	const uint8_t* data = (const uint8_t*)mmf->data + GetTileOffset(lv, tx, ty, bytesPerTexel);
+
+	GLuint handle = 0;
+	glGenTextures(1, &handle);
+	glBindTexture(GL_TEXTURE_2D, handle);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glGetError();
+	glTexImage2D(GL_TEXTURE_2D, 0, glInternalFormat, tw, th, 0, GL_RGBA, glType, data);
+	// the tile is shown with between 1 and 2 texels per pixel, this makes
+	// sure the latter doesn't flicker when moving around
+	glGenerateMipmap(GL_TEXTURE_2D);
+	GLenum e = glGetError();
+	if(e != GL_NO_ERROR) {
+		errprintf("Uploading the %u x %u tile %u, %u of level %d of the pyramid of '%s' failed "
+		          "(glGetError() says 0x%x)\n", tw, th, tx, ty, level, name.c_str(), e);
+		glDeleteTextures(1, &handle);
+		return 0;
+	}
+	if(level + 1 == (int)levels.size()) {
+		return handle; // the top tile isn't managed by the LRU cache
+	}
+
+	ResidentTile rt = { this, GetTileKey(level, tx, ty), handle,
+	                    size_t(tw) * th * bytesPerTexel * 4 / 3, pyramidUseCounter };
+	residentTiles.push_front(rt);
+	tiles[rt.key] = residentTiles.begin();
+	residentTileBytes += rt.bytes;
+	while(residentTileBytes > pyramidTileMaxBytes && residentTiles.back().lastUse != pyramidUseCounter) {
+		ResidentTile& old = residentTiles.back();
+		glDeleteTextures(1, &old.glTextureHandle);
+		residentTileBytes -= old.bytes;
+		old.pyramid->tiles.erase(old.key);
+		residentTiles.pop_back();
+	}
+	return handle;
+}
+
+unsigned int Texture::TilePyramid::GetTile(int level, uint32_t tx, uint32_t ty)
+{
+	if(level + 1 == (int)levels.size()) {
+		return topTile;
+	}
+	auto it = tiles.find(GetTileKey(level, tx, ty));
+	if(it == tiles.end()) {
+		return 0;
+	}
+	it->second->lastUse = pyramidUseCounter;
+	residentTiles.splice(residentTiles.begin(), residentTiles, it->second);
+	return it->second->glTextureHandle;
+}
+
+bool Texture::TilePyramid::AddTile(int level, uint32_t tx, uint32_t ty, float x0, float y0,
+                                   float x1, float y1, std::vector<PyramidTile>& out)
+{
+	unsigned int handle = GetTile(level, tx, ty);
+	if(handle == 0) {
+		return false;
+	}
+	uint32_t tw, th;
+	GetTileSize(levels[level], tx, ty, &tw, &th);
+	// the part of level 0 the tile covers, its last texels can be beyond the texture's
+	// right and bottom borders (if the finer level had an odd size)
+	float scale = float(1u << level);
+	float tileX = float(tx * PYRAMID_TILE_SIZE) * scale;
+	float tileY = float(ty * PYRAMID_TILE_SIZE) * scale;
+	float tileW = tw * scale;
+	float tileH = th * scale;
+	PyramidTile pt = { x0, y0, x1, y1, (x0 - tileX) / tileW, (y0 - tileY) / tileH,
+	                   (x1 - tileX) / tileW, (y1 - tileY) / tileH, handle };
+	out.push_back(pt);
+	return true;
+}
+
+bool Texture::StartPyramid()
+{
+	const MipLevel& ml = elements[0][0];
+	const bool isCompressed = (textureFlags & TF_COMPRESSED) != 0;
+	// integer textures can't be converted to float, so check if that works
+	float rgba[4];
+	if(!ConvertImageRegionToFloatRGBA(ml, dataFormat, glFormat, glType, isCompressed, 0, 0, 1, 1, rgba)) {
+		return false;
+	}
+	uint64_t sourceKey = ThumbCacheGetKey(name.c_str());
+	if(sourceKey == 0) {
+		return false;
+	}
+	uint32_t type = glType;
+	DecodedFormat decFmt;
+	if(isCompressed) {
+		type = GetSoftwareDecodedFormat(dataFormat, &decFmt) ? decFmt.glType : GL_FLOAT;
+	}
+
+	std::shared_ptr<TilePyramid> pyr = std::make_shared<TilePyramid>();
+	switch(type) {
+		case GL_UNSIGNED_BYTE:
+		case GL_UNSIGNED_SHORT_5_6_5:
+		case GL_UNSIGNED_SHORT_4_4_4_4:
+		case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+		case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+			pyr->texelFormat = PTF_RGBA8;
+			pyr->glInternalFormat = (textureFlags & TF_SRGB) ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+			pyr->glType = GL_UNSIGNED_BYTE;
+			break;
+		case GL_UNSIGNED_SHORT:
+		case GL_UNSIGNED_INT_2_10_10_10_REV:
+		case GL_UNSIGNED_INT_10_10_10_2:
+			pyr->texelFormat = PTF_RGBA16;
+			pyr->glInternalFormat = GL_RGBA16;
+			pyr->glType = GL_UNSIGNED_SHORT;
+			break;
+		default:
+			// HDR, SNORM etc
+			pyr->texelFormat = PTF_RGBA32F;
+			pyr->glInternalFormat = GL_RGBA32F;
+			pyr->glType = GL_FLOAT;
+	}
+	pyr->bytesPerTexel = GetBytesPerTexel(pyr->texelFormat);
+	pyr->fileSize = CalcPyramidLevels(ml.width, ml.height, pyr->bytesPerTexel, pyr->levels);
+	pyr->name = name;
+	pyr->sourceKey = sourceKey;
+	std::string dir = GetPyramidCacheDir();
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.tvpyr", (unsigned long long)sourceKey);
+#ifdef _WIN32
+	pyr->path = dir + "\\" + fileName;
+#else
+	pyr->path = dir + "/" + fileName;
+#endif
+	pyramid = pyr;
+
+	if(pyr->Open()) {
+		LogInfo("'%s' (%u x %u) is too big for your GPU/driver, showing it through the cached "
+		        "pyramid '%s'\n", name.c_str(), ml.width, ml.height, pyr->path.c_str());
+		return true;
+	}
+	if(!CreatePathRecursive(&dir.front())) {
+		LogWarn("Couldn't create the directory '%s' for the pyramid cache\n", dir.c_str());
+		pyramid = nullptr;
+		return false;
+	}
+	LogInfo("'%s' (%u x %u) is too big for your GPU/driver, building a pyramid with %d levels "
+	        "of %d x %d tiles (%.1f MB) in '%s'\n", name.c_str(), ml.width, ml.height,
+	        (int)pyr->levels.size(), PYRAMID_TILE_SIZE, PYRAMID_TILE_SIZE,
+	        pyr->fileSize / (1024.0 * 1024.0), pyr->path.c_str());
+	PyramidSource src = { ml, dataFormat, glFormat, glType, isCompressed };
+	ThreadPoolAddJob([pyr, src]() {
+		BuildPyramid(pyr, src);
+	});
+	return true;
+}
+
+bool Texture::ContinuePyramid(size_t maxUploadBytes)
+{
+	TilePyramid::State state;
+	{
+		std::lock_guard<std::mutex> lock(pyramid->mutex);
+		state = pyramid->state;
+	}
+	if(state == TilePyramid::BUILDING || state == TilePyramid::OPEN) {
+		return false;
+	}
+	if(state == TilePyramid::BUILT && pyramid->Open()) {
+		return true;
+	}
+	LogWarn("Couldn't build or open the pyramid of '%s', uploading it as tiles instead\n", name.c_str());
+	DeletePyramid();
+	return UploadTiled(maxUploadBytes);
+}
+
+void Texture::DeletePyramid()
+{
+	if(pyramid == nullptr) {
+		return;
+	}
+	TilePyramid& pyr = *pyramid;
+	{
+		std::unique_lock<std::mutex> lock(pyr.mutex);
+		// a job that hasn't started yet will see this and return immediately
+		pyr.cancelled = true;
+		pyr.condVar.wait(lock, [&pyr]{ return !pyr.jobRunning; });
+	}
+	pyr.Close();
+	pyramid = nullptr;
+}
+
+bool Texture::IsPyramidBuilding() const
+{
+	if(pyramid == nullptr) {
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(pyramid->mutex);
+	return pyramid->state != TilePyramid::OPEN;
+}
+
+float Texture::GetPyramidBuildProgress() const
+{
+	if(pyramid == nullptr) {
+		return 0.0f;
+	}
+	return float(pyramid->rowsDone.load()) / pyramid->levels[0].numTilesY;
+}
+
+int Texture::GetNumPyramidLevels() const
+{
+	return (pyramid != nullptr) ? (int)pyramid->levels.size() : 0;
+}
+
+bool Texture::GetPyramidTiles(float x0, float y0, float x1, float y1, float texelsPerPixel,
+                              size_t maxUploadBytes, std::vector<PyramidTile>& tiles)
+{
+	tiles.clear();
+	if(pyramid == nullptr || IsPyramidBuilding()) {
+		return false;
+	}
+	TilePyramid& pyr = *pyramid;
+	++pyramidUseCounter;
+	const int numLevels = (int)pyr.levels.size();
+	int level = 0;
+	if(texelsPerPixel > 1.0f) {
+		level = std::min(int(log2f(texelsPerPixel)), numLevels - 1);
+	}
+	const PyramidLevel& lv = pyr.levels[level];
+	const float width = (float)pyr.levels[0].width;
+	const float height = (float)pyr.levels[0].height;
+	x0 = std::max(x0, 0.0f);
+	y0 = std::max(y0, 0.0f);
+	x1 = std::min(x1, width);
+	y1 = std::min(y1, height);
+	if(x1 <= x0 || y1 <= y0) {
+		return true;
+	}
+
+	const float tileSize = float(PYRAMID_TILE_SIZE << level); // in texels of level 0
+	const uint32_t tx0 = uint32_t(x0 / tileSize);
+	const uint32_t ty0 = uint32_t(y0 / tileSize);
+	const uint32_t tx1 = std::min(uint32_t(ceilf(x1 / tileSize)), lv.numTilesX);
+	const uint32_t ty1 = std::min(uint32_t(ceilf(y1 / tileSize)), lv.numTilesY);
+	bool complete = true;
+	size_t uploadedBytes = 0;
+	for(uint32_t ty = ty0; ty < ty1; ++ty) {
+		for(uint32_t tx = tx0; tx < tx1; ++tx) {
+			// the part of the texture this tile covers
+			float rx0 = tx * tileSize;
+			float ry0 = ty * tileSize;
+			float rx1 = std::min(rx0 + tileSize, width);
+			float ry1 = std::min(ry0 + tileSize, height);
+			if(pyr.AddTile(level, tx, ty, rx0, ry0, rx1, ry1, tiles)) {
+				continue;
+			}
+			uint32_t tw, th;
+			GetTileSize(lv, tx, ty, &tw, &th);
+			size_t tileBytes = size_t(tw) * th * pyr.bytesPerTexel;
+			if(uploadedBytes == 0 || uploadedBytes + tileBytes <= maxUploadBytes) {
+				uploadedBytes += tileBytes;
+				if(pyr.UploadTile(level, tx, ty) != 0 && pyr.AddTile(level, tx, ty, rx0, ry0, rx1, ry1, tiles)) {
+					continue;
+				}
+			}
+			// use the part of a tile of a coarser level that covers it until it's uploaded
+			// (the top tile covers everything and is always there)
+			complete = false;
+			for(int l = level + 1; l < numLevels; ++l) {
+				int d = l - level;
+				if(pyr.AddTile(l, tx >> d, ty >> d, rx0, ry0, rx1, ry1, tiles)) {
+					break;
+				}
+			}
+		}
+	}
+	return complete;
+}
+
+} //namespace texview
@@ -5,6 +5,7 @@
  */
 #include "texview.h"
 
+#include <dirent.h> // opendir()
 #include <fcntl.h> // open()
 #include <sys/stat.h>
 #include <sys/mman.h> // mmap()
@@ -28,6 +29,11 @@ std::string ToAbsolutePath(const char* path)
 		ret = path;
 		return ret;
 	}
+	std::string archivePath, entryName;
+	if(SplitArchivePath(path, &archivePath, &entryName)) {
+		// realpath() would fail for files in archives
+		return ToAbsolutePath(archivePath.c_str()) + '/' + entryName;
+	}
 #ifdef __APPLE__
 	// according to their manpage, macOS is stuck in the 90s
 	// and doesn't support realpath(path, NULL)
@@ -53,6 +59,10 @@ std::string ToAbsolutePath(const char* path)
 
 MemMappedFile* LoadMemMappedFile(const char* filename)
 {
+	std::string archivePath, entryName;
+	if(SplitArchivePath(filename, &archivePath, &entryName)) {
+		return LoadArchiveEntry(archivePath, entryName);
+	}
 	int fd = open(filename, O_RDONLY);
 	if(fd == -1) {
 		errprintf("Couldn't open '%s': %d - %s\n", filename, errno, strerror(errno));
@@ -94,6 +104,11 @@ MemMappedFile* LoadMemMappedFile(const char* filename)
 
 void UnloadMemMappedFile(MemMappedFile* mmf)
 {
+	if(mmf->archive != nullptr) {
+		// it's not mapped itself, but (maybe) part of the archive's mapping
+		UnloadArchiveEntry(mmf);
+		return;
+	}
 	if(mmf->data != nullptr) {
 		munmap((void*)mmf->data, mmf->length);
 	}
@@ -103,6 +118,122 @@ void UnloadMemMappedFile(MemMappedFile* mmf)
 	delete mmf;
 }
 
+// archives are treated like directories
+static bool IsArchiveFile(const char* path)
+{
+	struct stat st = {};
+	return IsArchiveFileName(path) && stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+bool IsDirectory(const char* path)
+{
+	std::string archivePath, entryName;
+	if(SplitArchivePath(path, &archivePath, &entryName)) {
+		bool isDir = false;
+		uint64_t size = 0;
+		int64_t modTime = 0;
+		return GetArchiveEntryInfo(archivePath, entryName, &isDir, &size, &modTime) && isDir;
+	}
+	struct stat st = {};
+	return stat(path, &st) == 0 && (S_ISDIR(st.st_mode) || (S_ISREG(st.st_mode) && IsArchiveFileName(path)));
+}
+
+bool GetFileSizeAndModTime(const char* path, uint64_t* size, int64_t* modTime)
+{
+	std::string archivePath, entryName;
+	if(SplitArchivePath(path, &archivePath, &entryName)) {
+		bool isDir = false;
+		return GetArchiveEntryInfo(archivePath, entryName, &isDir, size, modTime) && !isDir;
+	}
+	struct stat st = {};
+	if(stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+		return false;
+	}
+	*size = (uint64_t)st.st_size;
+	*modTime = (int64_t)st.st_mtime;
+	return true;
+}
+
+FILE* FOpenUTF8(const char* path, const char* mode)
+{
+	return fopen(path, mode);
+}
+
+bool RenameFile(const char* oldPath, const char* newPath)
+{
+	if(rename(oldPath, newPath) != 0) {
+		errprintf("Couldn't rename '%s' to '%s': %d - %s\n", oldPath, newPath, errno, strerror(errno));
+		return false;
+	}
+	return true;
+}
+
+bool RemoveFile(const char* path)
+{
+	if(unlink(path) != 0) {
+		errprintf("Couldn't delete '%s': %d - %s\n", path, errno, strerror(errno));
+		return false;
+	}
+	return true;
+}
+
+bool FSeek64(FILE* f, uint64_t offset)
+{
+	return fseeko(f, (off_t)offset, SEEK_SET) == 0;
+}
+
+bool ListDirectory(const char* dir, std::vector<std::string>* files, std::vector<std::string>* subDirs)
+{
+	std::string archivePath, entryName;
+	if(SplitArchivePath(dir, &archivePath, &entryName)) {
+		return ListArchiveDirectory(archivePath, entryName, files, subDirs);
+	} else if(IsArchiveFile(dir)) {
+		return ListArchiveDirectory(dir, std::string(), files, subDirs);
+	}
+	DIR* d = opendir(dir);
+	if(d == nullptr) {
+		errprintf("Couldn't open directory '%s': %d - %s\n", dir, errno, strerror(errno));
+		return false;
+	}
+	std::string path;
+	while(struct dirent* ent = readdir(d)) {
+		const char* n = ent->d_name;
+		if(n[0] == '.' && (n[1] == '\0' || (n[1] == '.' && n[2] == '\0'))) {
+			continue;
+		}
+		bool isDir = false;
+		bool isFile = false;
+#ifdef _DIRENT_HAVE_D_TYPE
+		if(ent->d_type != DT_UNKNOWN && ent->d_type != DT_LNK) {
+			isDir = ent->d_type == DT_DIR;
+			isFile = ent->d_type == DT_REG;
+		} else
+#endif
+		{
+			// some filesystems don't provide d_type, and symlinks must be resolved
+			path = dir;
+			path += '/';
+			path += n;
+			struct stat st = {};
+			if(stat(path.c_str(), &st) == 0) {
+				isDir = S_ISDIR(st.st_mode);
+				isFile = S_ISREG(st.st_mode);
+			}
+		}
+		if(isFile && IsArchiveFileName(n)) {
+			isFile = false;
+			isDir = true;
+		}
+		if(isDir && subDirs != nullptr) {
+			subDirs->push_back(n);
+		} else if(isFile && files != nullptr) {
+			files->push_back(n);
+		}
+	}
+	closedir(d);
+	return true;
+}
+
 #ifndef PATH_MAX
 #define PATH_MAX 4096
 #endif
@@ -76,6 +76,10 @@ std::string ToAbsolutePath(const char* path)
 
 MemMappedFile* LoadMemMappedFile(const char* filename)
 {
+	std::string archivePath, entryName;
+	if (SplitArchivePath(filename, &archivePath, &entryName)) {
+		return LoadArchiveEntry(archivePath, entryName);
+	}
 	HANDLE fileHandle = INVALID_HANDLE_VALUE;
 	// convert filename to WCHAR and try to open the file
 	{
@@ -129,7 +133,10 @@ MemMappedFile* LoadMemMappedFile(const char* filename)
 
 void UnloadMemMappedFile(MemMappedFile* mmf)
 {
-	if (mmf != nullptr) {
+	if (mmf != nullptr && mmf->archive != nullptr) {
+		// it's not mapped itself, but (maybe) part of the archive's mapping
+		UnloadArchiveEntry(mmf);
+	} else if (mmf != nullptr) {
 		HANDLE fh = (HANDLE)mmf->fileHandle;
 		HANDLE moh = (HANDLE)mmf->mappingObjectHandle;
 		if (mmf->data != nullptr) {
@@ -145,6 +152,163 @@ void UnloadMemMappedFile(MemMappedFile* mmf)
 	}
 }
 
+// archives are treated like directories
+static bool IsArchiveFile(const char* path)
+{
+	if (!IsArchiveFileName(path)) {
+		return false;
+	}
+	WCHAR* wPath = Utf8ToUtf16(path);
+	if (wPath == nullptr) {
+		return false;
+	}
+	DWORD attr = GetFileAttributesW(wPath);
+	free(wPath);
+	return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY) == 0;
+}
+
+bool IsDirectory(const char* path)
+{
+	std::string archivePath, entryName;
+	if (SplitArchivePath(path, &archivePath, &entryName)) {
+		bool isDir = false;
+		uint64_t size = 0;
+		int64_t modTime = 0;
+		return GetArchiveEntryInfo(archivePath, entryName, &isDir, &size, &modTime) && isDir;
+	}
+	WCHAR* wPath = Utf8ToUtf16(path);
+	if (wPath == nullptr) {
+		return false;
+	}
+	DWORD attr = GetFileAttributesW(wPath);
+	free(wPath);
+	if (attr == INVALID_FILE_ATTRIBUTES) {
+		return false;
+	}
+	return (attr & FILE_ATTRIBUTE_DIRECTORY) != 0 || IsArchiveFileName(path);
+}
+
+bool ListDirectory(const char* dir, std::vector<std::string>* files, std::vector<std::string>* subDirs)
+{
+	std::string archivePath, entryName;
+	if (SplitArchivePath(dir, &archivePath, &entryName)) {
+		return ListArchiveDirectory(archivePath, entryName, files, subDirs);
+	} else if (IsArchiveFile(dir)) {
+		return ListArchiveDirectory(dir, std::string(), files, subDirs);
+	}
+	std::string pattern(dir);
+	pattern += "\\*";
+	WCHAR* wPattern = Utf8ToUtf16(pattern.c_str());
+	if (wPattern == nullptr) {
+		return false;
+	}
+	WIN32_FIND_DATAW fd = {};
+	HANDLE findHandle = FindFirstFileW(wPattern, &fd);
+	free(wPattern);
+	if (findHandle == INVALID_HANDLE_VALUE) {
+		DWORD err = GetLastError();
+		if (err == ERROR_FILE_NOT_FOUND) {
+			return true; // no files in there
+		}
+		errprintf("Couldn't open directory '%s'! GetLastError(): %d\n", dir, (int)err);
+		return false;
+	}
+	do {
+		const WCHAR* n = fd.cFileName;
+		if (n[0] == L'.' && (n[1] == L'\0' || (n[1] == L'.' && n[2] == L'\0'))) {
+			continue;
+		}
+		bool isDir = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		char* name = Utf16ToUtf8(n);
+		if (name == nullptr) {
+			continue;
+		}
+		if (!isDir && IsArchiveFileName(name)) {
+			isDir = true;
+		}
+		if (isDir && subDirs != nullptr) {
+			subDirs->push_back(name);
+		} else if (!isDir && files != nullptr) {
+			files->push_back(name);
+		}
+		free(name);
+	} while (FindNextFileW(findHandle, &fd));
+	FindClose(findHandle);
+	return true;
+}
+
+bool GetFileSizeAndModTime(const char* path, uint64_t* size, int64_t* modTime)
+{
+	std::string archivePath, entryName;
+	if (SplitArchivePath(path, &archivePath, &entryName)) {
+		bool isDir = false;
+		return GetArchiveEntryInfo(archivePath, entryName, &isDir, size, modTime) && !isDir;
+	}
+	WCHAR* wPath = Utf8ToUtf16(path);
+	if (wPath == nullptr) {
+		return false;
+	}
+	WIN32_FILE_ATTRIBUTE_DATA fad = {};
+	BOOL ok = GetFileAttributesExW(wPath, GetFileExInfoStandard, &fad);
+	free(wPath);
+	if (!ok || (fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+		return false;
+	}
+	*size = ((uint64_t)fad.nFileSizeHigh << 32) | fad.nFileSizeLow;
+	*modTime = (int64_t)(((uint64_t)fad.ftLastWriteTime.dwHighDateTime << 32) | fad.ftLastWriteTime.dwLowDateTime);
+	return true;
+}
+
+FILE* FOpenUTF8(const char* path, const char* mode)
+{
+	WCHAR* wPath = Utf8ToUtf16(path);
+	WCHAR* wMode = Utf8ToUtf16(mode);
+	FILE* ret = nullptr;
+	if (wPath != nullptr && wMode != nullptr) {
+		ret = _wfopen(wPath, wMode);
+	}
+	free(wPath);
+	free(wMode);
+	return ret;
+}
+
+bool RenameFile(const char* oldPath, const char* newPath)
+{
+	WCHAR* wOld = Utf8ToUtf16(oldPath);
+	WCHAR* wNew = Utf8ToUtf16(newPath);
+	BOOL ok = FALSE;
+	if (wOld != nullptr && wNew != nullptr) {
+		ok = MoveFileExW(wOld, wNew, MOVEFILE_REPLACE_EXISTING);
+	}
+	free(wOld);
+	free(wNew);
+	if (!ok) {
+		errprintf("Couldn't rename '%s' to '%s'! GetLastError(): %d\n", oldPath, newPath, GetLastError());
+		return false;
+	}
+	return true;
+}
+
+bool RemoveFile(const char* path)
+{
+	WCHAR* wPath = Utf8ToUtf16(path);
+	BOOL ok = FALSE;
+	if (wPath != nullptr) {
+		ok = DeleteFileW(wPath);
+	}
+	free(wPath);
+	if (!ok) {
+		errprintf("Couldn't delete '%s'! GetLastError(): %d\n", path, GetLastError());
+		return false;
+	}
+	return true;
+}
+
+bool FSeek64(FILE* f, uint64_t offset)
+{
+	return _fseeki64(f, (__int64)offset, SEEK_SET) == 0;
+}
+
 // returns something like C:\Users\Horst\AppData\Roaming\texview (in UTF-8)
 const char* GetSettingsDir()
 {
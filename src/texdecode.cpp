@@ -0,0 +1,2994 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+// Decoding of block-compressed texture formats on the CPU, for GPUs/drivers
+// that don't support them (for example S3TC with some software renderers).
+// There's a scalar reference implementation of each decoder, and for the
+// hot paths SIMD versions for SSE2, AVX2 (detected at runtime) and NEON.
+// The work is split into chunks of block rows that are decoded in parallel.
+
+#include <glad/gl.h>
+
+#include "texview.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define TV_HAVE_SSE2 1
+		#include <emmintrin.h>
+	#endif
+	#if defined(__GNUC__) || defined(_MSC_VER)
+		// the AVX2 code is compiled for AVX2 just in these functions
+		// and only called if the CPU supports it (see CPUHasAVX2())
+		#define TV_HAVE_AVX2 1
+		#include <immintrin.h>
+		#ifdef _MSC_VER
+			#define TV_AVX2_FUNC
+		#else
+			#define TV_AVX2_FUNC __attribute__((target("avx2")))
+		#endif
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define TV_HAVE_NEON 1
+	#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+	#define TV_FORCEINLINE __forceinline
+#else
+	// the helpers must really be inlined into the AVX2 functions, if they're called
+	// as normal (non-AVX) functions the SSE/AVX transition penalties make it *slow*
+	#define TV_FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+namespace texview {
+
+enum DecoderType {
+	DEC_BC1,  // DXT1 RGB (alpha is always 1)
+	DEC_BC1A, // DXT1 RGBA (1bit alpha)
+	DEC_BC2,  // DXT3
+	DEC_BC3,  // DXT5
+	DEC_BC4U, // RGTC1
+	DEC_BC4S, // signed RGTC1
+	DEC_BC5U, // RGTC2
+	DEC_BC5S, // signed RGTC2
+	DEC_BC6HU, // BPTC unsigned float
+	DEC_BC6HS, // BPTC signed float
+	DEC_BC7,   // BPTC
+	DEC_ASTC,      // ASTC, to RGBA8
+	DEC_ASTC_SRGB, // ASTC sRGB, to SRGB8_ALPHA8
+	DEC_ASTC_HDR,  // ASTC with HDR blocks, to RGBA16F (not in swDecodeFormatTable, see GetSoftwareDecodedFormat())
+};
+
+struct SWDecodeFormatInfo {
+	uint32_t compressedFormat;
+	DecoderType decoder;
+	DecodedFormat decodedFormat;
+	uint8_t blockBytes;
+	uint8_t blockW; // 4 for all BCn formats, ASTC has different block sizes
+	uint8_t blockH;
+};
+
+static const SWDecodeFormatInfo swDecodeFormatTable[] = {
+	{ GL_COMPRESSED_RGB_S3TC_DXT1_EXT,           DEC_BC1,   { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 },  8, 4, 4 },
+	{ GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,          DEC_BC1,   { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 },  8, 4, 4 },
+	{ GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,          DEC_BC1A,  { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 },  8, 4, 4 },
+	{ GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,    DEC_BC1A,  { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 },  8, 4, 4 },
+	{ GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,          DEC_BC2,   { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 }, 16, 4, 4 },
+	{ GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT,    DEC_BC2,   { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 }, 16, 4, 4 },
+	{ GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,          DEC_BC3,   { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 }, 16, 4, 4 },
+	{ GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,    DEC_BC3,   { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 }, 16, 4, 4 },
+	{ GL_COMPRESSED_RED_RGTC1,                   DEC_BC4U,  { GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1 },  8, 4, 4 },
+	{ GL_COMPRESSED_SIGNED_RED_RGTC1,            DEC_BC4S,  { GL_R8_SNORM, GL_RED, GL_BYTE, 1 },  8, 4, 4 },
+	{ GL_COMPRESSED_RG_RGTC2,                    DEC_BC5U,  { GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2 }, 16, 4, 4 },
+	{ GL_COMPRESSED_SIGNED_RG_RGTC2,             DEC_BC5S,  { GL_RG8_SNORM, GL_RG, GL_BYTE, 2 }, 16, 4, 4 },
+	{ GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB, DEC_BC6HU, { GL_RGB16F, GL_RGB, GL_HALF_FLOAT, 6 }, 16, 4, 4 },
+	{ GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB,   DEC_BC6HS, { GL_RGB16F, GL_RGB, GL_HALF_FLOAT, 6 }, 16, 4, 4 },
+	{ GL_COMPRESSED_RGBA_BPTC_UNORM_ARB,         DEC_BC7,   { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 }, 16, 4, 4 },
+	{ GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB,   DEC_BC7,   { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 }, 16, 4, 4 },
+
+#define ASTC_ENTRIES(W, H) \
+	{ GL_COMPRESSED_RGBA_ASTC_ ## W ## x ## H ## _KHR, DEC_ASTC, \
+		{ GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 }, 16, W, H }, \
+	{ GL_COMPRESSED_SRGB8_ALPHA8_ASTC_ ## W ## x ## H ## _KHR, DEC_ASTC_SRGB, \
+		{ GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 }, 16, W, H },
+
+	ASTC_ENTRIES(4, 4)
+	ASTC_ENTRIES(5, 4)
+	ASTC_ENTRIES(5, 5)
+	ASTC_ENTRIES(6, 5)
+	ASTC_ENTRIES(6, 6)
+	ASTC_ENTRIES(8, 5)
+	ASTC_ENTRIES(8, 6)
+	ASTC_ENTRIES(8, 8)
+	ASTC_ENTRIES(10, 5)
+	ASTC_ENTRIES(10, 6)
+	ASTC_ENTRIES(10, 8)
+	ASTC_ENTRIES(10, 10)
+	ASTC_ENTRIES(12, 10)
+	ASTC_ENTRIES(12, 12)
+
+#undef ASTC_ENTRIES
+};
+
+// ASTC textures that contain HDR blocks are decoded to half floats instead
+static const DecodedFormat astcHDRDecodedFormat = { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8 };
+
+static const SWDecodeFormatInfo* GetSWDecodeFormatInfo(uint32_t compressedGLformat)
+{
+	for(const SWDecodeFormatInfo& fi : swDecodeFormatTable) {
+		if(fi.compressedFormat == compressedGLformat) {
+			return &fi;
+		}
+	}
+	return nullptr;
+}
+
+// ############ Helpers shared by all implementations ############
+
+static TV_FORCEINLINE uint32_t ReadU32(const uint8_t* p)
+{
+	uint32_t ret;
+	memcpy(&ret, p, 4);
+	return ret; // NOTE: assuming little endian, like the rest of texview
+}
+
+static TV_FORCEINLINE void WriteU32(uint8_t* p, uint32_t val)
+{
+	memcpy(p, &val, 4);
+}
+
+static TV_FORCEINLINE uint64_t ReadU64(const uint8_t* p)
+{
+	uint64_t ret;
+	memcpy(&ret, p, 8);
+	return ret;
+}
+
+// pixels are RGBA8 in memory, which (on little endian) is A<<24 | B<<16 | G<<8 | R
+static TV_FORCEINLINE uint32_t MakeRGBA(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+// calculates the 4 colors of a BC1 color block (also used for the color part of BC2/BC3)
+// if allow3color is false, the block is always interpreted as 4-color block (like in BC2/BC3)
+// if punchThroughAlpha is true, the 4th color of 3-color blocks is transparent black
+static TV_FORCEINLINE void MakeBC1Palette(const uint8_t* block, uint32_t pal[4], bool allow3color, bool punchThroughAlpha)
+{
+	uint32_t c0 = block[0] | (block[1] << 8);
+	uint32_t c1 = block[2] | (block[3] << 8);
+	// expand 5/6 bit to 8 bit by replicating the highest bits into the lowest ones
+	uint32_t r0 = (c0 >> 11) & 31, g0 = (c0 >> 5) & 63, b0 = c0 & 31;
+	uint32_t r1 = (c1 >> 11) & 31, g1 = (c1 >> 5) & 63, b1 = c1 & 31;
+	r0 = (r0 << 3) | (r0 >> 2); g0 = (g0 << 2) | (g0 >> 4); b0 = (b0 << 3) | (b0 >> 2);
+	r1 = (r1 << 3) | (r1 >> 2); g1 = (g1 << 2) | (g1 >> 4); b1 = (b1 << 3) | (b1 >> 2);
+
+	pal[0] = MakeRGBA(r0, g0, b0, 255);
+	pal[1] = MakeRGBA(r1, g1, b1, 255);
+	if(c0 > c1 || !allow3color) {
+		pal[2] = MakeRGBA((2*r0 + r1 + 1) / 3, (2*g0 + g1 + 1) / 3, (2*b0 + b1 + 1) / 3, 255);
+		pal[3] = MakeRGBA((r0 + 2*r1 + 1) / 3, (g0 + 2*g1 + 1) / 3, (b0 + 2*b1 + 1) / 3, 255);
+	} else {
+		pal[2] = MakeRGBA((r0 + r1 + 1) / 2, (g0 + g1 + 1) / 2, (b0 + b1 + 1) / 2, 255);
+		pal[3] = punchThroughAlpha ? 0 : MakeRGBA(0, 0, 0, 255);
+	}
+}
+
+// the 8 values of a BC4 block (also used for BC3 alpha and BC5)
+static TV_FORCEINLINE void MakeBC4PaletteUnsigned(const uint8_t* block, uint8_t pal[8])
+{
+	uint32_t a0 = block[0];
+	uint32_t a1 = block[1];
+	pal[0] = a0;
+	pal[1] = a1;
+	if(a0 > a1) {
+		for(uint32_t i=1; i < 7; ++i) {
+			pal[i+1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+		}
+	} else {
+		for(uint32_t i=1; i < 5; ++i) {
+			pal[i+1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+		}
+		pal[6] = 0;
+		pal[7] = 255;
+	}
+}
+
+// divides and rounds to nearest, also for negative numbers
+static TV_FORCEINLINE int DivRoundSigned(int x, int div)
+{
+	return (x >= 0) ? (x + div/2) / div : -((-x + div/2) / div);
+}
+
+static TV_FORCEINLINE void MakeBC4PaletteSigned(const uint8_t* block, int8_t pal[8])
+{
+	// -128 is mapped to -127, see RGTC spec
+	int a0 = std::max(int(int8_t(block[0])), -127);
+	int a1 = std::max(int(int8_t(block[1])), -127);
+	pal[0] = a0;
+	pal[1] = a1;
+	if(a0 > a1) {
+		for(int i=1; i < 7; ++i) {
+			pal[i+1] = DivRoundSigned((7 - i) * a0 + i * a1, 7);
+		}
+	} else {
+		for(int i=1; i < 5; ++i) {
+			pal[i+1] = DivRoundSigned((5 - i) * a0 + i * a1, 5);
+		}
+		pal[6] = -127;
+		pal[7] = 127;
+	}
+}
+
+// the 16 3bit indices of a BC4 block, one per byte
+static TV_FORCEINLINE void GetBC4Indices(const uint8_t* block, uint8_t idx[16])
+{
+	uint64_t bits = ReadU64(block) >> 16;
+	for(int i=0; i < 16; ++i) {
+		idx[i] = bits & 7;
+		bits >>= 3;
+	}
+}
+
+static TV_FORCEINLINE void DecodeBC2Alpha(const uint8_t* block, uint8_t alpha[16])
+{
+	for(int i=0; i < 8; ++i) {
+		alpha[2*i]   = (block[i] & 0x0F) * 17;
+		alpha[2*i+1] = (block[i] >> 4) * 17;
+	}
+}
+
+static TV_FORCEINLINE void DecodeBC4BlockScalar(const uint8_t* block, uint8_t out[16], bool isSigned)
+{
+	uint8_t idx[16];
+	GetBC4Indices(block, idx);
+	uint8_t pal[8];
+	if(isSigned) {
+		MakeBC4PaletteSigned(block, (int8_t*)pal);
+	} else {
+		MakeBC4PaletteUnsigned(block, pal);
+	}
+	for(int i=0; i < 16; ++i) {
+		out[i] = pal[idx[i]];
+	}
+}
+
+// A "row function" decodes numBlocks blocks (4x4 unless it's ASTC) that are next to each other
+// into dst (always whole blocks, cropping is done by the caller)
+// dstPitch is the distance between two rows of pixels in dst, in bytes.
+typedef void (*RowDecodeFun)(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                             uint8_t* dst, size_t dstPitch);
+
+// ############ Scalar reference implementation ############
+
+static void DecodeS3TCRowScalar(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                                uint8_t* dst, size_t dstPitch)
+{
+	const DecoderType dec = fi.decoder;
+	const bool hasAlphaBlock = (dec == DEC_BC2 || dec == DEC_BC3);
+	const uint32_t blockBytes = hasAlphaBlock ? 16 : 8;
+	for(uint32_t b=0; b < numBlocks; ++b) {
+		const uint8_t* block = blocks + b * blockBytes;
+		const uint8_t* colorBlock = hasAlphaBlock ? block + 8 : block;
+		uint32_t pal[4];
+		MakeBC1Palette(colorBlock, pal, !hasAlphaBlock, dec == DEC_BC1A);
+		uint8_t alpha[16];
+		if(dec == DEC_BC2) {
+			DecodeBC2Alpha(block, alpha);
+		} else if(dec == DEC_BC3) {
+			DecodeBC4BlockScalar(block, alpha, false);
+		}
+		uint32_t indices = ReadU32(colorBlock + 4);
+		for(int y=0; y < 4; ++y) {
+			uint32_t row[4];
+			for(int x=0; x < 4; ++x) {
+				uint32_t c = pal[indices & 3];
+				indices >>= 2;
+				if(hasAlphaBlock) {
+					c = (c & 0x00FFFFFF) | (uint32_t(alpha[y*4 + x]) << 24);
+				}
+				row[x] = c;
+			}
+			memcpy(dst + y * dstPitch + b * 16, row, 16);
+		}
+	}
+}
+
+static void DecodeRGTCRowScalar(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                                uint8_t* dst, size_t dstPitch)
+{
+	const DecoderType dec = fi.decoder;
+	const bool isSigned = (dec == DEC_BC4S || dec == DEC_BC5S);
+	if(dec == DEC_BC4U || dec == DEC_BC4S) {
+		for(uint32_t b=0; b < numBlocks; ++b) {
+			uint8_t red[16];
+			DecodeBC4BlockScalar(blocks + b * 8, red, isSigned);
+			for(int y=0; y < 4; ++y) {
+				memcpy(dst + y * dstPitch + b * 4, red + 4*y, 4);
+			}
+		}
+	} else {
+		for(uint32_t b=0; b < numBlocks; ++b) {
+			uint8_t red[16], green[16];
+			DecodeBC4BlockScalar(blocks + b * 16, red, isSigned);
+			DecodeBC4BlockScalar(blocks + b * 16 + 8, green, isSigned);
+			for(int y=0; y < 4; ++y) {
+				uint8_t* out = dst + y * dstPitch + b * 8;
+				for(int x=0; x < 4; ++x) {
+					out[2*x] = red[4*y + x];
+					out[2*x + 1] = green[4*y + x];
+				}
+			}
+		}
+	}
+}
+
+// ############ SSE2 ############
+
+#ifdef TV_HAVE_SSE2
+
+static inline __m128i SelectSSE2(__m128i mask, __m128i a, __m128i b)
+{
+	// where mask is set, use a, otherwise b
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static void DecodeS3TCRowSSE2(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                              uint8_t* dst, size_t dstPitch)
+{
+	const DecoderType dec = fi.decoder;
+	const bool hasAlphaBlock = (dec == DEC_BC2 || dec == DEC_BC3);
+	const uint32_t blockBytes = hasAlphaBlock ? 16 : 8;
+	const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+	const __m128i zero = _mm_setzero_si128();
+	for(uint32_t b=0; b < numBlocks; ++b) {
+		const uint8_t* block = blocks + b * blockBytes;
+		const uint8_t* colorBlock = hasAlphaBlock ? block + 8 : block;
+		uint32_t pal[4];
+		MakeBC1Palette(colorBlock, pal, !hasAlphaBlock, dec == DEC_BC1A);
+		const __m128i p0 = _mm_set1_epi32(pal[0]);
+		const __m128i p1 = _mm_set1_epi32(pal[1]);
+		const __m128i p2 = _mm_set1_epi32(pal[2]);
+		const __m128i p3 = _mm_set1_epi32(pal[3]);
+
+		// alpha of each row, already shifted to the alpha byte of each 32bit pixel
+		__m128i rowAlpha[4];
+		if(hasAlphaBlock) {
+			uint8_t alpha[16];
+			if(dec == DEC_BC2) {
+				DecodeBC2Alpha(block, alpha);
+			} else {
+				// no good way to do the 3bit index lookup with plain SSE2
+				// (no pshufb), so the BC3 alpha indices are done with scalar code
+				DecodeBC4BlockScalar(block, alpha, false);
+			}
+			__m128i a = _mm_loadu_si128((const __m128i*)alpha);
+			__m128i a16lo = _mm_unpacklo_epi8(zero, a); // alpha << 8 as 16bit, rows 0 and 1
+			__m128i a16hi = _mm_unpackhi_epi8(zero, a); // rows 2 and 3
+			rowAlpha[0] = _mm_unpacklo_epi16(zero, a16lo); // alpha << 24 as 32bit
+			rowAlpha[1] = _mm_unpackhi_epi16(zero, a16lo);
+			rowAlpha[2] = _mm_unpacklo_epi16(zero, a16hi);
+			rowAlpha[3] = _mm_unpackhi_epi16(zero, a16hi);
+		}
+
+		const __m128i idx = _mm_set1_epi32((int)ReadU32(colorBlock + 4));
+		for(int y=0; y < 4; ++y) {
+			// the lower and the higher bit of the 2bit index of each pixel in this row
+			const int s = 8 * y;
+			const __m128i bit0 = _mm_set_epi32(int(1u << (s+6)), 1 << (s+4), 1 << (s+2), 1 << s);
+			const __m128i bit1 = _mm_set_epi32(int(2u << (s+6)), 2 << (s+4), 2 << (s+2), 2 << s);
+			__m128i sel0 = _mm_cmpeq_epi32(_mm_and_si128(idx, bit0), bit0);
+			__m128i sel1 = _mm_cmpeq_epi32(_mm_and_si128(idx, bit1), bit1);
+			__m128i c01 = SelectSSE2(sel0, p1, p0);
+			__m128i c23 = SelectSSE2(sel0, p3, p2);
+			__m128i c = SelectSSE2(sel1, c23, c01);
+			if(hasAlphaBlock) {
+				c = _mm_or_si128(_mm_and_si128(c, rgbMask), rowAlpha[y]);
+			}
+			_mm_storeu_si128((__m128i*)(dst + y * dstPitch + b * 16), c);
+		}
+	}
+}
+
+#endif // TV_HAVE_SSE2
+
+// ############ AVX2 ############
+
+#ifdef TV_HAVE_AVX2
+
+static bool CPUHasAVX2()
+{
+#ifdef _MSC_VER
+	int regs[4];
+	__cpuid(regs, 0);
+	if(regs[0] < 7) {
+		return false;
+	}
+	__cpuid(regs, 1);
+	// OSXSAVE and AVX
+	if((regs[2] & (1 << 27)) == 0 || (regs[2] & (1 << 28)) == 0) {
+		return false;
+	}
+	// is the OS saving the YMM registers on context switch?
+	if((_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(regs, 7, 0);
+	return (regs[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// 16 3bit indices of a BC4 block in 12bit groups (4 indices each) => 4 indices, one per byte
+static uint32_t bc4IndexLUT[4096];
+
+static void InitBC4IndexLUT()
+{
+	for(uint32_t i=0; i < 4096; ++i) {
+		bc4IndexLUT[i] = (i & 7) | (((i >> 3) & 7) << 8) | (((i >> 6) & 7) << 16) | (((i >> 9) & 7) << 24);
+	}
+}
+
+// uses pshufb (SSSE3, which every AVX2 CPU has) to look up the 16 values of a BC4 block
+TV_AVX2_FUNC static inline __m128i DecodeBC4BlockAVX2(const uint8_t* block, bool isSigned)
+{
+	uint8_t pal[16] = {};
+	if(isSigned) {
+		MakeBC4PaletteSigned(block, (int8_t*)pal);
+	} else {
+		MakeBC4PaletteUnsigned(block, pal);
+	}
+	uint64_t bits = ReadU64(block) >> 16;
+	__m128i idx = _mm_setr_epi32(bc4IndexLUT[bits & 0xFFF], bc4IndexLUT[(bits >> 12) & 0xFFF],
+	                             bc4IndexLUT[(bits >> 24) & 0xFFF], bc4IndexLUT[(bits >> 36) & 0xFFF]);
+	__m128i palette = _mm_loadl_epi64((const __m128i*)pal);
+	return _mm_shuffle_epi8(palette, idx);
+}
+
+TV_AVX2_FUNC static void DecodeS3TCRowAVX2(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                                           uint8_t* dst, size_t dstPitch)
+{
+	const DecoderType dec = fi.decoder;
+	const bool hasAlphaBlock = (dec == DEC_BC2 || dec == DEC_BC3);
+	const uint32_t blockBytes = hasAlphaBlock ? 16 : 8;
+	const __m256i shifts01 = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+	const __m256i shifts23 = _mm256_setr_epi32(16, 18, 20, 22, 24, 26, 28, 30);
+	const __m256i three = _mm256_set1_epi32(3);
+	const __m256i rgbMask = _mm256_set1_epi32(0x00FFFFFF);
+	for(uint32_t b=0; b < numBlocks; ++b) {
+		const uint8_t* block = blocks + b * blockBytes;
+		const uint8_t* colorBlock = hasAlphaBlock ? block + 8 : block;
+		uint32_t pal[4];
+		MakeBC1Palette(colorBlock, pal, !hasAlphaBlock, dec == DEC_BC1A);
+		const __m256i palette = _mm256_setr_epi32(pal[0], pal[1], pal[2], pal[3],
+		                                          pal[0], pal[1], pal[2], pal[3]);
+		const __m256i idx = _mm256_set1_epi32((int)ReadU32(colorBlock + 4));
+		// indices of rows 0+1 and 2+3, then use them to look up the colors
+		__m256i i01 = _mm256_and_si256(_mm256_srlv_epi32(idx, shifts01), three);
+		__m256i i23 = _mm256_and_si256(_mm256_srlv_epi32(idx, shifts23), three);
+		__m256i c01 = _mm256_permutevar8x32_epi32(palette, i01);
+		__m256i c23 = _mm256_permutevar8x32_epi32(palette, i23);
+
+		if(hasAlphaBlock) {
+			__m128i a;
+			if(dec == DEC_BC2) {
+				uint8_t alpha[16];
+				DecodeBC2Alpha(block, alpha);
+				a = _mm_loadu_si128((const __m128i*)alpha);
+			} else {
+				a = DecodeBC4BlockAVX2(block, false);
+			}
+			__m256i a01 = _mm256_slli_epi32(_mm256_cvtepu8_epi32(a), 24);
+			__m256i a23 = _mm256_slli_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(a, 8)), 24);
+			c01 = _mm256_or_si256(_mm256_and_si256(c01, rgbMask), a01);
+			c23 = _mm256_or_si256(_mm256_and_si256(c23, rgbMask), a23);
+		}
+
+		uint8_t* out = dst + b * 16;
+		_mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(c01));
+		_mm_storeu_si128((__m128i*)(out + dstPitch), _mm256_extracti128_si256(c01, 1));
+		_mm_storeu_si128((__m128i*)(out + 2 * dstPitch), _mm256_castsi256_si128(c23));
+		_mm_storeu_si128((__m128i*)(out + 3 * dstPitch), _mm256_extracti128_si256(c23, 1));
+	}
+}
+
+TV_AVX2_FUNC static void DecodeRGTCRowAVX2(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                                           uint8_t* dst, size_t dstPitch)
+{
+	const DecoderType dec = fi.decoder;
+	const bool isSigned = (dec == DEC_BC4S || dec == DEC_BC5S);
+	if(dec == DEC_BC4U || dec == DEC_BC4S) {
+		for(uint32_t b=0; b < numBlocks; ++b) {
+			__m128i red = DecodeBC4BlockAVX2(blocks + b * 8, isSigned);
+			uint8_t* out = dst + b * 4;
+			WriteU32(out, _mm_cvtsi128_si32(red));
+			WriteU32(out + dstPitch, _mm_extract_epi32(red, 1));
+			WriteU32(out + 2 * dstPitch, _mm_extract_epi32(red, 2));
+			WriteU32(out + 3 * dstPitch, _mm_extract_epi32(red, 3));
+		}
+	} else {
+		for(uint32_t b=0; b < numBlocks; ++b) {
+			__m128i red = DecodeBC4BlockAVX2(blocks + b * 16, isSigned);
+			__m128i green = DecodeBC4BlockAVX2(blocks + b * 16 + 8, isSigned);
+			__m128i rg01 = _mm_unpacklo_epi8(red, green);
+			__m128i rg23 = _mm_unpackhi_epi8(red, green);
+			uint8_t* out = dst + b * 8;
+			_mm_storel_epi64((__m128i*)out, rg01);
+			_mm_storel_epi64((__m128i*)(out + dstPitch), _mm_srli_si128(rg01, 8));
+			_mm_storel_epi64((__m128i*)(out + 2 * dstPitch), rg23);
+			_mm_storel_epi64((__m128i*)(out + 3 * dstPitch), _mm_srli_si128(rg23, 8));
+		}
+	}
+}
+
+#endif // TV_HAVE_AVX2
+
+// ############ NEON ############
+
+#ifdef TV_HAVE_NEON
+
+// the byte indices for vqtbl1q_u8() to look up the 32bit palette entries
+static inline uint8x16_t NeonPaletteIndices(uint32_t indices)
+{
+	uint32_t idx[4];
+	for(int i=0; i < 4; ++i) {
+		idx[i] = ((indices >> (2*i)) & 3) * 0x04040404u + 0x03020100u;
+	}
+	return vreinterpretq_u8_u32(vld1q_u32(idx));
+}
+
+static inline uint8x16_t DecodeBC4BlockNEON(const uint8_t* block, bool isSigned)
+{
+	uint8_t pal[16] = {};
+	if(isSigned) {
+		MakeBC4PaletteSigned(block, (int8_t*)pal);
+	} else {
+		MakeBC4PaletteUnsigned(block, pal);
+	}
+	uint8_t idx[16];
+	GetBC4Indices(block, idx);
+	return vqtbl1q_u8(vld1q_u8(pal), vld1q_u8(idx));
+}
+
+static void DecodeS3TCRowNEON(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                              uint8_t* dst, size_t dstPitch)
+{
+	const DecoderType dec = fi.decoder;
+	const bool hasAlphaBlock = (dec == DEC_BC2 || dec == DEC_BC3);
+	const uint32_t blockBytes = hasAlphaBlock ? 16 : 8;
+	for(uint32_t b=0; b < numBlocks; ++b) {
+		const uint8_t* block = blocks + b * blockBytes;
+		const uint8_t* colorBlock = hasAlphaBlock ? block + 8 : block;
+		uint32_t pal[4];
+		MakeBC1Palette(colorBlock, pal, !hasAlphaBlock, dec == DEC_BC1A);
+		const uint8x16_t palette = vreinterpretq_u8_u32(vld1q_u32(pal));
+		uint8x16_t alpha = vdupq_n_u8(0);
+		if(hasAlphaBlock) {
+			if(dec == DEC_BC2) {
+				uint8_t a[16];
+				DecodeBC2Alpha(block, a);
+				alpha = vld1q_u8(a);
+			} else {
+				alpha = DecodeBC4BlockNEON(block, false);
+			}
+		}
+		uint32_t indices = ReadU32(colorBlock + 4);
+		for(int y=0; y < 4; ++y) {
+			uint8x16_t c = vqtbl1q_u8(palette, NeonPaletteIndices(indices >> (8*y)));
+			if(hasAlphaBlock) {
+				// alpha of this row into the highest byte of each pixel
+				static const uint8_t alphaIdxTab[4][16] = {
+					{ 0xFF, 0xFF, 0xFF, 0, 0xFF, 0xFF, 0xFF, 1, 0xFF, 0xFF, 0xFF, 2, 0xFF, 0xFF, 0xFF, 3 },
+					{ 0xFF, 0xFF, 0xFF, 4, 0xFF, 0xFF, 0xFF, 5, 0xFF, 0xFF, 0xFF, 6, 0xFF, 0xFF, 0xFF, 7 },
+					{ 0xFF, 0xFF, 0xFF, 8, 0xFF, 0xFF, 0xFF, 9, 0xFF, 0xFF, 0xFF, 10, 0xFF, 0xFF, 0xFF, 11 },
+					{ 0xFF, 0xFF, 0xFF, 12, 0xFF, 0xFF, 0xFF, 13, 0xFF, 0xFF, 0xFF, 14, 0xFF, 0xFF, 0xFF, 15 },
+				};
+				// out of range indices give 0 with vqtbl1q_u8()
+				uint8x16_t a = vqtbl1q_u8(alpha, vld1q_u8(alphaIdxTab[y]));
+				c = vorrq_u8(vandq_u8(c, vreinterpretq_u8_u32(vdupq_n_u32(0x00FFFFFF))), a);
+			}
+			vst1q_u8(dst + y * dstPitch + b * 16, c);
+		}
+	}
+}
+
+static void DecodeRGTCRowNEON(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                              uint8_t* dst, size_t dstPitch)
+{
+	const DecoderType dec = fi.decoder;
+	const bool isSigned = (dec == DEC_BC4S || dec == DEC_BC5S);
+	if(dec == DEC_BC4U || dec == DEC_BC4S) {
+		for(uint32_t b=0; b < numBlocks; ++b) {
+			uint32x4_t red = vreinterpretq_u32_u8(DecodeBC4BlockNEON(blocks + b * 8, isSigned));
+			uint8_t* out = dst + b * 4;
+			vst1q_lane_u32((uint32_t*)out, red, 0);
+			vst1q_lane_u32((uint32_t*)(out + dstPitch), red, 1);
+			vst1q_lane_u32((uint32_t*)(out + 2 * dstPitch), red, 2);
+			vst1q_lane_u32((uint32_t*)(out + 3 * dstPitch), red, 3);
+		}
+	} else {
+		for(uint32_t b=0; b < numBlocks; ++b) {
+			uint8x16x2_t rg = vzipq_u8(DecodeBC4BlockNEON(blocks + b * 16, isSigned),
+			                           DecodeBC4BlockNEON(blocks + b * 16 + 8, isSigned));
+			uint8_t* out = dst + b * 8;
+			vst1_u8(out, vget_low_u8(rg.val[0]));
+			vst1_u8(out + dstPitch, vget_high_u8(rg.val[0]));
+			vst1_u8(out + 2 * dstPitch, vget_low_u8(rg.val[1]));
+			vst1_u8(out + 3 * dstPitch, vget_high_u8(rg.val[1]));
+		}
+	}
+}
+
+#endif // TV_HAVE_NEON
+
+// ############ BPTC (BC6H and BC7) ############
+
+// reads bits from a 128bit block, starting at the lowest bit of the first byte
+struct BitReader128 {
+	uint64_t lo;
+	uint64_t hi;
+
+	explicit BitReader128(const uint8_t* block)
+	{
+		lo = ReadU64(block);
+		hi = ReadU64(block + 8);
+	}
+
+	TV_FORCEINLINE uint32_t Read(uint32_t numBits)
+	{
+		if(numBits == 0) {
+			return 0;
+		}
+		uint32_t ret = uint32_t(lo & ((uint64_t(1) << numBits) - 1));
+		lo = (lo >> numBits) | (hi << (64 - numBits));
+		hi >>= numBits;
+		return ret;
+	}
+};
+
+// partition tables and anchor indices from the BC7 specification,
+// BC6H uses the first 32 entries of the 2-subset tables
+static const uint8_t bc7Partition2[64][16] = {
+	{0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1}, {0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1}, {0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1}, {0,0,0,1,0,0,1,1,0,0,1,1,0,1,1,1},
+	{0,0,0,0,0,0,0,1,0,0,0,1,0,0,1,1}, {0,0,1,1,0,1,1,1,0,1,1,1,1,1,1,1}, {0,0,0,1,0,0,1,1,0,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,1,0,0,1,1,0,1,1,1},
+	{0,0,0,0,0,0,0,0,0,0,0,1,0,0,1,1}, {0,0,1,1,0,1,1,1,1,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,1,0,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,0,0,0,0,1,0,1,1,1},
+	{0,0,0,1,0,1,1,1,1,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1}, {0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1},
+	{0,0,0,0,1,0,0,0,1,1,1,0,1,1,1,1}, {0,1,1,1,0,0,0,1,0,0,0,0,0,0,0,0}, {0,0,0,0,0,0,0,0,1,0,0,0,1,1,1,0}, {0,1,1,1,0,0,1,1,0,0,0,1,0,0,0,0},
+	{0,0,1,1,0,0,0,1,0,0,0,0,0,0,0,0}, {0,0,0,0,1,0,0,0,1,1,0,0,1,1,1,0}, {0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0}, {0,1,1,1,0,0,1,1,0,0,1,1,0,0,0,1},
+	{0,0,1,1,0,0,0,1,0,0,0,1,0,0,0,0}, {0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0}, {0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0}, {0,0,1,1,0,1,1,0,0,1,1,0,1,1,0,0},
+	{0,0,0,1,0,1,1,1,1,1,1,0,1,0,0,0}, {0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0}, {0,1,1,1,0,0,0,1,1,0,0,0,1,1,1,0}, {0,0,1,1,1,0,0,1,1,0,0,1,1,1,0,0},
+	{0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1}, {0,0,0,0,1,1,1,1,0,0,0,0,1,1,1,1}, {0,1,0,1,1,0,1,0,0,1,0,1,1,0,1,0}, {0,0,1,1,0,0,1,1,1,1,0,0,1,1,0,0},
+	{0,0,1,1,1,1,0,0,0,0,1,1,1,1,0,0}, {0,1,0,1,0,1,0,1,1,0,1,0,1,0,1,0}, {0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1}, {0,1,0,1,1,0,1,0,1,0,1,0,0,1,0,1},
+	{0,1,1,1,0,0,1,1,1,1,0,0,1,1,1,0}, {0,0,0,1,0,0,1,1,1,1,0,0,1,0,0,0}, {0,0,1,1,0,0,1,0,0,1,0,0,1,1,0,0}, {0,0,1,1,1,0,1,1,1,1,0,1,1,1,0,0},
+	{0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0}, {0,0,1,1,1,1,0,0,1,1,0,0,0,0,1,1}, {0,1,1,0,0,1,1,0,1,0,0,1,1,0,0,1}, {0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0},
+	{0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,0}, {0,0,1,0,0,1,1,1,0,0,1,0,0,0,0,0}, {0,0,0,0,0,0,1,0,0,1,1,1,0,0,1,0}, {0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,0},
+	{0,1,1,0,1,1,0,0,1,0,0,1,0,0,1,1}, {0,0,1,1,0,1,1,0,1,1,0,0,1,0,0,1}, {0,1,1,0,0,0,1,1,1,0,0,1,1,1,0,0}, {0,0,1,1,1,0,0,1,1,1,0,0,0,1,1,0},
+	{0,1,1,0,1,1,0,0,1,1,0,0,1,0,0,1}, {0,1,1,0,0,0,1,1,0,0,1,1,1,0,0,1}, {0,1,1,1,1,1,1,0,1,0,0,0,0,0,0,1}, {0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,1},
+	{0,0,0,0,1,1,1,1,0,0,1,1,0,0,1,1}, {0,0,1,1,0,0,1,1,1,1,1,1,0,0,0,0}, {0,0,1,0,0,0,1,0,1,1,1,0,1,1,1,0}, {0,1,0,0,0,1,0,0,0,1,1,1,0,1,1,1},
+};
+
+static const uint8_t bc7Partition3[64][16] = {
+	{0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2}, {0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1}, {0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1}, {0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1},
+	{0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2}, {0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2}, {0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1}, {0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1},
+	{0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2}, {0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2}, {0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2}, {0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2},
+	{0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2}, {0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2}, {0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2}, {0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0},
+	{0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2}, {0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0}, {0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2}, {0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1},
+	{0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2}, {0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1}, {0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2}, {0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0},
+	{0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0}, {0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2}, {0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0}, {0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1},
+	{0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2}, {0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2}, {0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1}, {0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1},
+	{0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2}, {0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1}, {0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2}, {0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0},
+	{0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0}, {0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0}, {0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0}, {0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1},
+	{0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1}, {0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2}, {0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1}, {0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2},
+	{0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1}, {0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1}, {0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1}, {0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1},
+	{0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2}, {0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1}, {0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2}, {0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2},
+	{0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2}, {0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2}, {0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2}, {0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2},
+	{0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2}, {0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2}, {0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2}, {0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2},
+	{0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1}, {0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2}, {0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2}, {0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0},
+};
+
+static const uint8_t bc7PartitionNone[16] = {};
+
+// index of the anchor pixel of the second subset (of 2) / second and third subset (of 3)
+static const uint8_t bc7Anchor2of2[64] = {
+	15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15, 15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+	15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,  6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15,
+};
+static const uint8_t bc7Anchor2of3[64] = {
+	 3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,  3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+	 8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,  3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3,
+};
+static const uint8_t bc7Anchor3of3[64] = {
+	15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8, 15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+	15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8, 15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8,
+};
+
+static const uint8_t bptcWeights2[4] = { 0, 21, 43, 64 };
+static const uint8_t bptcWeights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const uint8_t bptcWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static TV_FORCEINLINE const uint8_t* GetBPTCWeights(uint32_t indexBits)
+{
+	return (indexBits == 2) ? bptcWeights2 : ((indexBits == 3) ? bptcWeights3 : bptcWeights4);
+}
+
+struct BC7ModeInfo {
+	uint8_t numSubsets;
+	uint8_t partitionBits;
+	uint8_t rotationBits;
+	uint8_t indexSelectionBits;
+	uint8_t colorBits;
+	uint8_t alphaBits;
+	uint8_t endpointPBits; // one P-bit per endpoint
+	uint8_t sharedPBits;   // one P-bit per subset
+	uint8_t indexBits;
+	uint8_t indexBits2;    // for the second set of indices used by modes 4 and 5
+};
+
+static constexpr BC7ModeInfo bc7Modes[8] = {
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+// expands a value with numBits bits to 8 bits by replicating the highest bits
+static TV_FORCEINLINE uint8_t ExpandTo8Bits(uint32_t val, uint32_t numBits)
+{
+	val <<= (8 - numBits);
+	return uint8_t(val | (val >> numBits));
+}
+
+static TV_FORCEINLINE uint8_t BPTCInterpolate(uint32_t e0, uint32_t e1, uint32_t weight)
+{
+	return uint8_t(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+}
+
+// Each BC7 mode has its own instance of this function, so all the mode-specific
+// bit counts are compile-time constants and the compiler can throw away
+// everything that mode doesn't need (like subset handling for modes 4-6,
+// P-bits for modes 4 and 5, the second index set for everything but 4 and 5).
+template<int MODE>
+static void DecodeBC7Block(const uint8_t* block, uint8_t* dst, size_t dstPitch)
+{
+	constexpr BC7ModeInfo mi = bc7Modes[MODE];
+	constexpr uint32_t numSubsets = mi.numSubsets;
+	constexpr uint32_t numChannels = (mi.alphaBits > 0) ? 4 : 3;
+
+	BitReader128 br(block);
+	br.Read(MODE + 1);
+	const uint32_t partition = br.Read(mi.partitionBits);
+	const uint32_t rotation = br.Read(mi.rotationBits);
+	const uint32_t indexSelection = br.Read(mi.indexSelectionBits);
+
+	uint8_t endpoints[numSubsets][2][4]; // [subset][endpoint][channel]
+	for(uint32_t c=0; c < numChannels; ++c) {
+		const uint32_t bits = (c < 3) ? mi.colorBits : mi.alphaBits;
+		for(uint32_t s=0; s < numSubsets; ++s) {
+			endpoints[s][0][c] = br.Read(bits);
+			endpoints[s][1][c] = br.Read(bits);
+		}
+	}
+
+	uint32_t colorPrec = mi.colorBits;
+	uint32_t alphaPrec = mi.alphaBits;
+	if(mi.endpointPBits || mi.sharedPBits) {
+		for(uint32_t s=0; s < numSubsets; ++s) {
+			uint32_t p[2];
+			p[0] = br.Read(1);
+			p[1] = mi.sharedPBits ? p[0] : br.Read(1);
+			for(uint32_t e=0; e < 2; ++e) {
+				for(uint32_t c=0; c < numChannels; ++c) {
+					endpoints[s][e][c] = (endpoints[s][e][c] << 1) | p[e];
+				}
+			}
+		}
+		++colorPrec;
+		++alphaPrec;
+	}
+	for(uint32_t s=0; s < numSubsets; ++s) {
+		for(uint32_t e=0; e < 2; ++e) {
+			for(uint32_t c=0; c < 3; ++c) {
+				endpoints[s][e][c] = ExpandTo8Bits(endpoints[s][e][c], colorPrec);
+			}
+			endpoints[s][e][3] = (numChannels == 4) ? ExpandTo8Bits(endpoints[s][e][3], alphaPrec) : 255;
+		}
+	}
+
+	const uint8_t* partitionTab = bc7PartitionNone;
+	uint32_t anchor2 = 0, anchor3 = 0;
+	if(numSubsets == 2) {
+		partitionTab = bc7Partition2[partition];
+		anchor2 = bc7Anchor2of2[partition];
+	} else if(numSubsets == 3) {
+		partitionTab = bc7Partition3[partition];
+		anchor2 = bc7Anchor2of3[partition];
+		anchor3 = bc7Anchor3of3[partition];
+	}
+
+	// anchor pixels have one index bit less (its highest bit is implicitly 0)
+	uint8_t indices[16];
+	for(uint32_t i=0; i < 16; ++i) {
+		bool isAnchor = (i == 0) || (numSubsets > 1 && (i == anchor2 || i == anchor3));
+		indices[i] = br.Read(isAnchor ? mi.indexBits - 1 : mi.indexBits);
+	}
+	uint8_t indices2[16];
+	if(mi.indexBits2 > 0) {
+		for(uint32_t i=0; i < 16; ++i) {
+			indices2[i] = br.Read((i == 0) ? mi.indexBits2 - 1 : mi.indexBits2);
+		}
+	}
+
+	const uint8_t* weights = GetBPTCWeights(mi.indexBits);
+	const uint8_t* weights2 = GetBPTCWeights(mi.indexBits2);
+	if(mi.indexBits2 == 0) {
+		for(uint32_t i=0; i < 16; ++i) {
+			const uint8_t (*ep)[4] = endpoints[partitionTab[i]];
+			const uint32_t w = weights[indices[i]];
+			uint8_t px[4];
+			for(uint32_t c=0; c < 4; ++c) {
+				px[c] = BPTCInterpolate(ep[0][c], ep[1][c], w);
+			}
+			memcpy(dst + (i / 4) * dstPitch + (i % 4) * 4, px, 4);
+		}
+	} else {
+		// modes 4 and 5 have separate indices for color and alpha, and the
+		// rotation swaps alpha with one of the color channels after interpolation.
+		// instead of swapping in each pixel the endpoints are swapped here,
+		// and the swapped color channel is interpolated with the alpha weights
+		uint32_t rotChannel = 3;
+		if(rotation != 0) {
+			rotChannel = rotation - 1;
+			for(uint32_t e=0; e < 2; ++e) {
+				std::swap(endpoints[0][e][rotChannel], endpoints[0][e][3]);
+			}
+		}
+		const uint8_t (*ep)[4] = endpoints[0];
+		for(uint32_t i=0; i < 16; ++i) {
+			uint32_t colorW = weights[indices[i]];
+			uint32_t alphaW = weights2[indices2[i]];
+			if(indexSelection) {
+				std::swap(colorW, alphaW);
+			}
+			uint8_t px[4];
+			for(uint32_t c=0; c < 4; ++c) {
+				px[c] = BPTCInterpolate(ep[0][c], ep[1][c], (c == rotChannel) ? alphaW : colorW);
+			}
+			memcpy(dst + (i / 4) * dstPitch + (i % 4) * 4, px, 4);
+		}
+	}
+}
+
+static void DecodeBC7InvalidBlock(const uint8_t*, uint8_t* dst, size_t dstPitch)
+{
+	// blocks with an invalid mode (first byte is 0) decode to transparent black
+	for(int y=0; y < 4; ++y) {
+		memset(dst + y * dstPitch, 0, 16);
+	}
+}
+
+typedef void (*BC7BlockFun)(const uint8_t* block, uint8_t* dst, size_t dstPitch);
+
+// indexed with the first byte of the block, the mode is its lowest set bit
+static BC7BlockFun bc7BlockFuns[256];
+
+static void InitBC7BlockFuns()
+{
+	static const BC7BlockFun modeFuns[8] = {
+		DecodeBC7Block<0>, DecodeBC7Block<1>, DecodeBC7Block<2>, DecodeBC7Block<3>,
+		DecodeBC7Block<4>, DecodeBC7Block<5>, DecodeBC7Block<6>, DecodeBC7Block<7>
+	};
+	bc7BlockFuns[0] = DecodeBC7InvalidBlock;
+	for(int i=1; i < 256; ++i) {
+		int mode = 0;
+		while((i & (1 << mode)) == 0) {
+			++mode;
+		}
+		bc7BlockFuns[i] = modeFuns[mode];
+	}
+}
+
+static void DecodeBC7Row(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo&,
+                         uint8_t* dst, size_t dstPitch)
+{
+	for(uint32_t b=0; b < numBlocks; ++b) {
+		const uint8_t* block = blocks + b * 16;
+		bc7BlockFuns[block[0]](block, dst + b * 16, dstPitch);
+	}
+}
+
+// BC6H endpoint values, they're spread all over the block in a different way for each mode
+enum BC6HField : uint8_t {
+	RW, RX, RY, RZ,
+	GW, GX, GY, GZ,
+	BW, BX, BY, BZ,
+	BC6H_D, // partition
+	BC6H_NUM_FIELDS
+};
+
+struct BC6HBits {
+	uint8_t field;
+	uint8_t firstBit;
+	uint8_t numBits; // 0 terminates the list
+};
+
+struct BC6HModeInfo {
+	uint8_t modeValue; // the 2 or 5 mode bits
+	bool twoRegions;
+	bool transformed; // endpoints other than the first are deltas
+	uint8_t endpointBits;
+	uint8_t deltaBits[3]; // for R, G, B
+	BC6HBits bits[25]; // in the order they're stored in the block
+};
+
+// the layout of the bits of each mode, from the BC6H documentation
+// (the mode numbers in the comments are the ones used there)
+static const BC6HModeInfo bc6hModes[14] = {
+	// mode 1
+	{ 0x00, true, true, 10, { 5, 5, 5 }, {
+		{GY,4,1}, {BY,4,1}, {BZ,4,1}, {RW,0,10}, {GW,0,10}, {BW,0,10}, {RX,0,5}, {GZ,4,1}, {GY,0,4},
+		{GX,0,5}, {BZ,0,1}, {GZ,0,4}, {BX,0,5}, {BZ,1,1}, {BY,0,4}, {RY,0,5}, {BZ,2,1}, {RZ,0,5}, {BZ,3,1},
+		{BC6H_D,0,5} } },
+	// mode 2
+	{ 0x01, true, true, 7, { 6, 6, 6 }, {
+		{GY,5,1}, {GZ,4,1}, {GZ,5,1}, {RW,0,7}, {BZ,0,1}, {BZ,1,1}, {BY,4,1}, {GW,0,7}, {BY,5,1}, {BZ,2,1},
+		{GY,4,1}, {BW,0,7}, {BZ,3,1}, {BZ,5,1}, {BZ,4,1}, {RX,0,6}, {GY,0,4}, {GX,0,6}, {GZ,0,4}, {BX,0,6},
+		{BY,0,4}, {RY,0,6}, {RZ,0,6}, {BC6H_D,0,5} } },
+	// mode 3
+	{ 0x02, true, true, 11, { 5, 4, 4 }, {
+		{RW,0,10}, {GW,0,10}, {BW,0,10}, {RX,0,5}, {RW,10,1}, {GY,0,4}, {GX,0,4}, {GW,10,1}, {BZ,0,1},
+		{GZ,0,4}, {BX,0,4}, {BW,10,1}, {BZ,1,1}, {BY,0,4}, {RY,0,5}, {BZ,2,1}, {RZ,0,5}, {BZ,3,1},
+		{BC6H_D,0,5} } },
+	// mode 4
+	{ 0x06, true, true, 11, { 4, 5, 4 }, {
+		{RW,0,10}, {GW,0,10}, {BW,0,10}, {RX,0,4}, {RW,10,1}, {GZ,4,1}, {GY,0,4}, {GX,0,5}, {GW,10,1},
+		{GZ,0,4}, {BX,0,4}, {BW,10,1}, {BZ,1,1}, {BY,0,4}, {RY,0,4}, {BZ,0,1}, {BZ,2,1}, {RZ,0,4},
+		{GY,4,1}, {BZ,3,1}, {BC6H_D,0,5} } },
+	// mode 5
+	{ 0x0A, true, true, 11, { 4, 4, 5 }, {
+		{RW,0,10}, {GW,0,10}, {BW,0,10}, {RX,0,4}, {RW,10,1}, {BY,4,1}, {GY,0,4}, {GX,0,4}, {GW,10,1},
+		{BZ,0,1}, {GZ,0,4}, {BX,0,5}, {BW,10,1}, {BY,0,4}, {RY,0,4}, {BZ,1,1}, {BZ,2,1}, {RZ,0,4},
+		{BZ,4,1}, {BZ,3,1}, {BC6H_D,0,5} } },
+	// mode 6
+	{ 0x0E, true, true, 9, { 5, 5, 5 }, {
+		{RW,0,9}, {BY,4,1}, {GW,0,9}, {GY,4,1}, {BW,0,9}, {BZ,4,1}, {RX,0,5}, {GZ,4,1}, {GY,0,4},
+		{GX,0,5}, {BZ,0,1}, {GZ,0,4}, {BX,0,5}, {BZ,1,1}, {BY,0,4}, {RY,0,5}, {BZ,2,1}, {RZ,0,5},
+		{BZ,3,1}, {BC6H_D,0,5} } },
+	// mode 7
+	{ 0x12, true, true, 8, { 6, 5, 5 }, {
+		{RW,0,8}, {GZ,4,1}, {BY,4,1}, {GW,0,8}, {BZ,2,1}, {GY,4,1}, {BW,0,8}, {BZ,3,1}, {BZ,4,1},
+		{RX,0,6}, {GY,0,4}, {GX,0,5}, {BZ,0,1}, {GZ,0,4}, {BX,0,5}, {BZ,1,1}, {BY,0,4}, {RY,0,6},
+		{RZ,0,6}, {BC6H_D,0,5} } },
+	// mode 8
+	{ 0x16, true, true, 8, { 5, 6, 5 }, {
+		{RW,0,8}, {BZ,0,1}, {BY,4,1}, {GW,0,8}, {GY,5,1}, {GY,4,1}, {BW,0,8}, {GZ,5,1}, {BZ,4,1},
+		{RX,0,5}, {GZ,4,1}, {GY,0,4}, {GX,0,6}, {GZ,0,4}, {BX,0,5}, {BZ,1,1}, {BY,0,4}, {RY,0,5},
+		{BZ,2,1}, {RZ,0,5}, {BZ,3,1}, {BC6H_D,0,5} } },
+	// mode 9
+	{ 0x1A, true, true, 8, { 5, 5, 6 }, {
+		{RW,0,8}, {BZ,1,1}, {BY,4,1}, {GW,0,8}, {BY,5,1}, {GY,4,1}, {BW,0,8}, {BZ,5,1}, {BZ,4,1},
+		{RX,0,5}, {GZ,4,1}, {GY,0,4}, {GX,0,5}, {BZ,0,1}, {GZ,0,4}, {BX,0,6}, {BY,0,4}, {RY,0,5},
+		{BZ,2,1}, {RZ,0,5}, {BZ,3,1}, {BC6H_D,0,5} } },
+	// mode 10
+	{ 0x1E, true, false, 6, { 6, 6, 6 }, {
+		{RW,0,6}, {GZ,4,1}, {BZ,0,1}, {BZ,1,1}, {BY,4,1}, {GW,0,6}, {GY,5,1}, {BY,5,1}, {BZ,2,1},
+		{GY,4,1}, {BW,0,6}, {GZ,5,1}, {BZ,3,1}, {BZ,5,1}, {BZ,4,1}, {RX,0,6}, {GY,0,4}, {GX,0,6},
+		{GZ,0,4}, {BX,0,6}, {BY,0,4}, {RY,0,6}, {RZ,0,6}, {BC6H_D,0,5} } },
+	// mode 11
+	{ 0x03, false, false, 10, { 10, 10, 10 }, {
+		{RW,0,10}, {GW,0,10}, {BW,0,10}, {RX,0,10}, {GX,0,10}, {BX,0,10} } },
+	// mode 12
+	{ 0x07, false, true, 11, { 9, 9, 9 }, {
+		{RW,0,10}, {GW,0,10}, {BW,0,10}, {RX,0,9}, {RW,10,1}, {GX,0,9}, {GW,10,1}, {BX,0,9}, {BW,10,1} } },
+	// mode 13 (the highest bits of the first endpoint are stored in reverse order)
+	{ 0x0B, false, true, 12, { 8, 8, 8 }, {
+		{RW,0,10}, {GW,0,10}, {BW,0,10}, {RX,0,8}, {RW,11,1}, {RW,10,1}, {GX,0,8}, {GW,11,1}, {GW,10,1},
+		{BX,0,8}, {BW,11,1}, {BW,10,1} } },
+	// mode 14
+	{ 0x0F, false, true, 16, { 4, 4, 4 }, {
+		{RW,0,10}, {GW,0,10}, {BW,0,10}, {RX,0,4}, {RW,15,1}, {RW,14,1}, {RW,13,1}, {RW,12,1}, {RW,11,1},
+		{RW,10,1}, {GX,0,4}, {GW,15,1}, {GW,14,1}, {GW,13,1}, {GW,12,1}, {GW,11,1}, {GW,10,1}, {BX,0,4},
+		{BW,15,1}, {BW,14,1}, {BW,13,1}, {BW,12,1}, {BW,11,1}, {BW,10,1} } },
+};
+
+// the 5bit mode value => the entry in bc6hModes, or -1 for reserved modes
+// (the 2bit modes are in here with all possible upper bits)
+static int8_t bc6hModeIndices[32];
+
+static void InitBC6HModeIndices()
+{
+	for(int i=0; i < 32; ++i) {
+		bc6hModeIndices[i] = -1;
+	}
+	for(int m=0; m < 14; ++m) {
+		uint32_t val = bc6hModes[m].modeValue;
+		if(val < 2) {
+			for(uint32_t upper=0; upper < 8; ++upper) {
+				bc6hModeIndices[val | (upper << 2)] = m;
+			}
+		} else {
+			bc6hModeIndices[val] = m;
+		}
+	}
+}
+
+static TV_FORCEINLINE int SignExtend(int val, uint32_t numBits)
+{
+	const int shift = 32 - numBits;
+	return int(uint32_t(val) << shift) >> shift;
+}
+
+// endpoint values to 16bit (17bit with sign)
+static TV_FORCEINLINE int BC6HUnquantize(int val, uint32_t bits, bool isSigned)
+{
+	if(!isSigned) {
+		if(bits >= 15 || val == 0) {
+			return val;
+		}
+		if(val == (1 << bits) - 1) {
+			return 0xFFFF;
+		}
+		return ((val << 16) + 0x8000) >> bits;
+	}
+	if(bits >= 16) {
+		return val;
+	}
+	bool neg = val < 0;
+	if(neg) {
+		val = -val;
+	}
+	int ret;
+	if(val == 0) {
+		ret = 0;
+	} else if(val >= (1 << (bits - 1)) - 1) {
+		ret = 0x7FFF;
+	} else {
+		ret = ((val << 15) + 0x4000) >> (bits - 1);
+	}
+	return neg ? -ret : ret;
+}
+
+// interpolated value => half float bits
+static TV_FORCEINLINE uint16_t BC6HFinishUnquantize(int val, bool isSigned)
+{
+	if(!isSigned) {
+		return uint16_t((val * 31) >> 6);
+	}
+	if(val < 0) {
+		return uint16_t(0x8000 | (((-val) * 31) >> 5));
+	}
+	return uint16_t((val * 31) >> 5);
+}
+
+// decodes a BC6H block to RGB half floats (6 bytes per pixel)
+static void DecodeBC6HBlock(const uint8_t* block, bool isSigned, uint8_t* dst, size_t dstPitch)
+{
+	BitReader128 br(block);
+	uint32_t modeVal = br.Read(2);
+	if(modeVal > 1) {
+		modeVal |= br.Read(3) << 2;
+	}
+	const int modeIdx = bc6hModeIndices[modeVal];
+	if(modeIdx < 0) {
+		// reserved mode => black
+		for(int y=0; y < 4; ++y) {
+			memset(dst + y * dstPitch, 0, 4 * 6);
+		}
+		return;
+	}
+	const BC6HModeInfo& mi = bc6hModes[modeIdx];
+
+	int fields[BC6H_NUM_FIELDS] = {};
+	for(const BC6HBits& b : mi.bits) {
+		if(b.numBits == 0) {
+			break;
+		}
+		fields[b.field] |= br.Read(b.numBits) << b.firstBit;
+	}
+
+	// endpoints[region*2 + endpoint][channel]
+	const uint32_t numEndpoints = mi.twoRegions ? 4 : 2;
+	int endpoints[4][3];
+	for(uint32_t e=0; e < numEndpoints; ++e) {
+		for(uint32_t c=0; c < 3; ++c) {
+			endpoints[e][c] = fields[c * 4 + e]; // RW, RX, RY, RZ, GW, ...
+		}
+	}
+
+	const uint32_t epBits = mi.endpointBits;
+	const int epMask = (1 << epBits) - 1;
+	for(uint32_t c=0; c < 3; ++c) {
+		if(isSigned) {
+			endpoints[0][c] = SignExtend(endpoints[0][c], epBits);
+		}
+		for(uint32_t e=1; e < numEndpoints; ++e) {
+			if(isSigned || mi.transformed) {
+				endpoints[e][c] = SignExtend(endpoints[e][c], mi.deltaBits[c]);
+			}
+			if(mi.transformed) {
+				endpoints[e][c] = (endpoints[0][c] + endpoints[e][c]) & epMask;
+				if(isSigned) {
+					endpoints[e][c] = SignExtend(endpoints[e][c], epBits);
+				}
+			}
+		}
+	}
+	for(uint32_t e=0; e < numEndpoints; ++e) {
+		for(uint32_t c=0; c < 3; ++c) {
+			endpoints[e][c] = BC6HUnquantize(endpoints[e][c], epBits, isSigned);
+		}
+	}
+
+	const uint32_t partition = fields[BC6H_D];
+	const uint8_t* partitionTab = mi.twoRegions ? bc7Partition2[partition] : bc7PartitionNone;
+	const uint32_t anchor2 = mi.twoRegions ? bc7Anchor2of2[partition] : 0;
+	const uint32_t indexBits = mi.twoRegions ? 3 : 4;
+	const uint8_t* weights = GetBPTCWeights(indexBits);
+
+	for(uint32_t i=0; i < 16; ++i) {
+		const bool isAnchor = (i == 0) || (i == anchor2 && mi.twoRegions);
+		const uint32_t w = weights[br.Read(isAnchor ? indexBits - 1 : indexBits)];
+		const int* ep0 = endpoints[partitionTab[i] * 2];
+		const int* ep1 = endpoints[partitionTab[i] * 2 + 1];
+		uint16_t px[3];
+		for(uint32_t c=0; c < 3; ++c) {
+			int val = ((64 - int(w)) * ep0[c] + int(w) * ep1[c] + 32) >> 6;
+			px[c] = BC6HFinishUnquantize(val, isSigned);
+		}
+		memcpy(dst + (i / 4) * dstPitch + (i % 4) * 6, px, 6);
+	}
+}
+
+static void DecodeBC6HRow(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                          uint8_t* dst, size_t dstPitch)
+{
+	const DecoderType dec = fi.decoder;
+	const bool isSigned = (dec == DEC_BC6HS);
+	for(uint32_t b=0; b < numBlocks; ++b) {
+		DecodeBC6HBlock(blocks + b * 16, isSigned, dst + b * 4 * 6, dstPitch);
+	}
+}
+
+// ############ ASTC ############
+
+// ASTC is a lot more complex than the BCn formats: there are many block sizes
+// ("footprints"), each block can use a differently sized grid of weights (that's
+// bilinearly interpolated to the block size), up to 4 partitions with their own
+// color endpoint modes (some of them HDR), and all values are stored with
+// "integer sequence encoding" that packs values with ranges like 0..4 or 0..11.
+// See https://registry.khronos.org/DataFormat/specs/1.3/dataformat.1.3.html#ASTC
+// Everything that only depends on the footprint and the block mode or partition
+// seed is calculated once per footprint (when a format with that footprint is first
+// decoded), so decoding a block is mostly unpacking the integers and table lookups.
+// Only 2D blocks are supported, there are no 3D textures in texview anyway.
+
+// the 128 bits of an ASTC block
+struct ASTCBits {
+	uint64_t lo;
+	uint64_t hi;
+
+	// returns numBits (< 32) bits starting at bit pos, bits after the end of the block are 0
+	TV_FORCEINLINE uint32_t Get(uint32_t pos, uint32_t numBits) const
+	{
+		uint64_t val;
+		if(pos >= 128) {
+			return 0;
+		} else if(pos >= 64) {
+			val = hi >> (pos - 64);
+		} else if(pos == 0) {
+			val = lo;
+		} else {
+			val = (lo >> pos) | (hi << (64 - pos));
+		}
+		return uint32_t(val) & ((1u << numBits) - 1);
+	}
+
+	// returns numBits bits starting at pos, moved to the start, everything after them is 0
+	TV_FORCEINLINE ASTCBits Extract(uint32_t pos, uint32_t numBits) const
+	{
+		ASTCBits ret = *this;
+		if(pos >= 64) {
+			ret.lo = hi >> (pos - 64);
+			ret.hi = 0;
+		} else if(pos > 0) {
+			ret.lo = (lo >> pos) | (hi << (64 - pos));
+			ret.hi = hi >> pos;
+		}
+		if(numBits < 64) {
+			ret.lo &= (uint64_t(1) << numBits) - 1;
+			ret.hi = 0;
+		} else if(numBits < 128) {
+			ret.hi &= (uint64_t(1) << (numBits - 64)) - 1;
+		}
+		return ret;
+	}
+};
+
+static TV_FORCEINLINE uint64_t ReverseBits64(uint64_t v)
+{
+	v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+	v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+	v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+	v = ((v >> 8) & 0x00FF00FF00FF00FFULL) | ((v & 0x00FF00FF00FF00FFULL) << 8);
+	v = ((v >> 16) & 0x0000FFFF0000FFFFULL) | ((v & 0x0000FFFF0000FFFFULL) << 16);
+	return (v >> 32) | (v << 32);
+}
+
+// the ranges supported by the integer sequence encoding, from 0..1 to 0..255.
+// each value has the given number of bits, and (optionally) a trit (0..2) or quint (0..4)
+// on top of them, 5 trits are packed into 8 bits and 3 quints into 7 bits.
+// The weight ranges are the first 12 entries
+struct ASTCRange {
+	uint8_t trits;
+	uint8_t quints;
+	uint8_t bits;
+};
+
+static const ASTCRange astcRanges[21] = {
+	{ 0, 0, 1 }, // 0..1
+	{ 1, 0, 0 }, // 0..2
+	{ 0, 0, 2 }, // 0..3
+	{ 0, 1, 0 }, // 0..4
+	{ 1, 0, 1 }, // 0..5
+	{ 0, 0, 3 }, // 0..7
+	{ 0, 1, 1 }, // 0..9
+	{ 1, 0, 2 }, // 0..11
+	{ 0, 0, 4 }, // 0..15
+	{ 0, 1, 2 }, // 0..19
+	{ 1, 0, 3 }, // 0..23
+	{ 0, 0, 5 }, // 0..31
+	{ 0, 1, 3 }, // 0..39
+	{ 1, 0, 4 }, // 0..47
+	{ 0, 0, 6 }, // 0..63
+	{ 0, 1, 4 }, // 0..79
+	{ 1, 0, 5 }, // 0..95
+	{ 0, 0, 7 }, // 0..127
+	{ 0, 1, 5 }, // 0..159
+	{ 1, 0, 6 }, // 0..191
+	{ 0, 0, 8 }, // 0..255
+};
+
+// color endpoints need at least the 0..5 range
+enum { ASTC_MIN_COLOR_RANGE = 4 };
+
+static uint32_t ASTCSequenceBits(uint32_t numValues, uint32_t range)
+{
+	const ASTCRange& r = astcRanges[range];
+	uint32_t ret = numValues * r.bits;
+	if(r.trits) {
+		ret += (numValues * 8 + 4) / 5;
+	} else if(r.quints) {
+		ret += (numValues * 7 + 2) / 3;
+	}
+	return ret;
+}
+
+static uint8_t astcTrits[256][5];
+static uint8_t astcQuints[128][3];
+// unquantized color endpoint values (0..255) for each range >= ASTC_MIN_COLOR_RANGE
+static uint8_t astcColorUnquant[21][256];
+// unquantized weights (0..64) for each weight range
+static uint8_t astcWeightUnquant[12][32];
+// the biggest range that fits in the available bits,
+// for [number of color values / 2][available bits], 0 if none fits
+static uint8_t astcColorRangeForBits[10][129];
+// unorm16 value => half float (for LDR endpoints when decoding to half floats)
+static uint16_t astcUnorm16ToHalf[65536];
+
+// only for 0 <= f <= 65504
+static uint16_t FloatToHalf(float f)
+{
+	if(f < 6.103515625e-05f) { // subnormal
+		return uint16_t(f * 16777216.0f + 0.5f);
+	}
+	int exp = 0;
+	float mant = frexpf(f, &exp); // f = mant * 2^exp with 0.5 <= mant < 1
+	// if rounding overflows the mantissa, that carries into the exponent, which is correct
+	return uint16_t(((exp + 14) << 10) + uint32_t((mant * 2.0f - 1.0f) * 1024.0f + 0.5f));
+}
+
+// repeats the numBits bits of val until it has totalBits bits
+static uint32_t ReplicateBits(uint32_t val, uint32_t numBits, uint32_t totalBits)
+{
+	uint32_t ret = 0;
+	int pos = totalBits;
+	while(pos > 0) {
+		pos -= numBits;
+		ret |= (pos >= 0) ? (val << pos) : (val >> -pos);
+	}
+	return ret;
+}
+
+static uint8_t UnquantizeASTCColor(uint32_t range, uint32_t val)
+{
+	const ASTCRange& r = astcRanges[range];
+	if(!r.trits && !r.quints) {
+		return uint8_t(ReplicateBits(val, r.bits, 8));
+	}
+	// see the "Color Unquantization Parameters" table in the spec
+	uint32_t D = val >> r.bits; // the trit or quint
+	uint32_t m = val & ((1u << r.bits) - 1);
+	uint32_t A = (m & 1) ? 0x1FF : 0;
+	uint32_t b = m >> 1;
+	uint32_t B = 0, C = 0;
+	switch(range) {
+		case 4:  C = 204; break;
+		case 6:  C = 113; break;
+		case 7:  C = 93;  B = (b << 8) | (b << 4) | (b << 2) | (b << 1); break; // b000b0bb0
+		case 9:  C = 54;  B = (b << 8) | (b << 3) | (b << 2); break; // b0000bb00
+		case 10: C = 44;  B = (b << 7) | (b << 2) | b; break;        // cb000cbcb
+		case 12: C = 26;  B = (b << 7) | (b << 1) | (b >> 1); break; // cb0000cbc
+		case 13: C = 22;  B = (b << 6) | b; break;                   // dcb000dcb
+		case 15: C = 13;  B = (b << 6) | (b >> 1); break;            // dcb0000dc
+		case 16: C = 11;  B = (b << 5) | (b >> 2); break;            // edcb000ed
+		case 18: C = 6;   B = (b << 5) | (b >> 3); break;            // edcb0000e
+		case 19: C = 5;   B = (b << 4) | (b >> 4); break;            // fedcb000f
+	}
+	uint32_t T = (D * C + B) ^ A;
+	return uint8_t((A & 0x80) | (T >> 2));
+}
+
+static uint8_t UnquantizeASTCWeight(uint32_t range, uint32_t val)
+{
+	const ASTCRange& r = astcRanges[range];
+	uint32_t ret;
+	if(!r.trits && !r.quints) {
+		ret = ReplicateBits(val, r.bits, 6);
+	} else if(r.bits == 0) {
+		static const uint8_t tritVals[3] = { 0, 32, 63 };
+		static const uint8_t quintVals[5] = { 0, 16, 32, 47, 63 };
+		ret = r.trits ? tritVals[val] : quintVals[val];
+	} else {
+		// "Weight Unquantization Parameters" table in the spec
+		uint32_t D = val >> r.bits;
+		uint32_t m = val & ((1u << r.bits) - 1);
+		uint32_t A = (m & 1) ? 0x7F : 0;
+		uint32_t b = m >> 1;
+		uint32_t B = 0, C = 0;
+		switch(range) {
+			case 4:  C = 50; break;
+			case 6:  C = 28; break;
+			case 7:  C = 23; B = (b << 6) | (b << 2) | b; break; // b000b0b
+			case 9:  C = 13; B = (b << 6) | (b << 1); break;     // b0000b0
+			case 10: C = 11; B = (b << 5) | b; break;            // cb000cb
+		}
+		uint32_t T = (D * C + B) ^ A;
+		ret = (A & 0x20) | (T >> 2);
+	}
+	// 0..63 => 0..64
+	return uint8_t((ret > 32) ? ret + 1 : ret);
+}
+
+static void InitASTCTables()
+{
+	// the trit and quint decoding is straight from the spec
+	for(uint32_t T=0; T < 256; ++T) {
+		uint32_t C, t[5];
+		if(((T >> 2) & 7) == 7) {
+			C = (((T >> 5) & 7) << 2) | (T & 3);
+			t[4] = 2;
+			t[3] = 2;
+		} else {
+			C = T & 0x1F;
+			if(((T >> 5) & 3) == 3) {
+				t[4] = 2;
+				t[3] = (T >> 7) & 1;
+			} else {
+				t[4] = (T >> 7) & 1;
+				t[3] = (T >> 5) & 3;
+			}
+		}
+		if((C & 3) == 3) {
+			t[2] = 2;
+			t[1] = (C >> 4) & 1;
+			t[0] = (((C >> 3) & 1) << 1) | ((C >> 2) & 1 & ~(C >> 3));
+		} else if(((C >> 2) & 3) == 3) {
+			t[2] = 2;
+			t[1] = 2;
+			t[0] = C & 3;
+		} else {
+			t[2] = (C >> 4) & 1;
+			t[1] = (C >> 2) & 3;
+			t[0] = (((C >> 1) & 1) << 1) | (C & 1 & ~(C >> 1));
+		}
+		for(int i=0; i < 5; ++i) {
+			astcTrits[T][i] = uint8_t(t[i]);
+		}
+	}
+	for(uint32_t Q=0; Q < 128; ++Q) {
+		uint32_t q[3];
+		if(((Q >> 1) & 3) == 3 && ((Q >> 5) & 3) == 0) {
+			uint32_t notQ0 = ~Q & 1;
+			q[2] = ((Q & 1) << 2) | ((((Q >> 4) & notQ0)) << 1) | ((Q >> 3) & notQ0);
+			q[1] = 4;
+			q[0] = 4;
+		} else {
+			uint32_t C;
+			if(((Q >> 1) & 3) == 3) {
+				q[2] = 4;
+				C = (((Q >> 3) & 3) << 3) | ((~(Q >> 5) & 3) << 1) | (Q & 1);
+			} else {
+				q[2] = (Q >> 5) & 3;
+				C = Q & 0x1F;
+			}
+			if((C & 7) == 5) {
+				q[1] = 4;
+				q[0] = (C >> 3) & 3;
+			} else {
+				q[1] = (C >> 3) & 3;
+				q[0] = C & 7;
+			}
+		}
+		for(int i=0; i < 3; ++i) {
+			astcQuints[Q][i] = uint8_t(q[i]);
+		}
+	}
+
+	for(uint32_t r=0; r < 21; ++r) {
+		const ASTCRange& rng = astcRanges[r];
+		uint32_t numVals = (rng.trits ? 3u : (rng.quints ? 5u : 1u)) << rng.bits;
+		for(uint32_t v=0; v < numVals; ++v) {
+			if(r >= ASTC_MIN_COLOR_RANGE) {
+				astcColorUnquant[r][v] = UnquantizeASTCColor(r, v);
+			}
+			if(r < 12) {
+				astcWeightUnquant[r][v] = UnquantizeASTCWeight(r, v);
+			}
+		}
+	}
+
+	for(uint32_t pairs=1; pairs < 10; ++pairs) {
+		for(uint32_t bits=0; bits <= 128; ++bits) {
+			uint8_t best = 0;
+			for(uint32_t r=20; r >= ASTC_MIN_COLOR_RANGE; --r) {
+				if(ASTCSequenceBits(pairs * 2, r) <= bits) {
+					best = uint8_t(r);
+					break;
+				}
+			}
+			astcColorRangeForBits[pairs][bits] = best;
+		}
+	}
+
+	for(uint32_t i=0; i < 65535; ++i) {
+		astcUnorm16ToHalf[i] = FloatToHalf(i / 65535.0f);
+	}
+	astcUnorm16ToHalf[65535] = 0x3C00; // 1.0
+}
+
+// decodes numValues integers of the given range from bits (starting at bit 0).
+// bits after the end of the sequence must be 0 (ASTCBits::Extract() takes care of that)
+static void DecodeASTCIntegerSequence(const ASTCBits& bits, uint32_t numValues, uint32_t range, uint8_t* out)
+{
+	const ASTCRange& r = astcRanges[range];
+	const uint32_t n = r.bits;
+	uint32_t pos = 0;
+	if(r.trits) {
+		// 5 values with n bits each, and the 8 bits of the trits spread between them
+		for(uint32_t i=0; i < numValues; i += 5) {
+			uint32_t m[5];
+			uint32_t T;
+			m[0] = bits.Get(pos, n);       pos += n;
+			T = bits.Get(pos, 2);          pos += 2;
+			m[1] = bits.Get(pos, n);       pos += n;
+			T |= bits.Get(pos, 2) << 2;    pos += 2;
+			m[2] = bits.Get(pos, n);       pos += n;
+			T |= bits.Get(pos, 1) << 4;    pos += 1;
+			m[3] = bits.Get(pos, n);       pos += n;
+			T |= bits.Get(pos, 2) << 5;    pos += 2;
+			m[4] = bits.Get(pos, n);       pos += n;
+			T |= bits.Get(pos, 1) << 7;    pos += 1;
+			uint32_t num = std::min(5u, numValues - i);
+			for(uint32_t j=0; j < num; ++j) {
+				out[i + j] = uint8_t((astcTrits[T][j] << n) | m[j]);
+			}
+		}
+	} else if(r.quints) {
+		// same for 3 values and 7 bits of quints
+		for(uint32_t i=0; i < numValues; i += 3) {
+			uint32_t m[3];
+			uint32_t Q;
+			m[0] = bits.Get(pos, n);       pos += n;
+			Q = bits.Get(pos, 3);          pos += 3;
+			m[1] = bits.Get(pos, n);       pos += n;
+			Q |= bits.Get(pos, 2) << 3;    pos += 2;
+			m[2] = bits.Get(pos, n);       pos += n;
+			Q |= bits.Get(pos, 2) << 5;    pos += 2;
+			uint32_t num = std::min(3u, numValues - i);
+			for(uint32_t j=0; j < num; ++j) {
+				out[i + j] = uint8_t((astcQuints[Q][j] << n) | m[j]);
+			}
+		}
+	} else {
+		for(uint32_t i=0; i < numValues; ++i) {
+			out[i] = uint8_t(bits.Get(pos, n));
+			pos += n;
+		}
+	}
+}
+
+struct ASTCBlockMode {
+	uint8_t weightW; // size of the weight grid
+	uint8_t weightH;
+	uint8_t weightRange; // index into astcRanges
+	uint8_t weightBits;  // number of bits used by the weights
+	uint8_t numWeights;  // (of both planes together, if dualPlane)
+	uint8_t infillIdx;   // index of the table in ASTCFootprint::infill, 0xFF if the grid has the block size
+	bool dualPlane;
+	bool valid;
+};
+
+// how to get the weight of a texel from the (smaller) weight grid:
+// sum of gridWeight[idx[i]] * factor[i], factors add up to 16
+struct ASTCInfillTexel {
+	uint8_t idx[4];
+	uint8_t factor[4];
+};
+
+struct ASTCFootprint {
+	uint32_t blockW;
+	uint32_t blockH;
+	std::once_flag initFlag;
+	ASTCBlockMode blockModes[2048];
+	// infill tables of all weight grid sizes used by valid block modes, blockW*blockH entries each
+	std::vector<ASTCInfillTexel> infill;
+	// partition of each texel, indexed by ((numPartitions-2)*1024 + seed)*blockW*blockH + texelIdx
+	std::vector<uint8_t> partitions;
+};
+
+static ASTCFootprint astcFootprints[] = {
+	{ 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 },
+	{ 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+};
+
+// decodes the 11 bit block mode into weight grid size, range and dual plane flag
+static ASTCBlockMode DecodeASTCBlockMode(uint32_t mode, uint32_t blockW, uint32_t blockH)
+{
+	ASTCBlockMode ret = {};
+	uint32_t range = (mode >> 4) & 1;
+	uint32_t highPrecision = (mode >> 9) & 1;
+	uint32_t dualPlane = (mode >> 10) & 1;
+	uint32_t A = (mode >> 5) & 3;
+	uint32_t W, H;
+	if((mode & 3) != 0) {
+		range |= (mode & 3) << 1;
+		uint32_t B = (mode >> 7) & 3;
+		switch((mode >> 2) & 3) {
+			case 0: W = B + 4; H = A + 2; break;
+			case 1: W = B + 8; H = A + 2; break;
+			case 2: W = A + 2; H = B + 8; break;
+			default:
+				B &= 1;
+				if(mode & 0x100) {
+					W = B + 2;
+					H = A + 2;
+				} else {
+					W = A + 2;
+					H = B + 6;
+				}
+		}
+	} else {
+		range |= ((mode >> 2) & 3) << 1;
+		if(((mode >> 2) & 3) == 0) {
+			return ret; // reserved (or void extent, which is handled elsewhere)
+		}
+		uint32_t B = (mode >> 9) & 3;
+		switch((mode >> 7) & 3) {
+			case 0: W = 12; H = A + 2; break;
+			case 1: W = A + 2; H = 12; break;
+			case 2:
+				W = A + 6;
+				H = B + 6;
+				dualPlane = 0;
+				highPrecision = 0;
+				break;
+			default:
+				if(((mode >> 5) & 3) == 0) {
+					W = 6;
+					H = 10;
+				} else if(((mode >> 5) & 3) == 1) {
+					W = 10;
+					H = 6;
+				} else {
+					return ret; // reserved
+				}
+		}
+	}
+	uint32_t numWeights = W * H * (dualPlane + 1);
+	ret.weightW = uint8_t(W);
+	ret.weightH = uint8_t(H);
+	ret.weightRange = uint8_t(range - 2 + 6 * highPrecision);
+	ret.dualPlane = dualPlane != 0;
+	if(numWeights > 64 || W > blockW || H > blockH) {
+		return ret;
+	}
+	uint32_t weightBits = ASTCSequenceBits(numWeights, ret.weightRange);
+	if(weightBits < 24 || weightBits > 96) {
+		return ret;
+	}
+	ret.numWeights = uint8_t(numWeights);
+	ret.weightBits = uint8_t(weightBits);
+	ret.valid = true;
+	return ret;
+}
+
+static uint32_t ASTCHash52(uint32_t p)
+{
+	p ^= p >> 15;  p -= p << 17;  p += p << 7;  p += p << 4;
+	p ^= p >> 5;   p += p << 16;  p ^= p >> 7;  p ^= p >> 3;
+	p ^= p << 6;   p ^= p >> 17;
+	return p;
+}
+
+// straight from the spec, but without the z coordinate that's only used for 3D blocks
+static uint8_t SelectASTCPartition(uint32_t seed, uint32_t x, uint32_t y, uint32_t numPartitions, bool smallBlock)
+{
+	if(smallBlock) {
+		x <<= 1;
+		y <<= 1;
+	}
+	seed += (numPartitions - 1) * 1024;
+	uint32_t rnum = ASTCHash52(seed);
+	uint32_t s[8];
+	for(int i=0; i < 8; ++i) {
+		s[i] = (rnum >> (4 * i)) & 0xF;
+		s[i] *= s[i];
+	}
+	int sh1, sh2;
+	if(seed & 1) {
+		sh1 = (seed & 2) ? 4 : 5;
+		sh2 = (numPartitions == 3) ? 6 : 5;
+	} else {
+		sh1 = (numPartitions == 3) ? 6 : 5;
+		sh2 = (seed & 2) ? 4 : 5;
+	}
+	for(int i=0; i < 8; i += 2) {
+		s[i] >>= sh1;
+		s[i+1] >>= sh2;
+	}
+	uint32_t a = (s[0] * x + s[1] * y + (rnum >> 14)) & 0x3F;
+	uint32_t b = (s[2] * x + s[3] * y + (rnum >> 10)) & 0x3F;
+	uint32_t c = (s[4] * x + s[5] * y + (rnum >> 6)) & 0x3F;
+	uint32_t d = (s[6] * x + s[7] * y + (rnum >> 2)) & 0x3F;
+	if(numPartitions < 4) d = 0;
+	if(numPartitions < 3) c = 0;
+
+	if(a >= b && a >= c && a >= d) return 0;
+	if(b >= c && b >= d) return 1;
+	if(c >= d) return 2;
+	return 3;
+}
+
+static void InitASTCFootprint(ASTCFootprint& fp)
+{
+	const uint32_t bw = fp.blockW;
+	const uint32_t bh = fp.blockH;
+	const uint32_t numTexels = bw * bh;
+
+	// index of the infill table for each weight grid size, 0 if not created yet
+	uint8_t gridInfillIdx[13][13] = {};
+	for(uint32_t mode=0; mode < 2048; ++mode) {
+		ASTCBlockMode bm = DecodeASTCBlockMode(mode, bw, bh);
+		bm.infillIdx = 0xFF;
+		if(bm.valid && (bm.weightW != bw || bm.weightH != bh)) {
+			uint8_t& idx = gridInfillIdx[bm.weightH][bm.weightW];
+			if(idx == 0) {
+				idx = uint8_t(fp.infill.size() / numTexels) + 1;
+				// see "Weight Infill" in the spec
+				const uint32_t gw = bm.weightW;
+				const uint32_t gh = bm.weightH;
+				const uint32_t ds = (1024 + bw / 2) / (bw - 1);
+				const uint32_t dt = (1024 + bh / 2) / (bh - 1);
+				for(uint32_t t=0; t < bh; ++t) {
+					for(uint32_t s=0; s < bw; ++s) {
+						uint32_t gs = (ds * s * (gw - 1) + 32) >> 6;
+						uint32_t gt = (dt * t * (gh - 1) + 32) >> 6;
+						uint32_t fs = gs & 0xF;
+						uint32_t ft = gt & 0xF;
+						uint32_t w11 = (fs * ft + 8) >> 4;
+						uint32_t v0 = (gs >> 4) + (gt >> 4) * gw;
+						ASTCInfillTexel it;
+						it.factor[0] = uint8_t(16 - fs - ft + w11);
+						it.factor[1] = uint8_t(fs - w11);
+						it.factor[2] = uint8_t(ft - w11);
+						it.factor[3] = uint8_t(w11);
+						it.idx[0] = uint8_t(v0);
+						it.idx[1] = uint8_t(v0 + 1);
+						it.idx[2] = uint8_t(v0 + gw);
+						it.idx[3] = uint8_t(v0 + gw + 1);
+						for(int i=1; i < 4; ++i) {
+							// at the right/bottom border those would be outside the grid
+							if(it.factor[i] == 0) {
+								it.idx[i] = it.idx[0];
+							}
+						}
+						fp.infill.push_back(it);
+					}
+				}
+			}
+			bm.infillIdx = idx - 1;
+		}
+		fp.blockModes[mode] = bm;
+	}
+
+	fp.partitions.resize(3 * 1024 * numTexels);
+	const bool smallBlock = numTexels < 31;
+	for(uint32_t numPartitions=2; numPartitions <= 4; ++numPartitions) {
+		for(uint32_t seed=0; seed < 1024; ++seed) {
+			uint8_t* part = &fp.partitions[((numPartitions - 2) * 1024 + seed) * numTexels];
+			for(uint32_t y=0; y < bh; ++y) {
+				for(uint32_t x=0; x < bw; ++x) {
+					part[y * bw + x] = SelectASTCPartition(seed, x, y, numPartitions, smallBlock);
+				}
+			}
+		}
+	}
+}
+
+static std::once_flag astcTablesInitFlag;
+
+static const ASTCFootprint* GetASTCFootprint(uint32_t blockW, uint32_t blockH)
+{
+	std::call_once(astcTablesInitFlag, InitASTCTables);
+	for(ASTCFootprint& fp : astcFootprints) {
+		if(fp.blockW == blockW && fp.blockH == blockH) {
+			std::call_once(fp.initFlag, InitASTCFootprint, std::ref(fp));
+			return &fp;
+		}
+	}
+	return nullptr;
+}
+
+// color endpoint modes with HDR endpoints (2, 3, 7, 11, 14, 15)
+enum { ASTC_HDR_CEM_MASK = 0xC88C };
+
+// everything in the block before the weights and color endpoint values
+struct ASTCBlockInfo {
+	const ASTCBlockMode* mode;
+	uint32_t numPartitions;
+	uint32_t partitionSeed;
+	uint32_t cem[4]; // color endpoint mode of each partition
+	uint32_t colorStart; // first bit of the color endpoint values
+	uint32_t colorBits;
+	uint32_t numColorValues;
+	uint32_t colorRange;
+	uint32_t ccs; // for dual plane: color component that uses the second plane's weights
+	bool isHDR;   // if any partition uses HDR endpoints
+};
+
+// returns false for invalid ("error") blocks. void extent blocks must be handled before
+static bool ParseASTCBlock(const ASTCFootprint& fp, const ASTCBits& bits, ASTCBlockInfo& info)
+{
+	const ASTCBlockMode& bm = fp.blockModes[bits.Get(0, 11)];
+	if(!bm.valid) {
+		return false;
+	}
+	info.mode = &bm;
+	info.numPartitions = bits.Get(11, 2) + 1;
+	if(info.numPartitions == 4 && bm.dualPlane) {
+		return false;
+	}
+	uint32_t extraCEMBits = 0;
+	if(info.numPartitions == 1) {
+		info.partitionSeed = 0;
+		info.cem[0] = bits.Get(13, 4);
+		info.colorStart = 17;
+	} else {
+		info.partitionSeed = bits.Get(13, 10);
+		info.colorStart = 29;
+		uint32_t cemField = bits.Get(23, 6);
+		if((cemField & 3) == 0) {
+			// all partitions use the same mode
+			for(uint32_t p=0; p < info.numPartitions; ++p) {
+				info.cem[p] = cemField >> 2;
+			}
+		} else {
+			// the modes are from the same or the next class, the bits that don't fit
+			// in the field are below the weights
+			extraCEMBits = 3 * info.numPartitions - 4;
+			uint32_t cemBits = (cemField >> 2) | (bits.Get(128 - bm.weightBits - extraCEMBits, extraCEMBits) << 4);
+			uint32_t baseClass = (cemField & 3) - 1;
+			for(uint32_t p=0; p < info.numPartitions; ++p) {
+				uint32_t c = (cemBits >> p) & 1;
+				uint32_t m = (cemBits >> (info.numPartitions + 2 * p)) & 3;
+				info.cem[p] = ((baseClass + c) << 2) | m;
+			}
+		}
+	}
+	uint32_t colorEnd = 128 - bm.weightBits - extraCEMBits;
+	info.ccs = 0;
+	if(bm.dualPlane) {
+		colorEnd -= 2;
+		info.ccs = bits.Get(colorEnd, 2);
+	}
+	info.numColorValues = 0;
+	info.isHDR = false;
+	for(uint32_t p=0; p < info.numPartitions; ++p) {
+		info.numColorValues += 2 * ((info.cem[p] >> 2) + 1);
+		info.isHDR |= ((ASTC_HDR_CEM_MASK >> info.cem[p]) & 1) != 0;
+	}
+	if(info.numColorValues > 18 || colorEnd <= info.colorStart) {
+		return false;
+	}
+	info.colorBits = colorEnd - info.colorStart;
+	info.colorRange = astcColorRangeForBits[info.numColorValues / 2][info.colorBits];
+	return info.colorRange != 0;
+}
+
+struct ASTCEndpoints {
+	int e0[4]; // 16 bit values, for HDR channels in the logarithmic representation
+	int e1[4];
+	bool hdrRGB;
+	bool hdrAlpha;
+};
+
+static TV_FORCEINLINE int ClampInt(int val, int minVal, int maxVal)
+{
+	return std::min(std::max(val, minVal), maxVal);
+}
+
+static TV_FORCEINLINE void BitTransferSigned(int& a, int& b)
+{
+	b = (b >> 1) | (a & 0x80);
+	a = (a >> 1) & 0x3F;
+	if(a & 0x20) {
+		a -= 0x40;
+	}
+}
+
+static TV_FORCEINLINE void SetASTCColor(int* c, int r, int g, int b, int a)
+{
+	c[0] = r;
+	c[1] = g;
+	c[2] = b;
+	c[3] = a;
+}
+
+// sets RGB of c0 and c1 (12 bit values) for HDR color endpoint mode 11 ("HDR RGB, direct")
+static void UnpackASTCHDRRGB(const int* v, int* c0, int* c1)
+{
+	int majComp = ((v[4] & 0x80) >> 7) | ((v[5] & 0x80) >> 6);
+	if(majComp == 3) {
+		SetASTCColor(c0, v[0] << 4, v[2] << 4, (v[4] & 0x7F) << 5, 0);
+		SetASTCColor(c1, v[1] << 4, v[3] << 4, (v[5] & 0x7F) << 5, 0);
+		return;
+	}
+	int mode = ((v[1] & 0x80) >> 7) | ((v[2] & 0x80) >> 6) | ((v[3] & 0x80) >> 5);
+	int a = v[0] | ((v[1] & 0x40) << 2);
+	int b0 = v[2] & 0x3F;
+	int b1 = v[3] & 0x3F;
+	int c = v[1] & 0x3F;
+	int d0 = v[4] & 0x7F;
+	int d1 = v[5] & 0x7F;
+	static const int dBits[8] = { 7, 6, 7, 6, 5, 6, 5, 6 };
+
+	int bit0 = (v[2] >> 6) & 1;
+	int bit1 = (v[3] >> 6) & 1;
+	int bit2 = (v[4] >> 6) & 1;
+	int bit3 = (v[5] >> 6) & 1;
+	int bit4 = (v[4] >> 5) & 1;
+	int bit5 = (v[5] >> 5) & 1;
+
+	int oneHotMode = 1 << mode;
+	if(oneHotMode & 0xA4) a |= bit0 << 9;
+	if(oneHotMode & 0x8)  a |= bit2 << 9;
+	if(oneHotMode & 0x50) a |= bit4 << 9;
+	if(oneHotMode & 0x50) a |= bit5 << 10;
+	if(oneHotMode & 0xA0) a |= bit1 << 10;
+	if(oneHotMode & 0xC0) a |= bit2 << 11;
+	if(oneHotMode & 0x4)  c |= bit1 << 6;
+	if(oneHotMode & 0xE8) c |= bit3 << 6;
+	if(oneHotMode & 0x20) c |= bit2 << 7;
+	if(oneHotMode & 0x5B) {
+		b0 |= bit0 << 6;
+		b1 |= bit1 << 6;
+	}
+	if(oneHotMode & 0x12) {
+		b0 |= bit2 << 7;
+		b1 |= bit3 << 7;
+	}
+	// the bits of d0 and d1 above dBits were used above, the rest is signed
+	d0 = SignExtend(d0, dBits[mode]);
+	d1 = SignExtend(d1, dBits[mode]);
+
+	int shift = (mode >> 1) ^ 3;
+	a <<= shift;
+	b0 <<= shift;
+	b1 <<= shift;
+	c <<= shift;
+	d0 = d0 * (1 << shift);
+	d1 = d1 * (1 << shift);
+
+	int rgb0[3] = { a - c, a - b0 - c - d0, a - b1 - c - d1 };
+	int rgb1[3] = { a, a - b0, a - b1 };
+	if(majComp != 0) {
+		std::swap(rgb0[0], rgb0[majComp]);
+		std::swap(rgb1[0], rgb1[majComp]);
+	}
+	for(int i=0; i < 3; ++i) {
+		c0[i] = ClampInt(rgb0[i], 0, 0xFFF);
+		c1[i] = ClampInt(rgb1[i], 0, 0xFFF);
+	}
+}
+
+// sets RGB of c0 and c1 (12 bit values) for HDR color endpoint mode 7 ("HDR RGB, base+scale")
+static void UnpackASTCHDRRGBScale(const int* v, int* c0, int* c1)
+{
+	int modeVal = ((v[0] & 0xC0) >> 6) | ((v[1] & 0x80) >> 5) | ((v[2] & 0x80) >> 4);
+	int majComp, mode;
+	if((modeVal & 0xC) != 0xC) {
+		majComp = modeVal >> 2;
+		mode = modeVal & 3;
+	} else if(modeVal != 0xF) {
+		majComp = modeVal & 3;
+		mode = 4;
+	} else {
+		majComp = 0;
+		mode = 5;
+	}
+	int red = v[0] & 0x3F;
+	int green = v[1] & 0x1F;
+	int blue = v[2] & 0x1F;
+	int scale = v[3] & 0x1F;
+
+	int bit0 = (v[1] >> 6) & 1;
+	int bit1 = (v[1] >> 5) & 1;
+	int bit2 = (v[2] >> 6) & 1;
+	int bit3 = (v[2] >> 5) & 1;
+	int bit4 = (v[3] >> 7) & 1;
+	int bit5 = (v[3] >> 6) & 1;
+	int bit6 = (v[3] >> 5) & 1;
+
+	int oneHotMode = 1 << mode;
+	if(oneHotMode & 0x30) green |= bit0 << 6;
+	if(oneHotMode & 0x3A) green |= bit1 << 5;
+	if(oneHotMode & 0x30) blue |= bit2 << 6;
+	if(oneHotMode & 0x3A) blue |= bit3 << 5;
+	if(oneHotMode & 0x3D) scale |= bit6 << 5;
+	if(oneHotMode & 0x2D) scale |= bit5 << 6;
+	if(oneHotMode & 0x04) scale |= bit4 << 7;
+	if(oneHotMode & 0x3B) red |= bit4 << 6;
+	if(oneHotMode & 0x04) red |= bit3 << 6;
+	if(oneHotMode & 0x10) red |= bit5 << 7;
+	if(oneHotMode & 0x0F) red |= bit2 << 7;
+	if(oneHotMode & 0x05) red |= bit1 << 8;
+	if(oneHotMode & 0x0A) red |= bit0 << 8;
+	if(oneHotMode & 0x05) red |= bit0 << 9;
+	if(oneHotMode & 0x02) red |= bit6 << 9;
+	if(oneHotMode & 0x01) red |= bit3 << 10;
+	if(oneHotMode & 0x02) red |= bit5 << 10;
+
+	static const int shifts[6] = { 1, 1, 2, 3, 4, 5 };
+	int shift = shifts[mode];
+	red <<= shift;
+	green <<= shift;
+	blue <<= shift;
+	scale <<= shift;
+	if(mode != 5) {
+		green = red - green;
+		blue = red - blue;
+	}
+	int rgb[3] = { red, green, blue };
+	if(majComp != 0) {
+		std::swap(rgb[0], rgb[majComp]);
+	}
+	for(int i=0; i < 3; ++i) {
+		c0[i] = ClampInt(rgb[i] - scale, 0, 0xFFF);
+		c1[i] = ClampInt(rgb[i], 0, 0xFFF);
+	}
+}
+
+// v are the unquantized color values of the partition
+static void UnpackASTCEndpoints(uint32_t cem, const int* v, bool isSRGB, ASTCEndpoints& ep)
+{
+	// 8 bit values for LDR, 12 bit values for HDR
+	int c0[4], c1[4];
+	ep.hdrRGB = ((ASTC_HDR_CEM_MASK >> cem) & 1) != 0;
+	ep.hdrAlpha = ep.hdrRGB && cem != 14; // 14 is HDR RGB with LDR alpha
+	const int hdrOne = 0x780; // 1.0 in HDR alpha
+	switch(cem) {
+		case 0: // LDR luminance, direct
+			SetASTCColor(c0, v[0], v[0], v[0], 0xFF);
+			SetASTCColor(c1, v[1], v[1], v[1], 0xFF);
+			break;
+		case 1: { // LDR luminance, base+offset
+			int l0 = (v[0] >> 2) | (v[1] & 0xC0);
+			int l1 = std::min(l0 + (v[1] & 0x3F), 0xFF);
+			SetASTCColor(c0, l0, l0, l0, 0xFF);
+			SetASTCColor(c1, l1, l1, l1, 0xFF);
+			break;
+		}
+		case 2: { // HDR luminance, large range
+			int y0, y1;
+			if(v[1] >= v[0]) {
+				y0 = v[0] << 4;
+				y1 = v[1] << 4;
+			} else {
+				y0 = (v[1] << 4) + 8;
+				y1 = (v[0] << 4) - 8;
+			}
+			SetASTCColor(c0, y0, y0, y0, hdrOne);
+			SetASTCColor(c1, y1, y1, y1, hdrOne);
+			break;
+		}
+		case 3: { // HDR luminance, small range
+			int y0, d;
+			if(v[0] & 0x80) {
+				y0 = ((v[1] & 0xE0) << 4) | ((v[0] & 0x7F) << 2);
+				d = (v[1] & 0x1F) << 2;
+			} else {
+				y0 = ((v[1] & 0xF0) << 4) | ((v[0] & 0x7F) << 1);
+				d = (v[1] & 0x0F) << 1;
+			}
+			int y1 = std::min(y0 + d, 0xFFF);
+			SetASTCColor(c0, y0, y0, y0, hdrOne);
+			SetASTCColor(c1, y1, y1, y1, hdrOne);
+			break;
+		}
+		case 4: // LDR luminance+alpha, direct
+			SetASTCColor(c0, v[0], v[0], v[0], v[2]);
+			SetASTCColor(c1, v[1], v[1], v[1], v[3]);
+			break;
+		case 5: { // LDR luminance+alpha, base+offset
+			int v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3];
+			BitTransferSigned(v1, v0);
+			BitTransferSigned(v3, v2);
+			int l1 = ClampInt(v0 + v1, 0, 0xFF);
+			SetASTCColor(c0, v0, v0, v0, v2);
+			SetASTCColor(c1, l1, l1, l1, ClampInt(v2 + v3, 0, 0xFF));
+			break;
+		}
+		case 6: // LDR RGB, base+scale
+			SetASTCColor(c0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, 0xFF);
+			SetASTCColor(c1, v[0], v[1], v[2], 0xFF);
+			break;
+		case 7: // HDR RGB, base+scale
+			UnpackASTCHDRRGBScale(v, c0, c1);
+			c0[3] = c1[3] = hdrOne;
+			break;
+		case 8: // LDR RGB, direct
+		case 12: { // LDR RGBA, direct
+			int a0 = (cem == 12) ? v[6] : 0xFF;
+			int a1 = (cem == 12) ? v[7] : 0xFF;
+			if(v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+				SetASTCColor(c0, v[0], v[2], v[4], a0);
+				SetASTCColor(c1, v[1], v[3], v[5], a1);
+			} else {
+				// "blue contraction"
+				SetASTCColor(c0, (v[1] + v[5]) >> 1, (v[3] + v[5]) >> 1, v[5], a1);
+				SetASTCColor(c1, (v[0] + v[4]) >> 1, (v[2] + v[4]) >> 1, v[4], a0);
+			}
+			break;
+		}
+		case 9: // LDR RGB, base+offset
+		case 13: { // LDR RGBA, base+offset
+			// RGB only has 6 values, alpha is 0xFF + 0 then
+			int vt[8] = { 0, 0, 0, 0, 0, 0, 0xFF, 0 };
+			for(int i=0; i < ((cem == 13) ? 8 : 6); ++i) {
+				vt[i] = v[i];
+			}
+			if(cem == 13) {
+				BitTransferSigned(vt[7], vt[6]);
+			}
+			BitTransferSigned(vt[1], vt[0]);
+			BitTransferSigned(vt[3], vt[2]);
+			BitTransferSigned(vt[5], vt[4]);
+			int base[4] = { vt[0], vt[2], vt[4], vt[6] };
+			int sum[4] = { vt[0] + vt[1], vt[2] + vt[3], vt[4] + vt[5], vt[6] + vt[7] };
+			if(vt[1] + vt[3] + vt[5] >= 0) {
+				SetASTCColor(c0, base[0], base[1], base[2], base[3]);
+				SetASTCColor(c1, sum[0], sum[1], sum[2], sum[3]);
+			} else {
+				SetASTCColor(c0, (sum[0] + sum[2]) >> 1, (sum[1] + sum[2]) >> 1, sum[2], sum[3]);
+				SetASTCColor(c1, (base[0] + base[2]) >> 1, (base[1] + base[2]) >> 1, base[2], base[3]);
+			}
+			for(int i=0; i < 4; ++i) {
+				c0[i] = ClampInt(c0[i], 0, 0xFF);
+				c1[i] = ClampInt(c1[i], 0, 0xFF);
+			}
+			break;
+		}
+		case 10: // LDR RGB, base+scale plus two alpha
+			SetASTCColor(c0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, v[4]);
+			SetASTCColor(c1, v[0], v[1], v[2], v[5]);
+			break;
+		case 11: // HDR RGB, direct
+			UnpackASTCHDRRGB(v, c0, c1);
+			c0[3] = c1[3] = hdrOne;
+			break;
+		case 14: // HDR RGB, direct + LDR alpha
+			UnpackASTCHDRRGB(v, c0, c1);
+			c0[3] = v[6];
+			c1[3] = v[7];
+			break;
+		case 15: { // HDR RGB, direct + HDR alpha
+			UnpackASTCHDRRGB(v, c0, c1);
+			int mode = ((v[6] >> 7) & 1) | ((v[7] >> 6) & 2);
+			int v6 = v[6] & 0x7F;
+			int v7 = v[7] & 0x7F;
+			if(mode == 3) {
+				c0[3] = v6 << 5;
+				c1[3] = v7 << 5;
+			} else {
+				v6 |= (v7 << (mode + 1)) & 0x780;
+				v7 &= (0x3F >> mode);
+				v7 ^= 0x20 >> mode;
+				v7 -= 0x20 >> mode;
+				v6 <<= (4 - mode);
+				v7 = v7 * (1 << (4 - mode));
+				c0[3] = v6;
+				c1[3] = ClampInt(v6 + v7, 0, 0xFFF);
+			}
+			break;
+		}
+	}
+	// expand to 16 bits
+	for(int i=0; i < 4; ++i) {
+		bool isHDR = (i < 3) ? ep.hdrRGB : ep.hdrAlpha;
+		if(isHDR) {
+			ep.e0[i] = c0[i] << 4;
+			ep.e1[i] = c1[i] << 4;
+		} else if(isSRGB) {
+			ep.e0[i] = (c0[i] << 8) | 0x80;
+			ep.e1[i] = (c1[i] << 8) | 0x80;
+		} else {
+			ep.e0[i] = c0[i] * 257;
+			ep.e1[i] = c1[i] * 257;
+		}
+	}
+}
+
+// converts an interpolated HDR value (from the logarithmic representation) to half float
+static TV_FORCEINLINE uint16_t ASTCLNSToHalf(uint32_t val)
+{
+	uint32_t mant = val & 0x7FF;
+	uint32_t exp = val >> 11;
+	if(mant < 512) {
+		mant *= 3;
+	} else if(mant < 1536) {
+		mant = 4 * mant - 512;
+	} else {
+		mant = 5 * mant - 2048;
+	}
+	return uint16_t(std::min((exp << 10) | (mant >> 3), 0x7BFFu));
+}
+
+// fills the block with a single color, pixel has the output format
+static void FillASTCBlock(const ASTCFootprint& fp, const void* pixel, uint32_t bpp, uint8_t* dst, size_t dstPitch)
+{
+	for(uint32_t y=0; y < fp.blockH; ++y) {
+		uint8_t* dstRow = dst + y * dstPitch;
+		for(uint32_t x=0; x < fp.blockW; ++x) {
+			memcpy(dstRow + x * bpp, pixel, bpp);
+		}
+	}
+}
+
+// invalid blocks are decoded as magenta
+template<DecoderType DEC>
+static void WriteASTCErrorBlock(const ASTCFootprint& fp, uint8_t* dst, size_t dstPitch)
+{
+	if(DEC == DEC_ASTC_HDR) {
+		const uint16_t magenta[4] = { 0x3C00, 0, 0x3C00, 0x3C00 };
+		FillASTCBlock(fp, magenta, 8, dst, dstPitch);
+	} else {
+		const uint8_t magenta[4] = { 0xFF, 0, 0xFF, 0xFF };
+		FillASTCBlock(fp, magenta, 4, dst, dstPitch);
+	}
+}
+
+// "void extent" blocks have a single color
+template<DecoderType DEC>
+static void DecodeASTCVoidExtent(const ASTCFootprint& fp, const ASTCBits& bits, uint8_t* dst, size_t dstPitch)
+{
+	const bool isHDR = bits.Get(9, 1) != 0;
+	// the extent (in texture coordinates) the color is valid for is just
+	// an optimization hint for the GPU, but still must be valid
+	uint32_t minS = bits.Get(12, 13);
+	uint32_t maxS = bits.Get(25, 13);
+	uint32_t minT = bits.Get(38, 13);
+	uint32_t maxT = bits.Get(51, 13);
+	bool allOnes = (minS & maxS & minT & maxT) == 0x1FFF;
+	if(bits.Get(10, 2) != 3 || (!allOnes && (minS >= maxS || minT >= maxT))
+	   || (isHDR && DEC != DEC_ASTC_HDR)) {
+		WriteASTCErrorBlock<DEC>(fp, dst, dstPitch);
+		return;
+	}
+	uint16_t color[4];
+	for(int i=0; i < 4; ++i) {
+		color[i] = uint16_t(bits.Get(64 + 16 * i, 16));
+	}
+	if(DEC == DEC_ASTC_HDR) {
+		if(!isHDR) {
+			for(int i=0; i < 4; ++i) {
+				color[i] = astcUnorm16ToHalf[color[i]];
+			}
+		} // else the color already is in half floats
+		FillASTCBlock(fp, color, 8, dst, dstPitch);
+	} else {
+		uint8_t color8[4];
+		for(int i=0; i < 4; ++i) {
+			color8[i] = uint8_t(color[i] >> 8);
+		}
+		FillASTCBlock(fp, color8, 4, dst, dstPitch);
+	}
+}
+
+// decodes an ASTC block to RGBA8 (DEC_ASTC, DEC_ASTC_SRGB) or RGBA16F (DEC_ASTC_HDR)
+template<DecoderType DEC>
+static void DecodeASTCBlock(const ASTCFootprint& fp, const uint8_t* block, uint8_t* dst, size_t dstPitch)
+{
+	ASTCBits bits = { ReadU64(block), ReadU64(block + 8) };
+	if(bits.Get(0, 9) == 0x1FC) {
+		DecodeASTCVoidExtent<DEC>(fp, bits, dst, dstPitch);
+		return;
+	}
+	ASTCBlockInfo info;
+	// HDR endpoints are invalid when decoding to LDR
+	if(!ParseASTCBlock(fp, bits, info) || (info.isHDR && DEC != DEC_ASTC_HDR)) {
+		WriteASTCErrorBlock<DEC>(fp, dst, dstPitch);
+		return;
+	}
+	const ASTCBlockMode& bm = *info.mode;
+	const uint32_t numTexels = fp.blockW * fp.blockH;
+
+	uint8_t colorVals[18];
+	DecodeASTCIntegerSequence(bits.Extract(info.colorStart, info.colorBits),
+	                          info.numColorValues, info.colorRange, colorVals);
+	ASTCEndpoints endpoints[4];
+	const uint8_t* colorUnquant = astcColorUnquant[info.colorRange];
+	for(uint32_t p=0, valIdx=0; p < info.numPartitions; ++p) {
+		int vals[8];
+		uint32_t numVals = 2 * ((info.cem[p] >> 2) + 1);
+		for(uint32_t i=0; i < numVals; ++i) {
+			vals[i] = colorUnquant[colorVals[valIdx + i]];
+		}
+		valIdx += numVals;
+		UnpackASTCEndpoints(info.cem[p], vals, DEC == DEC_ASTC_SRGB, endpoints[p]);
+	}
+
+	// the weights are stored in reverse bit order from the end of the block
+	ASTCBits reversed = { ReverseBits64(bits.hi), ReverseBits64(bits.lo) };
+	uint8_t weightVals[64];
+	DecodeASTCIntegerSequence(reversed.Extract(0, bm.weightBits), bm.numWeights, bm.weightRange, weightVals);
+	const uint8_t* weightUnquant = astcWeightUnquant[bm.weightRange];
+	const uint32_t numPlanes = bm.dualPlane ? 2 : 1;
+	const uint32_t numGridWeights = bm.numWeights / numPlanes;
+	// with dual plane the weights of both planes are interleaved
+	uint8_t gridWeights[2][64];
+	for(uint32_t i=0; i < numGridWeights; ++i) {
+		for(uint32_t p=0; p < numPlanes; ++p) {
+			gridWeights[p][i] = weightUnquant[weightVals[i * numPlanes + p]];
+		}
+	}
+	uint8_t texelWeights[2][12 * 12];
+	const uint8_t* weights[2] = { gridWeights[0], gridWeights[numPlanes - 1] };
+	if(bm.infillIdx != 0xFF) {
+		const ASTCInfillTexel* infill = &fp.infill[bm.infillIdx * numTexels];
+		for(uint32_t p=0; p < numPlanes; ++p) {
+			const uint8_t* gw = gridWeights[p];
+			for(uint32_t t=0; t < numTexels; ++t) {
+				const ASTCInfillTexel& it = infill[t];
+				texelWeights[p][t] = uint8_t((gw[it.idx[0]] * it.factor[0] + gw[it.idx[1]] * it.factor[1]
+				                              + gw[it.idx[2]] * it.factor[2] + gw[it.idx[3]] * it.factor[3] + 8) >> 4);
+			}
+			weights[p] = texelWeights[p];
+		}
+		weights[1] = texelWeights[numPlanes - 1];
+	}
+
+	static const uint8_t noPartitions[12 * 12] = {};
+	const uint8_t* partition = noPartitions;
+	if(info.numPartitions > 1) {
+		partition = &fp.partitions[((info.numPartitions - 2) * 1024 + info.partitionSeed) * numTexels];
+	}
+
+	const uint32_t ccs = bm.dualPlane ? info.ccs : 4; // 4 => no channel uses the second plane
+	for(uint32_t y=0; y < fp.blockH; ++y) {
+		uint8_t* dstRow = dst + y * dstPitch;
+		for(uint32_t x=0; x < fp.blockW; ++x) {
+			const uint32_t t = y * fp.blockW + x;
+			const ASTCEndpoints& ep = endpoints[partition[t]];
+			const int w0 = weights[0][t];
+			const int w1 = weights[1][t];
+			uint32_t c[4];
+			for(uint32_t i=0; i < 4; ++i) {
+				int w = (i == ccs) ? w1 : w0;
+				c[i] = uint32_t((ep.e0[i] * (64 - w) + ep.e1[i] * w + 32) >> 6);
+			}
+			if(DEC == DEC_ASTC_HDR) {
+				uint16_t* px = (uint16_t*)(dstRow + x * 8);
+				for(uint32_t i=0; i < 4; ++i) {
+					bool isHDR = (i < 3) ? ep.hdrRGB : ep.hdrAlpha;
+					px[i] = isHDR ? ASTCLNSToHalf(c[i]) : astcUnorm16ToHalf[c[i]];
+				}
+			} else {
+				WriteU32(dstRow + x * 4, MakeRGBA(c[0] >> 8, c[1] >> 8, c[2] >> 8, c[3] >> 8));
+			}
+		}
+	}
+}
+
+template<DecoderType DEC>
+static void DecodeASTCRow(const uint8_t* blocks, uint32_t numBlocks, const SWDecodeFormatInfo& fi,
+                          uint8_t* dst, size_t dstPitch)
+{
+	const ASTCFootprint& fp = *GetASTCFootprint(fi.blockW, fi.blockH);
+	const uint32_t blockPitch = fi.blockW * fi.decodedFormat.bytesPerPixel;
+	for(uint32_t b=0; b < numBlocks; ++b) {
+		DecodeASTCBlock<DEC>(fp, blocks + b * 16, dst + b * blockPitch, dstPitch);
+	}
+}
+
+// returns true if any block is a HDR block, those can't be decoded to 8 bits per channel
+static bool ASTCImagesHaveHDRBlocks(const SWDecodeFormatInfo& fi, const CompressedImage* images, int numImages)
+{
+	const ASTCFootprint* fp = GetASTCFootprint(fi.blockW, fi.blockH);
+	if(fp == nullptr) {
+		return false;
+	}
+	for(int i=0; i < numImages; ++i) {
+		const CompressedImage& img = images[i];
+		size_t numBlocks = size_t((img.width + fi.blockW - 1) / fi.blockW) * ((img.height + fi.blockH - 1) / fi.blockH);
+		numBlocks = std::min(numBlocks, size_t(img.size / 16));
+		const uint8_t* blocks = (const uint8_t*)img.data;
+		for(size_t b=0; b < numBlocks; ++b) {
+			ASTCBits bits = { ReadU64(blocks + b * 16), ReadU64(blocks + b * 16 + 8) };
+			ASTCBlockInfo info;
+			if(bits.Get(0, 9) == 0x1FC) {
+				if(bits.Get(9, 1)) {
+					return true;
+				}
+			} else if(ParseASTCBlock(*fp, bits, info) && info.isHDR) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// ############ Dispatching ############
+
+static RowDecodeFun s3tcRowFun = nullptr;
+static RowDecodeFun rgtcRowFun = nullptr;
+
+static void InitDecoderFunctions()
+{
+	if(s3tcRowFun != nullptr) {
+		return;
+	}
+	// start with the scalar versions and replace them with
+	// the best SIMD version that's supported
+	RowDecodeFun s3tc = DecodeS3TCRowScalar;
+	RowDecodeFun rgtc = DecodeRGTCRowScalar;
+	const char* impl = "scalar";
+#ifdef TV_HAVE_SSE2
+	s3tc = DecodeS3TCRowSSE2;
+	impl = "SSE2";
+#endif
+#ifdef TV_HAVE_AVX2
+	if(CPUHasAVX2()) {
+		InitBC4IndexLUT();
+		s3tc = DecodeS3TCRowAVX2;
+		rgtc = DecodeRGTCRowAVX2;
+		impl = "AVX2";
+	}
+#endif
+#ifdef TV_HAVE_NEON
+	s3tc = DecodeS3TCRowNEON;
+	rgtc = DecodeRGTCRowNEON;
+	impl = "NEON";
+#endif
+	InitBC7BlockFuns();
+	InitBC6HModeIndices();
+	LogInfo("Using %s implementation for software texture decoding\n", impl);
+	rgtcRowFun = rgtc;
+	s3tcRowFun = s3tc;
+}
+
+static std::once_flag decoderInitFlag;
+
+static RowDecodeFun GetRowDecodeFun(DecoderType dec)
+{
+	std::call_once(decoderInitFlag, InitDecoderFunctions);
+	switch(dec) {
+		case DEC_BC1:
+		case DEC_BC1A:
+		case DEC_BC2:
+		case DEC_BC3:
+			return s3tcRowFun;
+		case DEC_BC4U:
+		case DEC_BC4S:
+		case DEC_BC5U:
+		case DEC_BC5S:
+			return rgtcRowFun;
+		case DEC_BC6HU:
+		case DEC_BC6HS:
+			return DecodeBC6HRow;
+		case DEC_BC7:
+			return DecodeBC7Row;
+		case DEC_ASTC:
+			return DecodeASTCRow<DEC_ASTC>;
+		case DEC_ASTC_SRGB:
+			return DecodeASTCRow<DEC_ASTC_SRGB>;
+		case DEC_ASTC_HDR:
+			return DecodeASTCRow<DEC_ASTC_HDR>;
+	}
+	return nullptr;
+}
+
+bool GetSoftwareDecodedFormat(uint32_t compressedGLformat, DecodedFormat* out,
+                               const CompressedImage* images, int numImages)
+{
+	const SWDecodeFormatInfo* fi = GetSWDecodeFormatInfo(compressedGLformat);
+	if(fi == nullptr) {
+		return false;
+	}
+	if(out != nullptr) {
+		*out = fi->decodedFormat;
+		// (sRGB ASTC can't have HDR blocks)
+		if(fi->decoder == DEC_ASTC && images != nullptr
+		   && ASTCImagesHaveHDRBlocks(*fi, images, numImages)) {
+			*out = astcHDRDecodedFormat;
+		}
+	}
+	return true;
+}
+
+// decodes block rows [firstRow, firstRow+numRows) of img
+static void DecodeBlockRows(const SWDecodeFormatInfo& fi, RowDecodeFun rowFun, const CompressedImage& img,
+                            uint32_t firstRow, uint32_t numRows)
+{
+	const uint32_t bpp = fi.decodedFormat.bytesPerPixel;
+	const uint32_t bw = fi.blockW;
+	const uint32_t bh = fi.blockH;
+	const uint32_t blocksX = (img.width + bw - 1) / bw;
+	const size_t dstPitch = size_t(img.width) * bpp;
+	const size_t srcPitch = size_t(blocksX) * fi.blockBytes;
+	const uint8_t* src = (const uint8_t*)img.data;
+	uint8_t* dst = (uint8_t*)img.decodedData;
+
+	// only whole blocks are decoded, so if the width isn't a multiple of the block width,
+	// the last block of each row is decoded into a temporary buffer and then cropped.
+	// same for the whole last row of blocks if the height isn't a multiple of the block height
+	const uint32_t fullBlocksX = img.width / bw;
+	const uint32_t lastBlockW = img.width - fullBlocksX * bw;
+	uint8_t tmpBlock[12 * 12 * 8]; // biggest ASTC block decoded to RGBA16F
+	std::vector<uint8_t> tmpRow;
+
+	for(uint32_t by = firstRow; by < firstRow + numRows; ++by) {
+		const uint8_t* srcRow = src + by * srcPitch;
+		uint8_t* dstRow = dst + size_t(by) * bh * dstPitch;
+		const uint32_t rowH = std::min(bh, img.height - by * bh);
+		if(rowH < bh) {
+			// last row of blocks, only partly inside the image
+			const size_t tmpPitch = size_t(blocksX) * bw * bpp;
+			tmpRow.resize(tmpPitch * bh);
+			rowFun(srcRow, blocksX, fi, tmpRow.data(), tmpPitch);
+			for(uint32_t y=0; y < rowH; ++y) {
+				memcpy(dstRow + y * dstPitch, tmpRow.data() + y * tmpPitch, dstPitch);
+			}
+			continue;
+		}
+		rowFun(srcRow, fullBlocksX, fi, dstRow, dstPitch);
+		if(lastBlockW != 0) {
+			rowFun(srcRow + fullBlocksX * fi.blockBytes, 1, fi, tmpBlock, bw * bpp);
+			for(uint32_t y=0; y < bh; ++y) {
+				memcpy(dstRow + y * dstPitch + fullBlocksX * bw * bpp, tmpBlock + y * bw * bpp, lastBlockW * bpp);
+			}
+		}
+	}
+}
+
+bool DecodeCompressedImages(uint32_t compressedGLformat, const CompressedImage* images, int numImages,
+                            const DecodedFormat& decodedFormat)
+{
+	const SWDecodeFormatInfo* fiPtr = GetSWDecodeFormatInfo(compressedGLformat);
+	if(fiPtr == nullptr) {
+		errprintf("Software decoding of format 0x%x is not supported!\n", compressedGLformat);
+		return false;
+	}
+	SWDecodeFormatInfo fi = *fiPtr;
+	if(fi.decoder == DEC_ASTC && decodedFormat.glIntFormat == astcHDRDecodedFormat.glIntFormat) {
+		fi.decoder = DEC_ASTC_HDR;
+		fi.decodedFormat = astcHDRDecodedFormat;
+	} else if(decodedFormat.glIntFormat != fi.decodedFormat.glIntFormat) {
+		errprintf("Software decoding of format 0x%x to 0x%x is not supported!\n",
+		          compressedGLformat, decodedFormat.glIntFormat);
+		return false;
+	}
+	RowDecodeFun rowFun = GetRowDecodeFun(fi.decoder);
+
+	// split the work into chunks of block rows (of all images) that
+	// are roughly the same size so all threads have something to do
+	struct Chunk {
+		int imgIdx;
+		uint32_t firstRow;
+		uint32_t numRows;
+	};
+	std::vector<Chunk> chunks;
+	const uint32_t pixelsPerChunk = 256 * 1024;
+	for(int i=0; i < numImages; ++i) {
+		const CompressedImage& img = images[i];
+		uint32_t blocksX = (img.width + fi.blockW - 1) / fi.blockW;
+		uint32_t blocksY = (img.height + fi.blockH - 1) / fi.blockH;
+		if(size_t(blocksX) * blocksY * fi.blockBytes > img.size) {
+			errprintf("Can't decode %u x %u image, it has only %u bytes of data!\n",
+			          img.width, img.height, img.size);
+			return false;
+		}
+		uint32_t pixelsPerRow = std::max(blocksX, 1u) * fi.blockW * fi.blockH;
+		uint32_t rowsPerChunk = std::max(1u, pixelsPerChunk / pixelsPerRow);
+		for(uint32_t row = 0; row < blocksY; row += rowsPerChunk) {
+			chunks.push_back({ i, row, std::min(rowsPerChunk, blocksY - row) });
+		}
+	}
+
+	ParallelFor((int)chunks.size(), [&](int chunkIdx) {
+		const Chunk& c = chunks[chunkIdx];
+		DecodeBlockRows(fi, rowFun, images[c.imgIdx], c.firstRow, c.numRows);
+	});
+	return true;
+}
+
+// ############ Converting uncompressed images (for thumbnails and comparisons) ############
+
+static float HalfToFloat(uint16_t h)
+{
+	uint32_t sign = uint32_t(h & 0x8000) << 16;
+	uint32_t exp = (h >> 10) & 0x1F;
+	uint32_t mant = h & 0x3FF;
+	uint32_t bits;
+	if(exp == 0) {
+		// zero or denormal => just calculate it
+		float f = mant * (1.0f / (1 << 24));
+		return sign ? -f : f;
+	} else if(exp == 31) {
+		bits = sign | 0x7F800000 | (mant << 13); // inf or NaN
+	} else {
+		bits = sign | ((exp + 112) << 23) | (mant << 13);
+	}
+	float ret;
+	memcpy(&ret, &bits, 4);
+	return ret;
+}
+
+// unsigned float with 5 exponent bits and mantissaBits bits (for R11F_G11F_B10F)
+static float SmallFloatToFloat(uint32_t val, uint32_t mantissaBits)
+{
+	uint32_t exp = val >> mantissaBits;
+	uint32_t mant = val & ((1u << mantissaBits) - 1);
+	if(exp == 0) {
+		return mant * (1.0f / (1 << 14)) / (1 << mantissaBits);
+	}
+	if(exp == 31) {
+		return (mant == 0) ? INFINITY : NAN;
+	}
+	return ldexpf(1.0f + float(mant) / (1 << mantissaBits), int(exp) - 15);
+}
+
+// returns how many bytes one pixel in glFormat/glType has (0 if unsupported)
+// and sets chanOrder to the indices (0-3 => r,g,b,a) the components are stored as
+// (-1 for components that aren't stored). Luminance sets r, g and b
+static uint32_t GetPixelLayout(uint32_t glFormat, uint32_t glType, int chanOrder[4], int* numChans)
+{
+	static const struct { uint32_t fmt; int num; int order[4]; } layouts[] = {
+		{ GL_RED,             1, { 0, -1, -1, -1 } },
+		{ GL_RG,              2, { 0,  1, -1, -1 } },
+		{ GL_RGB,             3, { 0,  1,  2, -1 } },
+		{ GL_BGR,             3, { 2,  1,  0, -1 } },
+		{ GL_RGBA,            4, { 0,  1,  2,  3 } },
+		{ GL_BGRA,            4, { 2,  1,  0,  3 } },
+		{ GL_ALPHA,           1, { 3, -1, -1, -1 } },
+		{ GL_LUMINANCE,       1, { 4, -1, -1, -1 } }, // 4: luminance
+		{ GL_LUMINANCE_ALPHA, 2, { 4,  3, -1, -1 } },
+		{ GL_DEPTH_COMPONENT, 1, { 0, -1, -1, -1 } },
+		{ GL_DEPTH_STENCIL,   1, { 0, -1, -1, -1 } }, // only the depth
+	};
+	int num = 0;
+	for(const auto& l : layouts) {
+		if(l.fmt == glFormat) {
+			num = l.num;
+			memcpy(chanOrder, l.order, sizeof(l.order));
+			break;
+		}
+	}
+	if(num == 0) {
+		return 0; // including the _INTEGER formats
+	}
+	*numChans = num;
+	switch(glType) {
+		case GL_UNSIGNED_BYTE:
+		case GL_BYTE:
+			return num;
+		case GL_UNSIGNED_SHORT:
+		case GL_SHORT:
+		case GL_HALF_FLOAT:
+			return num * 2;
+		case GL_UNSIGNED_INT:
+		case GL_INT:
+		case GL_FLOAT:
+			return num * 4;
+		// the packed formats contain all channels in one value
+		case GL_UNSIGNED_SHORT_5_6_5:
+		case GL_UNSIGNED_SHORT_4_4_4_4:
+		case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+		case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+			return 2;
+		case GL_UNSIGNED_INT_2_10_10_10_REV:
+		case GL_UNSIGNED_INT_10_10_10_2:
+		case GL_UNSIGNED_INT_10F_11F_11F_REV:
+		case GL_UNSIGNED_INT_5_9_9_9_REV:
+		case GL_UNSIGNED_INT_24_8:
+			return 4;
+		case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+			return 8;
+	}
+	return 0;
+}
+
+// extracts bits [shift, shift+numBits) of val, normalized to [0, 1]
+static inline float UnpackUnorm(uint32_t val, uint32_t shift, uint32_t numBits)
+{
+	uint32_t mask = (1u << numBits) - 1;
+	return float((val >> shift) & mask) / mask;
+}
+
+// converts one pixel to float RGBA, components that aren't stored are 0, alpha is 1
+static void PixelToFloat(const uint8_t* p, uint32_t glType, const int chanOrder[4], int numChans, float rgba[4])
+{
+	float vals[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float comps[4] = {};
+	int numComps = numChans;
+	switch(glType) {
+		case GL_UNSIGNED_BYTE:
+			for(int c=0; c < numChans; ++c)
+				comps[c] = p[c] * (1.0f / 255.0f);
+			break;
+		case GL_BYTE:
+			for(int c=0; c < numChans; ++c)
+				comps[c] = std::max(int8_t(p[c]) * (1.0f / 127.0f), -1.0f);
+			break;
+		case GL_UNSIGNED_SHORT:
+			for(int c=0; c < numChans; ++c) {
+				uint16_t v;
+				memcpy(&v, p + 2*c, 2);
+				comps[c] = v * (1.0f / 65535.0f);
+			}
+			break;
+		case GL_SHORT:
+			for(int c=0; c < numChans; ++c) {
+				int16_t v;
+				memcpy(&v, p + 2*c, 2);
+				comps[c] = std::max(v * (1.0f / 32767.0f), -1.0f);
+			}
+			break;
+		case GL_HALF_FLOAT:
+			for(int c=0; c < numChans; ++c) {
+				uint16_t v;
+				memcpy(&v, p + 2*c, 2);
+				comps[c] = HalfToFloat(v);
+			}
+			break;
+		case GL_UNSIGNED_INT:
+			for(int c=0; c < numChans; ++c)
+				comps[c] = float(ReadU32(p + 4*c) / 4294967295.0);
+			break;
+		case GL_INT:
+			for(int c=0; c < numChans; ++c)
+				comps[c] = float(std::max(int32_t(ReadU32(p + 4*c)) / 2147483647.0, -1.0));
+			break;
+		case GL_FLOAT:
+		case GL_FLOAT_32_UNSIGNED_INT_24_8_REV: // the depth is a float, ignore the stencil
+			memcpy(comps, p, 4 * numChans);
+			break;
+		default: {
+			// packed formats, they always have the components in RGBA order
+			// (or BGRA if the glFormat says so, chanOrder takes care of that)
+			uint16_t v16;
+			memcpy(&v16, p, 2);
+			uint32_t v32 = ReadU32(p);
+			switch(glType) {
+				case GL_UNSIGNED_SHORT_5_6_5:
+					comps[0] = UnpackUnorm(v16, 11, 5);
+					comps[1] = UnpackUnorm(v16, 5, 6);
+					comps[2] = UnpackUnorm(v16, 0, 5);
+					numComps = 3;
+					break;
+				case GL_UNSIGNED_SHORT_4_4_4_4:
+					for(int c=0; c < 4; ++c)
+						comps[c] = UnpackUnorm(v16, 12 - 4*c, 4);
+					numComps = 4;
+					break;
+				case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+					for(int c=0; c < 4; ++c)
+						comps[c] = UnpackUnorm(v16, 4*c, 4);
+					numComps = 4;
+					break;
+				case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+					for(int c=0; c < 3; ++c)
+						comps[c] = UnpackUnorm(v16, 5*c, 5);
+					comps[3] = UnpackUnorm(v16, 15, 1);
+					numComps = 4;
+					break;
+				case GL_UNSIGNED_INT_2_10_10_10_REV:
+					for(int c=0; c < 3; ++c)
+						comps[c] = UnpackUnorm(v32, 10*c, 10);
+					comps[3] = UnpackUnorm(v32, 30, 2);
+					numComps = 4;
+					break;
+				case GL_UNSIGNED_INT_10_10_10_2:
+					for(int c=0; c < 3; ++c)
+						comps[c] = UnpackUnorm(v32, 22 - 10*c, 10);
+					comps[3] = UnpackUnorm(v32, 0, 2);
+					numComps = 4;
+					break;
+				case GL_UNSIGNED_INT_10F_11F_11F_REV:
+					comps[0] = SmallFloatToFloat(v32 & 0x7FF, 6);
+					comps[1] = SmallFloatToFloat((v32 >> 11) & 0x7FF, 6);
+					comps[2] = SmallFloatToFloat(v32 >> 22, 5);
+					numComps = 3;
+					break;
+				case GL_UNSIGNED_INT_5_9_9_9_REV: {
+					float scale = ldexpf(1.0f, int(v32 >> 27) - 15 - 9);
+					for(int c=0; c < 3; ++c)
+						comps[c] = ((v32 >> (9*c)) & 0x1FF) * scale;
+					numComps = 3;
+				} break;
+				case GL_UNSIGNED_INT_24_8:
+					comps[0] = UnpackUnorm(v32, 8, 24);
+					numComps = 1;
+					break;
+			}
+		}
+	}
+	// for packed formats the glFormat is RGB(A) or BGR(A), its chanOrder is still right
+	// (and if it has less channels than the packed type, chanOrder is -1 for the others)
+	for(int c=0; c < numComps; ++c) {
+		int dst = chanOrder[c];
+		if(dst == 4) {
+			vals[0] = vals[1] = vals[2] = comps[c];
+		} else if(dst >= 0) {
+			vals[dst] = comps[c];
+		}
+	}
+	memcpy(rgba, vals, sizeof(vals));
+}
+
+static float ApplySwizzleChannel(const float rgba[4], char c)
+{
+	switch(c) {
+		case 'r': case 'x': return rgba[0];
+		case 'g': case 'y': return rgba[1];
+		case 'b': case 'z': return rgba[2];
+		case 'a': case 'w': return rgba[3];
+		case '0': return 0.0f;
+		case '1': return 1.0f;
+	}
+	return 0.0f;
+}
+
+bool DownscaleToRGBA8(const void* data, uint32_t width, uint32_t height, uint32_t rowPitch,
+                      uint32_t glFormat, uint32_t glType, const char* swizzle,
+                      uint32_t dstWidth, uint32_t dstHeight, uint8_t* dst)
+{
+	int chanOrder[4];
+	int numChans = 0;
+	uint32_t bpp = GetPixelLayout(glFormat, glType, chanOrder, &numChans);
+	if(bpp == 0 || width == 0 || height == 0 || dstWidth == 0 || dstHeight == 0) {
+		return false;
+	}
+	if(rowPitch == 0) {
+		rowPitch = width * bpp;
+	}
+	// box filter: every source pixel is added to the destination pixel it falls into.
+	// this is done row by row so huge images (without mipmaps) don't need lots of memory
+	std::vector<float> sums(size_t(dstWidth) * dstHeight * 4, 0.0f);
+	std::vector<uint32_t> counts(size_t(dstWidth) * dstHeight, 0);
+	std::vector<uint32_t> dstXForSrcX(width);
+	for(uint32_t x=0; x < width; ++x) {
+		dstXForSrcX[x] = uint32_t(uint64_t(x) * dstWidth / width);
+	}
+	const uint8_t* src = (const uint8_t*)data;
+	for(uint32_t y=0; y < height; ++y) {
+		uint32_t dy = uint32_t(uint64_t(y) * dstHeight / height);
+		const uint8_t* srcRow = src + size_t(y) * rowPitch;
+		float* sumRow = sums.data() + size_t(dy) * dstWidth * 4;
+		uint32_t* countRow = counts.data() + size_t(dy) * dstWidth;
+		for(uint32_t x=0; x < width; ++x) {
+			float rgba[4];
+			PixelToFloat(srcRow + x * bpp, glType, chanOrder, numChans, rgba);
+			uint32_t dx = dstXForSrcX[x];
+			for(int c=0; c < 4; ++c) {
+				// clamp here already so HDR values or NaNs don't spoil the average
+				float v = rgba[c];
+				sumRow[dx*4 + c] += (v > 0.0f) ? std::min(v, 1.0f) : 0.0f;
+			}
+			++countRow[dx];
+		}
+	}
+	for(size_t i=0; i < counts.size(); ++i) {
+		float rgba[4];
+		float div = counts[i] ? 1.0f / counts[i] : 0.0f;
+		for(int c=0; c < 4; ++c) {
+			rgba[c] = sums[i*4 + c] * div;
+		}
+		for(int c=0; c < 4; ++c) {
+			float v = (swizzle != nullptr) ? ApplySwizzleChannel(rgba, swizzle[c]) : rgba[c];
+			dst[i*4 + c] = uint8_t(v * 255.0f + 0.5f);
+		}
+	}
+	return true;
+}
+
+bool ConvertToFloatRGBA(const void* data, uint32_t width, uint32_t height, uint32_t rowPitch,
+                        uint32_t glFormat, uint32_t glType, float* dst)
+{
+	int chanOrder[4];
+	int numChans = 0;
+	uint32_t bpp = GetPixelLayout(glFormat, glType, chanOrder, &numChans);
+	if(bpp == 0 || width == 0 || height == 0) {
+		return false;
+	}
+	if(rowPitch == 0) {
+		rowPitch = width * bpp;
+	}
+	// PixelToFloat() isn't exactly fast, so convert chunks of rows in parallel
+	const uint32_t rowsPerChunk = std::max(1u, (64u * 1024u) / width);
+	const int numChunks = int((height + rowsPerChunk - 1) / rowsPerChunk);
+	const uint8_t* src = (const uint8_t*)data;
+	ParallelFor(numChunks, [&](int chunkIdx) {
+		uint32_t yStart = chunkIdx * rowsPerChunk;
+		uint32_t yEnd = std::min(yStart + rowsPerChunk, height);
+		for(uint32_t y=yStart; y < yEnd; ++y) {
+			const uint8_t* srcRow = src + size_t(y) * rowPitch;
+			float* dstRow = dst + size_t(y) * width * 4;
+			for(uint32_t x=0; x < width; ++x) {
+				PixelToFloat(srcRow + x * bpp, glType, chanOrder, numChans, dstRow + x*4);
+			}
+		}
+	});
+	return true;
+}
+
+// ############ Benchmark (texview --bench-decoders) ############
+
+// returns true if block is a valid ASTC block that's not a void extent block
+// and has HDR endpoints if wantHDR is set, or only LDR endpoints otherwise
+static bool IsBenchmarkableASTCBlock(const ASTCFootprint& fp, const uint8_t* block, bool wantHDR)
+{
+	ASTCBits bits = { ReadU64(block), ReadU64(block + 8) };
+	ASTCBlockInfo info;
+	return bits.Get(0, 9) != 0x1FC && ParseASTCBlock(fp, bits, info) && info.isHDR == wantHDR;
+}
+
+// decodes a 2048x2048 image of random blocks a few times and prints the throughput
+// for BC7, mode is the BC7 mode all blocks use (or -1 for random modes),
+// for ASTC mode 1 means that all blocks are HDR blocks, otherwise they're LDR
+static void BenchmarkDecoder(const char* name, uint32_t glFormat, int mode = -1)
+{
+	const SWDecodeFormatInfo* fi = GetSWDecodeFormatInfo(glFormat);
+	assert(fi != nullptr);
+	const uint32_t size = 2048;
+	const uint32_t numBlocks = ((size + fi->blockW - 1) / fi->blockW) * ((size + fi->blockH - 1) / fi->blockH);
+	std::vector<uint8_t> blocks(size_t(numBlocks) * fi->blockBytes);
+	uint32_t rnd = 0x12345678;
+	auto fillRandom = [&rnd](uint8_t* data, size_t numBytes) {
+		for(size_t i=0; i < numBytes; ++i) {
+			// xorshift32, good enough for random-ish blocks
+			rnd ^= rnd << 13;
+			rnd ^= rnd >> 17;
+			rnd ^= rnd << 5;
+			data[i] = uint8_t(rnd);
+		}
+	};
+	fillRandom(blocks.data(), blocks.size());
+	DecodedFormat decFmt = fi->decodedFormat;
+	const ASTCFootprint* astcFootprint = nullptr;
+	if(fi->decoder == DEC_ASTC) {
+		astcFootprint = GetASTCFootprint(fi->blockW, fi->blockH);
+		if(mode == 1) {
+			decFmt = astcHDRDecodedFormat;
+		}
+	}
+	for(uint32_t b=0; b < numBlocks; ++b) {
+		uint8_t* block = &blocks[size_t(b) * fi->blockBytes];
+		if(fi->decoder == DEC_BC7 && mode >= 0) {
+			// the mode is the lowest bit that's set
+			block[0] = (block[0] & ~((2u << mode) - 1)) | (1u << mode);
+		} else if(fi->decoder == DEC_BC6HU || fi->decoder == DEC_BC6HS) {
+			// random blocks shouldn't use the reserved modes
+			while(bc6hModeIndices[block[0] & 31] < 0) {
+				block[0] += 1;
+			}
+		} else if(astcFootprint != nullptr) {
+			// most random data isn't a valid ASTC block and would be decoded
+			// as the error color, which is a lot faster than real blocks
+			while(!IsBenchmarkableASTCBlock(*astcFootprint, block, mode == 1)) {
+				fillRandom(block, 16);
+			}
+		}
+	}
+	std::vector<uint8_t> decoded(size_t(size) * size * decFmt.bytesPerPixel);
+	CompressedImage img = { blocks.data(), (uint32_t)blocks.size(), size, size, decoded.data() };
+
+	int runs = 0;
+	double startTime = GetTimeSeconds();
+	double elapsed = 0.0;
+	// at least 3 runs, or more if it's fast, so the result isn't too noisy
+	while(runs < 3 || elapsed < 0.5) {
+		DecodeCompressedImages(glFormat, &img, 1, decFmt);
+		++runs;
+		elapsed = GetTimeSeconds() - startTime;
+	}
+	double secsPerRun = elapsed / runs;
+	double mbPerSec = (decoded.size() / (1024.0 * 1024.0)) / secsPerRun;
+	double mpixPerSec = (double(size) * size / 1000000.0) / secsPerRun;
+	printf("  %-16s %9.1f MB/s  %8.1f MPixel/s  (%.2f ms per %ux%u image)\n",
+	       name, mbPerSec, mpixPerSec, secsPerRun * 1000.0, size, size);
+}
+
+void BenchmarkSoftwareDecoders()
+{
+	GetRowDecodeFun(DEC_BC1); // initializes the decoders
+	printf("Benchmarking software texture decoders with %d threads\n", std::max(1, ThreadPoolGetNumThreads()));
+	printf("(MB/s are of the decoded data)\n");
+
+	BenchmarkDecoder("BC1", GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+	BenchmarkDecoder("BC1 RGBA", GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
+	BenchmarkDecoder("BC2", GL_COMPRESSED_RGBA_S3TC_DXT3_EXT);
+	BenchmarkDecoder("BC3", GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+	BenchmarkDecoder("BC4", GL_COMPRESSED_RED_RGTC1);
+	BenchmarkDecoder("BC4 signed", GL_COMPRESSED_SIGNED_RED_RGTC1);
+	BenchmarkDecoder("BC5", GL_COMPRESSED_RG_RGTC2);
+	BenchmarkDecoder("BC5 signed", GL_COMPRESSED_SIGNED_RG_RGTC2);
+	BenchmarkDecoder("BC6H unsigned", GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB);
+	BenchmarkDecoder("BC6H signed", GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB);
+	for(int mode=0; mode < 8; ++mode) {
+		char name[32];
+		snprintf(name, sizeof(name), "BC7 mode %d", mode);
+		BenchmarkDecoder(name, GL_COMPRESSED_RGBA_BPTC_UNORM_ARB, mode);
+	}
+
+	struct { int w, h; uint32_t glFormat; } astcFormats[] = {
+		{ 4, 4, GL_COMPRESSED_RGBA_ASTC_4x4_KHR },
+		{ 5, 4, GL_COMPRESSED_RGBA_ASTC_5x4_KHR },
+		{ 5, 5, GL_COMPRESSED_RGBA_ASTC_5x5_KHR },
+		{ 6, 5, GL_COMPRESSED_RGBA_ASTC_6x5_KHR },
+		{ 6, 6, GL_COMPRESSED_RGBA_ASTC_6x6_KHR },
+		{ 8, 5, GL_COMPRESSED_RGBA_ASTC_8x5_KHR },
+		{ 8, 6, GL_COMPRESSED_RGBA_ASTC_8x6_KHR },
+		{ 8, 8, GL_COMPRESSED_RGBA_ASTC_8x8_KHR },
+		{ 10, 5, GL_COMPRESSED_RGBA_ASTC_10x5_KHR },
+		{ 10, 6, GL_COMPRESSED_RGBA_ASTC_10x6_KHR },
+		{ 10, 8, GL_COMPRESSED_RGBA_ASTC_10x8_KHR },
+		{ 10, 10, GL_COMPRESSED_RGBA_ASTC_10x10_KHR },
+		{ 12, 10, GL_COMPRESSED_RGBA_ASTC_12x10_KHR },
+		{ 12, 12, GL_COMPRESSED_RGBA_ASTC_12x12_KHR },
+	};
+	for(const auto& af : astcFormats) {
+		char name[32];
+		snprintf(name, sizeof(name), "ASTC %dx%d", af.w, af.h);
+		BenchmarkDecoder(name, af.glFormat, 0);
+	}
+	BenchmarkDecoder("ASTC 4x4 HDR", GL_COMPRESSED_RGBA_ASTC_4x4_KHR, 1);
+	BenchmarkDecoder("ASTC 8x8 HDR", GL_COMPRESSED_RGBA_ASTC_8x8_KHR, 1);
+}
+
+} //namespace texview
@@ -18,23 +18,37 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <condition_variable>
+#include <mutex>
+
 #ifdef _WIN32
 	#define strcasecmp _stricmp
 #endif
 
 namespace texview {
 
+int glVersion = 0;
+
 void Texture::Clear()
 {
+	// the pyramid building job uses texData or decodedData, so this must be done first
+	DeletePyramid();
 	formatName.clear();
 	elements.clear();
+	decodedData.clear();
+	generatedMips.clear();
 	if(glTextureHandle > 0) {
 		glDeleteTextures(1, &glTextureHandle);
 		glTextureHandle = 0;
 	}
+	DeleteGLTiles();
+	// the inflating jobs use texData, so make sure they're done before it's freed
+	StopInflatingKTXLevels();
+	ktxLazyLevels = nullptr;
 	if(texDataFreeFun != nullptr) {
 		texDataFreeFun( (void*)texData, texDataFreeCookie );
 		texDataFreeFun = nullptr;
@@ -43,11 +57,35 @@ void Texture::Clear()
 	glFormat = glType = glTarget = 0;
 	defaultSwizzle = nullptr;
 	texData = nullptr;
+	ktxTex = nullptr; // was freed by texDataFreeFun
 
 	name.clear();
 	fileType = FT_NONE;
+	fileSize = 0;
+	fileModTime = 0;
 	textureFlags = 0;
 	dataFormat = 0;
+	nextMipToUpload = -1;
+	nextTileToUpload = -1;
+}
+
+size_t Texture::GetDataSize() const
+{
+	size_t ret = 0;
+	if(ktxTex != nullptr && decodedData.empty()) {
+		// the MipLevels of KTX textures are just placeholders with a size of w*h*4,
+		// the real sizes (incl. all layers and faces) are only known by libktx
+		for(ktx_uint32_t level = 0; level < ktxTex->numLevels; ++level) {
+			ret += ktxTexture_GetLevelSize(ktxTex, level);
+		}
+		return ret;
+	}
+	for(const std::vector<MipLevel>& mips : elements) {
+		for(const MipLevel& ml : mips) {
+			ret += ml.size;
+		}
+	}
+	return ret;
 }
 
 static const char* getGLerrorString(GLenum e)
@@ -71,27 +109,40 @@ static const char* getGLerrorString(GLenum e)
 	return ret;
 }
 
+static uint32_t GetCompressedBlockWidth(uint32_t glFormat);
+static uint32_t GetCompressedBlockHeight(uint32_t glFormat);
+
 bool Texture::UploadTexture2D(uint32_t target, int internalFormat, int level,
                               bool isCompressed, const Texture::MipLevel& mipLevel)
 {
+	// the texture has already been allocated by AllocateTextureStorage()
+	size_t maxChunkSize = UploadRingGetMaxChunkSize();
+	if(maxChunkSize != 0 && mipLevel.size > maxChunkSize) {
+		// too big for the upload ring => upload it in chunks
+		return UploadInChunks(target, internalFormat, level, -1, isCompressed, mipLevel);
+	}
+
+	// if possible, this copies the data to the upload ring (in one go from the
+	// memory-mapped file) and returns the offset in the ring to pass to GL instead
+	const void* data = UploadRingBegin(mipLevel.data, mipLevel.size);
 	if(isCompressed) {
-		glCompressedTexImage2D(target, level, internalFormat,
-							   mipLevel.width, mipLevel.height,
-							   0, mipLevel.size, mipLevel.data);
+		glCompressedTexSubImage2D(target, level, 0, 0, mipLevel.width, mipLevel.height,
+		                          internalFormat, mipLevel.size, data);
+		UploadRingEnd();
 		GLenum e = glGetError();
 		if(e != GL_NO_ERROR) {
-			errprintf("Sending data from '%s' for mipmap level %d to the GPU with glCompressedTexImage2D() failed. "
+			errprintf("Sending data from '%s' for mipmap level %d to the GPU with glCompressedTexSubImage2D() failed. "
 					  "Probably your GPU/driver doesn't support '%s' compression (glGetError() says '%s')\n",
 					  name.c_str(), level, formatName.c_str(), getGLerrorString(e));
 			return false;
 		}
 	} else {
-		glTexImage2D(target, level, internalFormat, mipLevel.width,
-					 mipLevel.height, 0, glFormat, glType,
-					 mipLevel.data);
+		glTexSubImage2D(target, level, 0, 0, mipLevel.width, mipLevel.height,
+		                glFormat, glType, data);
+		UploadRingEnd();
 		GLenum e = glGetError();
 		if(e != GL_NO_ERROR) {
-			errprintf("Sending data from '%s' for mipmap level %d to the GPU with glTexImage2D() failed. "
+			errprintf("Sending data from '%s' for mipmap level %d to the GPU with glTexSubImage2D() failed. "
 					  "glGetError() says '%s'\n", name.c_str(), level, getGLerrorString(e));
 			return false;
 		}
@@ -102,10 +153,17 @@ bool Texture::UploadTexture2D(uint32_t target, int internalFormat, int level,
 bool Texture::UploadTexture3Dslice(uint32_t target, int internalFormat, int level, int elemIdx,
                                    bool isCompressed, const Texture::MipLevel& mipLevel)
 {
+	size_t maxChunkSize = UploadRingGetMaxChunkSize();
+	if(maxChunkSize != 0 && mipLevel.size > maxChunkSize) {
+		return UploadInChunks(target, internalFormat, level, elemIdx, isCompressed, mipLevel);
+	}
+
+	const void* data = UploadRingBegin(mipLevel.data, mipLevel.size);
 	if(isCompressed) {
-		glCompressedTexSubImage3D(glTarget, level, 0, 0, elemIdx, mipLevel.width,
+		glCompressedTexSubImage3D(target, level, 0, 0, elemIdx, mipLevel.width,
 		                          mipLevel.height, 1, internalFormat,
-		                          mipLevel.size, mipLevel.data);
+		                          mipLevel.size, data);
+		UploadRingEnd();
 		int e = glGetError();
 		if(e != GL_NO_ERROR) {
 			errprintf("Sending data from '%s', array index %d for mipmap level %d to the GPU with glCompressedTexImage3D() failed. "
@@ -114,8 +172,9 @@ bool Texture::UploadTexture3Dslice(uint32_t target, int internalFormat, int leve
 			return false;
 		}
 	} else {
-		glTexSubImage3D(glTarget, level, 0, 0, elemIdx, mipLevel.width,
-		                mipLevel.height, 1, glFormat, glType, mipLevel.data);
+		glTexSubImage3D(target, level, 0, 0, elemIdx, mipLevel.width,
+		                mipLevel.height, 1, glFormat, glType, data);
+		UploadRingEnd();
 		int e = glGetError();
 		if(e != GL_NO_ERROR) {
 			errprintf("Sending data from '%s', array index %d for mipmap level %d to the GPU with glTexSubImage3D() failed. "
@@ -127,17 +186,381 @@ bool Texture::UploadTexture3Dslice(uint32_t target, int internalFormat, int leve
 	return true;
 }
 
-bool Texture::CreateOpenGLtexture()
+// uploads an image that's too big for the upload ring
+// in chunks of rows (of blocks, for compressed formats) with glTexSubImage*().
+// elemIdx is the array index (z offset), or -1 if it's not an array
+bool Texture::UploadInChunks(uint32_t target, int internalFormat, int level, int elemIdx,
+                             bool isCompressed, const Texture::MipLevel& mipLevel)
+{
+	const uint32_t width = mipLevel.width;
+	const uint32_t height = mipLevel.height;
+	const uint32_t blockH = isCompressed ? GetCompressedBlockHeight(internalFormat) : 1;
+	const uint32_t numRows = (height + blockH - 1) / blockH;
+	const size_t rowSize = mipLevel.size / numRows;
+	uint32_t rowsPerChunk = (uint32_t)std::max(size_t(1), UploadRingGetMaxChunkSize() / rowSize);
+	if(rowSize * numRows != mipLevel.size) {
+		// shouldn't happen, but if it does, upload it in one piece
+		// (from client memory, because it's too big for the upload ring)
+		rowsPerChunk = numRows;
+	}
+
+	for(uint32_t row = 0; row < numRows; row += rowsPerChunk) {
+		uint32_t chunkRows = std::min(rowsPerChunk, numRows - row);
+		uint32_t y = row * blockH;
+		uint32_t chunkHeight = std::min(chunkRows * blockH, height - y);
+		size_t chunkSize = chunkRows * rowSize;
+
+		const void* data = UploadRingBegin((const unsigned char*)mipLevel.data + row * rowSize, chunkSize);
+		if(elemIdx < 0) {
+			if(isCompressed) {
+				glCompressedTexSubImage2D(target, level, 0, y, width, chunkHeight,
+				                          internalFormat, chunkSize, data);
+			} else {
+				glTexSubImage2D(target, level, 0, y, width, chunkHeight, glFormat, glType, data);
+			}
+		} else {
+			if(isCompressed) {
+				glCompressedTexSubImage3D(target, level, 0, y, elemIdx, width, chunkHeight, 1,
+				                          internalFormat, chunkSize, data);
+			} else {
+				glTexSubImage3D(target, level, 0, y, elemIdx, width, chunkHeight, 1,
+				                glFormat, glType, data);
+			}
+		}
+		UploadRingEnd();
+		GLenum e = glGetError();
+		if(e != GL_NO_ERROR) {
+			errprintf("Sending rows %u to %u of mipmap level %d of '%s' (format '%s') to the GPU "
+			          "with glTexSubImage*() failed. glGetError() says '%s'\n", y, y + chunkHeight - 1,
+			          level, name.c_str(), formatName.c_str(), getGLerrorString(e));
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool IsASTCFormat(uint32_t glFormat, bool includeSRGB)
+{
+	// the KHR_texture_compression_astc_* formats are contiguous
+	if(glFormat >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR && glFormat <= GL_COMPRESSED_RGBA_ASTC_12x12_KHR) {
+		return true;
+	}
+	return includeSRGB && glFormat >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+	       && glFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR;
+}
+
+// returns false if the format is known to not be supported
+// by the GPU/driver, according to the available extensions
+static bool IsCompressedFormatSupported(uint32_t glFormat)
+{
+	switch(glFormat) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return GLAD_GL_EXT_texture_compression_s3tc;
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+			return GLAD_GL_EXT_texture_compression_s3tc && GLAD_GL_EXT_texture_sRGB;
+		case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB:
+		case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB:
+		case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB:
+			return GLAD_GL_ARB_texture_compression_bptc;
+		// RGTC is part of OpenGL 3.0, so it should always be supported
+	}
+	if(IsASTCFormat(glFormat, true)) {
+		return GLAD_GL_KHR_texture_compression_astc_ldr;
+	}
+	// for everything else just try uploading it
+	return true;
+}
+
+// gets the (compressed) data of all mip levels of all elements, decodedData is left nullptr
+bool Texture::GetCompressedImages(std::vector<CompressedImage>& images)
+{
+	images.clear();
+	if(!LoadAllKTXLevels()) {
+		return false;
+	}
+	for(size_t e=0; e < elements.size(); ++e) {
+		const std::vector<MipLevel>& mipLevels = elements[e];
+		for(size_t level=0; level < mipLevels.size(); ++level) {
+			const MipLevel& ml = mipLevels[level];
+			const void* data = ml.data;
+			uint32_t size = ml.size;
+			if(ktxTex != nullptr) {
+				// KTX textures only have dummy mip levels, get the data from libktx
+				ktx_uint32_t numFaces = ktxTex->numFaces;
+				ktx_size_t imgOffset = 0;
+				if(ktxTexture_GetImageOffset(ktxTex, level, e / numFaces, e % numFaces, &imgOffset) != KTX_SUCCESS) {
+					errprintf("Couldn't get data of mip level %d of element %d of '%s' from libktx\n",
+					          (int)level, (int)e, name.c_str());
+					return false;
+				}
+				data = ktxTexture_GetData(ktxTex) + imgOffset;
+				size = (uint32_t)ktxTexture_GetImageSize(ktxTex, level);
+			}
+			images.push_back({ data, size, ml.width, ml.height, nullptr });
+		}
+	}
+	return true;
+}
+
+bool Texture::SoftwareDecode()
+{
+	if(!decodedData.empty() || !(textureFlags & TF_COMPRESSED)
+	   || !GetSoftwareDecodedFormat(dataFormat, nullptr)) {
+		return false;
+	}
+	if(ktxTex != nullptr && ktxTex->baseDepth > 1) {
+		return false; // 3D textures aren't supported (by the rest of texview either)
+	}
+	std::vector<CompressedImage> images;
+	DecodedFormat decFmt;
+	if(!GetCompressedImages(images)
+	   || !GetSoftwareDecodedFormat(dataFormat, &decFmt, images.data(), (int)images.size())) {
+		return false;
+	}
+
+	size_t totalSize = 0;
+	for(const CompressedImage& img : images) {
+		size_t size = size_t(img.width) * img.height * decFmt.bytesPerPixel;
+		if(size > UINT32_MAX) { // MipLevel::size is only 32bit
+			errprintf("Texture '%s' is too big to decode in software\n", name.c_str());
+			return false;
+		}
+		totalSize += size;
+	}
+	decodedData.resize(totalSize);
+
+	size_t offset = 0;
+	for(CompressedImage& img : images) {
+		img.decodedData = decodedData.data() + offset;
+		offset += size_t(img.width) * img.height * decFmt.bytesPerPixel;
+	}
+
+	double startTime = GetTimeSeconds();
+	if(!DecodeCompressedImages(dataFormat, images.data(), (int)images.size(), decFmt)) {
+		errprintf("Decoding '%s' (%s) in software failed!\n", name.c_str(), formatName.c_str());
+		decodedData.clear();
+		decodedData.shrink_to_fit();
+		return false;
+	}
+	double ms = (GetTimeSeconds() - startTime) * 1000.0;
+	LogInfo("Decoded '%s' (%s) in software in %.2f ms\n", name.c_str(), formatName.c_str(), ms);
+
+	size_t imgIdx = 0;
+	for(std::vector<MipLevel>& mipLevels : elements) {
+		for(MipLevel& ml : mipLevels) {
+			ml.data = images[imgIdx].decodedData;
+			ml.size = ml.width * ml.height * decFmt.bytesPerPixel;
+			++imgIdx;
+		}
+	}
+	dataFormat = decFmt.glIntFormat;
+	glFormat = decFmt.glFormat;
+	glType = decFmt.glType;
+	textureFlags &= ~TF_COMPRESSED;
+	formatName += " (decoded in software)";
+	return true;
+}
+
+bool Texture::SoftwareDecodeIfUnsupported()
+{
+	if(!(textureFlags & TF_COMPRESSED)) {
+		return false;
+	}
+	if(!IsCompressedFormatSupported(dataFormat)) {
+		return SoftwareDecode();
+	}
+	// (sRGB ASTC can't have HDR blocks)
+	if(IsASTCFormat(dataFormat, false) && !GLAD_GL_KHR_texture_compression_astc_hdr) {
+		// GPUs that only support LDR ASTC decode HDR blocks as magenta,
+		// so if the texture has any, decode it in software (to half floats)
+		std::vector<CompressedImage> images;
+		DecodedFormat decFmt;
+		if(GetCompressedImages(images)
+		   && GetSoftwareDecodedFormat(dataFormat, &decFmt, images.data(), (int)images.size())
+		   && decFmt.glType == GL_HALF_FLOAT) {
+			return SoftwareDecode();
+		}
+	}
+	return false;
+}
+
+bool Texture::WithUncompressedImage(int level, int elemIdx, const UncompressedImageFun& fn)
+{
+	if(level < 0 || level >= GetNumMips() || elemIdx < 0 || elemIdx >= (int)elements.size()) {
+		return false;
+	}
+	if(ktxTex != nullptr && ktxTex->baseDepth > 1) {
+		return false; // 3D textures aren't supported
+	}
+	MipLevel& ml = elements[elemIdx][level];
+	const uint32_t w = ml.width;
+	const uint32_t h = ml.height;
+
+	bool acquiredKTXLevel = false;
+	const void* data = ml.data;
+	uint32_t size = ml.size;
+	if(ktxLazyLevels != nullptr && decodedData.empty()) {
+		// inflates just this level, in this thread
+		if(!AcquireKTXLevel(level)) {
+			return false;
+		}
+		acquiredKTXLevel = true;
+		data = ml.data;
+		size = ml.size;
+	} else if(ktxTex != nullptr && decodedData.empty()) {
+		// KTX textures only have dummy mip levels, get the data from libktx
+		ktx_uint32_t numFaces = ktxTex->numFaces;
+		ktx_size_t imgOffset = 0;
+		if(ktxTexture_GetImageOffset(ktxTex, level, elemIdx / numFaces, elemIdx % numFaces, &imgOffset) != KTX_SUCCESS) {
+			return false;
+		}
+		data = ktxTexture_GetData(ktxTex) + imgOffset;
+		size = (uint32_t)ktxTexture_GetImageSize(ktxTex, level);
+	}
+
+	bool ret = false;
+	uint32_t fmt = glFormat;
+	uint32_t type = glType;
+	// the size includes padding at the end of rows, if any (KTX1 has that)
+	uint32_t rowPitch = (size % h == 0) ? size / h : 0;
+	std::vector<uint8_t> decoded;
+	if(textureFlags & TF_COMPRESSED) {
+		CompressedImage img = { data, size, w, h, nullptr };
+		DecodedFormat decFmt;
+		if(GetSoftwareDecodedFormat(dataFormat, &decFmt, &img, 1)) {
+			decoded.resize(size_t(w) * h * decFmt.bytesPerPixel);
+			img.decodedData = decoded.data();
+			if(DecodeCompressedImages(dataFormat, &img, 1, decFmt)) {
+				data = decoded.data();
+				fmt = decFmt.glFormat;
+				type = decFmt.glType;
+				rowPitch = 0;
+			} else {
+				data = nullptr;
+			}
+		} else {
+			data = nullptr; // no software decoder for this format
+		}
+	}
+	if(data != nullptr) {
+		ret = fn(data, w, h, rowPitch, fmt, type);
+	}
+	if(acquiredKTXLevel) {
+		ReleaseKTXLevel(level);
+	}
+	return ret;
+}
+
+bool Texture::CreateThumbnail(int maxSize, std::vector<uint8_t>& rgba, int* thumbW, int* thumbH)
+{
+	int numMips = GetNumMips();
+	if(numMips == 0 || maxSize <= 0) {
+		return false;
+	}
+	// use the smallest mip level that's still at least as big as the thumbnail,
+	// so (for DDS and KTX with mipmaps) only a tiny part of the file must be read and decoded
+	int level = 0;
+	for(int l = numMips-1; l > 0; --l) {
+		const MipLevel& ml = elements[0][l];
+		if(ml.width >= (uint32_t)maxSize || ml.height >= (uint32_t)maxSize) {
+			level = l;
+			break;
+		}
+	}
+	const MipLevel& ml = elements[0][level];
+	float scale = std::min(1.0f, float(maxSize) / std::max(ml.width, ml.height));
+	int tw = std::max(1, int(ml.width * scale + 0.5f));
+	int th = std::max(1, int(ml.height * scale + 0.5f));
+
+	// same default swizzle as the viewer uses
+	const char* swizzle = defaultSwizzle;
+	if(swizzle == nullptr && !(textureFlags & TF_HAS_ALPHA)) {
+		swizzle = "rgb1";
+	}
+	bool ret = WithUncompressedImage(level, 0, [&](const void* data, uint32_t w, uint32_t h,
+	                                               uint32_t rowPitch, uint32_t fmt, uint32_t type) {
+		rgba.resize(size_t(tw) * th * 4);
+		return DownscaleToRGBA8(data, w, h, rowPitch, fmt, type, swizzle, tw, th, rgba.data());
+	});
+	if(ret) {
+		*thumbW = tw;
+		*thumbH = th;
+	}
+	return ret;
+}
+
+bool Texture::GetFloatImage(int level, int elemIdx, std::vector<float>& rgba)
+{
+	return WithUncompressedImage(level, elemIdx, [&rgba](const void* data, uint32_t w, uint32_t h,
+	                                                     uint32_t rowPitch, uint32_t fmt, uint32_t type) {
+		rgba.resize(size_t(w) * h * 4);
+		return ConvertToFloatRGBA(data, w, h, rowPitch, fmt, type, rgba.data());
+	});
+}
+
+bool Texture::CreateOpenGLtexture(size_t maxUploadBytes)
 {
 	if(glTextureHandle != 0) {
 		glDeleteTextures(1, &glTextureHandle);
 		glTextureHandle = 0;
 	}
+	DeleteGLTiles();
+	DeletePyramid();
+	nextMipToUpload = -1;
 
 	if(elements.empty())
 		return false;
 
-	if(ktxTex != nullptr) {
+	// usually this has already been done when loading the texture, but just to be sure..
+	SoftwareDecodeIfUnsupported();
+
+	if(UploadToOpenGL(maxUploadBytes)) {
+		return true;
+	}
+	// the extensions said it should work, but it didn't.
+	// if it's a compressed format we can decode in software, do that and try again
+	if((textureFlags & TF_COMPRESSED) && GetSoftwareDecodedFormat(dataFormat, nullptr)) {
+		LogWarn("Couldn't upload '%s' in format %s, trying again after decoding it in software\n",
+		        name.c_str(), formatName.c_str());
+		if(glTextureHandle != 0) {
+			glDeleteTextures(1, &glTextureHandle);
+			glTextureHandle = 0;
+		}
+		DeleteGLTiles();
+		if(SoftwareDecode()) {
+			return UploadToOpenGL(maxUploadBytes);
+		}
+	}
+	nextMipToUpload = -1;
+	return false;
+}
+
+bool Texture::ContinueUpload(size_t maxUploadBytes)
+{
+	if(pyramid != nullptr) {
+		return ContinuePyramid(maxUploadBytes);
+	}
+	if(nextTileToUpload >= 0) {
+		return UploadNextTiles(maxUploadBytes);
+	}
+	if(nextMipToUpload < 0 || glTextureHandle == 0) {
+		return false;
+	}
+	glBindTexture(glTarget, glTextureHandle);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	return UploadNextMipLevels(maxUploadBytes, false);
+}
+
+bool Texture::UploadToOpenGL(size_t maxUploadBytes)
+{
+	if(ktxTex != nullptr && decodedData.empty() && ktxLazyLevels == nullptr) {
 		GLenum target = 0;
 		GLenum glErr = 0;
 		KTX_error_code res = ktxTexture_GLUpload(ktxTex, &glTextureHandle, &target, &glErr);
@@ -148,19 +571,213 @@ bool Texture::CreateOpenGLtexture()
 			return false;
 		}
 		glTarget = target;
-		GLint intFmt = 0;
-		GLenum baseFmt = 0;
-		ktxTexture_GetOpenGLFormat(ktxTex, &intFmt, &baseFmt, NULL, NULL);
 		return true;
 	}
 
+	if(NeedsTiles()) {
+		// with a pyramid only the visible tiles must be on the GPU,
+		// glTiles are for formats that can't be converted for it
+		if(StartPyramid()) {
+			return true;
+		}
+		return UploadTiled(maxUploadBytes);
+	}
+
 	glGenTextures(1, &glTextureHandle);
 	glBindTexture(glTarget, glTextureHandle);
 
-	GLenum internalFormat = dataFormat;
-	int numMips = GetNumMips();
+	// rows of DDS data and of the software-decoded data are tightly packed,
+	// the default alignment of 4 breaks e.g. GL_R8 textures with odd widths
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 	glGetError();
+
+	if(!AllocateTextureStorage()) {
+		return false;
+	}
+
+	// the levels are uploaded from the smallest to the biggest one, so if
+	// only a part of them is uploaded now, the texture can be shown already
+	// (with GL_TEXTURE_BASE_LEVEL set to the finest level that's available)
+	uploadStartTime = GetTimeSeconds();
+	uploadBusyTime = 0.0;
+	uploadedBytes = 0;
+	nextMipToUpload = GetNumMips() - 1;
+	return UploadNextMipLevels(maxUploadBytes, true);
+}
+
+// glTexStorage*() needs sized internal formats, stb_image images use unsized ones
+static bool IsUnsizedFormat(uint32_t internalFormat)
+{
+	switch(internalFormat) {
+		case GL_RED:
+		case GL_RG:
+		case GL_RGB:
+		case GL_RGBA:
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+		case GL_LUMINANCE_ALPHA:
+		case GL_INTENSITY:
+		case GL_DEPTH_COMPONENT:
+		case GL_DEPTH_STENCIL:
+			return true;
+	}
+	return false;
+}
+
+// allocates all mipmap levels of the (bound) texture, for all cubemap faces
+// and array elements, before any data is uploaded with glTex(Sub)Image*().
+// If possible that's done at once with glTexStorage*(), so the driver knows
+// the whole texture upfront and doesn't have to revalidate (and maybe reallocate)
+// it after each level - also, the memory use of big arrays is predictable.
+// Otherwise the levels are allocated one by one, but still from the biggest
+// to the smallest one, because the levels are uploaded in the opposite order
+// (see UploadNextMipLevels()) and some drivers lose the small levels if they're
+// specified first and don't match the size of the level 0 specified afterwards.
+bool Texture::AllocateTextureStorage()
+{
+	const int numMips = GetNumMips();
+	const bool isArray = IsArray();
+	const bool isCubemap = IsCubemap();
+	GLenum internalFormat = dataFormat;
+
+	// cubemap arrays are loaded like normal arrays but with 6 times the elements,
+	// loading always all faces of one cubemap and then the same for the next cubemap
+	// incomplete cubemaps are not allowed in arrays
+	// see also https://www.khronos.org/opengl/wiki/Cubemap_Texture#Cubemap_array_textures
+	// (if this happens, I'll just leave the memory of missing faces uninitialized)
+	uint32_t numLogicalElements = GetNumElements();
+	if(isArray && isCubemap) {
+		numLogicalElements *= 6;
+	}
+
+	if(GLAD_GL_ARB_texture_storage && !IsUnsizedFormat(internalFormat)) {
+		uint32_t width = elements[0][0].width;
+		uint32_t height = elements[0][0].height;
+		if(isArray) {
+			glTexStorage3D(glTarget, numMips, internalFormat, width, height, numLogicalElements);
+		} else {
+			// for cubemaps this allocates all 6 faces
+			glTexStorage2D(glTarget, numMips, internalFormat, width, height);
+		}
+		GLenum e = glGetError();
+		if(e == GL_NO_ERROR) {
+			return true;
+		}
+		LogWarn("Allocating '%s' (%s) with glTexStorage*() failed (glGetError() says '%s'), "
+		        "allocating its mipmap levels one by one instead\n",
+		        name.c_str(), formatName.c_str(), getGLerrorString(e));
+	}
+
+	for(int mipIdx = 0; mipIdx < numMips; ++mipIdx) {
+		uint32_t width = elements[0][mipIdx].width;
+		uint32_t height = elements[0][mipIdx].height;
+		// according to https://community.khronos.org/t/glcompressedteximage2d-and-null-data/41505/8
+		// one can't pass data=NULL to glCompressedTexImage*(), but to just reserve space
+		// compressed internal formats can be passed to glTexImage*() (unlike when uploading data)
+		const char* funName = "glTexImage2D";
+		if(isArray) {
+			glTexImage3D(glTarget, mipIdx, internalFormat, width, height, numLogicalElements, 0, glFormat, glType, nullptr);
+			funName = "glTexImage3D";
+		} else if(isCubemap) {
+			for(int cf=0; cf < 6; ++cf) {
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + cf, mipIdx, internalFormat, width, height, 0, glFormat, glType, nullptr);
+			}
+		} else {
+			glTexImage2D(glTarget, mipIdx, internalFormat, width, height, 0, glFormat, glType, nullptr);
+		}
+		GLenum e = glGetError();
+		if(e != GL_NO_ERROR) {
+			errprintf("Allocating GPU memory for mipmap level %d (%u x %u) of texture '%s' with "
+			          "%u elements for format '%s' with %s() failed. Maybe your GPU/driver doesn't "
+			          "support that format (glGetError() says '%s')\n",
+			          mipIdx, width, height, name.c_str(), numLogicalElements,
+			          formatName.c_str(), funName, getGLerrorString(e));
+			return false;
+		}
+	}
+	return true;
+}
+
+// uploads mip levels, starting at nextMipToUpload and going to finer levels,
+// until the next level wouldn't fit into maxUploadBytes anymore (but at least one).
+// if !mayWait, lazily inflated KTX levels that aren't ready yet aren't waited for
+// (unless it's the first one)
+bool Texture::UploadNextMipLevels(size_t maxUploadBytes, bool mayWait)
+{
+	const bool firstBatch = mayWait;
+	const int prevNextMip = nextMipToUpload;
+	const double batchStartTime = GetTimeSeconds();
+	bool anySuccess = false;
+	size_t batchBytes = 0;
+	while(nextMipToUpload >= 0) {
+		int mipIdx = nextMipToUpload;
+		size_t levelSize = 0;
+		if(ktxLazyLevels != nullptr) {
+			levelSize = ktxTexture_GetLevelSize(ktxTex, mipIdx);
+		} else {
+			for(const std::vector<MipLevel>& mipLevels : elements) {
+				levelSize += mipLevels[mipIdx].size;
+			}
+		}
+		if(batchBytes > 0 && batchBytes + levelSize > maxUploadBytes) {
+			break;
+		}
+		if(ktxLazyLevels != nullptr) {
+			// (when uploading everything at once, there's no next time)
+			if(!mayWait && maxUploadBytes != SIZE_MAX && !IsKTXLevelReady(mipIdx)) {
+				break; // try again next time
+			}
+			if(!AcquireKTXLevel(mipIdx)) {
+				--nextMipToUpload;
+				continue;
+			}
+		}
+		if(UploadMipLevel(mipIdx)) {
+			anySuccess = true;
+		}
+		if(ktxLazyLevels != nullptr) {
+			ReleaseKTXLevel(mipIdx);
+		}
+		batchBytes += levelSize;
+		mayWait = false; // only wait for the first level (if at all)
+		--nextMipToUpload;
+	}
+
+	if(nextMipToUpload != prevNextMip) {
+		glTexParameteri(glTarget, GL_TEXTURE_BASE_LEVEL, nextMipToUpload + 1);
+		double now = GetTimeSeconds();
+		double ms = (now - uploadStartTime) * 1000.0;
+		uploadBusyTime += now - batchStartTime;
+		uploadedBytes += batchBytes;
+		if(nextMipToUpload < 0) {
+			// this is the throughput as seen by the main thread: with the upload ring,
+			// the actual transfer to the GPU happens asynchronously
+			double mb = uploadedBytes / (1024.0 * 1024.0);
+			double mbPerSec = mb / std::max(uploadBusyTime, 0.000001);
+			const char* how = (UploadRingGetMaxChunkSize() == 0) ? "from client memory"
+			                  : UploadRingIsPersistent() ? "through persistently mapped PBO" : "through PBO";
+			if(firstBatch) {
+				LogInfo("Uploaded '%s' (%.1f MB) to the GPU in %.2f ms (%.1f MB/s %s)\n",
+				        name.c_str(), mb, ms, mbPerSec, how);
+			} else {
+				LogInfo("Progressive upload of '%s' (%.1f MB) to the GPU finished after %.2f ms, "
+				        "%.2f ms of that were spent uploading (%.1f MB/s %s)\n",
+				        name.c_str(), mb, ms, uploadBusyTime * 1000.0, mbPerSec, how);
+			}
+		} else if(firstBatch) {
+			LogInfo("Uploaded mip levels %d to %d of '%s' in %.2f ms, the rest follows progressively\n",
+			        nextMipToUpload + 1, prevNextMip, name.c_str(), ms);
+		}
+	}
+	return anySuccess;
+}
+
+// uploads the given mipmap level of all elements (cubemap faces, array layers)
+// to the currently bound texture
+bool Texture::UploadMipLevel(int mipIdx)
+{
+	GLenum internalFormat = dataFormat;
 	bool anySuccess = false;
 
 	const bool isArray = IsArray();
@@ -172,92 +789,303 @@ bool Texture::CreateOpenGLtexture()
 			for(int cf=0; cf < 6; ++cf) {
 				if(textureFlags & (TF_CUBEMAP_XPOS << cf)) {
 					GLenum target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + cf;
-					std::vector<MipLevel>& mipLevels = elements[elemIdx];
-					for(int i=0; i < numMips; ++i) {
-						if(UploadTexture2D(target, internalFormat, i, isCompressed, mipLevels[i])) {
-							anySuccess = true;
-						}
+					if(UploadTexture2D(target, internalFormat, mipIdx, isCompressed, elements[elemIdx][mipIdx])) {
+						anySuccess = true;
 					}
 					++elemIdx;
 				}
 			}
 		} else { // Texture2D
-			std::vector<MipLevel>& mipLevels = elements[0];
-			for(int i=0; i < numMips; ++i) {
-				if(UploadTexture2D(glTarget, internalFormat, i, isCompressed, mipLevels[i])) {
-					anySuccess = true;
-				}
+			if(UploadTexture2D(glTarget, internalFormat, mipIdx, isCompressed, elements[0][mipIdx])) {
+				anySuccess = true;
 			}
 		}
 	} else { // it's an array
 		// somewhat helpful: https://ferransole.wordpress.com/2014/06/09/array-textures/
 		const int numElements = GetNumElements();
 		const int numCubeFaces = GetNumCubemapFaces();
-		for(int mipIdx=0; mipIdx < numMips; ++mipIdx) {
-			uint32_t width = elements[0][mipIdx].width;
-			uint32_t height = elements[0][mipIdx].height;
-
-			// first allocate the space for all array elements of this mipmap level
-
-			// cubemap arrays are loaded like normal arrays but with 6 times the elements,
-			// loading always all faces of one cubemap and then the same for the next cubemap
-			// incomplete cubemaps are not allowed in arrays
-			// see also https://www.khronos.org/opengl/wiki/Cubemap_Texture#Cubemap_array_textures
-			// (if this happens, I'll just leave the memory of missing faces uninitialized)
-			uint32_t numLogicalElements = numElements;
-			if(isCubemap) {
-				numLogicalElements *= 6;
-			}
-			// according to https://community.khronos.org/t/glcompressedteximage2d-and-null-data/41505/8
-			// one can't pass data=NULL to glCompressedTexImage*(), but to just reserve space
-			// compressed internal formats can be passed to glTexImage3D (unlike when uploading data)
-			glTexImage3D(glTarget, mipIdx, internalFormat, width, height, numLogicalElements, 0, glFormat, glType, nullptr);
-			GLenum e = glGetError();
-			if(e != GL_NO_ERROR) {
-				errprintf("Allocating GPU memory for mipmap level %d (%u x %u) of texture '%s' with "
-				          "%d array elements for format '%s' on the GPU with glTexImage3D() failed. "
-				          "(glGetError() says '%s')\n",
-				          mipIdx, width, height, name.c_str(), numElements,
-				          formatName.c_str(), getGLerrorString(e));
-				return false;
-			}
 
-			// now upload the data of all array elements
-			for(int elemIdx=0; elemIdx < numElements; ++elemIdx) {
-				if(isCubemap) {
-					int realElemIdx = elemIdx * numCubeFaces; // in elements array
-					// logical index assuming (like OpenGL does) that all 6 cubemap faces are available
-					int logicalElemIdx = elemIdx * 6;
-					for(int cf=0; cf < 6; ++cf) {
-						if(textureFlags & (TF_CUBEMAP_XPOS << cf)) {
-							const MipLevel& mipLevel = elements[realElemIdx][mipIdx];
-							if(UploadTexture3Dslice(glTarget, internalFormat, mipIdx, logicalElemIdx, isCompressed, mipLevel)) {
-								anySuccess = true;
-							}
-							++realElemIdx;
+		// (the space for all array elements has been allocated by AllocateTextureStorage())
+		for(int elemIdx=0; elemIdx < numElements; ++elemIdx) {
+			if(isCubemap) {
+				int realElemIdx = elemIdx * numCubeFaces; // in elements array
+				// logical index assuming (like OpenGL does) that all 6 cubemap faces are available
+				int logicalElemIdx = elemIdx * 6;
+				for(int cf=0; cf < 6; ++cf) {
+					if(textureFlags & (TF_CUBEMAP_XPOS << cf)) {
+						const MipLevel& mipLevel = elements[realElemIdx][mipIdx];
+						if(UploadTexture3Dslice(glTarget, internalFormat, mipIdx, logicalElemIdx, isCompressed, mipLevel)) {
+							anySuccess = true;
 						}
-						++logicalElemIdx;
-					}
-				} else {
-					const MipLevel& mipLevel = elements[elemIdx][mipIdx];
-					if(UploadTexture3Dslice(glTarget, internalFormat, mipIdx, elemIdx, isCompressed, mipLevel)) {
-						anySuccess = true;
+						++realElemIdx;
 					}
+					++logicalElemIdx;
+				}
+			} else {
+				const MipLevel& mipLevel = elements[elemIdx][mipIdx];
+				if(UploadTexture3Dslice(glTarget, internalFormat, mipIdx, elemIdx, isCompressed, mipLevel)) {
+					anySuccess = true;
 				}
-			} // for elemIdx
-		} // for mipIdx
+			}
+		} // for elemIdx
 	}
 
 	return anySuccess;
 }
 
+// textures bigger than GL_MAX_TEXTURE_SIZE are split into tiles of (at most)
+// this size, which is small enough to only draw the visible parts of huge
+// images and to upload them progressively, but big enough to need only a few
+// draw calls (a 32k x 32k image has 64 tiles)
+enum { MAX_GL_TILE_SIZE = 4096 };
+
+static int GetMaxTextureSize()
+{
+	static int maxTexSize = 0;
+	if(maxTexSize == 0) {
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexSize);
+	}
+	return maxTexSize;
+}
+
+bool Texture::NeedsTiles() const
+{
+	if(IsArray() || IsCubemap()) {
+		return false;
+	}
+	if(ktxTex != nullptr && decodedData.empty()) {
+		return false; // the data isn't in elements, tiles are created from that
+	}
+	int maxTexSize = GetMaxTextureSize();
+	const MipLevel& ml = elements[0][0];
+	return maxTexSize > 0 && (ml.width > (uint32_t)maxTexSize || ml.height > (uint32_t)maxTexSize);
+}
+
+void Texture::DeleteGLTiles()
+{
+	for(GLTile& tile : glTiles) {
+		if(tile.glTextureHandle != 0) {
+			glDeleteTextures(1, &tile.glTextureHandle);
+		}
+	}
+	glTiles.clear();
+	numTileMips = 0;
+	nextTileToUpload = -1;
+}
+
+// splits the texture into glTiles and uploads the first of them
+bool Texture::UploadTiled(size_t maxUploadBytes)
+{
+	const bool isCompressed = (textureFlags & TF_COMPRESSED) != 0;
+	const uint32_t blockW = isCompressed ? GetCompressedBlockWidth(dataFormat) : 1;
+	const uint32_t blockH = isCompressed ? GetCompressedBlockHeight(dataFormat) : 1;
+	uint32_t tileSize = 1;
+	while(tileSize * 2 <= (uint32_t)std::min(GetMaxTextureSize(), (int)MAX_GL_TILE_SIZE)) {
+		tileSize *= 2;
+	}
+	if(tileSize % blockW != 0 || tileSize % blockH != 0) {
+		errprintf("'%s' is too big for your GPU/driver (max %d x %d) and can't be split into tiles "
+		          "because of its block size (%u x %u)\n", name.c_str(), GetMaxTextureSize(),
+		          GetMaxTextureSize(), blockW, blockH);
+		return false;
+	}
+	// all tiles have the same number of mip levels, and in each of them the part
+	// of a tile must start at a block boundary to be copied out of the level
+	numTileMips = 0;
+	while(numTileMips < GetNumMips()) {
+		uint32_t levelTileSize = tileSize >> numTileMips;
+		if(levelTileSize == 0 || levelTileSize % blockW != 0 || levelTileSize % blockH != 0) {
+			break;
+		}
+		++numTileMips;
+	}
+
+	const uint32_t width = elements[0][0].width;
+	const uint32_t height = elements[0][0].height;
+	for(uint32_t y = 0; y < height; y += tileSize) {
+		for(uint32_t x = 0; x < width; x += tileSize) {
+			GLTile tile = { x, y, std::min(tileSize, width - x), std::min(tileSize, height - y), 0 };
+			glTiles.push_back(tile);
+		}
+	}
+	LogInfo("'%s' (%u x %u) is too big for your GPU/driver (max %d x %d), splitting it into "
+	        "%d tiles of up to %u x %u with %d mip levels\n", name.c_str(), width, height,
+	        GetMaxTextureSize(), GetMaxTextureSize(), (int)glTiles.size(), tileSize, tileSize, numTileMips);
+
+	uploadStartTime = GetTimeSeconds();
+	uploadBusyTime = 0.0;
+	uploadedBytes = 0;
+	nextTileToUpload = 0;
+	if(!UploadNextTiles(maxUploadBytes)) {
+		DeleteGLTiles();
+		return false;
+	}
+	return true;
+}
+
+// uploads tiles, starting at nextTileToUpload, until the next one wouldn't fit
+// into maxUploadBytes anymore (but at least one), like UploadNextMipLevels()
+bool Texture::UploadNextTiles(size_t maxUploadBytes)
+{
+	const double batchStartTime = GetTimeSeconds();
+	const bool firstBatch = (nextTileToUpload == 0);
+	const int numTiles = (int)glTiles.size();
+	const MipLevel& level0 = elements[0][0];
+	const double bytesPerTexel = double(level0.size) / (double(level0.width) * level0.height);
+	bool anySuccess = false;
+	size_t batchBytes = 0;
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	while(nextTileToUpload >= 0 && nextTileToUpload < numTiles) {
+		GLTile& tile = glTiles[nextTileToUpload];
+		size_t tileBytes = size_t(bytesPerTexel * tile.width * tile.height);
+		if(batchBytes > 0 && batchBytes + tileBytes > maxUploadBytes) {
+			break;
+		}
+		if(UploadTile(tile)) {
+			anySuccess = true;
+		}
+		batchBytes += tileBytes;
+		++nextTileToUpload;
+	}
+
+	double now = GetTimeSeconds();
+	uploadBusyTime += now - batchStartTime;
+	uploadedBytes += batchBytes;
+	if(nextTileToUpload >= numTiles) {
+		nextTileToUpload = -1;
+		double mb = uploadedBytes / (1024.0 * 1024.0);
+		LogInfo("Uploaded the %d tiles of '%s' (%.1f MB) to the GPU in %.2f ms, %.2f ms of that "
+		        "were spent uploading\n", numTiles, name.c_str(), mb,
+		        (now - uploadStartTime) * 1000.0, uploadBusyTime * 1000.0);
+	} else if(firstBatch) {
+		LogInfo("Uploaded %d of %d tiles of '%s' in %.2f ms, the rest follows progressively\n",
+		        nextTileToUpload, numTiles, name.c_str(), (now - uploadStartTime) * 1000.0);
+	}
+	return anySuccess;
+}
+
+// copies the w x h texels at x, y of the given level (all multiples of the
+// block size, unless they reach the right or bottom border) to out, tightly packed
+static void CopyImageRegion(const Texture::MipLevel& ml, uint32_t blockW, uint32_t blockH,
+                            uint32_t x, uint32_t y, uint32_t w, uint32_t h, std::vector<uint8_t>& out)
+{
+	const uint32_t numBlockCols = (ml.width + blockW - 1) / blockW;
+	const uint32_t numBlockRows = (ml.height + blockH - 1) / blockH;
+	const size_t rowSize = ml.size / numBlockRows;
+	const size_t blockSize = rowSize / numBlockCols;
+	const uint32_t regionCols = (w + blockW - 1) / blockW;
+	const uint32_t regionRows = (h + blockH - 1) / blockH;
+	const size_t regionRowSize = regionCols * blockSize;
+	// a tile that's only a few texels wide can end up one texel beyond the
+	// border in the coarsest levels, use the last texels then
+	const uint32_t col = std::min(x / blockW, numBlockCols - std::min(regionCols, numBlockCols));
+	const uint32_t row = std::min(y / blockH, numBlockRows - std::min(regionRows, numBlockRows));
+	out.resize(regionRowSize * regionRows);
+	const uint8_t* src = (const uint8_t*)ml.data + row * rowSize + col * blockSize;
+	for(uint32_t r = 0; r < regionRows; ++r) {
+		memcpy(out.data() + r * regionRowSize, src + r * rowSize, regionRowSize);
+	}
+}
+
+bool ConvertImageRegionToFloatRGBA(const Texture::MipLevel& ml, uint32_t dataFormat,
+                                   uint32_t glFormat, uint32_t glType, bool isCompressed,
+                                   uint32_t x, uint32_t y, uint32_t w, uint32_t h, float* dst)
+{
+	if(ml.data == nullptr || w == 0 || h == 0 || x + w > ml.width || y + h > ml.height) {
+		return false;
+	}
+	if(!isCompressed) {
+		// rows aren't padded in the textures that can be split (see Texture::NeedsTiles())
+		const size_t rowPitch = ml.size / ml.height;
+		const size_t bytesPerTexel = rowPitch / ml.width;
+		const uint8_t* src = (const uint8_t*)ml.data + y * rowPitch + x * bytesPerTexel;
+		return ConvertToFloatRGBA(src, w, h, (uint32_t)rowPitch, glFormat, glType, dst);
+	}
+	std::vector<uint8_t> blocks;
+	CopyImageRegion(ml, GetCompressedBlockWidth(dataFormat), GetCompressedBlockHeight(dataFormat),
+	                x, y, w, h, blocks);
+	CompressedImage img = { blocks.data(), (uint32_t)blocks.size(), w, h, nullptr };
+	DecodedFormat decFmt;
+	if(!GetSoftwareDecodedFormat(dataFormat, &decFmt, &img, 1)) {
+		return false;
+	}
+	std::vector<uint8_t> decoded(size_t(w) * h * decFmt.bytesPerPixel);
+	img.decodedData = decoded.data();
+	return DecodeCompressedImages(dataFormat, &img, 1, decFmt)
+	       && ConvertToFloatRGBA(decoded.data(), w, h, 0, decFmt.glFormat, decFmt.glType, dst);
+}
+
+// creates the OpenGL texture for the tile and uploads its part of the numTileMips levels
+bool Texture::UploadTile(GLTile& tile)
+{
+	const GLenum internalFormat = dataFormat;
+	const bool isCompressed = (textureFlags & TF_COMPRESSED) != 0;
+	const uint32_t blockW = isCompressed ? GetCompressedBlockWidth(dataFormat) : 1;
+	const uint32_t blockH = isCompressed ? GetCompressedBlockHeight(dataFormat) : 1;
+
+	// the tiles at the right and bottom border can be smaller and have less levels
+	int numMips = 1;
+	while(numMips < numTileMips && (std::max(tile.width, tile.height) >> numMips) > 0) {
+		++numMips;
+	}
+
+	glGenTextures(1, &tile.glTextureHandle);
+	glBindTexture(GL_TEXTURE_2D, tile.glTextureHandle);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numMips - 1);
+	// with linear filtering there are faint seams between the tiles,
+	// but that's better than sampling the other side of the tile
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glGetError();
+
+	if(GLAD_GL_ARB_texture_storage && !IsUnsizedFormat(internalFormat)) {
+		glTexStorage2D(GL_TEXTURE_2D, numMips, internalFormat, tile.width, tile.height);
+	} else {
+		for(int mipIdx = 0; mipIdx < numMips; ++mipIdx) {
+			glTexImage2D(GL_TEXTURE_2D, mipIdx, internalFormat, std::max(1u, tile.width >> mipIdx),
+			             std::max(1u, tile.height >> mipIdx), 0, glFormat, glType, nullptr);
+		}
+	}
+	GLenum e = glGetError();
+	if(e != GL_NO_ERROR) {
+		errprintf("Allocating GPU memory for the %u x %u tile at %u, %u of texture '%s' (format '%s') "
+		          "failed (glGetError() says '%s')\n", tile.width, tile.height, tile.x, tile.y,
+		          name.c_str(), formatName.c_str(), getGLerrorString(e));
+		glDeleteTextures(1, &tile.glTextureHandle);
+		tile.glTextureHandle = 0;
+		return false;
+	}
+
+	std::vector<uint8_t> region;
+	for(int mipIdx = numMips - 1; mipIdx >= 0; --mipIdx) {
+		const MipLevel& ml = elements[0][mipIdx];
+		// the tile size is a power of two, so the tile's part of the level
+		// is exactly as big as the tile's level (see UploadTiled())
+		uint32_t x = tile.x >> mipIdx;
+		uint32_t y = tile.y >> mipIdx;
+		uint32_t w = std::max(1u, tile.width >> mipIdx);
+		uint32_t h = std::max(1u, tile.height >> mipIdx);
+		CopyImageRegion(ml, blockW, blockH, x, y, w, h, region);
+		MipLevel tileLevel(w, h, region.data(), (uint32_t)region.size());
+		if(!UploadTexture2D(GL_TEXTURE_2D, internalFormat, mipIdx, isCompressed, tileLevel)) {
+			glDeleteTextures(1, &tile.glTextureHandle);
+			tile.glTextureHandle = 0;
+			return false;
+		}
+	}
+	return true;
+}
+
 Texture::~Texture() {
+	DeletePyramid();
+	StopInflatingKTXLevels();
 	if(texDataFreeFun != nullptr) {
 		texDataFreeFun( (void*)texData, texDataFreeCookie );
 	}
 	if(glTextureHandle > 0) {
 		glDeleteTextures(1, &glTextureHandle);
 	}
+	DeleteGLTiles();
 }
 
 const char* Texture::GetIntTexInfo(bool& isUnsigned)
@@ -317,24 +1145,90 @@ const char* Texture::GetIntTexInfo(bool& isUnsigned)
 	return ret;
 }
 
-bool Texture::Load(const char* filename)
+const char* GetDiagCodeName(DiagCode code)
+{
+	switch(code) {
+		case DC_FILE_UNREADABLE:        return "file-unreadable";
+		case DC_FILE_TOO_SMALL:         return "file-too-small";
+		case DC_UNSUPPORTED_FILETYPE:   return "unsupported-filetype";
+		case DC_DDS_HEADER_TRUNCATED:   return "dds-header-truncated";
+		case DC_DDS_UNKNOWN_FORMAT:     return "dds-unknown-format";
+		case DC_DDS_BROKEN_MISCFLAGS:   return "dds-broken-miscflags";
+		case DC_DDS_BOGUS_ARRAYSIZE:    return "dds-bogus-arraysize";
+		case DC_DDS_TRUNCATED_MIPCHAIN: return "dds-truncated-mipchain";
+		case DC_DDS_TOO_MANY_MIPS:      return "dds-too-many-mips";
+		case DC_DDS_TRAILING_DATA:      return "dds-trailing-data";
+		case DC_KTX_INVALID:            return "ktx-invalid";
+		case DC_IMAGE_DECODE_FAILED:    return "image-decode-failed";
+		case _DC_COUNT: break;
+	}
+	return "unknown";
+}
+
+const char* GetDiagSeverityName(DiagSeverity severity)
+{
+	switch(severity) {
+		case DS_NOTE:    return "note";
+		case DS_WARNING: return "warning";
+		case DS_ERROR:   return "error";
+	}
+	return "unknown";
+}
+
+// logs a problem with the file that's being loaded (as error, warning or info,
+// depending on severity) and, if diags is set, also adds it to diags
+static void ReportLoadIssue(std::vector<LoadDiagnostic>* diags, DiagSeverity severity,
+                            DiagCode code, const char* fmt, ...) IM_FMTARGS(4);
+
+static void ReportLoadIssue(std::vector<LoadDiagnostic>* diags, DiagSeverity severity,
+                            DiagCode code, const char* fmt, ...)
+{
+	std::string msg;
+	va_list args;
+	va_start(args, fmt);
+	StringAppendFormattedV(msg, fmt, args);
+	va_end(args);
+
+	switch(severity) {
+		case DS_NOTE:    LogInfo("%s", msg.c_str()); break;
+		case DS_WARNING: LogWarn("%s", msg.c_str()); break;
+		case DS_ERROR:   LogError("%s", msg.c_str()); break;
+	}
+	if(diags != nullptr) {
+		while(!msg.empty() && msg.back() == '\n') {
+			msg.pop_back();
+		}
+		diags->push_back(LoadDiagnostic{severity, code, std::move(msg)});
+	}
+}
+
+bool Texture::Load(const char* filename, std::vector<LoadDiagnostic>* diagnostics)
 {
 	Clear();
 
 	std::string fname( ToAbsolutePath(filename) );
 	filename = fname.c_str(); // from here on filename has an absolute path.
+	// (fails for files in archives, then it's never reused by another view)
+	GetFileSizeAndModTime(filename, &fileSize, &fileModTime);
 
 	MemMappedFile* mmf = LoadMemMappedFile(filename);
 	if(mmf == nullptr) {
+		if(diagnostics != nullptr) {
+			// LoadMemMappedFile() has already logged why
+			diagnostics->push_back(LoadDiagnostic{DS_ERROR, DC_FILE_UNREADABLE, "Couldn't open or map the file"});
+		}
 		return false;
 	}
 	if(mmf->length < 4) {
-		errprintf("File '%s' is too small (%d) to contain useful image data!\n",
-		          filename, (int)mmf->length);
+		ReportLoadIssue(diagnostics, DS_ERROR, DC_FILE_TOO_SMALL,
+		                "File '%s' is too small (%d) to contain useful image data!\n",
+		                filename, (int)mmf->length);
+		UnloadMemMappedFile(mmf);
+		return false;
 	}
 
 	if(memcmp(mmf->data, "DDS ", 4) == 0) {
-		return LoadDDS(mmf, filename);
+		return LoadDDS(mmf, filename, diagnostics);
 	}
 
 	static const unsigned char ktx1identifier[] = {
@@ -347,12 +1241,13 @@ bool Texture::Load(const char* filename)
 	if( mmf->length > 12 && (memcmp(mmf->data, ktx1identifier, 12) == 0
 	                         || memcmp(mmf->data, ktx2identifier, 12) == 0) )
 	{
-		return LoadKTX(mmf, filename);
+		return LoadKTX(mmf, filename, diagnostics);
 	}
 
 	// some other kind of file, try throwing it at stb_image
 	if(mmf->length > INT_MAX) {
-		errprintf("File '%s' is too big to load with stb_image\n", filename);
+		ReportLoadIssue(diagnostics, DS_ERROR, DC_UNSUPPORTED_FILETYPE,
+		                "File '%s' is too big to load with stb_image\n", filename);
 		UnloadMemMappedFile(mmf);
 		return false;
 	}
@@ -361,7 +1256,8 @@ bool Texture::Load(const char* filename)
 	int w, h, comp;
 	void* pix = nullptr;
 	if(!stbi_info_from_memory(data, len, &w, &h, &comp)) {
-		errprintf("Couldn't get info about '%s', maybe the filetype is unsupported?\n", filename);
+		ReportLoadIssue(diagnostics, DS_ERROR, DC_UNSUPPORTED_FILETYPE,
+		                "Couldn't get info about '%s', maybe the filetype is unsupported?\n", filename);
 		UnloadMemMappedFile(mmf);
 		return false;
 	}
@@ -421,33 +1317,288 @@ bool Texture::Load(const char* filename)
 		texData = pix;
 		texDataFreeFun = [](void* texData, intptr_t) -> void { stbi_image_free(texData); };
 
+		// (not always 4 bytes per pixel like MipLevel assumes by default)
+		uint32_t bytesPerChan = (glType == GL_FLOAT) ? 4 : ((glType == GL_UNSIGNED_SHORT) ? 2 : 1);
+		uint32_t size = uint32_t(w) * uint32_t(h) * numChans * bytesPerChan;
 		elements.push_back( std::vector<MipLevel>() );
-		elements[0].push_back( Texture::MipLevel(w, h, pix) );
+		elements[0].push_back( Texture::MipLevel(w, h, pix, size) );
 
 		return true;
 	} else {
-		formatName = nullptr;
+		formatName.clear();
 		glType = 0;
 	}
 
 	// TODO: anything else to try?
 
-	errprintf("Couldn't load '%s', maybe the filetype is unsupported?\n", filename);
+	ReportLoadIssue(diagnostics, DS_ERROR, DC_IMAGE_DECODE_FAILED,
+	                "Couldn't load '%s', maybe the filetype is unsupported? stb_image says: %s\n",
+	                filename, stbi_failure_reason());
 	UnloadMemMappedFile(mmf);
 	return false;
 }
 
-bool Texture::LoadKTX(MemMappedFile* mmf, const char* filename)
+static bool IsTranscodeTargetSupported(ktx_transcode_fmt_e fmt, bool srgb)
+{
+	switch(fmt) {
+		case KTX_TTF_BC1_RGB:
+		case KTX_TTF_BC3_RGBA:
+			return GLAD_GL_EXT_texture_compression_s3tc && (!srgb || GLAD_GL_EXT_texture_sRGB);
+		case KTX_TTF_BC4_R:
+		case KTX_TTF_BC5_RG:
+			return true; // RGTC is part of OpenGL 3.0
+		case KTX_TTF_BC7_RGBA:
+			return GLAD_GL_ARB_texture_compression_bptc;
+		case KTX_TTF_ASTC_4x4_RGBA:
+			return GLAD_GL_KHR_texture_compression_astc_ldr;
+		case KTX_TTF_ETC1_RGB: // libktx uses ETC2 RGB8 for this
+		case KTX_TTF_ETC2_RGBA:
+		case KTX_TTF_ETC2_EAC_R11:
+		case KTX_TTF_ETC2_EAC_RG11:
+			// ETC2/EAC are part of OpenGL 4.3 and GL_ARB_ES3_compatibility
+			return glVersion >= 43 || GLAD_GL_ARB_ES3_compatibility;
+		case KTX_TTF_RGBA32:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Picks the format a Basis Universal (ETC1S or UASTC) texture is transcoded to,
+// depending on what the GPU supports and how many channels the texture has
+// (according to its DFD). The candidates are ordered by transcode time + GPU memory:
+// UASTC is a subset of ASTC 4x4 (so transcoding to it is almost free) and is cheap
+// to turn into BC7; ETC1S is a subset of ETC1 and quick to turn into BC1/BC3/BC4/BC5.
+// One or two channels are best kept in BC4/BC5 (4 or 8 bits per pixel and no
+// crosstalk between channels), but those have no sRGB variants.
+// ETC2 comes after the BC formats, because on desktop GPUs the driver often
+// decompresses it (to uncompressed RGBA) on upload.
+// Uncompressed RGBA32 (4x the size of BC7 or ASTC) is the last resort.
+static ktx_transcode_fmt_e ChooseTranscodeTarget(ktxTexture2* ktxTex2)
+{
+	bool isUASTC = ktxTexture2_GetColorModel_e(ktxTex2) == KHR_DF_MODEL_UASTC;
+	bool srgb = ktxTexture2_GetOETF_e(ktxTex2) == KHR_DF_TRANSFER_SRGB;
+	int numChannels = (int)ktxTexture2_GetNumComponents(ktxTex2);
+	if(srgb && numChannels < 3) {
+		// no sRGB variants of BC4/BC5/EAC, use formats with (replicated) RGB instead
+		// (for two channels, the second is in the alpha channel then)
+		numChannels += 2;
+	}
+
+	static const ktx_transcode_fmt_e candidates[2][4][5] = {
+		{ // ETC1S
+			{ KTX_TTF_BC4_R,  KTX_TTF_ETC2_EAC_R11,  KTX_TTF_NOSELECTION },
+			{ KTX_TTF_BC5_RG, KTX_TTF_ETC2_EAC_RG11, KTX_TTF_NOSELECTION },
+			{ KTX_TTF_BC1_RGB,  KTX_TTF_ETC1_RGB,  KTX_TTF_BC7_RGBA, KTX_TTF_ASTC_4x4_RGBA, KTX_TTF_NOSELECTION },
+			{ KTX_TTF_BC3_RGBA, KTX_TTF_ETC2_RGBA, KTX_TTF_BC7_RGBA, KTX_TTF_ASTC_4x4_RGBA, KTX_TTF_NOSELECTION },
+		},
+		{ // UASTC
+			{ KTX_TTF_BC4_R,  KTX_TTF_ETC2_EAC_R11,  KTX_TTF_NOSELECTION },
+			{ KTX_TTF_BC5_RG, KTX_TTF_ETC2_EAC_RG11, KTX_TTF_NOSELECTION },
+			{ KTX_TTF_ASTC_4x4_RGBA, KTX_TTF_BC7_RGBA, KTX_TTF_BC1_RGB,  KTX_TTF_ETC1_RGB,  KTX_TTF_NOSELECTION },
+			{ KTX_TTF_ASTC_4x4_RGBA, KTX_TTF_BC7_RGBA, KTX_TTF_BC3_RGBA, KTX_TTF_ETC2_RGBA, KTX_TTF_NOSELECTION },
+		}
+	};
+	numChannels = std::min(std::max(numChannels, 1), 4);
+	for(ktx_transcode_fmt_e fmt : candidates[isUASTC][numChannels-1]) {
+		if(fmt == KTX_TTF_NOSELECTION)
+			break;
+		if(IsTranscodeTargetSupported(fmt, srgb))
+			return fmt;
+	}
+	return KTX_TTF_RGBA32;
+}
+
+// lets libktx transcode the images (levels, layers, faces) of Basis Universal
+// textures in parallel on our thread pool
+static void KTXParallelFor(void* /*userData*/, ktx_uint32_t numJobs,
+                           void (*job)(void* jobData, ktx_uint32_t i), void* jobData)
+{
+	ParallelFor((int)numJobs, [job, jobData](int i) { job(jobData, (ktx_uint32_t)i); });
+}
+
+// state of the lazily inflated levels of a zstd/zlib supercompressed KTX2 texture.
+// the levels are inflated by jobs on the thread pool (started by StartInflatingKTXLevels()),
+// or by the main thread if it needs a level before any worker got to it
+struct Texture::KTXLazyLevels {
+	enum LevelState {
+		PENDING,   // not inflated yet
+		INFLATING, // a thread is currently inflating it
+		READY,
+		FAILED,
+		RELEASED   // was inflated, but the data has been freed again
+	};
+	struct Level {
+		std::unique_ptr<unsigned char[]> data; // (not zero-initialized, unlike std::vector)
+		size_t size = 0;
+		LevelState state = PENDING;
+	};
+	std::vector<Level> levels;
+	// mutex protects levels, numRunning and cancelled
+	std::mutex mutex;
+	std::condition_variable condVar;
+	int numRunning = 0;
+	bool cancelled = false;
+	// only used while !cancelled and by running jobs, the Texture waits for those
+	// in StopInflatingKTXLevels() before freeing ktxTex and the file
+	ktxTexture2* ktxTex2 = nullptr;
+	const MemMappedFile* mmf = nullptr;
+	std::string name;
+
+	void InflateLevel(int level)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			LevelState st = levels[level].state;
+			if(cancelled || (st != PENDING && st != RELEASED)) {
+				return; // someone else is taking care of it
+			}
+			levels[level].state = INFLATING;
+			++numRunning;
+		}
+		size_t size = ktxTexture_GetLevelSize(ktxTexture(ktxTex2), level);
+		std::unique_ptr<unsigned char[]> data(new (std::nothrow) unsigned char[size]);
+		ktx_error_code_e res = KTX_OUT_OF_MEMORY;
+		if(data != nullptr) {
+			res = ktxTexture2_InflateLevelFromMemory(ktxTex2, level, (const ktx_uint8_t*)mmf->data,
+			                                         mmf->length, data.get(), size);
+		}
+		if(res != KTX_SUCCESS) {
+			errprintf("Couldn't inflate mip level %d of '%s': %s (%d)\n",
+			          level, name.c_str(), ktxErrorString(res), res);
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			Level& l = levels[level];
+			if(res == KTX_SUCCESS) {
+				l.data = std::move(data);
+				l.size = size;
+				l.state = READY;
+			} else {
+				l.state = FAILED;
+			}
+			--numRunning;
+		}
+		condVar.notify_all();
+	}
+};
+
+void Texture::StartInflatingKTXLevels(MemMappedFile* mmf)
+{
+	std::shared_ptr<KTXLazyLevels> ll = std::make_shared<KTXLazyLevels>();
+	ll->levels.resize(ktxTex->numLevels);
+	ll->ktxTex2 = (ktxTexture2*)ktxTex;
+	ll->mmf = mmf;
+	ll->name = name;
+	ktxLazyLevels = ll;
+
+	if(ThreadPoolGetNumThreads() > 0) {
+		// smallest level first, so the first ones are ready soon;
+		// the pool runs the jobs in the order they were added
+		for(int level = int(ktxTex->numLevels) - 1; level >= 0; --level) {
+			ThreadPoolAddJob([ll, level]() { ll->InflateLevel(level); });
+		}
+	} // otherwise the levels are inflated in AcquireKTXLevel() when they're needed
+}
+
+void Texture::StopInflatingKTXLevels()
+{
+	if(ktxLazyLevels == nullptr) {
+		return;
+	}
+	KTXLazyLevels& ll = *ktxLazyLevels;
+	std::unique_lock<std::mutex> lock(ll.mutex);
+	// jobs that haven't started yet will see this and return immediately
+	ll.cancelled = true;
+	ll.condVar.wait(lock, [&ll]{ return ll.numRunning == 0; });
+}
+
+bool Texture::AcquireKTXLevel(int level)
+{
+	KTXLazyLevels& ll = *ktxLazyLevels;
+	// if no worker has started inflating it yet, just do it in this thread
+	// instead of waiting for them (does nothing if it's already inflated or in progress)
+	ll.InflateLevel(level);
+
+	std::unique_lock<std::mutex> lock(ll.mutex);
+	KTXLazyLevels::Level& l = ll.levels[level];
+	ll.condVar.wait(lock, [&l]{ return l.state != KTXLazyLevels::PENDING && l.state != KTXLazyLevels::INFLATING; });
+	if(l.state != KTXLazyLevels::READY) {
+		return false;
+	}
+	// the level contains the images of all layers and faces, in the same order as elements
+	uint32_t imageSize = (uint32_t)ktxTexture_GetImageSize(ktxTex, level);
+	for(size_t e=0; e < elements.size(); ++e) {
+		MipLevel& ml = elements[e][level];
+		ml.data = l.data.get() + e * imageSize;
+		ml.size = imageSize;
+	}
+	return true;
+}
+
+void Texture::ReleaseKTXLevel(int level)
+{
+	KTXLazyLevels& ll = *ktxLazyLevels;
+	for(std::vector<MipLevel>& mipLevels : elements) {
+		mipLevels[level].data = nullptr;
+	}
+	std::lock_guard<std::mutex> lock(ll.mutex);
+	KTXLazyLevels::Level& l = ll.levels[level];
+	if(l.state == KTXLazyLevels::READY) {
+		l.data = nullptr;
+		l.size = 0;
+		l.state = KTXLazyLevels::RELEASED;
+	}
+}
+
+bool Texture::IsKTXLevelReady(int level) const
+{
+	if(ktxLazyLevels == nullptr) {
+		return true;
+	}
+	KTXLazyLevels& ll = *ktxLazyLevels;
+	std::lock_guard<std::mutex> lock(ll.mutex);
+	KTXLazyLevels::LevelState st = ll.levels[level].state;
+	// pending levels are inflated by the worker threads, if there are any -
+	// otherwise (and for released levels) AcquireKTXLevel() does it right away
+	if(st == KTXLazyLevels::PENDING)
+		return ThreadPoolGetNumThreads() == 0;
+	return st != KTXLazyLevels::INFLATING;
+}
+
+bool Texture::LoadAllKTXLevels()
+{
+	if(ktxLazyLevels == nullptr) {
+		return true;
+	}
+	// ktxTexture_LoadImageData() modifies ktxTex, so the jobs must be done first
+	StopInflatingKTXLevels();
+	ktxLazyLevels = nullptr;
+	for(std::vector<MipLevel>& mipLevels : elements) {
+		for(MipLevel& ml : mipLevels) {
+			ml.data = nullptr;
+		}
+	}
+	ktx_error_code_e res = ktxTexture_LoadImageData(ktxTex, nullptr, 0);
+	if(res != KTX_SUCCESS) {
+		errprintf("libktx couldn't load the image data of '%s': %s (%d)\n", name.c_str(), ktxErrorString(res), res);
+		return false;
+	}
+	return true;
+}
+
+bool Texture::LoadKTX(MemMappedFile* mmf, const char* filename, std::vector<LoadDiagnostic>* diags)
 {
 	ktxTexture* ktxTex = nullptr;
 	const unsigned char* data = (const unsigned char*)mmf->data;
 	ktx_error_code_e res;
 
 	res = ktxTexture_CreateFromMemory(data, mmf->length,
-						   KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktxTex);
+						   KTX_TEXTURE_CREATE_NO_FLAGS, &ktxTex);
 
 	if(res != KTX_SUCCESS) {
-		errprintf("libktx couldn't load '%s': %s (%d)\n", filename, ktxErrorString(res), res);
+		ReportLoadIssue(diags, DS_ERROR, DC_KTX_INVALID,
+		                "libktx couldn't load '%s': %s (%d)\n", filename, ktxErrorString(res), res);
 		UnloadMemMappedFile(mmf);
 		return false;
 	}
@@ -457,29 +1608,71 @@ bool Texture::LoadKTX(MemMappedFile* mmf, const char* filename)
 		ktxTex2 = (ktxTexture2*)ktxTex;
 	}
 
-	if(ktxTexture_NeedsTranscoding(ktxTex)) {
-		ktx_transcode_fmt_e transCodeTarget = KTX_TTF_RGBA32; // fall back to uncompressed RGBA
-		if(GLAD_GL_KHR_texture_compression_astc_ldr) {
-			transCodeTarget = KTX_TTF_ASTC_4x4_RGBA;
-		} else if(GLAD_GL_ARB_texture_compression_bptc) {
-			transCodeTarget = KTX_TTF_BC7_RGBA;
+	// the levels of zstd/zlib supercompressed textures are inflated lazily, straight from
+	// the memory-mapped file, instead of inflating all of them into one big buffer now.
+	// Basis Universal textures need all the data for transcoding, so they're loaded now,
+	// like all others (3D textures aren't supported by the upload code used for lazy levels)
+	bool inflateLazily = ktxTex2 != nullptr && ktxTex->baseDepth <= 1
+	                     && (ktxTex2->supercompressionScheme == KTX_SS_ZSTD
+	                         || ktxTex2->supercompressionScheme == KTX_SS_ZLIB)
+	                     && !ktxTexture_NeedsTranscoding(ktxTex);
+	if(!inflateLazily) {
+		res = ktxTexture_LoadImageData(ktxTex, nullptr, 0);
+		if(res != KTX_SUCCESS) {
+			ReportLoadIssue(diags, DS_ERROR, DC_KTX_INVALID, "libktx couldn't load the image data of '%s': %s (%d)\n",
+			                filename, ktxErrorString(res), res);
+			ktxTexture_Destroy(ktxTex);
+			UnloadMemMappedFile(mmf);
+			return false;
 		}
-		res = ktxTexture2_TranscodeBasis(ktxTex2, transCodeTarget, 0);
+	}
+
+	const char* transcodedFrom = nullptr;
+	if(ktxTexture_NeedsTranscoding(ktxTex)) {
+		transcodedFrom = (ktxTexture2_GetColorModel_e(ktxTex2) == KHR_DF_MODEL_UASTC) ? "UASTC" : "ETC1S";
+		ktx_transcode_fmt_e transCodeTarget = ChooseTranscodeTarget(ktxTex2);
+		double startTime = GetTimeSeconds();
+		res = ktxTexture2_TranscodeBasisParallel(ktxTex2, transCodeTarget, 0, KTXParallelFor, nullptr);
 		if(res != KTX_SUCCESS) {
-			errprintf("libktx couldn't transcode '%s': %s (%d)\n", filename, ktxErrorString(res), res);
+			ReportLoadIssue(diags, DS_ERROR, DC_KTX_INVALID,
+			                "libktx couldn't transcode '%s': %s (%d)\n", filename, ktxErrorString(res), res);
 			ktxTexture_Destroy(ktxTex);
 			UnloadMemMappedFile(mmf);
 			return false;
 		}
+		double ms = (GetTimeSeconds() - startTime) * 1000.0;
+		int numImages = ktxTex->numLevels * ktxTex->numLayers * ktxTex->numFaces;
+		LogInfo("Transcoded '%s' from %s to %s in %.2f ms (%d images, %d threads)\n", filename, transcodedFrom,
+		        ktxTranscodeFormatString(transCodeTarget), ms, numImages, ThreadPoolGetNumThreads() + 1);
 	}
 	name = filename;
 	// TODO: maybe using GL-like names like the DDS loader uses would be nicer?
 	//   for that https://github.com/KhronosGroup/KTX-Specification/blob/main/formats.json could help
 	formatName = (ktxTex->classId == ktxTexture2_c) ? "KTX2 " : "KTX ";
 	formatName += ktxTexture_GetFormatName(ktxTex);
+	if(transcodedFrom != nullptr) {
+		formatName += " (transcoded from ";
+		formatName += transcodedFrom;
+		formatName += ")";
+	}
 
 	this->ktxTex = ktxTex;
 	fileType = FT_KTX;
+	{
+		// needed to decide if the format must be decoded in software
+		GLint intFmt = 0;
+		GLenum baseFmt = 0, fmt = 0, type = 0;
+		ktxTexture_GetOpenGLFormat(ktxTex, &intFmt, &baseFmt, &fmt, &type);
+		dataFormat = intFmt;
+		glFormat = ktxTex->isCompressed ? baseFmt : fmt;
+		glType = type;
+		// (same condition for arrays as below, used if the texture is decoded in software)
+		if(ktxTex->isArray && ktxTex->numLayers > 1) {
+			glTarget = ktxTex->isCubemap ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D_ARRAY;
+		} else {
+			glTarget = ktxTex->isCubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+		}
+	}
 	if(ktxTex->isCompressed)
 		textureFlags |= TF_COMPRESSED;
 	if(ktxTexture_FormatHasAlpha(ktxTex))
@@ -531,6 +1724,10 @@ bool Texture::LoadKTX(MemMappedFile* mmf, const char* filename)
 		UnloadMemMappedFile(mmf);
 	};
 
+	if(inflateLazily) {
+		StartInflatingKTXLevels(mmf);
+	}
+
 	return true;
 }
 
@@ -715,6 +1912,26 @@ const ASTCInfo astcFormatTable[] = {
 #undef ALT_ASTC_ENTRY
 };
 
+static uint32_t GetCompressedBlockWidth(uint32_t glFormat)
+{
+	for(const ASTCInfo& astcInfo : astcFormatTable) {
+		if(astcInfo.glFormat == glFormat) {
+			return astcInfo.blockW;
+		}
+	}
+	return 4;
+}
+
+static uint32_t GetCompressedBlockHeight(uint32_t glFormat)
+{
+	for(const ASTCInfo& astcInfo : astcFormatTable) {
+		if(astcInfo.glFormat == glFormat) {
+			return astcInfo.blockH;
+		}
+	}
+	return 4; // all other supported compressed formats (BCn, ETC2, EAC) use 4x4 blocks
+}
+
 struct UncomprFormatInfo {
 	uint32_t ddsD3Dfmt;
 	int dxgiFormat;
@@ -1076,13 +2293,20 @@ static uint32_t CalcASTCmipSize(uint32_t w, uint32_t h, uint32_t blockW, uint32_
 	return std::max(1u, (w+blockW-1)/blockW) * std::max(1u, (h+blockH-1)/blockH) * 16;
 }
 
-bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
+bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename, std::vector<LoadDiagnostic>* diags)
 {
 	const unsigned char* data = (const unsigned char*)mmf->data;
 	const size_t len = mmf->length;
 	const unsigned char* dataEnd = data + len;
 	size_t dataOffset = 4 + sizeof(DDS_HEADER);
 
+	if(len < dataOffset) {
+		ReportLoadIssue(diags, DS_ERROR, DC_DDS_HEADER_TRUNCATED,
+		                "Invalid DDS file '%s', it's too small (%d bytes) for the DDS header!\n", filename, (int)len);
+		UnloadMemMappedFile(mmf);
+		return false;
+	}
+
 	const DDS_HEADER* header = (const DDS_HEADER*)(data+4); // skip magic number ("DDF ")
 	const DDS_HEADER_DXT10* dx10header = nullptr;
 	int w = header->dwWidth;
@@ -1097,7 +2321,9 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 	bool foundFormat = false;
 	if(fourcc == PIXEL_FMT_DX10) {
 		if(len < 148) {
-			errprintf("Invalid DDS file `%s`, says it has DX10 header but is only %d bytes!\n", filename, (int)len);
+			ReportLoadIssue(diags, DS_ERROR, DC_DDS_HEADER_TRUNCATED,
+			                "Invalid DDS file `%s`, says it has DX10 header but is only %d bytes!\n", filename, (int)len);
+			UnloadMemMappedFile(mmf);
 			return false;
 		}
 		dx10header = (const DDS_HEADER_DXT10*)(data + dataOffset);
@@ -1106,6 +2332,13 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 		// this check works around broken DDS files from GLI...
 		if(dx10header->miscFlags2 != UINT32_MAX) {
 			dx10misc2 = (dx10header->miscFlags2 & 7); // lowest 3 bits
+		} else {
+			ReportLoadIssue(diags, DS_NOTE, DC_DDS_BROKEN_MISCFLAGS,
+			                "DDS file '%s' has miscFlags2 = 0xffffffff (probably written by GLI), ignoring it\n", filename);
+		}
+		if(dx10header->miscFlag == UINT32_MAX) {
+			ReportLoadIssue(diags, DS_NOTE, DC_DDS_BROKEN_MISCFLAGS,
+			                "DDS file '%s' has miscFlag = 0xffffffff (probably written by GLI), ignoring it\n", filename);
 		}
 	}
 	// https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dx-graphics-dds-pguide#dds-file-layout
@@ -1140,8 +2373,10 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 			formatName = astcInfo.name;
 			ourFlags = astcInfo.ourFlags;
 		} else if(fourcc == PIXEL_FMT_DX10) {
-			errprintf("Couldn't detect data format of '%s' - its dxgiFormat (%d) is in the ASTC-range, but apparently didn't match any actual format\n",
-			          filename, dxgiFmt);
+			ReportLoadIssue(diags, DS_ERROR, DC_DDS_UNKNOWN_FORMAT,
+			                "Couldn't detect data format of '%s' - its dxgiFormat (%d) is in the ASTC-range, but apparently didn't match any actual format\n",
+			                filename, dxgiFmt);
+			UnloadMemMappedFile(mmf);
 			return false;
 		} // otherwise it was the "fourcc starts with 'AS'" case, for that also try the regular format table
 
@@ -1198,8 +2433,10 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 	if(!foundFormat) {
 		char fccstr[5] = { char(fourcc & 0xff), char((fourcc >> 8) & 0xff),
 		                   char((fourcc >> 16) & 0xff), char((fourcc >> 24) & 0xff), 0 };
-		errprintf( "Couldn't detect data format of '%s' - FourCC: 0x%x ('%s' %d) dxgiFormat: %d\n",
-		           filename, fourcc, fccstr, fourcc, dxgiFmt );
+		ReportLoadIssue(diags, DS_ERROR, DC_DDS_UNKNOWN_FORMAT,
+		                "Couldn't detect data format of '%s' - FourCC: 0x%x ('%s' %d) dxgiFormat: %d\n",
+		                filename, fourcc, fccstr, fourcc, dxgiFmt );
+		UnloadMemMappedFile(mmf);
 		return false;
 	}
 	formatName.insert(0, "DDS ");
@@ -1242,6 +2479,11 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 		glTarget = isCubemap ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D_ARRAY;
 	} else {
 		glTarget = isCubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+		if(dx10header != nullptr && dx10header->arraySize >= 0xfffff) {
+			ReportLoadIssue(diags, DS_WARNING, DC_DDS_BOGUS_ARRAYSIZE,
+			                "DDS file '%s' has implausible arraySize %u, treating it as a single texture\n",
+			                filename, dx10header->arraySize);
+		}
 	}
 	if(numCubeFaces > 1) {
 		numElements *= numCubeFaces;
@@ -1277,6 +2519,7 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 	texDataFreeFun = [](void* texData, intptr_t) -> void { UnloadMemMappedFile( (MemMappedFile*)texData ); };
 
 	const unsigned char* dataCur = data + dataOffset;
+	bool reportedTooManyMips = false;
 	elements.resize(numElements);
 	for(int e=0; e < numElements; ++e) {
 		std::vector<MipLevel>& mipLevels = elements[e];
@@ -1293,8 +2536,9 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 			}
 			const unsigned char* dataNext = dataCur + mipSize;
 			if(dataNext > dataEnd) {
-				errprintf("MipMap level %d of image %d for '%s' is incomplete (file too small, %u bytes left, are at %u bytes from start) mipSize: %u w: %d h: %d!\n",
-						i, e, filename, unsigned(dataEnd - dataCur), unsigned(dataCur-data), mipSize, mipW, mipH);
+				ReportLoadIssue(diags, DS_ERROR, DC_DDS_TRUNCATED_MIPCHAIN,
+				                "MipMap level %d of image %d for '%s' is incomplete (file too small, %u bytes left, are at %u bytes from start) mipSize: %u w: %d h: %d!\n",
+				                i, e, filename, unsigned(dataEnd - dataCur), unsigned(dataCur-data), mipSize, mipW, mipH);
 				if(numElements > 1) {
 					// for a cubemap or array don't tolerate missing mipmaps or elements
 					// it only leads to trouble later..
@@ -1305,8 +2549,10 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 				return (i > 0);
 			}
 			mipLevels.push_back( MipLevel(mipW, mipH, dataCur, mipSize) );
-			if(mipW == 1 && mipH == 1 && i < numMips-1) {
-				errprintf( "Texture '%s' claimed to have %d MipMap levels, but we're already done after %d levels\n", filename, numMips, i+1 );
+			if(mipW == 1 && mipH == 1 && i < numMips-1 && !reportedTooManyMips) {
+				reportedTooManyMips = true;
+				ReportLoadIssue(diags, DS_WARNING, DC_DDS_TOO_MANY_MIPS,
+				                "Texture '%s' claimed to have %d MipMap levels, but we're already done after %d levels\n", filename, numMips, i+1 );
 				// don't break, I think - because for texture arrays it's important
 				// to read (skip forward) as much data as all specified mips need
 				// so the next mip level 0 starts at the right position in data
@@ -1317,6 +2563,10 @@ bool Texture::LoadDDS(MemMappedFile* mmf, const char* filename)
 			mipH = std::max( mipH / 2, 1 );
 		}
 	}
+	if(dataCur < dataEnd) {
+		ReportLoadIssue(diags, DS_NOTE, DC_DDS_TRAILING_DATA,
+		                "DDS file '%s' has %u bytes of unused data at the end\n", filename, unsigned(dataEnd - dataCur));
+	}
 
 	return true;
 }
@@ -8,6 +8,10 @@
 #define _TEXVIEW_H
 
 #include <stdint.h>
+#include <stdio.h> // FILE
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -34,9 +38,22 @@ inline int NumBitsSet(uint32_t x) {
 #endif
 }
 
+// monotonic time in seconds, for measuring how long something takes
+inline double GetTimeSeconds() {
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Archive;
+
 struct MemMappedFile {
 	const void* data = nullptr;
 	size_t length = 0;
+	// for files in ZIP/PK3 archives (see archive.cpp) data either points into
+	// the archive's mapping, which is kept alive by this, or to an inflated
+	// copy that's owned by this
+	std::shared_ptr<Archive> archive;
+	bool ownsArchiveData = false;
 #ifdef _WIN32
 	// using void* instead of HANDLE to avoid dragging in windows.h
 	// (HANDLE is just a void* anyway)
@@ -53,6 +70,47 @@ extern MemMappedFile* LoadMemMappedFile(const char* filename);
 
 extern void UnloadMemMappedFile(MemMappedFile* mmf);
 
+// returns true if path exists and is a directory
+extern bool IsDirectory(const char* path);
+
+// returns false if path doesn't exist or isn't a regular file.
+// modTime is only useful to detect changes (its unit depends on the platform)
+extern bool GetFileSizeAndModTime(const char* path, uint64_t* size, int64_t* modTime);
+
+// like fopen(), but path is UTF-8 also on Windows
+extern FILE* FOpenUTF8(const char* path, const char* mode);
+
+// renames oldPath to newPath, replacing newPath if it already exists
+extern bool RenameFile(const char* oldPath, const char* newPath);
+
+// deletes the file at path
+extern bool RemoveFile(const char* path);
+
+// like fseek(f, offset, SEEK_SET), but works with offsets beyond 2GB everywhere
+extern bool FSeek64(FILE* f, uint64_t offset);
+
+// adds the names (not full paths) of the regular files and subdirectories
+// in dir to files and subDirs (either can be NULL), skipping "." and ".."
+// ZIP/PK3 archives are listed as subdirectories.
+// returns false if dir couldn't be opened
+extern bool ListDirectory(const char* dir, std::vector<std::string>* files, std::vector<std::string>* subDirs);
+
+// archive.cpp: files in ZIP and PK3 archives can be used with paths like
+// "/path/to/game.pk3/textures/wall.dds" with all the functions above,
+// the platform specific implementations call the following for them
+
+// returns true if name ends with .zip or .pk3
+extern bool IsArchiveFileName(const char* name);
+// if path is a file or directory in an archive, sets archivePath and
+// entryName (like "textures/wall.dds") and returns true
+extern bool SplitArchivePath(const char* path, std::string* archivePath, std::string* entryName);
+extern MemMappedFile* LoadArchiveEntry(const std::string& archivePath, const std::string& entryName);
+extern void UnloadArchiveEntry(MemMappedFile* mmf);
+extern bool GetArchiveEntryInfo(const std::string& archivePath, const std::string& entryName,
+                                bool* isDir, uint64_t* size, int64_t* modTime);
+extern bool ListArchiveDirectory(const std::string& archivePath, const std::string& dir,
+                                 std::vector<std::string>* files, std::vector<std::string>* subDirs);
+
 enum TextureFlags : uint32_t {
 	TF_NONE         = 0,
 	TF_SRGB         = 1,
@@ -79,6 +137,49 @@ enum TextureFlags : uint32_t {
 	                  | TF_CUBEMAP_ZPOS | TF_CUBEMAP_ZNEG,
 };
 
+// problems found in a file while loading it, so they can be reported
+// in a structured way (by texview --validate) instead of just being logged
+enum DiagSeverity {
+	DS_NOTE,    // something odd that's handled fine, like a workaround for a known broken writer
+	DS_WARNING, // the file violates the spec, but can still be used
+	DS_ERROR    // the file is broken and (at least partly) unusable
+};
+
+enum DiagCode {
+	DC_FILE_UNREADABLE,
+	DC_FILE_TOO_SMALL,
+	DC_UNSUPPORTED_FILETYPE,
+	DC_DDS_HEADER_TRUNCATED,
+	DC_DDS_UNKNOWN_FORMAT,
+	DC_DDS_BROKEN_MISCFLAGS, // GLI writes 0xffffffff into miscFlag and miscFlags2
+	DC_DDS_BOGUS_ARRAYSIZE,  // arraySize failed our sanity check and was ignored
+	DC_DDS_TRUNCATED_MIPCHAIN,
+	DC_DDS_TOO_MANY_MIPS,    // more mip levels than the dimensions allow
+	DC_DDS_TRAILING_DATA,
+	DC_KTX_INVALID,
+	DC_IMAGE_DECODE_FAILED,
+
+	_DC_COUNT
+};
+
+struct LoadDiagnostic {
+	DiagSeverity severity;
+	DiagCode code;
+	std::string message;
+};
+
+// short names like "dds-truncated-mipchain" or "warning", for printing
+extern const char* GetDiagCodeName(DiagCode code);
+extern const char* GetDiagSeverityName(DiagSeverity severity);
+
+struct CompressedImage; // see below
+
+// filters for Texture::GenerateMipmaps()
+enum MipFilter {
+	MF_BOX,   // averages the texels each texel covers, fast
+	MF_KAISER // Kaiser-windowed sinc (like NVTT), sharper but slower
+};
+
 struct Texture {
 
 	enum FileType {
@@ -117,6 +218,9 @@ private:
 	std::vector<std::vector<MipLevel> > elements;
 public:
 	FileType fileType = FT_NONE;
+	// of the file when it was loaded, to tell if it has changed since
+	uint64_t fileSize = 0;
+	int64_t fileModTime = 0;
 
 	uint32_t textureFlags = 0; // or-ed TextureFlag constants
 
@@ -142,6 +246,26 @@ public:
 
 	unsigned int glTextureHandle = 0;
 
+	// 2D textures that are bigger than GL_MAX_TEXTURE_SIZE are split into
+	// tiles that are separate OpenGL textures, glTextureHandle is 0 then
+	struct GLTile {
+		uint32_t x, y; // position of the top left texel in mip level 0
+		uint32_t width, height; // in mip level 0
+		unsigned int glTextureHandle; // 0 until it has been uploaded
+	};
+	std::vector<GLTile> glTiles;
+	// the tiles can't have as many mip levels as the whole texture
+	// (a 4096 texels wide tile only has 13), they only have the finest ones
+	int numTileMips = 0;
+
+	// if their format can be converted to RGBA8, RGBA16 or float, such textures are
+	// shown through a multiresolution pyramid of tiles instead of glTiles, which is
+	// built once in the background and stored in a cache file (see pyramid.cpp).
+	// Only the visible tiles of the level that matches the zoom are on the GPU.
+	// shared with the building job, which might outlive the Texture
+	struct TilePyramid;
+	std::shared_ptr<TilePyramid> pyramid;
+
 	// for formats that should be swizzled, in "simple" format like "agb1"
 	const char* defaultSwizzle = nullptr;
 
@@ -152,6 +276,29 @@ public:
 	TexDataFreeFun texDataFreeFun = nullptr;
 	ktxTexture* ktxTex = nullptr;
 
+	// if the GPU doesn't support the compressed format, the texture is decoded
+	// in software and the MipLevels point into this buffer instead of texData
+	std::vector<unsigned char> decodedData;
+
+	// the levels created by GenerateMipmaps(), all but the first MipLevel point into it
+	std::vector<unsigned char> generatedMips;
+
+	// for zstd/zlib supercompressed KTX2 textures, the mip levels are only inflated
+	// (in worker threads, smallest first) when they're needed and freed after uploading.
+	// shared with the inflating jobs, which might outlive the Texture (see texload.cpp)
+	struct KTXLazyLevels;
+	std::shared_ptr<KTXLazyLevels> ktxLazyLevels;
+
+	// during a progressive upload, the next (finer) mip level that must be uploaded,
+	// otherwise -1. all levels after it are already on the GPU
+	int nextMipToUpload = -1;
+	// the same for tiled textures (see glTiles), they're uploaded one tile at a time
+	int nextTileToUpload = -1;
+	double uploadStartTime = 0.0;
+	// for logging the upload throughput
+	double uploadBusyTime = 0.0; // seconds spent in the upload functions
+	size_t uploadedBytes = 0;
+
 	Texture() = default;
 
 	Texture(const Texture& other) = delete; // if needed we'll need reference counting or similar for texData
@@ -159,12 +306,24 @@ public:
 	Texture(Texture&& other) : name(std::move(other.name)),
 		formatName(std::move(other.formatName)),
 		elements(std::move(other.elements)), fileType(other.fileType),
+		fileSize(other.fileSize), fileModTime(other.fileModTime),
 		textureFlags(other.textureFlags), dataFormat(other.dataFormat),
 		glFormat(other.glFormat), glType(other.glType), glTarget(other.glTarget),
-		glTextureHandle(other.glTextureHandle), defaultSwizzle(other.defaultSwizzle),
+		glTextureHandle(other.glTextureHandle), glTiles(std::move(other.glTiles)),
+		numTileMips(other.numTileMips), pyramid(std::move(other.pyramid)),
+		defaultSwizzle(other.defaultSwizzle),
 		texData(other.texData), texDataFreeCookie(other.texDataFreeCookie),
-		texDataFreeFun(other.texDataFreeFun), ktxTex(other.ktxTex)
+		texDataFreeFun(other.texDataFreeFun), ktxTex(other.ktxTex),
+		decodedData(std::move(other.decodedData)),
+		generatedMips(std::move(other.generatedMips)),
+		ktxLazyLevels(std::move(other.ktxLazyLevels)),
+		nextMipToUpload(other.nextMipToUpload), nextTileToUpload(other.nextTileToUpload),
+		uploadStartTime(other.uploadStartTime),
+		uploadBusyTime(other.uploadBusyTime), uploadedBytes(other.uploadedBytes)
 	{
+		other.nextMipToUpload = -1;
+		other.nextTileToUpload = -1;
+		other.glTiles.clear();
 		other.texDataFreeFun = nullptr;
 		other.glTextureHandle = 0;
 		other.ktxTex = nullptr;
@@ -182,6 +341,10 @@ public:
 		dataFormat = other.dataFormat;
 		other.fileType = FT_NONE;
 		other.dataFormat = 0;
+		fileSize = other.fileSize;
+		fileModTime = other.fileModTime;
+		other.fileSize = 0;
+		other.fileModTime = 0;
 		textureFlags = other.textureFlags;
 		other.textureFlags = 0;
 		glFormat = other.glFormat;
@@ -190,6 +353,10 @@ public:
 		other.glFormat = other.glType = other.glTarget = 0;
 		glTextureHandle = other.glTextureHandle;
 		other.glTextureHandle = 0;
+		glTiles = std::move(other.glTiles);
+		other.glTiles.clear();
+		numTileMips = other.numTileMips;
+		pyramid = std::move(other.pyramid);
 		defaultSwizzle = other.defaultSwizzle;
 		other.defaultSwizzle = nullptr;
 		texData = other.texData;
@@ -200,16 +367,119 @@ public:
 		other.texDataFreeFun = nullptr;
 		ktxTex = other.ktxTex;
 		other.ktxTex = nullptr;
+		decodedData = std::move(other.decodedData);
+		other.decodedData.clear();
+		generatedMips = std::move(other.generatedMips);
+		other.generatedMips.clear();
+		ktxLazyLevels = std::move(other.ktxLazyLevels);
+		nextMipToUpload = other.nextMipToUpload;
+		other.nextMipToUpload = -1;
+		nextTileToUpload = other.nextTileToUpload;
+		other.nextTileToUpload = -1;
+		uploadStartTime = other.uploadStartTime;
+		uploadBusyTime = other.uploadBusyTime;
+		uploadedBytes = other.uploadedBytes;
 
 		return *this;
 	}
 
-	bool Load(const char* filename);
+	// if diagnostics is set, problems found in the file are added to it
+	// (in addition to being logged)
+	bool Load(const char* filename, std::vector<LoadDiagnostic>* diagnostics = nullptr);
+
+	// if the texture uses a compressed format that the GPU doesn't support,
+	// decode it in software (can be called from a worker thread)
+	// returns true if it was decoded
+	bool SoftwareDecodeIfUnsupported();
+
+	// creates all missing mip levels on the CPU if the (uncompressed) texture only has
+	// one, like all images loaded with stb_image (mipgen.cpp). Textures that are
+	// bigger than maxSize (if it's not 0) are skipped, they're shown through a pyramid
+	// with its own levels anyway. Can be called from a worker thread (before uploading).
+	// If assumeSRGB is set, 8bit RGB(A) images that don't specify their colorspace
+	// (like PNGs and JPGs) are filtered in linear light, like those that are marked as sRGB.
+	// returns true if the levels were generated
+	bool GenerateMipmaps(MipFilter filter, bool assumeSRGB, uint32_t maxSize = 0);
+
+	// creates a thumbnail of the first image (array layer or cubemap face) of the texture
+	// with at most maxSize x maxSize RGBA8 pixels (keeping the aspect ratio), from the
+	// smallest mip level that's at least that big. Can be called from a worker thread.
+	bool CreateThumbnail(int maxSize, std::vector<uint8_t>& rgba, int* thumbW, int* thumbH);
+
+	// decodes the given mip level of the given element (array layer or cubemap face,
+	// like in elements) to float RGBA (see ConvertToFloatRGBA()), without swizzling.
+	// Can be called from a worker thread, but not while the texture is being uploaded.
+	bool GetFloatImage(int level, int elemIdx, std::vector<float>& rgba);
+
+	// creates the OpenGL texture and uploads the data.
+	// if maxUploadBytes is set, only the smallest mip levels that fit into it
+	// (but at least one) are uploaded now, and GL_TEXTURE_BASE_LEVEL is set to the
+	// finest of them. The other levels must then be uploaded with ContinueUpload(),
+	// for example once per frame. (Textures uploaded with libktx are always uploaded
+	// at once, the others support this)
+	// 2D textures that are too big for OpenGL are split into glTiles, those are
+	// uploaded progressively one tile (with all its mip levels) at a time.
+	bool CreateOpenGLtexture(size_t maxUploadBytes = SIZE_MAX);
+
+	// uploads the next finer mip levels of a progressive upload
+	// (at least one level, more if they fit into maxUploadBytes) and updates
+	// GL_TEXTURE_BASE_LEVEL. Binds the texture. Returns false if nothing was uploaded
+	// (for tiled textures it's the next tiles instead of levels)
+	bool ContinueUpload(size_t maxUploadBytes);
+
+	// (for pyramids that's while it's being built)
+	bool IsUploadPending() const {
+		return nextMipToUpload >= 0 || nextTileToUpload >= 0 || IsPyramidBuilding();
+	}
+
+	// true for glTiles and pyramids
+	bool IsTiled() const {
+		return !glTiles.empty() || pyramid != nullptr;
+	}
+
+	bool IsPyramid() const {
+		return pyramid != nullptr;
+	}
+
+	// true if there's something to draw on the GPU (glTextureHandle or tiles)
+	// (or will be once the pyramid has been built)
+	bool HasGLTexture() const {
+		return glTextureHandle != 0 || !glTiles.empty() || pyramid != nullptr;
+	}
 
-	bool CreateOpenGLtexture();
+	bool IsPyramidBuilding() const;
+	// from 0 to 1 while the pyramid is built
+	float GetPyramidBuildProgress() const;
+	// 0 if there is no pyramid (yet)
+	int GetNumPyramidLevels() const;
+
+	// a tile of a pyramid that should be drawn
+	struct PyramidTile {
+		float x0, y0, x1, y1; // the part of the texture it covers, in texels of mip level 0
+		float tcMinX, tcMinY, tcMaxX, tcMaxY; // texture coordinates of that part in the tile
+		unsigned int glTextureHandle; // a GL_TEXTURE_2D with mipmaps
+	};
+	// sets tiles to the pyramid tiles that cover the part of the texture from x0, y0
+	// to x1, y1 (in texels of mip level 0), from the level that has about
+	// texelsPerPixel texels per pixel on the screen.
+	// Tiles that aren't on the GPU yet are uploaded from the cache file as long as they
+	// fit into maxUploadBytes, the others are replaced with the matching part of a
+	// tile of a coarser level. returns false if that happened (so it should be drawn
+	// again soon) or if the pyramid isn't ready yet
+	bool GetPyramidTiles(float x0, float y0, float x1, float y1, float texelsPerPixel,
+	                     size_t maxUploadBytes, std::vector<PyramidTile>& tiles);
+
+	// the finest mip level that's on the GPU already (and GL_TEXTURE_BASE_LEVEL)
+	int GetFinestUploadedMip() const {
+		return nextMipToUpload + 1;
+	}
 
 	void Clear();
 
+	// size of the data of all mip levels of all elements,
+	// roughly how much GPU memory the texture needs
+	size_t GetDataSize() const;
+
 	int GetNumMips() const {
 		return elements.empty() ? 0 : int(elements[0].size());
 	}
@@ -268,17 +538,60 @@ public:
 	const char* GetIntTexInfo(bool& isUnsigned);
 
 private:
-	bool LoadDDS(MemMappedFile* mmf, const char* filename);
-	bool LoadKTX(MemMappedFile* mmf, const char* filename);
+	bool LoadDDS(MemMappedFile* mmf, const char* filename, std::vector<LoadDiagnostic>* diags);
+	bool LoadKTX(MemMappedFile* mmf, const char* filename, std::vector<LoadDiagnostic>* diags);
+
+	// called by WithUncompressedImage() with the image's data, size and format
+	typedef std::function<bool(const void* data, uint32_t width, uint32_t height, uint32_t rowPitch,
+	                           uint32_t glFormat, uint32_t glType)> UncompressedImageFun;
+	// calls fn with the data of the given mip level of the given element,
+	// decoded in software if it's compressed. returns fn's result, or false
+	// if the image couldn't be read or decoded
+	bool WithUncompressedImage(int level, int elemIdx, const UncompressedImageFun& fn);
+	bool GetCompressedImages(std::vector<CompressedImage>& images);
+	bool SoftwareDecode();
+	bool UploadToOpenGL(size_t maxUploadBytes);
+	bool AllocateTextureStorage();
+	bool UploadNextMipLevels(size_t maxUploadBytes, bool mayWait);
+	bool UploadMipLevel(int mipIdx);
+	bool NeedsTiles() const;
+	bool UploadTiled(size_t maxUploadBytes);
+	bool UploadNextTiles(size_t maxUploadBytes);
+	bool UploadTile(GLTile& tile);
+	// opens the cached pyramid or starts building it, returns false if the texture
+	// can't be shown through a pyramid (pyramid.cpp)
+	bool StartPyramid();
+	// opens the pyramid's cache file once it has been built, if building
+	// or opening it failed, the texture is uploaded as glTiles instead
+	bool ContinuePyramid(size_t maxUploadBytes);
+	// stops building the pyramid (waits for the job) and deletes its tiles on the GPU
+	void DeletePyramid();
+	void DeleteGLTiles();
+	// returns false if it's a lazily inflated level that isn't ready yet
+	bool IsKTXLevelReady(int level) const;
+
+	void StartInflatingKTXLevels(MemMappedFile* mmf);
+	void StopInflatingKTXLevels();
+	// makes the MipLevels of the given level point to its inflated data
+	// (waits for it to be inflated if necessary), returns false on error
+	bool AcquireKTXLevel(int level);
+	// frees the inflated data of the level again
+	void ReleaseKTXLevel(int level);
+	// inflates all levels into ktxTex, like when loading it without lazy inflation
+	bool LoadAllKTXLevels();
 
 	bool UploadTexture2D(uint32_t target, int internalFormat, int level, bool isCompressed, const Texture::MipLevel& mipLevel);
 	bool UploadTexture3Dslice(uint32_t target, int internalFormat, int level, int elemIdx, bool isCompressed, const Texture::MipLevel& mipLevel);
+	bool UploadInChunks(uint32_t target, int internalFormat, int level, int elemIdx, bool isCompressed, const Texture::MipLevel& mipLevel);
 };
 
 // how much we scale the font used by ImGui (*not* including the scaling ImGui
 // does automatically, if any) - for UpdateWarningOverlay()
 extern float imguiAdditionalScale;
 
+// OpenGL version of the context, major*10 + minor (e.g. 43 for 4.3), set in main()
+extern int glVersion;
+
 enum LogLevel {
 	LL_INFO,
 	LL_WARN,
@@ -290,12 +603,22 @@ extern void LogWindowHide();
 extern bool LogWindowIsShown();
 extern void DrawLogWindow();
 extern void LogImGuiInit();
+// for redrawing on demand: returns in how many seconds the log window or warning
+// overlay must be redrawn (0 if it changed, e.g. because a worker thread logged
+// something), or a negative value if it doesn't need to be redrawn
+extern double LogGetRedrawTimeout();
 
 extern void LogInfo(const char* fmt, ...) IM_FMTARGS(1);
 extern void LogWarn(const char* fmt, ...) IM_FMTARGS(1);
 extern void LogError(const char* fmt, ...) IM_FMTARGS(1);
 // to log additional lines without timestamp or "[Error]"
 extern void LogPrint(const char* fmt, ...) IM_FMTARGS(1);
+// for headless modes that print their own reports: if muted,
+// log messages are dropped instead of being printed to stderr
+extern void LogSetMuted(bool muted);
+// same, but only for messages logged by the calling thread, for example
+// in a worker job that creates thumbnails and shouldn't pop up warnings
+extern void LogSetMutedInThisThread(bool muted);
 
 extern void StringAppendFormatted(std::string& str, const char* fmt, ...)  IM_FMTARGS(2);
 extern void StringAppendFormattedV(std::string& str, const char* fmt, va_list args) IM_FMTLIST(2);
@@ -307,6 +630,179 @@ extern const char* GetSettingsDir();
 // but restored to its original state before it returns
 extern bool CreatePathRecursive(char* path);
 
+// window that lists the textures in a directory, with thumbnails (browser.cpp)
+extern void BrowserWindowShow();
+extern void BrowserWindowHide();
+extern bool BrowserWindowIsShown();
+// must be called every frame (also when the window isn't shown),
+// the window lists the directory of currentFile (unless the user changed it).
+// returns true if a file was clicked, its path is then written to fileToOpen
+extern bool DrawBrowserWindow(const char* currentFile, std::string& fileToOpen);
+// true while thumbnails that should be shown are still being created,
+// the window must be redrawn continuously then to show them once they're done
+extern bool BrowserNeedsRedraw();
+// sets names to the names (not paths) of the files in dir that look like
+// supported textures (by their extension), sorted like in the browser window
+extern void ListTextureFiles(const char* dir, std::vector<std::string>& names);
+// frees the thumbnails and writes new ones to the disk cache, call before ThreadPoolShutdown()
+extern void BrowserShutdown();
+
+// persistent cache of the browser's RGBA8 thumbnails in GetSettingsDir() (thumbcache.cpp)
+// returns a key for the file at path (a hash of its absolute path, size and
+// modification time), or 0 if it doesn't exist
+extern uint64_t ThumbCacheGetKey(const char* path);
+// returns the cached thumbnail for key (or NULL if it's not cached),
+// only valid until the next ThumbCacheAdd() or ThumbCacheShutdown()
+extern const uint8_t* ThumbCacheFind(uint64_t key, int* width, int* height);
+extern void ThumbCacheAdd(uint64_t key, std::vector<uint8_t>&& rgba, int width, int height);
+// writes the thumbnails added in this session to disk
+extern void ThumbCacheShutdown();
+
+// a simple pool of worker threads (threadpool.cpp)
+// numThreads <= 0 means "one per CPU core"
+extern void ThreadPoolInit(int numThreads = 0);
+// waits for running jobs to finish, jobs that haven't been started yet are dropped
+extern void ThreadPoolShutdown();
+extern int ThreadPoolGetNumThreads();
+// job is run in one of the worker threads at some point
+extern void ThreadPoolAddJob(std::function<void()> job);
+// calls fn(i) for all i in [0, numItems) on the worker threads
+// (and the calling thread) and returns once all calls are done
+extern void ParallelFor(int numItems, const std::function<void(int)>& fn);
+
+// streaming texture data to the GPU through a ring of pixel buffer memory (uploadring.cpp)
+// only call these from the main thread (with the OpenGL context)
+
+// biggest size that UploadRingBegin() accepts, bigger images must be uploaded in chunks.
+// 0 if the upload ring isn't available (then the data is uploaded from client memory)
+extern size_t UploadRingGetMaxChunkSize();
+// copies size bytes from data into the ring and binds it as GL_PIXEL_UNPACK_BUFFER.
+// returns what must be passed as data to glTex(Sub)Image*() or glCompressedTex(Sub)Image*()
+// (an offset into the buffer), or data itself if it can't be used (and then nothing is bound)
+extern const void* UploadRingBegin(const void* data, size_t size);
+// call this after the glTex*Image*() call that used UploadRingBegin()'s return value
+extern void UploadRingEnd();
+extern bool UploadRingIsPersistent();
+// call before destroying the OpenGL context
+extern void UploadRingShutdown();
+
+// software decoding of compressed formats the GPU doesn't support (texdecode.cpp)
+struct DecodedFormat {
+	uint32_t glIntFormat; // like Texture::dataFormat
+	uint32_t glFormat;
+	uint32_t glType;
+	uint32_t bytesPerPixel;
+};
+
+struct CompressedImage {
+	const void* data;
+	uint32_t size;
+	uint32_t width;
+	uint32_t height;
+	void* decodedData; // must have space for width * height * bytesPerPixel
+};
+
+// returns false if compressedGLformat can't be decoded in software,
+// otherwise sets *out to the uncompressed format it's decoded to.
+// for ASTC that depends on the data (HDR blocks are decoded to half floats),
+// so pass the images if you want to decode them (decodedData isn't used here)
+extern bool GetSoftwareDecodedFormat(uint32_t compressedGLformat, DecodedFormat* out,
+                                     const CompressedImage* images = nullptr, int numImages = 0);
+// decodes all images (e.g. all mipmap levels of a texture) in parallel
+// to decodedFormat, which must be the one returned by GetSoftwareDecodedFormat()
+extern bool DecodeCompressedImages(uint32_t compressedGLformat, const CompressedImage* images, int numImages,
+                                   const DecodedFormat& decodedFormat);
+// downscales an uncompressed image (in glFormat and glType, like the ones in Texture)
+// with a box filter to dstWidth x dstHeight RGBA8 pixels, written to dst.
+// rowPitch is the size of a row of the image in bytes (0: no padding).
+// if swizzle is set (like Texture::defaultSwizzle) it's applied to the result.
+// returns false for unsupported formats, like integer textures
+extern bool DownscaleToRGBA8(const void* data, uint32_t width, uint32_t height, uint32_t rowPitch,
+                             uint32_t glFormat, uint32_t glType, const char* swizzle,
+                             uint32_t dstWidth, uint32_t dstHeight, uint8_t* dst);
+// converts an uncompressed image (in glFormat and glType, like the ones in Texture)
+// to float RGBA, written to dst (width * height * 4 floats). Channels the format
+// doesn't have are 0, alpha is 1. rowPitch like in DownscaleToRGBA8().
+// returns false for unsupported formats, like integer textures
+extern bool ConvertToFloatRGBA(const void* data, uint32_t width, uint32_t height, uint32_t rowPitch,
+                               uint32_t glFormat, uint32_t glType, float* dst);
+// converts the w x h texels at x, y of ml (a mip level of a 2D texture in the given
+// formats, like in Texture) to float RGBA, written to dst (w * h * 4 floats).
+// Compressed formats are decoded in software, x and y must be multiples of their
+// block size then. Doesn't need the Texture, so it can be used by worker threads
+// as long as ml.data stays valid (texload.cpp)
+extern bool ConvertImageRegionToFloatRGBA(const Texture::MipLevel& ml, uint32_t dataFormat,
+                                          uint32_t glFormat, uint32_t glType, bool isCompressed,
+                                          uint32_t x, uint32_t y, uint32_t w, uint32_t h, float* dst);
+// prints how fast the decoders are (for texview --bench-decoders)
+extern void BenchmarkSoftwareDecoders();
+
+// 8 bit sRGB <-> linear float with lookup tables, thread-safe (mipgen.cpp)
+extern const float* GetSRGB8ToLinearLUT(); // 256 entries
+extern uint8_t LinearToSRGB8(float v);
+
+// error metrics between two images, on the CPU (imagecompare.cpp)
+struct ImageErrors {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	// mean squared error and the biggest absolute difference per channel (RGBA)
+	double mse[4] = {};
+	double maxError[4] = {};
+	double mseRGB = 0.0; // average of the red, green and blue MSE
+	double ssim[4] = {}; // mean SSIM per channel, only set if it was requested
+};
+
+// peak is the biggest possible value, 1.0 for normalized data. returns INFINITY if mse is 0
+extern double MSEToPSNR(double mse, double peak = 1.0);
+// a and b are float RGBA images (see ConvertToFloatRGBA()) of the same size.
+// calculating the SSIM (of 8x8 pixel windows) takes about twice as long as the rest
+extern void CompareFloatImages(const float* a, const float* b, uint32_t width, uint32_t height,
+                               ImageErrors* errors, bool calcSSIM = false);
+// compares the given mip level of element elemIdxA of a with that of element elemIdxB of b.
+// returns false if the sizes don't match or if the images can't be converted to float
+extern bool CompareTextureImages(Texture& a, int elemIdxA, Texture& b, int elemIdxB, int level,
+                                 ImageErrors* errors, bool calcSSIM = false);
+
+enum { IMAGE_STATS_NUM_BINS = 256 };
+
+// value statistics of an image per channel (RGBA), also on the CPU (imagecompare.cpp)
+struct ImageStats {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	double min[4] = {};
+	double max[4] = {};
+	double mean[4] = {};
+	double stddev[4] = {};
+	// the histograms of all channels cover the same range: at least 0 to 1,
+	// more if there are values outside of that (HDR, SNORM)
+	float histoMin = 0.0f;
+	float histoMax = 1.0f;
+	uint32_t histogram[4][IMAGE_STATS_NUM_BINS] = {};
+};
+
+// sets histoMin and histoMax from min and max
+extern void SetHistogramRange(ImageStats* stats);
+// rgba is a float RGBA image (see ConvertToFloatRGBA())
+extern void CalcImageStats(const float* rgba, uint32_t width, uint32_t height, ImageStats* stats);
+// calculates the statistics of the given mip level of the given element (array layer or
+// cubemap face, like in Texture::elements), without swizzling. returns false if that failed
+extern bool CalcTextureImageStats(Texture& tex, int elemIdx, int level, ImageStats* stats);
+
+// command line modes that don't need a window or OpenGL (cli.cpp)
+// argc and argv are the arguments after the mode's name, they return the exit code
+
+// texview --info [--json] file...
+// loads the files in parallel and prints information about them
+extern int RunInfoCommand(int argc, char** argv);
+
+// texview --validate [--json] [--werror] file-or-dir...
+// checks all DDS and KTX files (recursively in directories) for problems
+extern int RunValidateCommand(int argc, char** argv);
+
+// texview --compare [--json] [--min-psnr dB] [--min-ssim val] [--list file] a b [a2 b2 ...]
+// compares pairs of textures on the CPU (per mip level, layer and face)
+extern int RunCompareCommand(int argc, char** argv);
+
 } //namespace texview
 
 #endif // _TEXVIEW_H
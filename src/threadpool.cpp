@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+#include "texview.h"
+
+#include <assert.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace texview {
+
+static std::mutex jobMutex;
+static std::condition_variable jobCondVar;
+static std::deque<std::function<void()>> jobQueue;
+static std::vector<std::thread> workerThreads;
+static bool shutdownRequested = false;
+
+static void WorkerThreadFun()
+{
+	std::unique_lock<std::mutex> lock(jobMutex);
+	while(true) {
+		jobCondVar.wait(lock, []{ return shutdownRequested || !jobQueue.empty(); });
+		if(shutdownRequested) {
+			return;
+		}
+		std::function<void()> job = std::move(jobQueue.front());
+		jobQueue.pop_front();
+
+		// don't hold the lock while the job is running,
+		// other workers wouldn't get new jobs otherwise
+		lock.unlock();
+		job();
+		lock.lock();
+	}
+}
+
+void ThreadPoolInit(int numThreads)
+{
+	if(!workerThreads.empty()) {
+		return; // already initialized
+	}
+	if(numThreads <= 0) {
+		// hardware_concurrency() returns 0 if it doesn't know
+		numThreads = std::max(2, (int)std::thread::hardware_concurrency());
+	}
+	shutdownRequested = false;
+	workerThreads.reserve(numThreads);
+	for(int i=0; i < numThreads; ++i) {
+		workerThreads.push_back( std::thread(WorkerThreadFun) );
+	}
+}
+
+void ThreadPoolShutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		shutdownRequested = true;
+		// jobs that haven't been started yet are just dropped,
+		// but the ones that are already running are finished
+		// (they can't be interrupted anyway)
+		jobQueue.clear();
+	}
+	jobCondVar.notify_all();
+	for(std::thread& t : workerThreads) {
+		t.join();
+	}
+	workerThreads.clear();
+}
+
+int ThreadPoolGetNumThreads()
+{
+	return (int)workerThreads.size();
+}
+
+void ThreadPoolAddJob(std::function<void()> job)
+{
+	assert(!workerThreads.empty() && "call ThreadPoolInit() first!");
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		jobQueue.push_back(std::move(job));
+	}
+	jobCondVar.notify_one();
+}
+
+struct ParallelForState {
+	std::atomic<int> nextItem{0};
+	std::atomic<int> numDone{0};
+	int numItems = 0;
+	std::mutex mutex;
+	std::condition_variable doneCondVar;
+	const std::function<void(int)>* fn = nullptr;
+
+	// grabs items and runs fn on them until there are none left
+	void Work()
+	{
+		int done = 0;
+		while(true) {
+			int item = nextItem.fetch_add(1);
+			if(item >= numItems) {
+				break;
+			}
+			(*fn)(item);
+			++done;
+		}
+		if(done > 0 && numDone.fetch_add(done) + done == numItems) {
+			std::lock_guard<std::mutex> lock(mutex);
+			doneCondVar.notify_all();
+		}
+	}
+};
+
+void ParallelFor(int numItems, const std::function<void(int)>& fn)
+{
+	if(numItems <= 0) {
+		return;
+	}
+	int numThreads = (int)workerThreads.size();
+	if(numItems == 1 || numThreads == 0) {
+		for(int i=0; i < numItems; ++i) {
+			fn(i);
+		}
+		return;
+	}
+
+	// the state is shared with the helper jobs because they might only get
+	// to run after this function has returned (if the workers were busy
+	// with other jobs and the calling thread did all the work itself).
+	// fn is only ever called for items that haven't been completed yet,
+	// so using the pointer to it is fine (we return only after all are done)
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->numItems = numItems;
+	state->fn = &fn;
+
+	int numHelpers = std::min(numItems - 1, numThreads);
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		for(int i=0; i < numHelpers; ++i) {
+			jobQueue.push_back([state]() { state->Work(); });
+		}
+	}
+	jobCondVar.notify_all();
+
+	// the calling thread helps as well, which also means that calling
+	// ParallelFor() from a worker thread can't deadlock
+	state->Work();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->doneCondVar.wait(lock, [&state]{ return state->numDone.load() == state->numItems; });
+}
+
+} //namespace texview
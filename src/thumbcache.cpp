@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+// persistent cache for the browser's thumbnails, so they don't have to be
+// created again every time a directory is opened.
+// It's a single file in GetSettingsDir() that's memory-mapped, so looking up
+// a thumbnail is just a stat() and a binary search and the thumbnail can be
+// uploaded straight from the mapping. The file looks like:
+//   ThumbCacheHeader
+//   the RGBA8 data of all thumbnails
+//   the index: header.numEntries ThumbCacheEntry, sorted by key
+// Thumbnails created in this session are kept in memory until the cache is
+// flushed, then their data is written where the index was and a new index
+// is written behind it.
+
+#include "texview.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace texview {
+
+struct ThumbCacheHeader {
+	char magic[8]; // "TVTHUMBS"
+	uint32_t version;
+	uint32_t numEntries; // 0 while the file is being written
+	uint64_t indexOffset;
+};
+
+struct ThumbCacheEntry {
+	uint64_t key; // from ThumbCacheGetKey()
+	uint64_t offset; // of the RGBA8 data, from the start of the file
+	uint16_t width;
+	uint16_t height;
+	uint32_t padding;
+};
+
+static const char thumbCacheMagic[8] = { 'T', 'V', 'T', 'H', 'U', 'M', 'B', 'S' };
+static const uint32_t thumbCacheVersion = 1;
+
+// if the file would get bigger than this, it's rewritten with only the thumbnails
+// that have been used in this session (the others are likely from files
+// that have been changed or deleted since)
+static const uint64_t thumbCacheMaxBytes = 512ull << 20;
+// new thumbnails are written to disk when they use more than this much memory
+static const size_t thumbCacheMaxPendingBytes = 64 << 20;
+
+static bool thumbCacheOpened = false;
+static MemMappedFile* thumbCacheFile = nullptr;
+static const ThumbCacheEntry* thumbCacheIndex = nullptr;
+static uint32_t thumbCacheNumEntries = 0;
+// keys of the thumbnails that were used or added in this session
+static std::unordered_set<uint64_t> thumbCacheUsedKeys;
+
+struct PendingThumb {
+	std::vector<uint8_t> rgba;
+	int width = 0;
+	int height = 0;
+};
+static std::unordered_map<uint64_t, PendingThumb> pendingThumbs;
+static size_t pendingThumbBytes = 0;
+
+static std::string GetThumbCachePath()
+{
+	std::string ret = GetSettingsDir();
+#ifdef _WIN32
+	ret += "\\thumbcache.bin";
+#else
+	ret += "/thumbcache.bin";
+#endif
+	return ret;
+}
+
+static uint64_t HashFNV1a(const void* data, size_t len, uint64_t hash = 0xcbf29ce484222325ull)
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	for(size_t i = 0; i < len; ++i) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static void ThumbCacheClose()
+{
+	if(thumbCacheFile != nullptr) {
+		UnloadMemMappedFile(thumbCacheFile);
+		thumbCacheFile = nullptr;
+	}
+	thumbCacheIndex = nullptr;
+	thumbCacheNumEntries = 0;
+}
+
+static void ThumbCacheOpen()
+{
+	thumbCacheOpened = true;
+	std::string path = GetThumbCachePath();
+	uint64_t fileSize = 0;
+	int64_t modTime = 0;
+	if(!GetFileSizeAndModTime(path.c_str(), &fileSize, &modTime)) {
+		return; // doesn't exist yet
+	}
+	if(fileSize < sizeof(ThumbCacheHeader)) {
+		LogWarn("Thumbnail cache '%s' is broken (too small), ignoring it\n", path.c_str());
+		return;
+	}
+	thumbCacheFile = LoadMemMappedFile(path.c_str());
+	if(thumbCacheFile == nullptr) {
+		return;
+	}
+	const ThumbCacheHeader* header = (const ThumbCacheHeader*)thumbCacheFile->data;
+	if(memcmp(header->magic, thumbCacheMagic, sizeof(thumbCacheMagic)) != 0
+	   || header->version != thumbCacheVersion) {
+		LogWarn("Thumbnail cache '%s' has unknown format or version, ignoring it\n", path.c_str());
+		ThumbCacheClose();
+		return;
+	}
+	uint64_t indexSize = uint64_t(header->numEntries) * sizeof(ThumbCacheEntry);
+	if(header->indexOffset < sizeof(ThumbCacheHeader) || (header->indexOffset % 8) != 0
+	   || header->indexOffset + indexSize != thumbCacheFile->length) {
+		// can also happen if texview crashed while writing it
+		LogWarn("Thumbnail cache '%s' is broken, ignoring it\n", path.c_str());
+		ThumbCacheClose();
+		return;
+	}
+	thumbCacheIndex = (const ThumbCacheEntry*)((const char*)thumbCacheFile->data + header->indexOffset);
+	thumbCacheNumEntries = header->numEntries;
+}
+
+uint64_t ThumbCacheGetKey(const char* path)
+{
+	uint64_t size = 0;
+	int64_t modTime = 0;
+	if(!GetFileSizeAndModTime(path, &size, &modTime)) {
+		return 0;
+	}
+	std::string absPath = ToAbsolutePath(path);
+	uint64_t hash = HashFNV1a(absPath.data(), absPath.size());
+	hash = HashFNV1a(&size, sizeof(size), hash);
+	hash = HashFNV1a(&modTime, sizeof(modTime), hash);
+	return (hash != 0) ? hash : 1; // 0 means "no key"
+}
+
+const uint8_t* ThumbCacheFind(uint64_t key, int* width, int* height)
+{
+	if(key == 0) {
+		return nullptr;
+	}
+	if(!thumbCacheOpened) {
+		ThumbCacheOpen();
+	}
+	auto pit = pendingThumbs.find(key);
+	if(pit != pendingThumbs.end()) {
+		*width = pit->second.width;
+		*height = pit->second.height;
+		return pit->second.rgba.data();
+	}
+	const ThumbCacheEntry* end = thumbCacheIndex + thumbCacheNumEntries;
+	const ThumbCacheEntry* e = std::lower_bound(thumbCacheIndex, end, key,
+		[](const ThumbCacheEntry& e, uint64_t k) -> bool { return e.key < k; });
+	if(e == end || e->key != key) {
+		return nullptr;
+	}
+	const ThumbCacheHeader* header = (const ThumbCacheHeader*)thumbCacheFile->data;
+	uint64_t size = uint64_t(e->width) * e->height * 4;
+	if(size == 0 || e->offset < sizeof(ThumbCacheHeader) || e->offset + size > header->indexOffset) {
+		return nullptr; // broken entry
+	}
+	thumbCacheUsedKeys.insert(key);
+	*width = e->width;
+	*height = e->height;
+	return (const uint8_t*)thumbCacheFile->data + e->offset;
+}
+
+static bool WriteAll(FILE* f, const void* data, size_t size)
+{
+	return size == 0 || fwrite(data, size, 1, f) == 1;
+}
+
+// writes the data of all pending thumbnails at offset, followed by the index
+// (of them and the old entries), and updates the header.
+// if copyOldData is set, the data of the old entries is copied from the current
+// mapping first, otherwise it's expected to already be in the file before offset.
+// the header is first written with numEntries = 0 so a file that's only
+// partly written (because of a crash or full disk) is detected as broken
+static bool WriteThumbCache(FILE* f, uint64_t offset, std::vector<ThumbCacheEntry>& entries, bool copyOldData)
+{
+	ThumbCacheHeader header = {};
+	memcpy(header.magic, thumbCacheMagic, sizeof(thumbCacheMagic));
+	header.version = thumbCacheVersion;
+	if(!FSeek64(f, 0) || !WriteAll(f, &header, sizeof(header)) || !FSeek64(f, offset)) {
+		return false;
+	}
+
+	// if an old entry was broken, the thumbnail was created again
+	// and the old entry must not be in the index anymore
+	entries.erase(std::remove_if(entries.begin(), entries.end(), [](const ThumbCacheEntry& e) -> bool {
+		return pendingThumbs.count(e.key) != 0;
+	}), entries.end());
+	if(copyOldData) {
+		const uint8_t* mapped = (const uint8_t*)thumbCacheFile->data;
+		for(ThumbCacheEntry& e : entries) {
+			size_t size = size_t(e.width) * e.height * 4;
+			if(!WriteAll(f, mapped + e.offset, size)) {
+				return false;
+			}
+			e.offset = offset;
+			offset += size;
+		}
+	}
+	for(const auto& it : pendingThumbs) {
+		const PendingThumb& pt = it.second;
+		ThumbCacheEntry e = {};
+		e.key = it.first;
+		e.offset = offset;
+		e.width = (uint16_t)pt.width;
+		e.height = (uint16_t)pt.height;
+		if(!WriteAll(f, pt.rgba.data(), pt.rgba.size())) {
+			return false;
+		}
+		offset += pt.rgba.size();
+		entries.push_back(e);
+	}
+	// the index is read in place from the mapping, so align it
+	static const uint8_t zeros[8] = {};
+	size_t padding = (8 - offset % 8) % 8;
+	if(!WriteAll(f, zeros, padding)) {
+		return false;
+	}
+	offset += padding;
+
+	std::sort(entries.begin(), entries.end(), [](const ThumbCacheEntry& a, const ThumbCacheEntry& b) -> bool {
+		return a.key < b.key;
+	});
+	if(!WriteAll(f, entries.data(), entries.size() * sizeof(ThumbCacheEntry))) {
+		return false;
+	}
+	header.numEntries = (uint32_t)entries.size();
+	header.indexOffset = offset;
+	return FSeek64(f, 0) && WriteAll(f, &header, sizeof(header));
+}
+
+static void ThumbCacheFlush()
+{
+	if(pendingThumbs.empty()) {
+		return;
+	}
+	std::string path = GetThumbCachePath();
+	uint64_t oldDataEnd = sizeof(ThumbCacheHeader);
+	if(thumbCacheFile != nullptr) {
+		oldDataEnd = ((const ThumbCacheHeader*)thumbCacheFile->data)->indexOffset;
+	}
+	std::vector<ThumbCacheEntry> entries;
+	bool ok = false;
+	if(oldDataEnd + pendingThumbBytes <= thumbCacheMaxBytes) {
+		// append the new thumbnails, the old data stays where it is.
+		// the mapping must be closed before writing to the file (at least on Windows)
+		entries.assign(thumbCacheIndex, thumbCacheIndex + thumbCacheNumEntries);
+		bool exists = (thumbCacheFile != nullptr);
+		ThumbCacheClose();
+		FILE* f = FOpenUTF8(path.c_str(), exists ? "r+b" : "wb");
+		if(f != nullptr) {
+			ok = WriteThumbCache(f, oldDataEnd, entries, false);
+			ok = (fclose(f) == 0) && ok;
+		}
+	} else {
+		// too big => write a new file with just the thumbnails used in this session
+		// (and the new ones), then replace the old file with it
+		uint64_t size = sizeof(ThumbCacheHeader) + pendingThumbBytes;
+		for(uint32_t i = 0; i < thumbCacheNumEntries; ++i) {
+			if(thumbCacheUsedKeys.count(thumbCacheIndex[i].key) != 0) {
+				entries.push_back(thumbCacheIndex[i]);
+				size += uint64_t(thumbCacheIndex[i].width) * thumbCacheIndex[i].height * 4;
+			}
+		}
+		if(size > thumbCacheMaxBytes) {
+			entries.clear(); // even that's too much, start over
+		}
+		std::string tmpPath = path + ".tmp";
+		FILE* f = FOpenUTF8(tmpPath.c_str(), "wb");
+		if(f != nullptr) {
+			ok = WriteThumbCache(f, sizeof(ThumbCacheHeader), entries, true);
+			ok = (fclose(f) == 0) && ok;
+		}
+		ThumbCacheClose();
+		ok = ok && RenameFile(tmpPath.c_str(), path.c_str());
+	}
+	if(!ok) {
+		LogWarn("Couldn't write thumbnail cache '%s'\n", path.c_str());
+	}
+	pendingThumbs.clear();
+	pendingThumbBytes = 0;
+	// (re)open it, unless this was called by ThumbCacheShutdown()
+	thumbCacheOpened = false;
+}
+
+void ThumbCacheAdd(uint64_t key, std::vector<uint8_t>&& rgba, int width, int height)
+{
+	if(key == 0 || width <= 0 || height <= 0 || width > 0xffff || height > 0xffff
+	   || rgba.size() != size_t(width) * height * 4) {
+		return;
+	}
+	thumbCacheUsedKeys.insert(key);
+	PendingThumb& pt = pendingThumbs[key];
+	pendingThumbBytes -= pt.rgba.size();
+	pt.rgba = std::move(rgba);
+	pt.width = width;
+	pt.height = height;
+	pendingThumbBytes += pt.rgba.size();
+	if(pendingThumbBytes > thumbCacheMaxPendingBytes) {
+		ThumbCacheFlush();
+	}
+}
+
+void ThumbCacheShutdown()
+{
+	ThumbCacheFlush();
+	ThumbCacheClose();
+	thumbCacheOpened = false;
+	thumbCacheUsedKeys.clear();
+}
+
+} //namespace texview
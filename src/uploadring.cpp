@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2025 Daniel Gibson
+ *
+ * Released under MIT License, see Licenses.txt
+ */
+
+#include <glad/gl.h>
+
+#include "texview.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <deque>
+
+namespace texview {
+
+// texture data is streamed to the GPU through one big pixel buffer object
+// that's used as a ring buffer: each upload copies its data to the next free
+// part of it and the glTex*Image*() call only gets the offset into the buffer,
+// so the driver doesn't have to copy it (again) and the transfer to the GPU
+// can happen asynchronously while we render.
+// A fence after each upload tells when that part of the ring can be reused.
+
+static const size_t ringSize = 32 << 20;
+// data passed to UploadRingBegin() at once can't be bigger than this,
+// bigger images must be uploaded in several chunks
+static const size_t maxChunkSize = ringSize / 4;
+// for small images, copying them to the ring and creating a fence
+// isn't worth the effort, the driver can just copy them right away
+static const size_t minChunkSize = 64 * 1024;
+
+struct RingRange {
+	GLsync fence;
+	size_t begin;
+	size_t end;
+};
+
+static GLuint ringPBO = 0;
+// if ARB_buffer_storage is supported, the whole buffer is mapped persistently
+// and the data is memcpy()d straight into it, otherwise each range is mapped
+// with glMapBufferRange() while copying the data to it
+static unsigned char* ringMapping = nullptr;
+static bool ringInitFailed = false;
+static size_t ringHead = 0; // where the next range will start (unless it must wrap around)
+static std::deque<RingRange> ringRanges; // ranges still used by the GPU, oldest first
+static RingRange curRange = {};
+static bool curRangeActive = false;
+
+static bool InitUploadRing()
+{
+	if(ringPBO != 0) {
+		return true;
+	}
+	if(ringInitFailed) {
+		return false;
+	}
+	glGetError();
+	glGenBuffers(1, &ringPBO);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ringPBO);
+	if(GLAD_GL_ARB_buffer_storage) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, ringSize, nullptr, flags);
+		ringMapping = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ringSize, flags);
+		if(ringMapping == nullptr) {
+			LogWarn("Couldn't map the texture upload buffer persistently (glGetError() says 0x%x), "
+			        "falling back to glMapBufferRange() for each upload\n", glGetError());
+			// the storage of the buffer is immutable now, so a new one is needed
+			glDeleteBuffers(1, &ringPBO);
+			glGenBuffers(1, &ringPBO);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ringPBO);
+		}
+	}
+	if(ringMapping == nullptr) {
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, ringSize, nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	GLenum e = glGetError();
+	if(e != GL_NO_ERROR) {
+		LogWarn("Creating the texture upload buffer failed (glGetError() says 0x%x), "
+		        "textures will be uploaded directly from client memory\n", e);
+		glDeleteBuffers(1, &ringPBO);
+		ringPBO = 0;
+		ringMapping = nullptr;
+		ringInitFailed = true;
+		return false;
+	}
+	LogInfo("Using a %d MB %s pixel buffer object for texture uploads\n", int(ringSize >> 20),
+	        ringMapping ? "persistently mapped" : "streaming");
+	return true;
+}
+
+// waits until the GPU doesn't use any part of [begin, end) of the ring anymore
+static void WaitForRingRange(size_t begin, size_t end)
+{
+	// ranges are reused in the order they were used in, so if the
+	// newest overlapping one is done, all older ones are done as well
+	int lastOverlapping = -1;
+	for(int i=0; i < (int)ringRanges.size(); ++i) {
+		const RingRange& r = ringRanges[i];
+		if(r.begin < end && begin < r.end) {
+			lastOverlapping = i;
+		}
+	}
+	if(lastOverlapping >= 0) {
+		GLsync fence = ringRanges[lastOverlapping].fence;
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while(glClientWaitSync(fence, flags, 1000000000) == GL_TIMEOUT_EXPIRED) {
+			flags = 0; // flushing once is enough
+		}
+		for(int i=0; i <= lastOverlapping; ++i) {
+			glDeleteSync(ringRanges.front().fence);
+			ringRanges.pop_front();
+		}
+	}
+	// also get rid of the ones that are done anyway, so the list doesn't get too long
+	while(!ringRanges.empty()) {
+		GLenum res = glClientWaitSync(ringRanges.front().fence, 0, 0);
+		if(res != GL_ALREADY_SIGNALED && res != GL_CONDITION_SATISFIED) {
+			break;
+		}
+		glDeleteSync(ringRanges.front().fence);
+		ringRanges.pop_front();
+	}
+}
+
+size_t UploadRingGetMaxChunkSize()
+{
+	return InitUploadRing() ? maxChunkSize : 0;
+}
+
+const void* UploadRingBegin(const void* data, size_t size)
+{
+	if(size < minChunkSize || size > maxChunkSize || !InitUploadRing()) {
+		return data;
+	}
+	// offsets into the PBO must be aligned to the size of the pixel type
+	size_t alignedSize = (size + 15) & ~size_t(15);
+	size_t begin = ringHead;
+	if(begin + alignedSize > ringSize) {
+		begin = 0; // wrap around
+	}
+	WaitForRingRange(begin, begin + alignedSize);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ringPBO);
+	if(ringMapping != nullptr) {
+		memcpy(ringMapping + begin, data, size);
+	} else {
+		// the fences make sure that the GPU isn't using this range anymore,
+		// so the driver doesn't need to synchronize
+		GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, begin, size, access);
+		if(dst == nullptr) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return data;
+		}
+		memcpy(dst, data, size);
+		if(!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+			// the buffer's contents got corrupted somehow, the caller can still use data
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return data;
+		}
+	}
+	curRange.begin = begin;
+	curRange.end = begin + alignedSize;
+	curRangeActive = true;
+	ringHead = curRange.end;
+
+	// with a buffer bound to GL_PIXEL_UNPACK_BUFFER, the data "pointer"
+	// is interpreted as an offset into that buffer
+	return (const void*)(uintptr_t)begin;
+}
+
+void UploadRingEnd()
+{
+	if(!curRangeActive) {
+		return;
+	}
+	curRange.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	ringRanges.push_back(curRange);
+	curRangeActive = false;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+bool UploadRingIsPersistent()
+{
+	return ringMapping != nullptr;
+}
+
+void UploadRingShutdown()
+{
+	for(RingRange& r : ringRanges) {
+		glDeleteSync(r.fence);
+	}
+	ringRanges.clear();
+	if(ringPBO != 0) {
+		if(ringMapping != nullptr) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ringPBO);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			ringMapping = nullptr;
+		}
+		glDeleteBuffers(1, &ringPBO);
+		ringPBO = 0;
+	}
+	ringHead = 0;
+}
+
+} //namespace texview